@@ -0,0 +1,123 @@
+#    This is a component of EMC2
+#
+#    This program is free software; you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation; either version 2 of the License, or
+#    (at your option) any later version.
+#
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    GNU General Public License for more details.
+#
+#    You should have received a copy of the GNU General Public License
+#    along with this program; if not, write to the Free Software
+#    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#
+#
+# Reads the files written by trajlog(1).  A file is a trajlog_file_header_t
+# followed by trajlog_entry_t records, as laid out in
+# src/emc/motion/trajlog.h, in the byte order of the machine that wrote it.
+#
+#     import trajlog
+#     period, records = trajlog.read("run.trajlog")   # list of dicts
+#     a = trajlog.load("run.trajlog")                 # numpy record array
+#
+# Run as a program, it prints the records of a file as CSV.
+#
+import struct
+import sys
+
+FILE_MAGIC = "EMCTRAJ\0"
+VERSION = 1
+
+# in the order of trajlog_entry_t
+FIELDS = [
+    ('cycle', 'I'), ('id', 'i'), ('motion_type', 'i'),
+    ('queue_depth', 'i'), ('active_depth', 'i'), ('flags', 'I'),
+    ('time', 'q'), ('compute', 'q'),
+    ('x', 'd'), ('y', 'd'), ('z', 'd'),
+    ('a', 'd'), ('b', 'd'), ('c', 'd'),
+    ('u', 'd'), ('v', 'd'), ('w', 'd'),
+    ('vel', 'd'), ('next_vel', 'd'), ('req_vel', 'd'), ('max_vel', 'd'),
+    ('final_vel', 'd'), ('feed_scale', 'd'), ('progress', 'd'),
+    ('target', 'd'),
+]
+NAMES = [n for n, t in FIELDS]
+
+# trajlog_entry_t.flags
+BLENDING = 0x01
+BLEND_WITH_NEXT = 0x02
+SYNCHRONIZED = 0x04
+PAUSING = 0x08
+ABORTING = 0x10
+
+HEADER = struct.Struct("=8sIIII")
+ENTRY = struct.Struct("=" + "".join(t for n, t in FIELDS))
+
+def _header(f):
+    data = f.read(HEADER.size)
+    if len(data) != HEADER.size:
+        raise ValueError("not a trajectory log: too short")
+    magic, version, entry_size, period, reserved = HEADER.unpack(data)
+    if magic.decode("latin-1") != FILE_MAGIC:
+        raise ValueError("not a trajectory log")
+    if version != VERSION or entry_size != ENTRY.size:
+        raise ValueError("trajectory log version %d, this reads version %d"
+            % (version, VERSION))
+    return period
+
+def records(f):
+    """Returns the servo period in ns and an iterator over the records
+    of the open file f, each a tuple in the order of NAMES.  A record
+    cut short at the end of the file is left out."""
+    period = _header(f)
+    def gen():
+        while 1:
+            data = f.read(ENTRY.size)
+            if len(data) != ENTRY.size:
+                return
+            yield ENTRY.unpack(data)
+    return period, gen()
+
+def read(filename):
+    """Returns the servo period in ns and a list with a dict for each
+    record of the file."""
+    f = open(filename, "rb")
+    try:
+        period, it = records(f)
+        return period, [dict(zip(NAMES, r)) for r in it]
+    finally:
+        f.close()
+
+def load(filename):
+    """Returns the records of the file as a numpy record array with
+    a field for each of NAMES.  The servo period in ns is in its
+    'period' attribute."""
+    import numpy
+    f = open(filename, "rb")
+    try:
+        period = _header(f)
+        data = f.read()
+    finally:
+        f.close()
+    dtype = numpy.dtype([(n, "=" + t) for n, t in FIELDS])
+    count = len(data) // dtype.itemsize
+    a = numpy.frombuffer(data, dtype, count).view(numpy.recarray)
+    a.period = period
+    return a
+
+def main(args):
+    if len(args) != 1:
+        sys.stderr.write("usage: python -m trajlog file.trajlog > file.csv\n")
+        return 1
+    f = open(args[0], "rb")
+    period, it = records(f)
+    sys.stdout.write("# period %d ns\n" % period)
+    sys.stdout.write(",".join(NAMES) + "\n")
+    for r in it:
+        sys.stdout.write(",".join(repr(v) for v in r) + "\n")
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -69,6 +69,7 @@
 #include "timer.hh"
 #include "rcs_print.hh"
 #include "tool_parse.h"
+#include "tool_store.hh"
 
 static RCS_CMD_CHANNEL *emcioCommandBuffer = 0;
 static RCS_CMD_MSG *emcioCommand = 0;
@@ -76,10 +77,19 @@ static RCS_STAT_CHANNEL *emcioStatusBuffer = 0;
 static EMC_IO_STAT emcioStatus;
 static NML *emcErrorBuffer = 0;
 
-static char *ttcomments[CANON_POCKETS_MAX];
-static int fms[CANON_POCKETS_MAX];
+static ToolStore tools;
 static int random_toolchanger = 0;
 
+/* how often to look for input pin changes while a tool prepare or
+   change waits for them, from [EMCIO] EVENT_POLL_TIME; 0 means sleep a
+   whole cycle */
+static double emc_io_event_poll_time = 0.001;
+static hal_watch_t *input_watch = 0;
+static int last_command_count = 0;
+/* the command buffer has a blocking semaphore to sleep on, until a wait
+   on it fails */
+static int command_bsem = 1;
+
 
 struct iocontrol_str {
     hal_bit_t *user_enable_out;	/* output, TRUE when EMC wants stop */
@@ -241,6 +251,16 @@ static int iniLoad(const char *filename)
 	     filename, emc_io_cycle_time);
     }
 
+    temp = emc_io_event_poll_time;
+    if (NULL != (inistring = inifile.Find("EVENT_POLL_TIME", "EMCIO"))) {
+	if (1 != sscanf(inistring, "%lf", &emc_io_event_poll_time)) {
+	    emc_io_event_poll_time = temp;
+	    rtapi_print
+		("invalid [EMCIO] EVENT_POLL_TIME in %s (%s); using default %f\n",
+		 filename, inistring, emc_io_event_poll_time);
+	}
+    }
+
     inifile.Find(&random_toolchanger, "RANDOM_TOOLCHANGER", "EMCIO");
 
     // close it
@@ -251,67 +271,21 @@ static int iniLoad(const char *filename)
 
 /********************************************************************
 *
-* Description: saveToolTable(const char *filename, CANON_TOOL_TABLE toolTable[])
-*		Saves the tool table from toolTable[] array into file filename.
-*		  Array is CANON_TOOL_MAX + 1 entries, since 0 is included.
-*
-* Return Value: Zero on success or -1 if file not found.
+* Description: update_tool_table(void)
+*		Copies the tool store into the status tool table, if the
+*		store changed since the last copy.
 *
-* Side Effects: Default setting used if the parameter not found in
-*		the ini file.
-*
-* Called By: main()
+* Called By: main, load_tool
 *
 ********************************************************************/
-static int saveToolTable(const char *filename,
-			 CANON_TOOL_TABLE toolTable[])
+static void update_tool_table(void)
 {
-    int pocket;
-    FILE *fp;
-    const char *name;
-    int start_pocket;
-
-    // check filename
-    if (filename[0] == 0) {
-	name = tool_table_file;
-    } else {
-	// point to name provided
-	name = filename;
-    }
-
-    // open tool table file
-    if (NULL == (fp = fopen(name, "w"))) {
-	// can't open file
-	return -1;
-    }
-
-    if(random_toolchanger) {
-        start_pocket = 0;
-    } else {
-        start_pocket = 1;
+    if (emcioStatus.tool.toolTableChanges == tools.changes()) {
+	return;
     }
-    for (pocket = start_pocket; pocket < CANON_POCKETS_MAX; pocket++) {
-        if (toolTable[pocket].toolno != -1) {
-            fprintf(fp, "T%d P%d", toolTable[pocket].toolno, random_toolchanger? pocket: fms[pocket]);
-            if (toolTable[pocket].diameter) fprintf(fp, " D%f", toolTable[pocket].diameter);
-            if (toolTable[pocket].offset.tran.x) fprintf(fp, " X%+f", toolTable[pocket].offset.tran.x);
-            if (toolTable[pocket].offset.tran.y) fprintf(fp, " Y%+f", toolTable[pocket].offset.tran.y);
-            if (toolTable[pocket].offset.tran.z) fprintf(fp, " Z%+f", toolTable[pocket].offset.tran.z);
-            if (toolTable[pocket].offset.a) fprintf(fp, " A%+f", toolTable[pocket].offset.a);
-            if (toolTable[pocket].offset.b) fprintf(fp, " B%+f", toolTable[pocket].offset.b);
-            if (toolTable[pocket].offset.c) fprintf(fp, " C%+f", toolTable[pocket].offset.c);
-            if (toolTable[pocket].offset.u) fprintf(fp, " U%+f", toolTable[pocket].offset.u);
-            if (toolTable[pocket].offset.v) fprintf(fp, " V%+f", toolTable[pocket].offset.v);
-            if (toolTable[pocket].offset.w) fprintf(fp, " W%+f", toolTable[pocket].offset.w);
-            if (toolTable[pocket].frontangle) fprintf(fp, " I%+f", toolTable[pocket].frontangle);
-            if (toolTable[pocket].backangle) fprintf(fp, " J%+f", toolTable[pocket].backangle);
-            if (toolTable[pocket].orientation) fprintf(fp, " Q%d", toolTable[pocket].orientation);
-            fprintf(fp, " ;%s\n", ttcomments[pocket]);
-        }
-    }
-
-    fclose(fp);
-    return 0;
+    // on nonrandom machines the spindle pocket 0 isn't in the store
+    tools.fill_table(emcioStatus.tool.toolTable, random_toolchanger ? 0 : 1);
+    emcioStatus.tool.toolTableChanges = tools.changes();
 }
 
 static int done = 0;
@@ -508,6 +482,22 @@ int iocontrol_hal_init(void)
 	return -1;
     }
 
+    /* STEP 4: watch the inputs, so the main loop can sleep until one
+       of them changes */
+    input_watch = hal_watch_new();
+    if (input_watch == 0 ||
+	hal_watch_pin(input_watch, &(iocontrol_data->tool_prepared), HAL_BIT) < 0 ||
+	hal_watch_pin(input_watch, &(iocontrol_data->tool_changed), HAL_BIT) < 0 ||
+	hal_watch_pin(input_watch, &(iocontrol_data->emc_enable_in), HAL_BIT) < 0 ||
+	hal_watch_pin(input_watch, &(iocontrol_data->lube_level), HAL_BIT) < 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+			"IOCONTROL: ERROR: can't watch input pins\n");
+	hal_watch_delete(input_watch);
+	input_watch = 0;
+	hal_exit(comp_id);
+	return -1;
+    }
+
     hal_ready(comp_id);
 
     return 0;
@@ -576,18 +566,10 @@ int read_hal_inputs(void)
 void load_tool(int pocket) {
     if(random_toolchanger) {
         // swap the tools between the desired pocket and the spindle pocket
-        CANON_TOOL_TABLE temp;
-        char *comment_temp;
-
-        temp = emcioStatus.tool.toolTable[0];
-        emcioStatus.tool.toolTable[0] = emcioStatus.tool.toolTable[pocket];
-        emcioStatus.tool.toolTable[pocket] = temp;
-
-        comment_temp = ttcomments[0];
-        ttcomments[0] = ttcomments[pocket];
-        ttcomments[pocket] = comment_temp;
+        tools.swap_pockets(0, pocket);
+        update_tool_table();
 
-        if (0 != saveToolTable(tool_table_file, emcioStatus.tool.toolTable))
+        if (0 != tools.save(tool_table_file))
             emcioStatus.status = RCS_ERROR;
     } else if(pocket == 0) {
         // magic T0 = pocket 0 = no tool
@@ -605,11 +587,9 @@ void load_tool(int pocket) {
 
 void reload_tool_number(int toolno) {
     if(random_toolchanger) return; // doesn't need special handling here
-    for(int i=1; i<CANON_POCKETS_MAX; i++) {
-        if(emcioStatus.tool.toolTable[i].toolno == toolno) {
-            load_tool(i);
-            break;
-        }
+    int slot = tools.find_tool(toolno) + 1;
+    if(slot > 0 && slot < CANON_POCKETS_MAX) {
+        load_tool(slot);
     }
 }
 
@@ -632,6 +612,7 @@ int read_tool_inputs(void)
 {
     if (*iocontrol_data->tool_prepare && *iocontrol_data->tool_prepared) {
 	emcioStatus.tool.pocketPrepped = *(iocontrol_data->tool_prep_pocket); //check if tool has been prepared
+	emcioStatus.tool.toolPrepped = *(iocontrol_data->tool_prep_number);
 	*(iocontrol_data->tool_prepare) = 0;
 	emcioStatus.status = RCS_DONE;  // we finally finished to do tool-changing, signal task with RCS_DONE
 	return 10; //prepped finished
@@ -647,6 +628,7 @@ int read_tool_inputs(void)
 	*(iocontrol_data->tool_number) = emcioStatus.tool.toolInSpindle; //likewise in HAL
 	load_tool(emcioStatus.tool.pocketPrepped);
 	emcioStatus.tool.pocketPrepped = -1; //reset the tool preped number, -1 to permit tool 0 to be loaded
+	emcioStatus.tool.toolPrepped = 0;
 	*(iocontrol_data->tool_prep_number) = 0; //likewise in HAL
 	*(iocontrol_data->tool_prep_pocket) = 0; //likewise in HAL
 	*(iocontrol_data->tool_change) = 0; //also reset the tool change signal
@@ -656,7 +638,78 @@ int read_tool_inputs(void)
     return 0;
 }
 
+/* true once for every command written since the last call */
+static int command_pending(void)
+{
+    int count = emcioCommandBuffer->get_msg_count();
+
+    if (count == last_command_count) {
+	return 0;
+    }
+    last_command_count = count;
+    return 1;
+}
+
+/********************************************************************
+*
+* Description: wait_for_event(void)
+*		Sleeps until a new NML command arrives, an input pin
+*		changes, or a cycle has passed, whichever comes first.
+*		Writes to the command buffer flush its blocking semaphore
+*		(bsem= in the NML file), so a command wakes iocontrol at
+*		once. The input pins can only be polled: every
+*		EVENT_POLL_TIME while a tool prepare or change waits for
+*		its pin, once a cycle otherwise. Without the semaphore
+*		the command buffer is polled too, and the interval
+*		doubles every time nothing has changed while no tool
+*		prepare or change is under way.
+*
+* Called By: main when there is nothing to do
+********************************************************************/
+static void wait_for_event(void)
+{
+    double deadline, left, interval;
+    int handshake;
+
+    if (emc_io_event_poll_time <= 0.0) {
+	esleep(emc_io_cycle_time);
+	return;
+    }
+    deadline = etime() + emc_io_cycle_time;
+    interval = emc_io_event_poll_time;
+    handshake = *(iocontrol_data->tool_prepare) ||
+	*(iocontrol_data->tool_change);
+
+    for (;;) {
+	if (command_pending() || hal_watch_changed(input_watch)) {
+	    return;
+	}
+	left = deadline - etime();
+	if (left <= 0.0) {
+	    return;
+	}
+	if (command_bsem) {
+	    if (handshake && left > interval) {
+		left = interval;
+	    }
+	    if (emcioCommandBuffer->wait_for_write(left) >= 0) {
+		continue;
+	    }
+	    command_bsem = 0;
+	    rtapi_print_msg(RTAPI_MSG_INFO,
+			    "IOCONTROL: no blocking semaphore on the command "
+			    "buffer, polling it\n");
+	}
+	esleep(left < interval ? left : interval);
+	if (!handshake) {
+	    interval *= 2;
+	}
+    }
+}
+
 static void do_hal_exit(void) {
+    hal_watch_delete(input_watch);
+    input_watch = 0;
     hal_exit(comp_id);
 }
 
@@ -729,11 +782,6 @@ int main(int argc, char *argv[])
 	return -1;
     }
 
-    for(int i=0; i<CANON_POCKETS_MAX; i++) {
-        ttcomments[i] = (char *)malloc(CANON_TOOL_ENTRY_LEN);
-    }
-
-
     // on nonrandom machines, always start by assuming the spindle is empty
     if(!random_toolchanger) {
 	emcioStatus.tool.toolTable[0].toolno = -1;
@@ -742,14 +790,12 @@ int main(int argc, char *argv[])
         emcioStatus.tool.toolTable[0].frontangle = 0.0;
         emcioStatus.tool.toolTable[0].backangle = 0.0;
         emcioStatus.tool.toolTable[0].orientation = 0;
-        fms[0] = 0;
-        ttcomments[0][0] = '\0';
     }
 
-    if (0 != loadToolTable(tool_table_file, emcioStatus.tool.toolTable,
-		fms, ttcomments, random_toolchanger)) {
+    if (0 != tools.load(tool_table_file, random_toolchanger)) {
 	rcs_print_error("can't load tool table.\n");
     }
+    update_tool_table();
 
     done = 0;
 
@@ -795,8 +841,8 @@ int main(int argc, char *argv[])
 	if (0 == emcioCommand ||	// bad command pointer
 	    0 == emcioCommand->type ||	// bad command type
 	    emcioCommand->serial_number == emcioStatus.echo_serial_number) {	// command already finished
-	    /* wait until next cycle */
-	    esleep(emc_io_cycle_time);
+	    /* wait for something to do */
+	    wait_for_event();
 	    /* and repeat */
 	    continue;
 	}
@@ -815,8 +861,8 @@ int main(int argc, char *argv[])
 
 	case EMC_TOOL_INIT_TYPE:
 	    rtapi_print_msg(RTAPI_MSG_DBG, "EMC_TOOL_INIT\n");
-	    loadToolTable(tool_table_file, emcioStatus.tool.toolTable,
-		    fms, ttcomments, random_toolchanger);
+	    tools.load(tool_table_file, random_toolchanger);
+	    update_tool_table();
 	    reload_tool_number(emcioStatus.tool.toolInSpindle);
 	    break;
 
@@ -901,11 +947,12 @@ int main(int argc, char *argv[])
 		    ((EMC_TOOL_LOAD_TOOL_TABLE *) emcioCommand)->file;
 		if(!strlen(filename)) filename = tool_table_file;
 		rtapi_print_msg(RTAPI_MSG_DBG, "EMC_TOOL_LOAD_TOOL_TABLE\n");
-		if (0 != loadToolTable(filename, emcioStatus.tool.toolTable,
-				  fms, ttcomments, random_toolchanger))
+		if (0 != tools.load(filename, random_toolchanger)) {
 		    emcioStatus.status = RCS_ERROR;
-		else
+		} else {
+		    update_tool_table();
 		    reload_tool_number(emcioStatus.tool.toolInSpindle);
+		}
 	    }
 	    break;
 
@@ -928,18 +975,28 @@ int main(int argc, char *argv[])
                                 " frontangle=%lf, backangle=%lf, orientation=%d\n",
                                 p, t, offs.tran.z, offs.tran.x, d, f, b, o);
 
-                emcioStatus.tool.toolTable[p].toolno = t;
-                emcioStatus.tool.toolTable[p].offset = offs;
-                emcioStatus.tool.toolTable[p].diameter = d;
-                emcioStatus.tool.toolTable[p].frontangle = f;
-                emcioStatus.tool.toolTable[p].backangle = b;
-                emcioStatus.tool.toolTable[p].orientation = o;
+                CANON_TOOL_TABLE tool;
+                tool.toolno = t;
+                tool.offset = offs;
+                tool.diameter = d;
+                tool.frontangle = f;
+                tool.backangle = b;
+                tool.orientation = o;
+
+                // only this tool changes in the store
+                if (!random_toolchanger && p == 0) {
+                    // the nonrandom spindle pocket isn't in the store
+                    emcioStatus.tool.toolTable[0] = tool;
+                } else {
+                    tools.place_tool(p, tool);
+                }
+                update_tool_table();
 
                 if (emcioStatus.tool.toolInSpindle == t) {
                     emcioStatus.tool.toolTable[0] = emcioStatus.tool.toolTable[p];
                 }                    
             }
-	    if (0 != saveToolTable(tool_table_file, emcioStatus.tool.toolTable))
+	    if (0 != tools.save(tool_table_file))
 		emcioStatus.status = RCS_ERROR;
 	    break;
 
@@ -1034,9 +1091,12 @@ int main(int argc, char *argv[])
 	emcioStatus.heartbeat++;
 	emcioStatusBuffer->write(&emcioStatus);
 
-	esleep(emc_io_cycle_time);
-	/* clear reset line to allow for a later rising edge */
-	*(iocontrol_data->user_request_enable) = 0;
+	if (*(iocontrol_data->user_request_enable)) {
+	    /* hold the reset line for a cycle, then clear it to allow
+	       for a later rising edge */
+	    esleep(emc_io_cycle_time);
+	    *(iocontrol_data->user_request_enable) = 0;
+	}
 
     }	// end of "while (! done)" loop
 
@@ -1055,9 +1115,5 @@ int main(int argc, char *argv[])
 	emcioCommandBuffer = 0;
     }
 
-    for(int i=0; i<CANON_POCKETS_MAX; i++) {
-        free(ttcomments[i]);
-    }
-
     return 0;
 }
@@ -0,0 +1,190 @@
+/* Checks the tool store that iocontrol keeps its tool table in: a table
+   of more tools than the status view has room for survives a load/save
+   round trip, a single-tool change only changes that tool, and
+   SET_OFFSET to an empty pocket puts the tool in that pocket.  Each
+   check that goes wrong is reported as ****fail****.
+
+   usage: test_tool_store [scratch directory] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+#include "tool_store.hh"
+
+#define NTOOLS (CANON_POCKETS_MAX + 20)
+
+static int fail;
+
+static void check(int ok, const char *what)
+{
+    printf("%-60s", what);
+    if (!ok) {
+	fail++;
+	printf(" ****fail****");
+    }
+    printf("\n");
+}
+
+static std::string slurp(const char *filename)
+{
+    std::string s;
+    char buf[1024];
+    size_t n;
+    FILE *fp = fopen(filename, "r");
+
+    if (!fp)
+	return s;
+    while ((n = fread(buf, 1, sizeof(buf), fp)) > 0)
+	s.append(buf, n);
+    fclose(fp);
+    return s;
+}
+
+static int same_tool(const CANON_TOOL_TABLE &a, const CANON_TOOL_TABLE &b)
+{
+    return a.toolno == b.toolno
+	&& a.offset.tran.x == b.offset.tran.x
+	&& a.offset.tran.z == b.offset.tran.z
+	&& a.diameter == b.diameter
+	&& a.frontangle == b.frontangle
+	&& a.backangle == b.backangle
+	&& a.orientation == b.orientation;
+}
+
+// a nonrandom table with more tools than the view, every one different
+static void write_table(const char *filename)
+{
+    FILE *fp = fopen(filename, "w");
+
+    for (int i = 1; i <= NTOOLS; i++)
+	fprintf(fp, "T%d P%d Z%g D%g ;tool %d\n", i * 10, i, i * 0.25,
+		i * 0.125, i);
+    fclose(fp);
+}
+
+static void round_trip(const std::string &dir)
+{
+    std::string orig = dir + "/orig.tbl", saved = dir + "/saved.tbl";
+    std::string again = dir + "/again.tbl";
+    ToolStore a, b;
+    int ok;
+
+    write_table(orig.c_str());
+    check(a.load(orig.c_str(), 0) == 0, "load");
+    check(a.size() == NTOOLS, "every tool is loaded, past the view");
+    check(a.find_tool(NTOOLS * 10) == NTOOLS - 1,
+	  "a tool past the view is found by number");
+    check(a.find_slot(NTOOLS) == NTOOLS - 1,
+	  "a tool past the view is found by slot");
+
+    check(a.save(saved.c_str()) == 0, "save");
+    check(b.load(saved.c_str(), 0) == 0, "load the saved table");
+    ok = b.size() == a.size();
+    for (int i = 0; ok && i < a.size(); i++)
+	ok = same_tool(a[i].tool, b[i].tool) && a[i].pocket == b[i].pocket
+	    && a[i].comment == b[i].comment;
+    check(ok, "the saved table has the same tools, pockets and comments");
+    check(b.save(again.c_str()) == 0
+	  && slurp(saved.c_str()) == slurp(again.c_str()),
+	  "saving it again writes the same file");
+}
+
+static void single_tool(const std::string &dir)
+{
+    std::string orig = dir + "/orig.tbl", saved = dir + "/single.tbl";
+    ToolStore a, b;
+    int index, changes, ok;
+    CANON_TOOL_TABLE tool;
+    std::string comment;
+
+    write_table(orig.c_str());
+    a.load(orig.c_str(), 0);
+    index = a.find_tool(30);
+    tool = a[index].tool;
+    comment = a[index].comment;
+    tool.offset.tran.z = 9.5;
+    changes = a.changes();
+    a.set_tool(index, tool);
+    check(a.changes() != changes, "a change is counted");
+    check(a.find_tool(30) == index && a[index].tool.offset.tran.z == 9.5,
+	  "the tool is changed in place");
+
+    a.save(saved.c_str());
+    b.load(saved.c_str(), 0);
+    ok = b.size() == NTOOLS;
+    for (int i = 0; ok && i < b.size(); i++) {
+	if (b[i].tool.toolno == 30)
+	    ok = b[i].tool.offset.tran.z == 9.5 && b[i].pocket == 3
+		&& b[i].comment == comment;
+	else
+	    ok = b[i].tool.offset.tran.z == (i + 1) * 0.25;
+    }
+    check(ok, "only that tool is changed in the file");
+}
+
+static void new_pocket(const std::string &dir)
+{
+    std::string orig = dir + "/small.tbl", saved = dir + "/placed.tbl";
+    CANON_TOOL_TABLE table[CANON_POCKETS_MAX], tool;
+    ToolStore a, b;
+    FILE *fp;
+
+    fp = fopen(orig.c_str(), "w");
+    fprintf(fp, "T1 P1 Z1\nT2 P2 Z2\nT3 P3 Z3\n");
+    fclose(fp);
+
+    memset(&tool, 0, sizeof(tool));
+    tool.toolno = 9;
+    tool.offset.tran.z = 0.5;
+
+    // nonrandom: slot n is the n'th tool
+    a.load(orig.c_str(), 0);
+    a.place_tool(6, tool);
+    check(a.find_slot(6) >= 0 && a[a.find_slot(6)].tool.toolno == 9,
+	  "nonrandom: the tool is in the pocket it was set in");
+    a.fill_table(table, 1);
+    check(table[3].toolno == 3 && table[4].toolno == -1
+	  && table[5].toolno == -1 && table[6].toolno == 9,
+	  "nonrandom: the view has it in that pocket");
+    a.save(saved.c_str());
+    b.load(saved.c_str(), 0);
+    check(b.size() == 4 && b.find_tool(9) == 3,
+	  "nonrandom: the saved table has no empty tools");
+
+    // random: the pocket is the pocket
+    a.load(orig.c_str(), 1);
+    a.place_tool(12, tool);
+    check(a.find_slot(12) >= 0 && a[a.find_slot(12)].tool.toolno == 9,
+	  "random: the tool is in the pocket it was set in");
+    a.place_tool(2, tool);
+    check(a.size() == 4 && a[a.find_slot(2)].tool.toolno == 9,
+	  "random: a full pocket is replaced, not added to");
+}
+
+int main(int argc, char **argv)
+{
+    char scratch[] = "/tmp/test_tool_store.XXXXXX";
+    std::string dir;
+
+    if (argc > 1) {
+	dir = argv[1];
+    } else {
+	if (!mkdtemp(scratch)) {
+	    perror("mkdtemp");
+	    return 1;
+	}
+	dir = scratch;
+    }
+
+    round_trip(dir);
+    single_tool(dir);
+    new_pocket(dir);
+
+    if (argc == 1) {
+	std::string cmd = "rm -rf " + dir;
+	if (system(cmd.c_str()) != 0)
+	    fprintf(stderr, "could not remove %s\n", dir.c_str());
+    }
+    return fail ? 1 : 0;
+}
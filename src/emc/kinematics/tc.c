@@ -22,6 +22,7 @@
 #include "posemath.h"
 #include "emcpos.h"
 #include "tc.h"
+#include "motion_types.h"
 
 PmCartesian tcGetStartingUnitVector(TC_STRUCT *tc) {
     PmCartesian v;
@@ -92,6 +93,24 @@ EmcPose tcGetEndpoint(TC_STRUCT * tc) {
     return tcGetPosReal(tc, 1);
 }
 
+static EmcPose tcDrillPos(PmDrill *drill, double level)
+{
+    EmcPose pos;
+    double d = level - drill->params.start;
+
+    pos.tran.x = drill->start.tran.x + d * drill->unit.tran.x;
+    pos.tran.y = drill->start.tran.y + d * drill->unit.tran.y;
+    pos.tran.z = drill->start.tran.z + d * drill->unit.tran.z;
+    pos.a = drill->start.a;
+    pos.b = drill->start.b;
+    pos.c = drill->start.c;
+    pos.u = drill->start.u + d * drill->unit.u;
+    pos.v = drill->start.v + d * drill->unit.v;
+    pos.w = drill->start.w + d * drill->unit.w;
+
+    return pos;
+}
+
 EmcPose tcGetPosReal(TC_STRUCT * tc, int of_endpoint)
 {
     EmcPose pos;
@@ -101,7 +120,14 @@ EmcPose tcGetPosReal(TC_STRUCT * tc, int of_endpoint)
     
     double progress = of_endpoint? tc->target: tc->progress;
 
-    if (tc->motion_type == TC_RIGIDTAP) {
+    if (tc->motion_type == TC_DRILL) {
+        // progress is along the current step only
+        DRILL_CYCLE_STEP *step = &tc->coords.drill.step;
+        double level = step->to;
+        if (tc->target > 0.0)
+            level = step->from + (step->to - step->from) * progress / tc->target;
+        return tcDrillPos(&tc->coords.drill, level);
+    } else if (tc->motion_type == TC_RIGIDTAP) {
         if(tc->coords.rigidtap.state > REVERSING) {
             pmLinePoint(&tc->coords.rigidtap.aux_xyz, progress, &xyz);
         } else {
@@ -164,6 +190,63 @@ EmcPose tcGetPosReal(TC_STRUCT * tc, int of_endpoint)
 }
 
 
+/*! tcDrillNextStep() function
+ *
+ * \brief Moves a drill cycle on to its next step.
+ *
+ * A TC_DRILL segment stays at the head of the queue for the whole cycle.
+ * Whenever its current step is done, tpRunCycle() calls this to set up
+ * the next feed or traverse along the cycle axis as if it were a new
+ * segment starting at rest where the last one stopped.  A dwell keeps
+ * target and progress at zero until its time has run out; a spindle
+ * step has them at zero for the one cycle tpRunCycle() needs to act
+ * on it.
+ *
+ * @param    tc    the drill cycle
+ *
+ * @return	 int   1 while there is a step to run, 0 once the cycle is done
+ */
+int tcDrillNextStep(TC_STRUCT * tc)
+{
+    PmDrill *drill = &tc->coords.drill;
+    double length;
+
+    if (drill->dwell_left > 0.0) {
+        drill->dwell_left -= tc->cycle_time;
+        return 1;
+    }
+
+    if (!drillCycleStep(&drill->params, &drill->state, &drill->step))
+        return 0;
+
+    length = (drill->step.to - drill->step.from) * drill->scale;
+    tc->target = length < 0.0 ? -length : length;
+    tc->progress = 0.0;
+    tc->currentvel = 0.0;
+
+    switch (drill->step.kind) {
+    case DRILL_STEP_DWELL:
+        drill->dwell_left = drill->step.seconds;
+        break;
+    case DRILL_STEP_SPINDLE_STOP:
+    case DRILL_STEP_SPINDLE_START:
+        // no motion; tpRunCycle switches the spindle
+        drill->spindle_pending = 1;
+        break;
+    case DRILL_STEP_FEED:
+        tc->reqvel = drill->feed_vel;
+        tc->maxvel = drill->feed_maxvel;
+        tc->canon_motion_type = EMC_MOTION_TYPE_FEED;
+        break;
+    default:
+        tc->reqvel = drill->rapid_vel;
+        tc->maxvel = drill->rapid_vel;
+        tc->canon_motion_type = EMC_MOTION_TYPE_TRAVERSE;
+        break;
+    }
+    return 1;
+}
+
 /*!
  * \subsection TC queue functions
  * These following functions implement the motion queue that
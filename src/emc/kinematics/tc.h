@@ -18,6 +18,7 @@
 #include "posemath.h"
 #include "emcpos.h"
 #include "emcmotcfg.h"
+#include "drillcycle.h"
 
 /* values for endFlag */
 #define TC_TERM_COND_STOP 1
@@ -26,6 +27,7 @@
 #define TC_LINEAR 1
 #define TC_CIRCULAR 2
 #define TC_RIGIDTAP 3
+#define TC_DRILL 4
 
 /* structure for individual trajectory elements */
 
@@ -66,6 +68,23 @@ typedef struct {
     RIGIDTAP_STATE state;
 } PmRigidTap;
 
+typedef struct {
+    EmcPose start;          // position at level params.start
+    EmcPose unit;           // displacement for one unit of level
+    double scale;           // path length for one unit of level
+    DRILL_CYCLE_PARAMS params;
+    DRILL_CYCLE_STATE state;
+    DRILL_CYCLE_STEP step;  // the move or dwell being executed
+    double feed_vel;        // reqvel and maxvel of the feed moves,
+    double feed_maxvel;     // the traverses use the tc's maxvel
+    double rapid_vel;
+    double dwell_left;
+    char atspeed;           // wait for the spindle before the next feed step
+    char spindle_pending;   // tpRunCycle has yet to stop or start the spindle
+    double spindle_speed;   // what G86 turns the spindle back on with
+    int spindle_direction;
+} PmDrill;
+
 typedef struct {
     double cycle_time;
     double progress;        // where are we in the segment?  0..target
@@ -82,11 +101,13 @@ typedef struct {
         PmLine9 line;
         PmCircle9 circle;
         PmRigidTap rigidtap;
+        PmDrill drill;
     } coords;
 
     char motion_type;       // TC_LINEAR (coords.line) or 
                             // TC_CIRCULAR (coords.circle) or
-                            // TC_RIGIDTAP (coords.rigidtap)
+                            // TC_RIGIDTAP (coords.rigidtap) or
+                            // TC_DRILL (coords.drill)
     char active;            // this motion is being executed
     int canon_motion_type;  // this motion is due to which canon function?
     int blend_with_next;    // gcode requests continuous feed at the end of 
@@ -113,6 +134,7 @@ extern EmcPose tcGetPos(TC_STRUCT * tc);
 EmcPose tcGetPosReal(TC_STRUCT * tc, int of_endpoint);
 PmCartesian tcGetEndingUnitVector(TC_STRUCT *tc);
 PmCartesian tcGetStartingUnitVector(TC_STRUCT *tc);
+int tcDrillNextStep(TC_STRUCT *tc);
 
 /* queue of TC_STRUCT elements*/
 
@@ -20,6 +20,7 @@
 #include "../motion/motion.h"
 #include "hal.h"
 #include "../motion/mot_priv.h"
+#include "../motion/trajlog.h"
 #include "motion_debug.h"
 
 extern emcmot_status_t *emcmotStatus;
@@ -354,6 +355,107 @@ int tpAddRigidTap(TP_STRUCT *tp, EmcPose end, double vel, double ini_maxvel,
     return 0;
 }
 
+// Add a whole G73, G81, G82 or G83 cycle to the tc queue as one
+// segment.  It starts at the end of the previous move, and unit is
+// how far the tool moves for one unit of level along the cycle axis.
+// The steps are generated while the cycle runs, see tcDrillNextStep().
+// If atspeed is set, the first feed step waits for the spindle to be
+// at speed; the traverse down to the R plane does not.
+
+int tpAddDrillCycle(TP_STRUCT *tp, EmcPose unit, DRILL_CYCLE_PARAMS params,
+                    double vel, double ini_maxvel, double rapid_vel,
+                    double acc, unsigned char enables, char atspeed) {
+    TC_STRUCT tc;
+    PmDrill *drill = &tc.coords.drill;
+    double d;
+
+    if (!tp) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "TP is null\n");
+        return -1;
+    }
+    if (tp->aborting) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "TP is aborting\n");
+	return -1;
+    }
+
+    drill->start = tp->goalPos;
+    drill->unit = unit;
+    drill->scale = pmSqrt(pmSq(unit.tran.x) + pmSq(unit.tran.y) +
+                          pmSq(unit.tran.z) + pmSq(unit.u) +
+                          pmSq(unit.v) + pmSq(unit.w));
+    if (drill->scale <= 0.0) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "Drill cycle has no axis.\n");
+        return -1;
+    }
+    drill->params = params;
+    drill->feed_vel = vel;
+    drill->feed_maxvel = ini_maxvel;
+    drill->rapid_vel = rapid_vel;
+    drill->dwell_left = 0.0;
+    drill->atspeed = atspeed;
+    drill->spindle_pending = 0;
+    drillCycleInit(&drill->params, &drill->state);
+
+    tc.sync_accel = 0;
+    tc.cycle_time = tp->cycleTime;
+    tc.progress = 0.0;
+    tc.target = 0.0;
+    tc.maxaccel = acc;
+    tc.feed_override = 0.0;
+    tc.id = tp->nextId;
+    tc.active = 0;
+    tc.atspeed = 0;
+
+    tc.currentvel = 0.0;
+    tc.blending = 0;
+    tc.blend_vel = 0.0;
+    tc.vel_at_blend_start = 0.0;
+
+    tc.motion_type = TC_DRILL;
+    tc.blend_with_next = 0;
+    tc.tolerance = tp->tolerance;
+
+    // the traverses in the cycle must not follow the spindle
+    tc.synchronized = 0;
+    tc.uu_per_rev = tp->uu_per_rev;
+    tc.velocity_mode = tp->velocity_mode;
+    tc.enables = enables;
+    tc.indexrotary = -1;
+
+    if (syncdio.anychanged != 0) {
+	tc.syncdio = syncdio; //enqueue the list of DIOs that need toggling
+	tpClearDIOs(); // clear out the list, in order to prepare for the next time we need to use it
+    } else {
+	tc.syncdio.anychanged = 0;
+    }
+
+    // set up the first move
+    if (!tcDrillNextStep(&tc)) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "Drill cycle has no moves.\n");
+        return -1;
+    }
+
+    if (tcqPut(&tp->queue, tc) == -1) {
+        rtapi_print_msg(RTAPI_MSG_ERR, "tcqPut failed.\n");
+	return -1;
+    }
+
+    // the cycle ends at its clearance level
+    d = params.clear - params.start;
+    tp->goalPos.tran.x += d * unit.tran.x;
+    tp->goalPos.tran.y += d * unit.tran.y;
+    tp->goalPos.tran.z += d * unit.tran.z;
+    tp->goalPos.u += d * unit.u;
+    tp->goalPos.v += d * unit.v;
+    tp->goalPos.w += d * unit.w;
+
+    tp->done = 0;
+    tp->depth = tcqLen(&tp->queue);
+    tp->nextId++;
+
+    return 0;
+}
+
 // Add a straight line to the tc queue.  This is a coordinated
 // move in any or all of the six axes.  it goes from the end
 // of the previous move to the new end specified here at the
@@ -702,7 +804,10 @@ int tpRunCycle(TP_STRUCT * tp, long period)
         return 0;
     }
 
-    if (tc->target == tc->progress && waiting_for_atspeed != tc->id) {
+    // a drill cycle only ends after its last step; until then each
+    // finished step is followed by the next one in the same tc.
+    if (tc->target == tc->progress && waiting_for_atspeed != tc->id &&
+        (tc->motion_type != TC_DRILL || !tcDrillNextStep(tc))) {
         // if we're synced, and this move is ending, save the
         // spindle position so the next synced move can be in
         // the right place.
@@ -748,9 +853,10 @@ int tpRunCycle(TP_STRUCT * tp, long period)
 	}
     }
 
-    if(nexttc && nexttc->atspeed) {
+    if(nexttc && (nexttc->atspeed || nexttc->motion_type == TC_DRILL)) {
         // we'll have to wait for the spindle to be at-speed; might as well
-        // stop at the right place (don't blend), like above
+        // stop at the right place (don't blend), like above.  drill
+        // cycles always start from a stop.
         tc->blend_with_next = 0;
         nexttc = NULL;
     }
@@ -852,6 +958,37 @@ int tpRunCycle(TP_STRUCT * tp, long period)
         }
     }
 
+    // a drill cycle that asked for at-speed waits at the start of its
+    // first feed step, after the traverse to the R plane.
+    if(tc->motion_type == TC_DRILL && tc->coords.drill.atspeed &&
+       tc->coords.drill.step.kind == DRILL_STEP_FEED) {
+        if(!emcmotStatus->spindle_is_atspeed) {
+            waiting_for_atspeed = tc->id;
+            return 0;
+        }
+        tc->coords.drill.atspeed = 0;
+    }
+
+    // G86 stops the spindle at the bottom of the hole, the way
+    // EMCMOT_SPINDLE_OFF does, and turns it back on the way it was
+    // once it is out.
+    if(tc->motion_type == TC_DRILL && tc->coords.drill.spindle_pending) {
+        PmDrill *drill = &tc->coords.drill;
+
+        if(drill->step.kind == DRILL_STEP_SPINDLE_STOP) {
+            drill->spindle_speed = emcmotStatus->spindle.speed;
+            drill->spindle_direction = emcmotStatus->spindle.direction;
+            emcmotStatus->spindle.speed = 0;
+            emcmotStatus->spindle.direction = 0;
+            emcmotStatus->spindle.brake = 1;
+        } else {
+            emcmotStatus->spindle.speed = drill->spindle_speed;
+            emcmotStatus->spindle.direction = drill->spindle_direction;
+            emcmotStatus->spindle.brake = 0;
+        }
+        drill->spindle_pending = 0;
+    }
+
     if (MOTION_ID_VALID(waiting_for_index)) {
         if(emcmotStatus->spindle_index_enable) {
             /* haven't passed index yet */
@@ -1254,6 +1391,44 @@ int tpActiveDepth(TP_STRUCT * tp)
     return tp->activeDepth;
 }
 
+/* Fills in what the planner is doing with the current tc, for the
+   trajectory log.  The caller fills in the rest of the entry. */
+void tpTrajLog(TP_STRUCT * tp, struct trajlog_entry_t *e)
+{
+    TC_STRUCT *tc, *nexttc;
+
+    e->queue_depth = tcqLen(&tp->queue);
+    e->active_depth = tp->activeDepth;
+    e->flags = (tp->pausing ? TRAJLOG_PAUSING : 0) |
+        (tp->aborting ? TRAJLOG_ABORTING : 0);
+    tc = tcqItem(&tp->queue, 0, 0);
+    if (!tc) {
+        e->id = 0;
+        e->vel = e->next_vel = e->req_vel = e->max_vel = 0.0;
+        e->final_vel = e->feed_scale = e->progress = e->target = 0.0;
+        return;
+    }
+    nexttc = tc->blend_with_next ? tcqItem(&tp->queue, 1, 0) : NULL;
+
+    e->id = tc->id;
+    if (tc->blending)
+        e->flags |= TRAJLOG_BLENDING;
+    if (tc->blend_with_next)
+        e->flags |= TRAJLOG_BLEND_WITH_NEXT;
+    if (tc->synchronized)
+        e->flags |= TRAJLOG_SYNCHRONIZED;
+    e->vel = tc->currentvel;
+    e->next_vel = (tc->blending && nexttc) ? nexttc->currentvel : 0.0;
+    e->req_vel = tc->reqvel;
+    e->max_vel = tc->maxvel;
+    // tpRunCycle starts the blend once the tc is on its final
+    // deceleration and slower than blend_vel
+    e->final_vel = nexttc ? tc->blend_vel : 0.0;
+    e->feed_scale = tc->feed_override;
+    e->progress = tc->progress;
+    e->target = tc->target;
+}
+
 int tpSetAout(TP_STRUCT *tp, unsigned char index, double start, double end) {
     if (0 == tp) {
 	return -1;
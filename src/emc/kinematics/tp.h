@@ -73,6 +73,9 @@ extern int tpSetTermCond(TP_STRUCT * tp, int cond, double tolerance);
 extern int tpSetPos(TP_STRUCT * tp, EmcPose pos);
 extern int tpAddRigidTap(TP_STRUCT * tp, EmcPose end, double vel, double
         ini_maxvel, double acc, unsigned char enables);
+extern int tpAddDrillCycle(TP_STRUCT * tp, EmcPose unit,
+        DRILL_CYCLE_PARAMS params, double vel, double ini_maxvel,
+        double rapid_vel, double acc, unsigned char enables, char atspeed);
 extern int tpAddLine(TP_STRUCT * tp, EmcPose end, int type, double vel, double
                      ini_maxvel, double acc, unsigned char enables, char atspeed, int indexrotary);
 extern int tpAddCircle(TP_STRUCT * tp, EmcPose end, PmCartesian center,
@@ -87,6 +90,8 @@ extern int tpIsDone(TP_STRUCT * tp);
 extern int tpQueueDepth(TP_STRUCT * tp);
 extern int tpActiveDepth(TP_STRUCT * tp);
 extern int tpGetMotionType(TP_STRUCT * tp);
+struct trajlog_entry_t;
+extern void tpTrajLog(TP_STRUCT * tp, struct trajlog_entry_t *e);
 extern int tpSetSpindleSync(TP_STRUCT * tp, double sync, int wait);
 extern void tpToggleDIOs(TC_STRUCT * tc); //gets called when a new tc is taken from the queue. it checks and toggles all needed DIO's
 
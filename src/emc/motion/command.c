@@ -246,6 +246,34 @@ static int inRange(EmcPose pos, int id, char *move_type)
     return in_range;
 }
 
+/* drillCycleInRange() returns non-zero if the deepest and the highest
+   points of a drill cycle lie within the joint limits.  The cycle
+   starts at the end of the last queued move. */
+static int drillCycleInRange(emcmot_command_t * cmd)
+{
+    double levels[3];
+    int n;
+
+    levels[0] = cmd->drill.bottom;
+    levels[1] = cmd->drill.r;
+    levels[2] = cmd->drill.clear;
+    for (n = 0; n < 3; n++) {
+	EmcPose pos = emcmotDebug->queue.goalPos;
+	double d = levels[n] - cmd->drill.start;
+
+	pos.tran.x += d * cmd->pos.tran.x;
+	pos.tran.y += d * cmd->pos.tran.y;
+	pos.tran.z += d * cmd->pos.tran.z;
+	pos.u += d * cmd->pos.u;
+	pos.v += d * cmd->pos.v;
+	pos.w += d * cmd->pos.w;
+	if (!inRange(pos, cmd->id, "Drill cycle")) {
+	    return 0;
+	}
+    }
+    return 1;
+}
+
 /* clearHomes() will clear the homed flags for joints that have moved
    since homing, outside coordinated control, for machines with no
    forward kinematics. This is used in conjunction with the rehomeAll
@@ -1420,6 +1448,55 @@ check_stuff ( "before command_handler()" );
 	    }
 	    break;
 
+	case EMCMOT_DRILL_CYCLE:
+	    /* queue up a whole drill cycle, checked like EMCMOT_SET_LINE */
+	    /* requires coordinated mode, enable on, not on limits */
+	    rtapi_print_msg(RTAPI_MSG_DBG, "DRILL_CYCLE");
+	    if (!GET_MOTION_COORD_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
+		reportError(_("need to be enabled, in coord mode for drill cycle"));
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_COMMAND;
+		SET_MOTION_ERROR_FLAG(1);
+		break;
+	    } else if (!drillCycleInRange(emcmotCommand)) {
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		tpAbort(&emcmotDebug->queue);
+		SET_MOTION_ERROR_FLAG(1);
+		break;
+	    } else if (!limits_ok()) {
+		reportError(_("can't do drill cycle with limits exceeded"));
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_INVALID_PARAMS;
+		tpAbort(&emcmotDebug->queue);
+		SET_MOTION_ERROR_FLAG(1);
+		break;
+	    }
+
+	    /* the cycle's first feed takes over a pending at-speed wait,
+	       and it ends with a traverse, after which CSS asks for one
+	       again; so does G86 turning the spindle back on, like
+	       EMCMOT_SPINDLE_ON */
+	    issue_atspeed = emcmotStatus->atspeed_next_feed;
+	    emcmotStatus->atspeed_next_feed = 0;
+	    if (emcmotStatus->spindle.css_factor ||
+		(emcmotCommand->drill.mode & DRILL_SPINDLE_STOP)) {
+		emcmotStatus->atspeed_next_feed = 1;
+	    }
+	    /* append it to the emcmotDebug->queue */
+	    tpSetId(&emcmotDebug->queue, emcmotCommand->id);
+	    if (-1 == tpAddDrillCycle(&emcmotDebug->queue, emcmotCommand->pos,
+			emcmotCommand->drill, emcmotCommand->vel,
+			emcmotCommand->ini_maxvel, emcmotCommand->rapid_vel,
+			emcmotCommand->acc, emcmotStatus->enables_new,
+			issue_atspeed)) {
+		reportError(_("can't add drill cycle"));
+		emcmotStatus->commandStatus = EMCMOT_COMMAND_BAD_EXEC;
+		tpAbort(&emcmotDebug->queue);
+		SET_MOTION_ERROR_FLAG(1);
+		break;
+	    } else {
+		SET_MOTION_ERROR_FLAG(0);
+	    }
+	    break;
+
 	case EMCMOT_SET_TELEOP_VECTOR:
 	    rtapi_print_msg(RTAPI_MSG_DBG, "SET_TELEOP_VECTOR");
 	    if (!GET_MOTION_TELEOP_FLAG() || !GET_MOTION_ENABLE_FLAG()) {
@@ -19,6 +19,8 @@
 #include "emcmotglb.h"
 #include "motion.h"
 #include "mot_priv.h"
+#include "poslog.h"
+#include "trajlog.h"
 #include "rtapi_math.h"
 #include "tp.h"
 #include "tc.h"
@@ -204,6 +206,11 @@ static void output_to_hal(void);
 */
 static void update_status(void);
 
+/* 'log_trajectory()' adds this cycle's record to the trajectory log,
+   if there is one. 'start' is rtapi_get_time() at the start of the
+   cycle. */
+static void log_trajectory(long long start);
+
 
 /***********************************************************************
 *                        PUBLIC FUNCTION CODE                          *
@@ -243,6 +250,7 @@ void emcmotController(void *arg, long period)
 
     long long int now = rtapi_get_clocks();
     long int this_run = (long int)(now - last);
+    long long int start = emcmotTrajLog ? rtapi_get_time() : 0;
     emcmot_hal_data->last_period = this_run;
 #ifdef HAVE_CPU_KHZ
     emcmot_hal_data->last_period_ns = this_run * 1e6 / cpu_khz;
@@ -301,6 +309,9 @@ void emcmotController(void *arg, long period)
     if(period != last_period) {
         emcmotSetCycleTime(period);
         last_period = period;
+        if (emcmotTrajLog) {
+            emcmotTrajLog->period = period;
+        }
     }
 
     /* calculate servo frequency for calcs like vel = Dpos / period */
@@ -335,6 +346,7 @@ check_stuff ( "after compute_screw_comp()" );
 check_stuff ( "after output_to_hal()" );
     update_status();
 check_stuff ( "after update_status()" );
+    log_trajectory(start);
     /* here ends the core of the controller */
     emcmotStatus->heartbeat++;
     /* set tail to head, to indicate work complete */
@@ -1889,16 +1901,38 @@ static void output_to_hal(void)
     }
 }
 
+static void log_trajectory(long long start)
+{
+    trajlog_entry_t *e;
+
+    if (!emcmotTrajLog) {
+	return;
+    }
+    e = trajlogNext(emcmotTrajLog);
+    tpTrajLog(&emcmotDebug->queue, e);
+    e->cycle = emcmotStatus->heartbeat;
+    e->motion_type = emcmotStatus->motionType;
+    e->pos = emcmotStatus->carte_pos_cmd;
+    e->time = start;
+    e->compute = rtapi_get_time() - start;
+    trajlogCommit(emcmotTrajLog);
+}
+
 static void update_status(void)
 {
-    int joint_num, dio, aio;
+    int joint_num, dio, aio, changed;
     emcmot_joint_t *joint;
     emcmot_joint_status_t *joint_status;
+    static int old_command_num, old_command_status, old_motion_flag_seen;
+    static int old_depth, old_id, old_queue_full, old_paused;
+    static int old_homing_state, old_probe_tripped, old_orient_state;
+    static int old_atspeed;
 #ifdef WATCH_FLAGS
     static int old_joint_flags[8];
     static int old_motion_flag;
 #endif
 
+    changed = 0;
     /* copy status info from private joint structure to status
        struct in shared memory */
     for (joint_num = 0; joint_num < num_joints; joint_num++) {
@@ -1914,6 +1948,7 @@ static void update_status(void)
 	    old_joint_flags[joint_num] = joint->flag;
 	}
 #endif
+	changed |= joint_status->flag != joint->flag;
 	joint_status->flag = joint->flag;
 	joint_status->pos_cmd = joint->pos_cmd;
 	joint_status->pos_fb = joint->pos_fb;
@@ -1950,6 +1985,12 @@ static void update_status(void)
     emcmotStatus->motionType = tpGetMotionType(&emcmotDebug->queue);
     emcmotStatus->queueFull = tcqFull(&emcmotDebug->queue.queue);
 
+    /* publish this cycle's position for the backplot */
+    if (emcmotPosLog) {
+	poslogWrite(emcmotPosLog, &emcmotStatus->carte_pos_cmd,
+	    &emcmotStatus->carte_pos_fb, emcmotStatus->motionType);
+    }
+
     /* check to see if we should pause in order to implement
        single emcmotDebug->stepping */
     if (emcmotDebug->stepping && emcmotDebug->idForStep != emcmotStatus->id) {
@@ -1957,6 +1998,25 @@ static void update_status(void)
       emcmotDebug->stepping = 0;
       emcmotStatus->paused = 1;
     }
+
+    /* bump the change count when anything task is waiting on moves, so
+       it can sleep until then instead of polling the whole struct */
+#define CHANGED(old, val) ((old) != (val) ? ((old) = (val), 1) : 0)
+    changed |= CHANGED(old_command_num, emcmotStatus->commandNumEcho);
+    changed |= CHANGED(old_command_status, emcmotStatus->commandStatus);
+    changed |= CHANGED(old_motion_flag_seen, emcmotStatus->motionFlag);
+    changed |= CHANGED(old_depth, emcmotStatus->depth);
+    changed |= CHANGED(old_id, emcmotStatus->id);
+    changed |= CHANGED(old_queue_full, emcmotStatus->queueFull);
+    changed |= CHANGED(old_paused, emcmotStatus->paused);
+    changed |= CHANGED(old_homing_state, emcmotStatus->homingSequenceState);
+    changed |= CHANGED(old_probe_tripped, emcmotStatus->probeTripped);
+    changed |= CHANGED(old_orient_state, emcmotStatus->spindle.orient_state);
+    changed |= CHANGED(old_atspeed, emcmotStatus->spindle_is_atspeed);
+#undef CHANGED
+    if (changed) {
+	emcmotStatus->change_count++;
+    }
 #ifdef WATCH_FLAGS
     /*! \todo FIXME - this is for debugging */
     if ( old_motion_flag != emcmotStatus->motionFlag ) {
@@ -230,6 +230,10 @@ extern struct emcmot_config_t *emcmotConfig;
 extern struct emcmot_debug_t *emcmotDebug;
 extern struct emcmot_internal_t *emcmotInternal;
 extern struct emcmot_error_t *emcmotError;
+/* ring of positions for the backplot, or 0 if it could not be allocated */
+extern struct poslog_t *emcmotPosLog;
+/* per-cycle planner records for trajlog, or 0 unless traj_log=1 */
+extern struct trajlog_t *emcmotTrajLog;
 
 /***********************************************************************
 *                    PUBLIC FUNCTION PROTOTYPES                        *
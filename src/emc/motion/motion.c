@@ -19,6 +19,8 @@
 #include "motion_debug.h"
 #include "motion_struct.h"
 #include "mot_priv.h"
+#include "poslog.h"
+#include "trajlog.h"
 #include "rtapi_math.h"
 
 // Mark strings for translation, but defer translation to userspace
@@ -57,6 +59,8 @@ int num_dio = 4;			/* default number of motion synched DIO */
 RTAPI_MP_INT(num_dio, "number of digital inputs/outputs");
 int num_aio = 4;			/* default number of motion synched AIO */
 RTAPI_MP_INT(num_aio, "number of analog inputs/outputs");
+static int traj_log = 0;		/* record the trajectory log */
+RTAPI_MP_INT(traj_log, "record a trajectory log for trajlog");
 
 /***********************************************************************
 *                  GLOBAL VARIABLE DEFINITIONS                         *
@@ -98,6 +102,8 @@ struct emcmot_config_t *emcmotConfig = 0;
 struct emcmot_debug_t *emcmotDebug = 0;
 struct emcmot_internal_t *emcmotInternal = 0;
 struct emcmot_error_t *emcmotError = 0;	/* unused for RT_FIFO */
+struct poslog_t *emcmotPosLog = 0;
+struct trajlog_t *emcmotTrajLog = 0;
 
 /***********************************************************************
 *                  LOCAL VARIABLE DECLARATIONS                         *
@@ -105,6 +111,8 @@ struct emcmot_error_t *emcmotError = 0;	/* unused for RT_FIFO */
 
 /* RTAPI shmem ID - for comms with higher level user space stuff */
 static int emc_shmem_id;	/* the shared memory ID */
+static int poslog_shmem_id = -1;	/* the position log's */
+static int trajlog_shmem_id = -1;	/* the trajectory log's */
 
 /***********************************************************************
 *                   LOCAL FUNCTION PROTOTYPES                          *
@@ -259,6 +267,12 @@ void rtapi_app_exit(void)
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    _("MOTION: rtapi_shmem_delete() failed, returned %d\n"), retval);
     }
+    if (poslog_shmem_id >= 0) {
+	rtapi_shmem_delete(poslog_shmem_id, mot_comp_id);
+    }
+    if (trajlog_shmem_id >= 0) {
+	rtapi_shmem_delete(trajlog_shmem_id, mot_comp_id);
+    }
     /* disconnect from HAL and RTAPI */
     retval = hal_exit(mot_comp_id);
     if (retval < 0) {
@@ -856,6 +870,38 @@ static int init_comm_buffers(void)
     /* init error struct */
     emcmotErrorInit(emcmotError);
 
+    /* the position log is only for display, so carry on without it */
+    poslog_shmem_id = rtapi_shmem_new(POSLOG_SHMEM_KEY, mot_comp_id,
+	sizeof(poslog_t));
+    if (poslog_shmem_id < 0 ||
+	rtapi_shmem_getptr(poslog_shmem_id, (void **) &emcmotPosLog) < 0) {
+	rtapi_print_msg(RTAPI_MSG_WARN,
+	    "MOTION: could not allocate the position log, returned %d\n",
+	    poslog_shmem_id);
+	emcmotPosLog = 0;
+    } else {
+	memset(emcmotPosLog, 0, sizeof(poslog_t));
+	emcmotPosLog->magic = POSLOG_MAGIC_NUM;
+    }
+
+    /* so is the trajectory log, which is only there when asked for */
+    if (traj_log) {
+	trajlog_shmem_id = rtapi_shmem_new(TRAJLOG_SHMEM_KEY, mot_comp_id,
+	    sizeof(trajlog_t));
+	if (trajlog_shmem_id < 0 ||
+	    rtapi_shmem_getptr(trajlog_shmem_id, (void **) &emcmotTrajLog) < 0) {
+	    rtapi_print_msg(RTAPI_MSG_WARN,
+		"MOTION: could not allocate the trajectory log, returned %d\n",
+		trajlog_shmem_id);
+	    emcmotTrajLog = 0;
+	} else {
+	    memset(emcmotTrajLog, 0, sizeof(trajlog_t));
+	    emcmotTrajLog->version = TRAJLOG_VERSION;
+	    emcmotTrajLog->entry_size = sizeof(trajlog_entry_t);
+	    emcmotTrajLog->magic = TRAJLOG_MAGIC_NUM;
+	}
+    }
+
     /* init command struct */
     emcmotCommand->head = 0;
     emcmotCommand->command = 0;
@@ -880,6 +926,7 @@ static int init_comm_buffers(void)
     SET_MOTION_TELEOP_FLAG(0);
     emcmotDebug->split = 0;
     emcmotStatus->heartbeat = 0;
+    emcmotStatus->change_count = 0;
     emcmotStatus->computeTime = 0.0;
     emcmotConfig->numJoints = num_joints;
 
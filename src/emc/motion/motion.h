@@ -75,6 +75,7 @@ to another.
 
 #include "posemath.h"		/* PmCartesian, PmPose, pmCartMag() */
 #include "emcpos.h"		/* EmcPose */
+#include "drillcycle.h"		/* DRILL_CYCLE_PARAMS */
 #include "cubic.h"		/* CUBIC_STRUCT, CUBIC_COEFF */
 #include "emcmotcfg.h"		/* EMCMOT_MAX_JOINTS */
 #include "kinematics.h"
@@ -145,6 +146,7 @@ extern "C" {
 				   trip pos */
 	EMCMOT_RIGID_TAP,	/* go to pos, with sync to spindle speed, 
 				   then return to initial pos */
+	EMCMOT_DRILL_CYCLE,	/* queue up a whole drill cycle */
 
 	EMCMOT_SET_POSITION_LIMITS,	/* set the joint position +/- limits */
 	EMCMOT_SET_BACKLASH,	/* set the joint backlash */
@@ -214,6 +216,9 @@ extern "C" {
         int motion_type;        /* this move is because of traverse, feed, arc, or toolchange */
         double spindlesync;     /* user units per spindle revolution, 0 = no sync */
 	double acc;		/* max acceleration */
+	double rapid_vel;	/* velocity of the traverses in a drill cycle */
+	DRILL_CYCLE_PARAMS drill;	/* levels of a drill cycle, pos is the
+				   move for one unit of level */
 	double backlash;	/* amount of backlash */
 	int id;			/* id for motion */
 	int termCond;		/* termination condition */
@@ -651,6 +656,9 @@ Suggestion: Split this in to an Error and a Status flag register..
 
 	/* dynamic status-- changes every cycle */
 	unsigned int heartbeat;
+	unsigned int change_count;	/* incremented whenever state that task
+					   waits on (command echo, flags, queue)
+					   changes */
 	int config_num;		/* incremented whenever configuration
 				   changed. */
 	double computeTime;
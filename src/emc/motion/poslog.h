@@ -0,0 +1,59 @@
+/********************************************************************
+* Description: poslog.h
+*   Ring of positions that motion publishes every servo cycle, for
+*   the backplot in the user interfaces
+*
+*   The ring lives in its own RTAPI shared memory block, so readers do
+*   not need the rest of the motion structures.  Motion is the only
+*   writer and never waits for anybody; see shmring.h.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+#ifndef POSLOG_H
+#define POSLOG_H
+
+#include "emcpos.h"
+#include "shmring.h"
+
+#define POSLOG_SHMEM_KEY	0x504F534C
+#define POSLOG_MAGIC_NUM	0x504C4F47
+/* a power of two, so that the entry index stays right when head wraps;
+   about two seconds at a 1 kHz servo rate */
+#define POSLOG_DEPTH		2048
+
+typedef struct {
+    EmcPose cmd;		/* commanded Cartesian position */
+    EmcPose fb;			/* actual Cartesian position */
+    int motion_type;		/* EMC_MOTION_TYPE_* of the current move, or 0 */
+} poslog_entry_t;
+
+typedef struct poslog_t {
+    unsigned int magic;
+    volatile unsigned int head;	/* number of entries ever written */
+    poslog_entry_t entry[POSLOG_DEPTH];
+} poslog_t;
+
+/* Appends one entry.  Only called by motion. */
+static inline void poslogWrite(poslog_t * log, const EmcPose * cmd,
+			       const EmcPose * fb, int motion_type)
+{
+    poslog_entry_t *e = &log->entry[log->head % POSLOG_DEPTH];
+
+    e->cmd = *cmd;
+    e->fb = *fb;
+    e->motion_type = motion_type;
+    shmringCommit(&log->head);
+}
+
+/* Copies the entries written since *tail into buf; see shmringRead(). */
+static inline int poslogRead(poslog_t * log, unsigned int *tail,
+			     poslog_entry_t * buf, int max,
+			     unsigned int *lost)
+{
+    return shmringRead(&log->head, log->entry, sizeof(poslog_entry_t),
+		       POSLOG_DEPTH, tail, buf, max, lost);
+}
+
+#endif
@@ -0,0 +1,78 @@
+/********************************************************************
+* Description: shmring.h
+*   Lapped ring of fixed-size entries in RTAPI shared memory, with one
+*   writer that never waits and any number of readers
+*
+*   The position log (poslog.h) and the trajectory log (trajlog.h) are
+*   both such rings.  Each is a head counter, the number of entries
+*   ever written, followed by an array of a power of two entries.  The
+*   writer fills entry head % depth and then increments head; it
+*   overwrites the oldest entry when the ring is full.  Readers keep
+*   their own tail, copy what is new in one go, and find out afterwards
+*   whether the writer lapped them while they were copying.  Nobody
+*   takes a lock.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include "rtapi_string.h"	/* memcpy */
+
+/* Makes the entry just filled in visible to the readers.  Only called
+   by the writer. */
+static inline void shmringCommit(volatile unsigned int *head)
+{
+    /* the entry has to be complete before head says it is there */
+    __sync_synchronize();
+    (*head)++;
+}
+
+/* Copies the entries written since *tail from 'ring', an array of
+   'depth' entries of 'size' bytes, into buf, oldest first and at most
+   max of them, and advances *tail past them.  Entries the writer
+   overwrote before they could be copied are skipped and added to *lost.
+   Returns the number of entries in buf. */
+static inline int shmringRead(volatile unsigned int *headp,
+			      const void *ring, unsigned int size,
+			      unsigned int depth, unsigned int *tail,
+			      void *buf, int max, unsigned int *lost)
+{
+    const char *src = (const char *) ring;
+    char *dst = (char *) buf;
+    unsigned int head, first, n, i;
+    int stale;
+
+    head = *headp;
+    __sync_synchronize();
+    first = *tail;
+    if ((int) (head - first) < 0) {
+	/* the writer was restarted */
+	first = head;
+    } else if (head - first > depth) {
+	*lost += head - first - depth;
+	first = head - depth;
+    }
+    n = head - first;
+    if (n > (unsigned int) max)
+	n = max;
+    for (i = 0; i < n; i++)
+	memcpy(dst + i * size, src + ((first + i) % depth) * size, size);
+    __sync_synchronize();
+    *tail = first + n;
+
+    /* while the writer fills entry h, its slot still counts as holding
+       entry h - depth, so anything up to that may be torn */
+    stale = (int) (*headp + 1 - depth - first);
+    if (stale <= 0)
+	return n;
+    if ((unsigned int) stale > n)
+	stale = n;
+    memmove(dst, dst + stale * size, (n - stale) * size);
+    *lost += stale;
+    return n - stale;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/********************************************************************
+* Description: trajlog.h
+*   Ring of per-cycle trajectory planner records, for offline analysis
+*
+*   When motmod is loaded with traj_log=1 motion fills one record each
+*   servo cycle, in its own RTAPI shared memory block, and trajlog(1)
+*   drains the ring to a file.  Like the position log (poslog.h) it is
+*   a shmring.h ring: the writer never waits, it overwrites the oldest
+*   record when the ring is full, and the reader finds out afterwards
+*   what it lost.
+*
+*   The same records, preceded by a trajlog_file_header_t, make up the
+*   file.  Change TRAJLOG_VERSION whenever trajlog_entry_t changes, and
+*   the decoder in lib/python/trajlog.py with it.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+#ifndef TRAJLOG_H
+#define TRAJLOG_H
+
+#include "emcpos.h"
+#include "shmring.h"
+
+#define TRAJLOG_SHMEM_KEY	0x54524A4C
+#define TRAJLOG_MAGIC_NUM	0x544A4C47
+#define TRAJLOG_VERSION		1
+/* a power of two, so that the entry index stays right when head wraps;
+   about two seconds at a 1 kHz servo rate */
+#define TRAJLOG_DEPTH		2048
+
+/* trajlog_entry_t.flags */
+#define TRAJLOG_BLENDING	0x01	/* the tc is blending into the next */
+#define TRAJLOG_BLEND_WITH_NEXT	0x02	/* the tc ends in a blend (G64) */
+#define TRAJLOG_SYNCHRONIZED	0x04	/* the tc follows the spindle */
+#define TRAJLOG_PAUSING		0x08
+#define TRAJLOG_ABORTING	0x10
+
+/* Fields are ordered so that the layout has no padding, on 32 and
+   64 bit machines alike. */
+typedef struct trajlog_entry_t {
+    unsigned int cycle;		/* emcmotStatus->heartbeat */
+    int id;			/* tc being executed, 0 if the queue is empty */
+    int motion_type;		/* EMC_MOTION_TYPE_* of the current move */
+    int queue_depth;		/* tcs in the queue */
+    int active_depth;		/* tcs moving at once */
+    unsigned int flags;		/* TRAJLOG_* */
+    long long time;		/* rtapi_get_time() at the start of the cycle */
+    long long compute;		/* ns from then until the record was made */
+    EmcPose pos;		/* commanded Cartesian position */
+    double vel;			/* speed of the tc after this cycle */
+    double next_vel;		/* speed of the next tc while blending */
+    double req_vel;		/* speed requested by the program */
+    double max_vel;		/* speed limit of the tc */
+    double final_vel;		/* speed at which it hands over to the next
+				   tc, 0 if it has to stop */
+    double feed_scale;		/* feed override applied to the tc */
+    double progress;		/* distance along the tc */
+    double target;		/* length of the tc */
+} trajlog_entry_t;
+
+typedef struct trajlog_t {
+    unsigned int magic;
+    unsigned int version;	/* TRAJLOG_VERSION */
+    unsigned int entry_size;	/* sizeof(trajlog_entry_t) */
+    unsigned int period;	/* servo period in ns */
+    volatile unsigned int head;	/* number of entries ever written */
+    unsigned int reserved;
+    trajlog_entry_t entry[TRAJLOG_DEPTH];
+} trajlog_t;
+
+#define TRAJLOG_FILE_MAGIC	"EMCTRAJ"
+
+typedef struct {
+    char magic[8];		/* TRAJLOG_FILE_MAGIC */
+    unsigned int version;
+    unsigned int entry_size;
+    unsigned int period;
+    unsigned int reserved;
+} trajlog_file_header_t;
+
+/* Returns the entry to fill in next.  Only called by motion, which
+   then calls trajlogCommit(). */
+static inline trajlog_entry_t *trajlogNext(trajlog_t * log)
+{
+    return &log->entry[log->head % TRAJLOG_DEPTH];
+}
+
+static inline void trajlogCommit(trajlog_t * log)
+{
+    shmringCommit(&log->head);
+}
+
+/* Copies the entries written since *tail into buf; see shmringRead(). */
+static inline int trajlogRead(trajlog_t * log, unsigned int *tail,
+			      trajlog_entry_t * buf, int max,
+			      unsigned int *lost)
+{
+    return shmringRead(&log->head, log->entry, sizeof(trajlog_entry_t),
+		       TRAJLOG_DEPTH, tail, buf, max, lost);
+}
+
+#endif
@@ -0,0 +1,166 @@
+/********************************************************************
+* Description:  trajlog_usr.c
+*               Writes the trajectory log of motion to a file
+*
+*   motmod loaded with traj_log=1 makes one trajlog_entry_t per servo
+*   cycle (see trajlog.h).  This program copies them, behind a
+*   trajlog_file_header_t, to a file or to stdout until it is told to
+*   stop, and then reports how many records motion overwrote before
+*   they could be copied.  lib/python/trajlog.py reads the file.
+*
+*   Invoking:
+*
+*   trajlog [-n num_records] [file]
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rtapi.h"		/* RTAPI realtime OS API */
+#include "trajlog.h"
+
+static volatile int done = 0;
+
+static void quit(int sig)
+{
+    done = 1;
+}
+
+int main(int argc, char **argv)
+{
+    int comp_id, shmem_id = -1, n, got, exitval = 1;
+    long records = -1;		/* -1 means until killed */
+    unsigned int tail, lost = 0;
+    unsigned long written = 0;
+    char name[32], *end;
+    void *ptr;
+    trajlog_t *log;
+    trajlog_entry_t *buf;
+    trajlog_file_header_t header;
+    struct timespec delay;
+    FILE *out = stdout;
+
+    while ((n = getopt(argc, argv, "n:")) != -1) {
+	switch (n) {
+	case 'n':
+	    records = strtol(optarg, &end, 10);
+	    if (*end || records < 0) {
+		fprintf(stderr, "ERROR: invalid record count '%s'\n", optarg);
+		return 1;
+	    }
+	    break;
+	default:
+	    fprintf(stderr, "usage: %s [-n num_records] [file]\n", argv[0]);
+	    return 1;
+	}
+    }
+    if (optind + 1 < argc) {
+	fprintf(stderr, "ERROR: At most one filename may be specified\n");
+	return 1;
+    }
+    if (optind < argc) {
+	out = fopen(argv[optind], "wb");
+	if (!out) {
+	    perror(argv[optind]);
+	    return 1;
+	}
+    }
+    buf = malloc(sizeof(trajlog_entry_t) * TRAJLOG_DEPTH);
+    if (!buf) {
+	fprintf(stderr, "ERROR: out of memory\n");
+	return 1;
+    }
+
+    snprintf(name, sizeof(name), "trajlog%d", getpid());
+    comp_id = rtapi_init(name);
+    if (comp_id < 0) {
+	fprintf(stderr, "ERROR: rtapi_init() failed: %d\n", comp_id);
+	return 1;
+    }
+    shmem_id = rtapi_shmem_new(TRAJLOG_SHMEM_KEY, comp_id, sizeof(trajlog_t));
+    if (shmem_id < 0 || rtapi_shmem_getptr(shmem_id, &ptr) < 0) {
+	fprintf(stderr, "ERROR: couldn't map the trajectory log\n");
+	goto out;
+    }
+    log = ptr;
+    if (log->magic != TRAJLOG_MAGIC_NUM) {
+	fprintf(stderr, "ERROR: no trajectory log; load motmod with "
+	    "traj_log=1\n");
+	goto out;
+    }
+    if (log->version != TRAJLOG_VERSION
+	|| log->entry_size != sizeof(trajlog_entry_t)) {
+	fprintf(stderr, "ERROR: motion writes trajectory log version %u, "
+	    "this program reads version %d\n", log->version, TRAJLOG_VERSION);
+	goto out;
+    }
+
+    signal(SIGINT, quit);
+    signal(SIGTERM, quit);
+    signal(SIGPIPE, quit);
+
+    delay.tv_sec = 0;
+    delay.tv_nsec = 10000000;
+    /* the period is only known once motion has run a cycle */
+    while (!done && log->period == 0) {
+	nanosleep(&delay, NULL);
+    }
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, TRAJLOG_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRAJLOG_VERSION;
+    header.entry_size = sizeof(trajlog_entry_t);
+    header.period = log->period;
+    if (fwrite(&header, sizeof(header), 1, out) != 1) {
+	perror("trajlog");
+	goto out;
+    }
+
+    /* start with the next record, not with whatever is in the ring */
+    tail = log->head;
+    while (!done && records != 0) {
+	got = trajlogRead(log, &tail, buf, TRAJLOG_DEPTH, &lost);
+	if (got == 0) {
+	    nanosleep(&delay, NULL);
+	    continue;
+	}
+	if (records > 0 && got > records) {
+	    got = records;
+	}
+	if (fwrite(buf, sizeof(trajlog_entry_t), got, out) != (size_t) got) {
+	    perror("trajlog");
+	    goto out;
+	}
+	written += got;
+	if (records > 0) {
+	    records -= got;
+	}
+    }
+    if (fflush(out) != 0) {
+	perror("trajlog");
+	goto out;
+    }
+    exitval = 0;
+
+out:
+    if (written || lost) {
+	fprintf(stderr, "trajlog: %lu records written, %u lost\n", written,
+	    lost);
+    }
+    if (out != stdout) {
+	fclose(out);
+    }
+    free(buf);
+    if (shmem_id >= 0) {
+	rtapi_shmem_delete(shmem_id, comp_id);
+    }
+    rtapi_exit(comp_id);
+    return exitval;
+}
@@ -141,6 +141,18 @@ int usrmotReadEmcmotStatus(emcmot_status_t * s)
     return EMCMOT_COMM_SPLIT_READ_TIMEOUT;
 }
 
+/* copies the status change count to count */
+int usrmotReadEmcmotChangeCount(unsigned int *count)
+{
+    /* check for shmem still around */
+    if (0 == emcmotStatus) {
+	return EMCMOT_COMM_ERROR_CONNECT;
+    }
+    /* a single aligned word, so no head/tail check is needed */
+    *count = *(volatile unsigned int *) &emcmotStatus->change_count;
+    return EMCMOT_COMM_OK;
+}
+
 /* copies config to s */
 int usrmotReadEmcmotConfig(emcmot_config_t * s)
 {
@@ -479,6 +491,7 @@ void usrmotPrintEmcmotStatus(emcmot_status_t *s, int which)
 	printf("cmd:          \t%d\n", s->commandEcho);
 	printf("cmd num:      \t%d\n", s->commandNumEcho);
 	printf("heartbeat:    \t%u\n", s->heartbeat);
+	printf("change count: \t%u\n", s->change_count);
 	printf("compute time: \t%f\n", s->computeTime);
 /*! \todo Another #if 0 */
 #if 0				/*! \todo FIXME - change to work with joint
@@ -35,6 +35,10 @@ extern "C" {
    the emcmot controller and puts it in arg */
     extern int usrmotReadEmcmotStatus(emcmot_status_t * s);
 
+/* usrmotReadEmcmotChangeCount() gets just the status change count,
+   without copying the whole status struct */
+    extern int usrmotReadEmcmotChangeCount(unsigned int *count);
+
 /* usrmotReadEmcmotConfig() gets the config info out of
    the emcmot controller and puts it in arg */
     extern int usrmotReadEmcmotConfig(emcmot_config_t * s);
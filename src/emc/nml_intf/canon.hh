@@ -18,6 +18,7 @@
 
 #include "emcpos.h"
 #include "emctool.h"
+#include "drillcycle.h"
 
 /*
   This is the header file that all applications that use the
@@ -420,18 +421,35 @@ extern void STRAIGHT_FEED(int lineno,
 
 extern std::vector<unsigned int> knot_vector_creator(unsigned int n, unsigned int k);
 extern double Nmix(unsigned int i, unsigned int k, double u, 
-                    std::vector<unsigned int> knot_vector);
+                    const std::vector<unsigned int> &knot_vector);
 extern double Rden(double u, unsigned int k,
-                  std::vector<CONTROL_POINT> nurbs_control_points,
-                  std::vector<unsigned int> knot_vector);
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector);
 extern PLANE_POINT nurbs_point(double u, unsigned int k, 
-                  std::vector<CONTROL_POINT> nurbs_control_points,
-                  std::vector<unsigned int> knot_vector);
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector);
 extern PLANE_POINT nurbs_tangent(double u, unsigned int k,
-                  std::vector<CONTROL_POINT> nurbs_control_points,
-                  std::vector<unsigned int> knot_vector);
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector);
+extern void nurbs_point_tangent(double u, unsigned int k,
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector,
+                  PLANE_POINT &point, PLANE_POINT &tangent);
 extern double alpha_finder(double dx, double dy);
 
+/* NURBS are followed with biarcs: nurbs_biarcs() calls feed() for each
+   arc that stays within tolerance of the curve, in the same units as the
+   control points, with the end point, the center and the rotation as
+   ARC_FEED() takes them, or a rotation of 0 for a straight line.
+   NURBS_FEED() in each canon uses it, so they all make the same moves
+   of a curve. */
+#define NURBS_DEFAULT_TOLERANCE 0.001  /* mm, when G64 has no P */
+typedef void (*nurbs_arc_fn)(int lineno, double x, double y,
+                             double cx, double cy, int rotation);
+extern void nurbs_biarcs(int lineno,
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  unsigned int k, double tolerance, nurbs_arc_fn feed);
+
 /* Canon calls */
 
 extern void NURBS_FEED(int lineno, std::vector<CONTROL_POINT> nurbs_control_points, unsigned int k);
@@ -449,6 +467,21 @@ extern void RIGID_TAP(int lineno,
 /* Move linear and synced with the previously set pitch.
 Only linear moves are allowed, axes A,B,C are not allowed to move.*/
 
+extern void DRILL_CYCLE(int lineno, CANON_PLANE plane,
+                        double r, double clear, double bottom,
+                        double peck, double backoff, int mode, double dwell);
+
+/* Drill a hole along the axis perpendicular to the given plane, starting
+at the current position.  All levels are coordinates along that axis.
+Feed to bottom, in pecks of the given depth starting at r if peck is not
+zero, dwell there if mode has DRILL_DWELL, and traverse to clear, or
+feed there if mode has DRILL_FEED_RETRACT.  With DRILL_SPINDLE_STOP the
+spindle is stopped for the way out and started again once at clear,
+counterclockwise if mode also has DRILL_SPINDLE_CCW.  Between pecks, traverse back to r and then down to backoff above the
+last peck if mode has DRILL_FULL_RETRACT (G83), or only back off by
+backoff (G73).  The moves are the ones generated by drillCycleStep()
+in drillcycle.h.*/
+
 
 extern void STRAIGHT_PROBE(int lineno,
                            double x, double y, double z,
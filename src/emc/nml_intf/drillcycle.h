@@ -0,0 +1,157 @@
+/********************************************************************
+* Description: drillcycle.h
+*   Step generator for the parametric drill cycle primitive
+*
+*   G81, G82, G73, G83, G85, G86 and G89 are sent down as a single
+*   DRILL_CYCLE instead of one move per feed, retract and peck.  Whoever executes
+*   the primitive - the trajectory planner, or a canon that only
+*   previews or prints the program - calls drillCycleStep() to get the
+*   moves one at a time, so every one of them produces the same moves
+*   the interpreter used to produce itself.
+*
+*   Levels are coordinates along the cycle axis in the units and
+*   frame of the program, decreasing into the hole.
+*
+*   This is included by realtime code, so it must not use libm.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+#ifndef DRILLCYCLE_H
+#define DRILLCYCLE_H
+
+/* bits for DRILL_CYCLE_PARAMS mode */
+#define DRILL_FULL_RETRACT 1	/* retract to r after each peck (G83) */
+#define DRILL_DWELL 2		/* dwell at the bottom (G82, G86, G89) */
+#define DRILL_FEED_RETRACT 4	/* feed out to clear instead of
+				   traversing (G85, G89) */
+#define DRILL_SPINDLE_STOP 8	/* stop the spindle at the bottom and
+				   start it again once clear (G86) */
+#define DRILL_SPINDLE_CCW 16	/* ... turning counterclockwise */
+
+/* kinds of DRILL_CYCLE_STEP */
+#define DRILL_STEP_FEED 1
+#define DRILL_STEP_TRAVERSE 2
+#define DRILL_STEP_DWELL 3
+#define DRILL_STEP_SPINDLE_STOP 4
+#define DRILL_STEP_SPINDLE_START 5
+
+typedef struct {
+    double start;		/* level the cycle starts from */
+    double r;			/* level the pecks start from */
+    double bottom;		/* level of the bottom of the hole */
+    double clear;		/* level of the final retract */
+    double peck;		/* depth of each peck, 0 for no pecking */
+    double backoff;		/* clearance above the last peck when going
+				   back in (G83) or backing off (G73) */
+    double dwell;		/* seconds at the bottom, with DRILL_DWELL */
+    int mode;			/* DRILL_FULL_RETRACT, DRILL_DWELL, ... */
+} DRILL_CYCLE_PARAMS;
+
+typedef enum {
+    DRILL_PHASE_START, DRILL_PHASE_PECK, DRILL_PHASE_RETRACT,
+    DRILL_PHASE_REENTER, DRILL_PHASE_BOTTOM, DRILL_PHASE_DWELL,
+    DRILL_PHASE_STOP, DRILL_PHASE_CLEAR, DRILL_PHASE_RESTART,
+    DRILL_PHASE_DONE
+} DRILL_CYCLE_PHASE;
+
+typedef struct {
+    DRILL_CYCLE_PHASE phase;
+    double level;		/* where the last step ended */
+    double depth;		/* level of the current peck */
+} DRILL_CYCLE_STATE;
+
+typedef struct {
+    int kind;			/* DRILL_STEP_FEED, _TRAVERSE, _DWELL,
+				   _SPINDLE_STOP or _SPINDLE_START */
+    double from, to;		/* levels, equal unless the step moves */
+    double seconds;		/* length of a dwell */
+} DRILL_CYCLE_STEP;
+
+static inline void drillCycleInit(const DRILL_CYCLE_PARAMS * p,
+				  DRILL_CYCLE_STATE * s)
+{
+    s->phase = DRILL_PHASE_START;
+    s->level = p->start;
+    s->depth = p->r;
+}
+
+static inline int drillCycleMove(DRILL_CYCLE_STATE * s,
+				 DRILL_CYCLE_STEP * step, int kind,
+				 double to)
+{
+    step->kind = kind;
+    step->from = s->level;
+    step->to = to;
+    step->seconds = 0.0;
+    s->level = to;
+    return 1;
+}
+
+/* Puts the next step of the cycle into step.  Returns 1, or 0 once the
+   cycle is complete.  The pecks are computed exactly the way
+   convert_cycle_g83 and convert_cycle_g73 always have, including the
+   floating point order, so that every executor ends up with the same
+   positions. */
+static inline int drillCycleStep(const DRILL_CYCLE_PARAMS * p,
+				 DRILL_CYCLE_STATE * s,
+				 DRILL_CYCLE_STEP * step)
+{
+    double level;
+
+    for (;;) {
+	switch (s->phase) {
+	case DRILL_PHASE_START:
+	    s->depth = p->r - p->peck;
+	    s->phase = p->peck > 0.0 ? DRILL_PHASE_PECK : DRILL_PHASE_BOTTOM;
+	    break;
+	case DRILL_PHASE_PECK:
+	    if (!(s->depth > p->bottom)) {
+		s->phase = DRILL_PHASE_BOTTOM;
+		break;
+	    }
+	    s->phase = (p->mode & DRILL_FULL_RETRACT) ?
+		DRILL_PHASE_RETRACT : DRILL_PHASE_REENTER;
+	    return drillCycleMove(s, step, DRILL_STEP_FEED, s->depth);
+	case DRILL_PHASE_RETRACT:
+	    s->phase = DRILL_PHASE_REENTER;
+	    return drillCycleMove(s, step, DRILL_STEP_TRAVERSE, p->r);
+	case DRILL_PHASE_REENTER:
+	    level = s->depth + p->backoff;
+	    s->depth = s->depth - p->peck;
+	    s->phase = DRILL_PHASE_PECK;
+	    return drillCycleMove(s, step, DRILL_STEP_TRAVERSE, level);
+	case DRILL_PHASE_BOTTOM:
+	    s->phase = (p->mode & DRILL_DWELL) ?
+		DRILL_PHASE_DWELL : DRILL_PHASE_STOP;
+	    return drillCycleMove(s, step, DRILL_STEP_FEED, p->bottom);
+	case DRILL_PHASE_DWELL:
+	    s->phase = DRILL_PHASE_STOP;
+	    drillCycleMove(s, step, DRILL_STEP_DWELL, s->level);
+	    step->seconds = p->dwell;
+	    return 1;
+	case DRILL_PHASE_STOP:
+	    s->phase = DRILL_PHASE_CLEAR;
+	    if (p->mode & DRILL_SPINDLE_STOP)
+		return drillCycleMove(s, step, DRILL_STEP_SPINDLE_STOP,
+				      s->level);
+	    break;
+	case DRILL_PHASE_CLEAR:
+	    s->phase = DRILL_PHASE_RESTART;
+	    return drillCycleMove(s, step, (p->mode & DRILL_FEED_RETRACT) ?
+				  DRILL_STEP_FEED : DRILL_STEP_TRAVERSE,
+				  p->clear);
+	case DRILL_PHASE_RESTART:
+	    s->phase = DRILL_PHASE_DONE;
+	    if (p->mode & DRILL_SPINDLE_STOP)
+		return drillCycleMove(s, step, DRILL_STEP_SPINDLE_START,
+				      s->level);
+	    break;
+	default:
+	    return 0;
+	}
+    }
+}
+
+#endif
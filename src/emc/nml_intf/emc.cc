@@ -380,6 +380,9 @@ int emcFormat(NMLTYPE type, void *buffer, CMS * cms)
     case EMC_TRAJ_RIGID_TAP_TYPE:
 	((EMC_TRAJ_RIGID_TAP *) buffer)->update(cms);
         break;
+    case EMC_TRAJ_DRILL_CYCLE_TYPE:
+	((EMC_TRAJ_DRILL_CYCLE *) buffer)->update(cms);
+	break;
     case EMC_TRAJ_PAUSE_TYPE:
 	((EMC_TRAJ_PAUSE *) buffer)->update(cms);
 	break;
@@ -708,6 +711,8 @@ const char *emc_symbol_lookup(long type)
 	return "EMC_AUX_INPUT_WAIT";
     case EMC_TRAJ_RIGID_TAP_TYPE:
 	return "EMC_TRAJ_RIGID_TAP";
+    case EMC_TRAJ_DRILL_CYCLE_TYPE:
+	return "EMC_TRAJ_DRILL_CYCLE";
     case EMC_TRAJ_RESUME_TYPE:
 	return "EMC_TRAJ_RESUME";
     case EMC_TRAJ_SET_ACCELERATION_TYPE:
@@ -900,6 +905,8 @@ void EMC_TOOL_STAT::update(CMS * cms)
     EMC_TOOL_STAT_MSG::update(cms);
     cms->update(pocketPrepped);
     cms->update(toolInSpindle);
+    cms->update(toolPrepped);
+    cms->update(toolTableChanges);
     for (int i_toolTable = 0; i_toolTable < CANON_POCKETS_MAX; i_toolTable++)
 	CANON_TOOL_TABLE_update(cms, &(toolTable[i_toolTable]));
 
@@ -2856,6 +2863,29 @@ void EMC_TRAJ_RIGID_TAP::update(CMS * cms)
 
 }
 
+/*
+*	NML/CMS Update function for EMC_TRAJ_DRILL_CYCLE
+*/
+void EMC_TRAJ_DRILL_CYCLE::update(CMS * cms)
+{
+
+    EMC_TRAJ_CMD_MSG::update(cms);
+    EmcPose_update(cms, &unit);
+    cms->update(start);
+    cms->update(r);
+    cms->update(bottom);
+    cms->update(clear);
+    cms->update(peck);
+    cms->update(backoff);
+    cms->update(dwell);
+    cms->update(mode);
+    cms->update(vel);
+    cms->update(ini_maxvel);
+    cms->update(rapid_vel);
+    cms->update(acc);
+
+}
+
 
 /*
 *	NML/CMS Update function for EMC_LUBE_OFF
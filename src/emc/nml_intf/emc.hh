@@ -140,6 +140,7 @@ class PM_CARTESIAN;
 #define EMC_TRAJ_SET_SO_ENABLE_TYPE                  ((NMLTYPE) 235)
 #define EMC_TRAJ_SET_FH_ENABLE_TYPE                  ((NMLTYPE) 236)
 #define EMC_TRAJ_RIGID_TAP_TYPE                      ((NMLTYPE) 237)
+#define EMC_TRAJ_DRILL_CYCLE_TYPE                    ((NMLTYPE) 238)
 
 #define EMC_TRAJ_STAT_TYPE                           ((NMLTYPE) 299)
 
@@ -454,6 +455,11 @@ extern int emcTrajProbe(EmcPose pos, int type, double vel,
                         double ini_maxvel, double acc, unsigned char probe_type);
 extern int emcAuxInputWait(int index, int input_type, int wait_type, int timeout);
 extern int emcTrajRigidTap(EmcPose pos, double vel, double ini_maxvel, double acc);
+extern int emcTrajDrillCycle(EmcPose unit, double start, double r,
+                             double bottom, double clear, double peck,
+                             double backoff, double dwell, int mode,
+                             double vel, double ini_maxvel, double rapid_vel,
+                             double acc);
 
 extern int emcTrajUpdate(EMC_TRAJ_STAT * stat);
 
@@ -469,6 +475,7 @@ extern int emcMotionSetDout(unsigned char index, unsigned char start,
 			    unsigned char end, unsigned char now);
 
 extern int emcMotionUpdate(EMC_MOTION_STAT * stat);
+extern int emcMotionStatusChanged();
 
 // implementation functions for EMC_TASK types
 
@@ -487,6 +494,7 @@ extern int emcTaskPlanSetBlockDelete(bool state);
 extern int emcTaskPlanExit();
 extern int emcTaskPlanOpen(const char *file);
 extern int emcTaskPlanRead();
+extern int emcTaskPlanRestore(int line);
 extern int emcTaskPlanExecute(const char *command);
 extern int emcTaskPlanExecute(const char *command, int line_number); //used in case of MDI to pass the pseudo line number to interp
 extern int emcTaskPlanPause();
@@ -569,6 +577,7 @@ extern int emcIoSetCycleTime(double cycleTime);
 extern int emcIoSetDebug(int debug);
 
 extern int emcIoUpdate(EMC_IO_STAT * stat);
+extern int emcIoStatusChanged();
 
 // implementation functions for EMC aggregate types
 
@@ -948,6 +948,22 @@ class EMC_TRAJ_RIGID_TAP:public EMC_TRAJ_CMD_MSG {
     double vel, ini_maxvel, acc;
 };
 
+class EMC_TRAJ_DRILL_CYCLE:public EMC_TRAJ_CMD_MSG {
+  public:
+    EMC_TRAJ_DRILL_CYCLE():EMC_TRAJ_CMD_MSG(EMC_TRAJ_DRILL_CYCLE_TYPE,
+					sizeof(EMC_TRAJ_DRILL_CYCLE)) {
+    };
+
+    // For internal NML/CMS use only.
+    void update(CMS * cms);
+
+    EmcPose unit;		// move for one unit of level along the axis
+    double start, r, bottom, clear;	// levels, see DRILL_CYCLE_PARAMS
+    double peck, backoff, dwell;
+    int mode;
+    double vel, ini_maxvel, rapid_vel, acc;
+};
+
 // EMC_TRAJ status base class
 class EMC_TRAJ_STAT_MSG:public RCS_STAT_MSG {
   public:
@@ -1582,6 +1598,8 @@ class EMC_TOOL_STAT:public EMC_TOOL_STAT_MSG {
 
     int pocketPrepped;		// pocket ready for loading from
     int toolInSpindle;		// tool loaded, 0 is no tool
+    int toolPrepped;		// tool in pocketPrepped, 0 if none
+    int toolTableChanges;	// incremented whenever toolTable changes
     CANON_TOOL_TABLE toolTable[CANON_POCKETS_MAX];
 };
 
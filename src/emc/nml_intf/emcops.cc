@@ -152,6 +152,8 @@ EMC_TOOL_STAT_MSG(EMC_TOOL_STAT_TYPE, sizeof(EMC_TOOL_STAT))
 
     pocketPrepped = 0;
     toolInSpindle = 0;
+    toolPrepped = 0;
+    toolTableChanges = 0;
 
     for (t = 0; t < CANON_POCKETS_MAX; t++) {
 	toolTable[t].toolno = 0;
@@ -201,6 +203,8 @@ EMC_TOOL_STAT EMC_TOOL_STAT::operator =(EMC_TOOL_STAT s)
 
     pocketPrepped = s.pocketPrepped;
     toolInSpindle = s.toolInSpindle;
+    toolPrepped = s.toolPrepped;
+    toolTableChanges = s.toolTableChanges;
 
     for (t = 0; t < CANON_POCKETS_MAX; t++) {
 	toolTable[t].toolno = s.toolTable[t].toolno;
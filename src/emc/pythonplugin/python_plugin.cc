@@ -79,11 +79,32 @@ int PythonPlugin::call_method(bp::object method, bp::object &retval)
 
 }
 
+// look up [module.]callable - throws bp::error_already_set if not found
+void PythonPlugin::resolve(const char *module, const char *callable,
+			   bp::object &function)
+{
+    if (module == NULL) {  // default to function in toplevel module
+	function = main_namespace[callable];
+    } else {
+	bp::object submod =  main_namespace[module];
+	bp::object submod_namespace = submod.attr("__dict__");
+	function = submod_namespace[callable];
+    }
+}
+
 int PythonPlugin::call(const char *module, const char *callable,
 		       bp::object tupleargs, bp::object kwargs, bp::object &retval)
 {
-    bp::object function;
+    PythonCallable once;
+
+    return call(once, module, callable, tupleargs, kwargs, retval);
+}
 
+// same as above, but resolves the callable only on the first call or
+// after the module was reloaded
+int PythonPlugin::call(PythonCallable &cached, const char *module, const char *callable,
+		       bp::object tupleargs, bp::object kwargs, bp::object &retval)
+{
     if (callable == NULL)
 	return PLUGIN_NO_CALLABLE;
 
@@ -93,22 +114,19 @@ int PythonPlugin::call(const char *module, const char *callable,
 	return status;
 
     try {
-	if (module == NULL) {  // default to function in toplevel module
-	    function = main_namespace[callable];
-	} else {
-	    bp::object submod =  main_namespace[module];
-	    bp::object submod_namespace = submod.attr("__dict__");
-	    function = submod_namespace[callable];
+	if (cached.generation != generation) {
+	    resolve(module, callable, cached.function);
+	    cached.generation = generation;
 	}
 	// this wont work with boost-python1.34 - needs 1.40
 	//retval = function(*tupleargs, **kwargs);
 
 	// this does
-	PyObject *rv = PyObject_Call(function.ptr(), tupleargs.ptr(), kwargs.ptr());
+	PyObject *rv = PyObject_Call(cached.function.ptr(), tupleargs.ptr(), kwargs.ptr());
 	if (PyErr_Occurred()) 
 	    bp::throw_error_already_set();
 	if (rv) 
-	    retval = bp::object(bp::borrowed(rv));
+	    retval = bp::object(bp::handle<>(rv));
 	else
 	    retval = bp::object();
 	status = PLUGIN_OK;
@@ -235,6 +253,7 @@ int PythonPlugin::initialize()
 						  main_namespace,
 						  main_namespace);
 	    status = PLUGIN_OK;
+	    generation++;
 	}
 	catch (bp::error_already_set) {
 	    if (PyErr_Occurred()) {
@@ -258,6 +277,7 @@ int PythonPlugin::initialize()
 
 PythonPlugin::PythonPlugin(struct _inittab *inittab) :
     status(0),
+    generation(1),
     module_mtime(0),
     reload_on_change(0),
     ini_filename(0),
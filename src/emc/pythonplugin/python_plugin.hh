@@ -35,6 +35,14 @@ enum pp_status   {
     PLUGIN_EXCEPTION = 2
 };
 
+// a [module.]callable resolved by PythonPlugin::call() and reused on
+// later calls until the toplevel module is (re)initialized
+struct PythonCallable {
+    PythonCallable() : generation(0) {};
+    bp::object function;
+    unsigned generation;          // plugin generation function was resolved in
+};
+
 class PythonPlugin {
 public:
     // factory method
@@ -43,6 +51,8 @@ public:
     bool is_callable(const char *module, const char *funcname);
     int call(const char *module,const char *callable,
 	     bp::object tupleargs, bp::object kwargs, bp::object &retval);
+    int call(PythonCallable &cached, const char *module, const char *callable,
+	     bp::object tupleargs, bp::object kwargs, bp::object &retval);
     int run_string(const char *cmd, bp::object &retval, bool as_file = false);
     int call_method(bp::object method, bp::object &retval);
 
@@ -60,8 +70,10 @@ private:
     ~PythonPlugin() {};
 
     int reload();
+    void resolve(const char *module, const char *callable, bp::object &function);
     std::vector<std::string> inittab_entries;
     int status;
+    unsigned generation;                  // bumped by initialize(), invalidates PythonCallables
     time_t module_mtime;                  // toplevel module - last modification time
     bool reload_on_change;                // auto-reload if toplevel module was changed
     const char *ini_filename;
@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <sys/time.h>
 
 #define CHK(bad, fmt, ...)					       \
     do {							       \
@@ -59,6 +60,49 @@ void run(PythonPlugin *pp,const char *cmd, bool as_file)
     analyze(cmd,r);
 }
 
+static double now()
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// report per-call overhead of the ways the interpreter calls handlers
+void benchmark(PythonPlugin *pp, const char *mod, const char *func, int count)
+{
+    bp::object r;
+    PythonCallable cached;
+    bp::tuple args;
+    bp::dict kwargs;
+    double start;
+    int i;
+
+    if (!pp->is_callable(mod, func)) {
+	printf("benchmark: %s%s%s not callable\n", mod ? mod : "", mod ? "." : "", func);
+	return;
+    }
+
+    start = now();
+    for (i = 0; i < count; i++) {
+	bp::list plist;
+	pp->call(mod, func, bp::tuple(plist), bp::dict(), r);
+    }
+    printf("benchmark: by name, new args:      %8.3f usec/call\n",
+	   (now() - start) * 1e6 / count);
+
+    start = now();
+    for (i = 0; i < count; i++)
+	pp->call(mod, func, args, kwargs, r);
+    printf("benchmark: by name, reused args:   %8.3f usec/call\n",
+	   (now() - start) * 1e6 / count);
+
+    start = now();
+    for (i = 0; i < count; i++)
+	pp->call(cached, mod, func, args, kwargs, r);
+    printf("benchmark: cached, reused args:    %8.3f usec/call\n",
+	   (now() - start) * 1e6 / count);
+}
+
 void foo_init()
 {
     printf("foo init\n");
@@ -78,6 +122,7 @@ struct _inittab builtin_modules[] = {
 };
 
 int builtins;
+int benchcount;
 bool as_file = false;
 int
 main (int argc, char **argv)
@@ -93,8 +138,11 @@ main (int argc, char **argv)
 
     opterr = 0;
 
-    while ((c = getopt (argc, argv, "fbi:C:c:x:")) != -1) {
+    while ((c = getopt (argc, argv, "fbi:C:c:x:B:")) != -1) {
 	switch (c)  {
+	case 'B':
+	    benchcount = atoi(optarg);
+	    break;
 	case 'f':
 	    as_file = true;
 	    break;
@@ -161,5 +209,8 @@ main (int argc, char **argv)
     for (index = optind; index < argc; index++) {
 	run(python_plugin, argv[index], as_file);
     }
+    if (benchcount > 0)
+	benchmark(python_plugin, callablemod,
+		  callablefunc ? callablefunc : "func", benchcount);
     return 0;
 }
@@ -155,6 +155,7 @@ BOOST_PYTHON_MODULE(emccanon) {
     def("PROGRAM_END",&PROGRAM_END);
     def("PROGRAM_STOP",&PROGRAM_STOP);
     def("RIGID_TAP",&RIGID_TAP);
+    def("DRILL_CYCLE",&DRILL_CYCLE);
     def("SELECT_PLANE",&SELECT_PLANE);
     def("SELECT_POCKET",&SELECT_POCKET);
     def("SET_AUX_OUTPUT_BIT",&SET_AUX_OUTPUT_BIT);
@@ -141,6 +141,7 @@ static PyObject *callback;
 static int interp_error;
 static int last_sequence_number;
 static bool metric;
+static double motion_tolerance;
 static double _pos_x, _pos_y, _pos_z, _pos_a, _pos_b, _pos_c, _pos_u, _pos_v, _pos_w;
 EmcPose tool_offset;
 
@@ -169,22 +170,21 @@ static void maybe_new_line(int sequence_number) {
     Py_XDECREF(result);
 }
 
+static void nurbs_arc(int line_number, double x, double y, double cx, double cy, int rotation) {
+    if(rotation) {
+        ARC_FEED(line_number, x, y, cx, cy, rotation,
+                 _pos_z, _pos_a, _pos_b, _pos_c, _pos_u, _pos_v, _pos_w);
+        _pos_x = x; _pos_y = y;
+    } else {
+        STRAIGHT_FEED(line_number, x, y, _pos_z, _pos_a, _pos_b, _pos_c, _pos_u, _pos_v, _pos_w);
+    }
+}
+
+// the same arcs motion makes of the curve, see NURBS_FEED in emccanon.cc
 void NURBS_FEED(int line_number, std::vector<CONTROL_POINT> nurbs_control_points, unsigned int k) {
-    double u = 0.0;
-    unsigned int n = nurbs_control_points.size() - 1;
-    double umax = n - k + 2;
-    unsigned int div = nurbs_control_points.size()*15;
-    std::vector<unsigned int> knot_vector = knot_vector_creator(n, k);	
-    PLANE_POINT P1;
-    while (u+umax/div < umax) {
-        PLANE_POINT P1 = nurbs_point(u+umax/div,k,nurbs_control_points,knot_vector);
-        STRAIGHT_FEED(line_number, P1.X,P1.Y, _pos_z, _pos_a, _pos_b, _pos_c, _pos_u, _pos_v, _pos_w);
-        u = u + umax/div;
-    } 
-    P1.X = nurbs_control_points[n].X;
-    P1.Y = nurbs_control_points[n].Y;
-    STRAIGHT_FEED(line_number, P1.X,P1.Y, _pos_z, _pos_a, _pos_b, _pos_c, _pos_u, _pos_v, _pos_w);
-    knot_vector.clear();
+    double tolerance = motion_tolerance > 0 ? motion_tolerance :
+        metric ? NURBS_DEFAULT_TOLERANCE : NURBS_DEFAULT_TOLERANCE / 25.4;
+    nurbs_biarcs(line_number, nurbs_control_points, k, tolerance, nurbs_arc);
 }
 
 void ARC_FEED(int line_number,
@@ -495,6 +495,54 @@ void RIGID_TAP(int line_number,
     if(result == NULL) interp_error ++;
     Py_XDECREF(result);
 }
+
+// the preview shows a drill cycle as the moves it is made of
+void DRILL_CYCLE(int line_number, CANON_PLANE plane,
+                 double r, double clear, double bottom,
+                 double peck, double backoff, int mode, double dwell) {
+    DRILL_CYCLE_PARAMS params;
+    DRILL_CYCLE_STATE state;
+    DRILL_CYCLE_STEP step;
+    double pos[9] = {_pos_x, _pos_y, _pos_z, _pos_a, _pos_b, _pos_c,
+                     _pos_u, _pos_v, _pos_w};
+    int axis;
+
+    if(plane == CANON_PLANE_XY) axis = 2;
+    else if(plane == CANON_PLANE_YZ) axis = 0;
+    else if(plane == CANON_PLANE_XZ) axis = 1;
+    else if(plane == CANON_PLANE_UV) axis = 8;
+    else if(plane == CANON_PLANE_VW) axis = 6;
+    else axis = 7;
+
+    params.start = pos[axis];
+    params.r = r;
+    params.bottom = bottom;
+    params.clear = clear;
+    params.peck = peck;
+    params.backoff = backoff;
+    params.dwell = dwell;
+    params.mode = mode;
+
+    drillCycleInit(&params, &state);
+    while(drillCycleStep(&params, &state, &step)) {
+        if(interp_error) return;
+        if(step.kind == DRILL_STEP_DWELL) {
+            DWELL(step.seconds);
+            continue;
+        }
+        // the preview has no spindle
+        if(step.kind == DRILL_STEP_SPINDLE_STOP ||
+           step.kind == DRILL_STEP_SPINDLE_START)
+            continue;
+        pos[axis] = step.to;
+        if(step.kind == DRILL_STEP_FEED)
+            STRAIGHT_FEED(line_number, pos[0], pos[1], pos[2], pos[3],
+                          pos[4], pos[5], pos[6], pos[7], pos[8]);
+        else
+            STRAIGHT_TRAVERSE(line_number, pos[0], pos[1], pos[2], pos[3],
+                              pos[4], pos[5], pos[6], pos[7], pos[8]);
+    }
+}
 double GET_EXTERNAL_MOTION_CONTROL_TOLERANCE() { return 0.1; }
 double GET_EXTERNAL_PROBE_POSITION_X() { return _pos_x; }
 double GET_EXTERNAL_PROBE_POSITION_Y() { return _pos_y; }
@@ -674,8 +722,8 @@ static bool check_abort() {
 USER_DEFINED_FUNCTION_TYPE USER_DEFINED_FUNCTION[USER_DEFINED_FUNCTION_NUM];
 
 CANON_MOTION_MODE motion_mode;
-void SET_MOTION_CONTROL_MODE(CANON_MOTION_MODE mode, double tolerance) { motion_mode = mode; }
-void SET_MOTION_CONTROL_MODE(double tolerance) { }
+void SET_MOTION_CONTROL_MODE(CANON_MOTION_MODE mode, double tolerance) { motion_mode = mode; motion_tolerance = tolerance; }
+void SET_MOTION_CONTROL_MODE(double tolerance) { motion_tolerance = tolerance; }
 void SET_MOTION_CONTROL_MODE(CANON_MOTION_MODE mode) { motion_mode = mode; }
 CANON_MOTION_MODE GET_EXTERNAL_MOTION_CONTROL_MODE() { return motion_mode; }
 void SET_NAIVECAM_TOLERANCE(double tolerance) { }
@@ -705,6 +753,7 @@ static PyObject *parse_file(PyObject *self, PyObject *args) {
     gettimeofday(&t0, NULL);
 
     metric=false;
+    motion_tolerance = 0;
     interp_error = 0;
     last_sequence_number = -1;
 
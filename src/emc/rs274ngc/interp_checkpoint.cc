@@ -0,0 +1,411 @@
+/********************************************************************
+* Description: interp_checkpoint.cc
+*
+* run-from-line checkpoints
+*
+* Running a program from line N means reading and executing every line
+* before N with the results thrown away, which takes minutes on long
+* programs. While a file is read at the top level, the interpreter saves
+* a compact copy of its model every [RS274NGC]CHECKPOINT_INTERVAL lines:
+* the fields of _setup that lines change, the tool table, the numbered
+* parameters that are not zero, the global named parameters, the o-word
+* labels seen so far and the offset of the next line. The first one is
+* taken before the first line, so it is the model the program was
+* started with. restore_checkpoint() puts the last checkpoint taken
+* before line N back, seeks the file to it and hands the model to canon
+* like init() does, so only the lines after it have to be read again.
+*
+* A checkpoint is only taken where the model is complete: at call level
+* zero, outside of sub definitions and skipped blocks, with nothing in
+* the cutter compensation queue and no Python handler pending. As remap
+* handlers may keep state in Python, no checkpoints are taken while
+* remaps are configured.
+*
+* A run from line N so continues the program as it was read from the
+* model of the first checkpoint, whatever the program itself left behind
+* when it was stopped, at its end or part way through: the modes, the
+* parameters and the tool table all come from the checkpoint. What the
+* operator sets up must not be lost that way, so the checkpoints are
+* only restored if the program file, the parameters and the tool table
+* are still the way the program left them when it was closed; see
+* leave_checkpoints(). A program read from the start again keeps the
+* checkpoints if it starts from the same model as the first one, and
+* takes new ones otherwise. Lines only ever advance the high water mark,
+* so a checkpoint always is the first time a loop body reached its line.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <boost/python.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "interp_internal.hh"
+#include "interp_queue.hh"
+#include "rs274ngc_interp.hh"
+
+// the parts of _setup which lines of a program change and which can be
+// copied as they are: the position, which follows the machine, and the
+// rest of the model
+#define CHECKPOINT_POSITION_FIELDS(X) \
+    X(AA_current) X(BB_current) X(CC_current) \
+    X(u_current) X(v_current) X(w_current) \
+    X(current_x) X(current_y) X(current_z) \
+    X(program_x) X(program_y) X(program_z)
+
+#define CHECKPOINT_MODEL_FIELDS(X) \
+    X(AA_axis_offset) X(AA_origin_offset) \
+    X(BB_axis_offset) X(BB_origin_offset) \
+    X(CC_axis_offset) X(CC_origin_offset) \
+    X(u_axis_offset) X(u_origin_offset) \
+    X(v_axis_offset) X(v_origin_offset) \
+    X(w_axis_offset) X(w_origin_offset) \
+    X(arc_not_allowed) \
+    X(axis_offset_x) X(axis_offset_y) X(axis_offset_z) \
+    X(control_mode) X(current_pocket) \
+    X(cutter_comp_radius) X(cutter_comp_orientation) X(cutter_comp_side) \
+    X(cycle_cc) X(cycle_i) X(cycle_j) X(cycle_k) X(cycle_l) \
+    X(cycle_p) X(cycle_q) X(cycle_r) X(cycle_il) X(cycle_il_flag) \
+    X(distance_mode) X(ijk_distance_mode) \
+    X(feed_mode) X(feed_override) X(feed_rate) \
+    X(flood) X(length_units) X(mist) X(motion_mode) \
+    X(origin_index) X(origin_offset_x) X(origin_offset_y) X(origin_offset_z) \
+    X(rotation_xy) X(plane) X(cutter_comp_firstmove) \
+    X(retract_mode) X(selected_pocket) X(selected_tool) \
+    X(speed) X(spindle_mode) X(speed_feed_mode) X(speed_override) \
+    X(spindle_turning) X(tool_offset) X(traverse_rate) \
+    X(return_value) X(value_returned) \
+    X(adaptive_feed) X(feed_hold) X(lathe_diameter_mode) \
+    X(tolerance) X(naivecam_tolerance) X(css_maximum) \
+    X(sub_context[0].context_status) X(sub_context[0].saved_g_codes) \
+    X(sub_context[0].saved_m_codes) X(sub_context[0].saved_settings)
+
+#define CHECKPOINT_FIELDS(X) \
+    CHECKPOINT_POSITION_FIELDS(X) CHECKPOINT_MODEL_FIELDS(X)
+
+#define PACK_FIELD(f) \
+    cp.state.append((const char *) &_setup.f, sizeof(_setup.f));
+#define UNPACK_FIELD(f) \
+    memcpy(&_setup.f, p, sizeof(_setup.f)); p += sizeof(_setup.f);
+#define HASH_FIELD(f) \
+    fnv1a(&hash, &_setup.f, sizeof(_setup.f));
+
+static void fnv1a(unsigned long long *hash, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *) data;
+
+    while (len--) {
+	*hash ^= *p++;
+	*hash *= 1099511628211ULL;
+    }
+}
+
+static bool checkpoint_after(int line, const checkpoint &cp)
+{
+    return line < cp.sequence_number;
+}
+
+/****************************************************************************/
+
+/*! Interp::checkpoint_fingerprint
+
+Returned Value: a hash of the open program file and of everything a
+checkpoint puts back: the numbered parameters, the global named
+parameters, the tool table and, if modes is true, the modal state and
+the other fields in CHECKPOINT_MODEL_FIELDS. The position and the
+parameters that report probe results and the position (5061 to 5070,
+5420 to 5428) are left out, as they follow the machine; pocket 0 is
+left out for the same reason.
+
+Without the modes it leaves out what synch() reads back from canon,
+which need not come back exactly the way the interpreter sent it.
+
+*/
+
+unsigned long long Interp::checkpoint_fingerprint(bool modes)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    unsigned long long globals_hash = 0;
+    struct stat st;
+    int pocket, n;
+
+    fnv1a(&hash, _setup.filename, strlen(_setup.filename));
+    if (_setup.file_pointer && fstat(fileno(_setup.file_pointer), &st) == 0) {
+	fnv1a(&hash, &st.st_size, sizeof(st.st_size));
+	fnv1a(&hash, &st.st_mtime, sizeof(st.st_mtime));
+    }
+    if (modes) {
+	CHECKPOINT_MODEL_FIELDS(HASH_FIELD)
+    }
+    for (n = 0; n < RS274NGC_MAX_PARAMETERS; n++) {
+	if ((n >= 5061 && n <= 5070) || (n >= 5420 && n <= 5428))
+	    continue;
+	fnv1a(&hash, &_setup.parameters[n], sizeof(double));
+    }
+    // the order of the table depends on its history, so the entries
+    // are added up rather than chained
+    parameter_table &globals = _setup.sub_context[0].named_params;
+    for (parameter_table::iterator it = globals.begin(); it != globals.end(); ++it) {
+	unsigned long long entry = 14695981039346656037ULL;
+	if (it->value.attr & PA_USE_LOOKUP)
+	    continue;
+	fnv1a(&entry, &it->symbol->hash, sizeof(it->symbol->hash));
+	fnv1a(&entry, it->symbol->name, strlen(it->symbol->name));
+	fnv1a(&entry, &it->value.value, sizeof(it->value.value));
+	globals_hash += entry;
+    }
+    fnv1a(&hash, &globals_hash, sizeof(globals_hash));
+    fnv1a(&hash, &_setup.pockets_max, sizeof(_setup.pockets_max));
+    for (pocket = 1; pocket < _setup.pockets_max; pocket++) {
+	// field by field, the struct has padding
+	CANON_TOOL_TABLE *tool = &_setup.tool_table[pocket];
+	fnv1a(&hash, &tool->toolno, sizeof(tool->toolno));
+	fnv1a(&hash, &tool->offset, sizeof(tool->offset));
+	fnv1a(&hash, &tool->diameter, sizeof(tool->diameter));
+	fnv1a(&hash, &tool->frontangle, sizeof(tool->frontangle));
+	fnv1a(&hash, &tool->backangle, sizeof(tool->backangle));
+	fnv1a(&hash, &tool->orientation, sizeof(tool->orientation));
+    }
+    return hash;
+}
+
+/****************************************************************************/
+
+/*! Interp::check_checkpoints
+
+Returned Value: int (INTERP_OK)
+
+Side effects:
+   The first time after open() the checkpoints are dropped if the
+   program starts from another model than the first of them was taken
+   with, and the line for the next one is set.
+
+Called by: Interp::take_checkpoint, Interp::restore_checkpoint
+
+*/
+
+int Interp::check_checkpoints()
+{
+    unsigned long long inputs;
+
+    if (_setup.checkpoint_checked)
+	return INTERP_OK;
+    _setup.checkpoint_checked = true;
+    _setup.checkpoint_left = false;
+
+    inputs = checkpoint_fingerprint(true);
+    if (inputs != _setup.checkpoint_inputs || _setup.checkpoints.empty()) {
+	_setup.checkpoints.clear();
+	_setup.checkpoint_inputs = inputs;
+	_setup.checkpoint_spacing = _setup.checkpoint_interval;
+	// the first one is taken before the first line
+	_setup.checkpoint_next = _setup.sequence_number;
+    } else {
+	_setup.checkpoint_next = _setup.checkpoints.back().sequence_number +
+	    _setup.checkpoint_spacing;
+    }
+    return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! Interp::take_checkpoint
+
+Returned Value: int (INTERP_OK)
+
+Side effects:
+   A checkpoint of the model is added to _setup.checkpoints if the
+   program has got past the line for the next one and the model can be
+   restored from a copy at this point.
+
+Called by: Interp::_read, before a line is read from the file
+
+*/
+
+int Interp::take_checkpoint()
+{
+    size_t n;
+
+    if (_setup.checkpoint_interval <= 0 || !_setup.file_pointer)
+	return INTERP_OK;
+    CHP(check_checkpoints());
+
+    if (_setup.sequence_number < _setup.checkpoint_next ||
+	_setup.call_level != 0 || _setup.remap_level != 0 ||
+	_setup.defining_sub || _setup.skipping_o || _setup.skipping_to_sub ||
+	_setup.call_state != CS_NORMAL || !qc().empty() ||
+	!_setup.remaps.empty())
+	return INTERP_OK;
+
+    if (_setup.checkpoints.size() >= CHECKPOINT_MAX) {
+	// keeping the first one, the model the program started with
+	for (n = 0; 2 * n < _setup.checkpoints.size(); n++)
+	    std::swap(_setup.checkpoints[n], _setup.checkpoints[2 * n]);
+	_setup.checkpoints.resize(n);
+	_setup.checkpoint_spacing *= 2;
+    }
+
+    _setup.checkpoints.push_back(checkpoint());
+    checkpoint &cp = _setup.checkpoints.back();
+
+    cp.sequence_number = _setup.sequence_number;
+    cp.position = ftell(_setup.file_pointer);
+    CHECKPOINT_FIELDS(PACK_FIELD)
+    cp.tool_table.assign(_setup.tool_table,
+			 _setup.tool_table + _setup.pockets_max);
+    for (n = 0; n < RS274NGC_MAX_PARAMETERS; n++) {
+	if (_setup.parameters[n] != 0.0)
+	    cp.parameters.push_back(numbered_value(n, _setup.parameters[n]));
+    }
+    parameter_table &globals = _setup.sub_context[0].named_params;
+    cp.globals.reserve(globals.size());
+    for (parameter_table::iterator it = globals.begin(); it != globals.end(); ++it)
+	cp.globals.push_back(named_value(it->symbol, it->value));
+    cp.offset_map = _setup.offset_map;
+
+    _setup.checkpoint_next = cp.sequence_number + _setup.checkpoint_spacing;
+    return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! Interp::leave_checkpoints
+
+Returned Value: int (INTERP_OK)
+
+Side effects:
+   If the open program has been read, what it leaves in the parameters
+   and the tool table is noted, so that restore_checkpoint() can tell
+   whether anything else changed them afterwards.
+
+Called by: Interp::close, also when it only closes lazily
+
+*/
+
+int Interp::leave_checkpoints()
+{
+    if (_setup.checkpoint_checked && !_setup.checkpoint_left &&
+	_setup.file_pointer) {
+	_setup.checkpoint_setup = checkpoint_fingerprint(false);
+	_setup.checkpoint_left = true;
+    }
+    return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! Interp::restore_checkpoint
+
+Returned Value: int
+   The number of lines skipped, 0 if there is no checkpoint to resume
+   from, or -1 if no file is open.
+
+Side effects:
+   The model is set to the last checkpoint taken before line was read,
+   the file is positioned at the line after it, and the settings canon
+   keeps are sent to canon. Reading goes on from there. That may be the
+   checkpoint taken before the first line, which skips nothing but
+   still puts back the model the program was started with.
+
+   Nothing is restored if the program file, the parameters or the
+   tool table changed since the program was last closed; the
+   checkpoints are then dropped, unless the program starts from the
+   same model as they did.
+
+Called by: external programs, before the first read() after open()
+
+Nothing is restored once a line of the file has been read.
+
+*/
+
+int Interp::restore_checkpoint(int line)
+{
+    checkpoint_list::iterator it;
+    const char *p;
+    size_t n;
+
+    if (!_setup.file_pointer)
+	return -1;
+    if (_setup.checkpoint_interval <= 0 || _setup.checkpoint_checked)
+	return 0;
+
+    it = std::upper_bound(_setup.checkpoints.begin(), _setup.checkpoints.end(),
+			  line - 1, checkpoint_after);
+    if (it == _setup.checkpoints.begin() || !_setup.checkpoint_left ||
+	checkpoint_fingerprint(false) != _setup.checkpoint_setup) {
+	check_checkpoints();
+	return 0;
+    }
+    const checkpoint &cp = *--it;
+    if (fseek(_setup.file_pointer, cp.position, SEEK_SET) != 0) {
+	check_checkpoints();
+	return 0;
+    }
+    _setup.checkpoint_checked = true;
+    _setup.checkpoint_left = false;
+    _setup.checkpoint_next = _setup.checkpoints.back().sequence_number +
+	_setup.checkpoint_spacing;
+
+    _setup.sequence_number = cp.sequence_number;
+    p = cp.state.data();
+    CHECKPOINT_FIELDS(UNPACK_FIELD)
+    std::copy(cp.tool_table.begin(), cp.tool_table.end(), _setup.tool_table);
+    std::fill(_setup.parameters, _setup.parameters + RS274NGC_MAX_PARAMETERS, 0.0);
+    for (n = 0; n < cp.parameters.size(); n++)
+	_setup.parameters[cp.parameters[n].first] = cp.parameters[n].second;
+    parameter_table &globals = _setup.sub_context[0].named_params;
+    globals.clear();
+    for (n = 0; n < cp.globals.size(); n++)
+	globals[cp.globals[n].first] = cp.globals[n].second;
+    _setup.offset_map = cp.offset_map;
+
+    write_g_codes((block_pointer) NULL, &_setup);
+    write_m_codes((block_pointer) NULL, &_setup);
+    write_settings(&_setup);
+
+    // the lines in between would have told canon about these
+    USE_LENGTH_UNITS(_setup.length_units);
+    SET_G5X_OFFSET(_setup.origin_index,
+		   _setup.origin_offset_x,
+		   _setup.origin_offset_y,
+		   _setup.origin_offset_z,
+		   _setup.AA_origin_offset,
+		   _setup.BB_origin_offset,
+		   _setup.CC_origin_offset,
+		   _setup.u_origin_offset,
+		   _setup.v_origin_offset,
+		   _setup.w_origin_offset);
+    SET_G92_OFFSET(_setup.axis_offset_x,
+		   _setup.axis_offset_y,
+		   _setup.axis_offset_z,
+		   _setup.AA_axis_offset,
+		   _setup.BB_axis_offset,
+		   _setup.CC_axis_offset,
+		   _setup.u_axis_offset,
+		   _setup.v_axis_offset,
+		   _setup.w_axis_offset);
+    SET_XY_ROTATION(_setup.rotation_xy);
+    SELECT_PLANE(_setup.plane);
+    SET_FEED_MODE(_setup.feed_mode == UNITS_PER_REVOLUTION);
+    if (_setup.feed_mode != INVERSE_TIME)
+	SET_FEED_RATE(_setup.feed_rate);
+    SET_SPINDLE_MODE(_setup.spindle_mode == CONSTANT_SURFACE ?
+		     _setup.css_maximum : 0);
+    SET_SPINDLE_SPEED(_setup.speed);
+    USE_TOOL_LENGTH_OFFSET(_setup.tool_offset);
+    if (_setup.tolerance >= 0)
+	SET_MOTION_CONTROL_MODE(_setup.control_mode, _setup.tolerance);
+    if (_setup.naivecam_tolerance >= 0)
+	SET_NAIVECAM_TOLERANCE(_setup.naivecam_tolerance);
+
+    return cp.sequence_number;
+}
@@ -1494,21 +1494,28 @@ int Interp::convert_control_mode(int g_code,     //!< g_code being executed (G_6
   if (g_code == G_61) {
     SET_MOTION_CONTROL_MODE(CANON_EXACT_PATH, 0);
     settings->control_mode = CANON_EXACT_PATH;
+    settings->tolerance = 0;
   } else if (g_code == G_61_1) {
     SET_MOTION_CONTROL_MODE(CANON_EXACT_STOP, 0);
     settings->control_mode = CANON_EXACT_STOP;
+    settings->tolerance = 0;
   } else if (g_code == G_64) {
 	if (tolerance >= 0) {
 	    SET_MOTION_CONTROL_MODE(CANON_CONTINUOUS, tolerance);
+	    settings->tolerance = tolerance;
 	} else {
 	    SET_MOTION_CONTROL_MODE(CANON_CONTINUOUS, 0);
+	    settings->tolerance = 0;
 	}
 	if (naivecam_tolerance >= 0) {
 	    SET_NAIVECAM_TOLERANCE(naivecam_tolerance);
+	    settings->naivecam_tolerance = naivecam_tolerance;
 	} else if (tolerance >= 0) {
 	    SET_NAIVECAM_TOLERANCE(tolerance);   // if no naivecam_tolerance specified use same for both
+	    settings->naivecam_tolerance = tolerance;
 	} else {
 	    SET_NAIVECAM_TOLERANCE(0);
+	    settings->naivecam_tolerance = 0;
 	}
     settings->control_mode = CANON_CONTINUOUS;
   } else 
@@ -3984,9 +3991,10 @@ int Interp::convert_spindle_mode(block_pointer block, setup_pointer settings)
     } else { /* G_96 */
         settings->spindle_mode = CONSTANT_SURFACE;
 	if(block->d_flag)
-	    enqueue_SET_SPINDLE_MODE(fabs(block->d_number_float));
+	    settings->css_maximum = fabs(block->d_number_float);
 	else
-	    enqueue_SET_SPINDLE_MODE(1e30);
+	    settings->css_maximum = 1e30;
+	enqueue_SET_SPINDLE_MODE(settings->css_maximum);
     }
     return INTERP_OK;
 }
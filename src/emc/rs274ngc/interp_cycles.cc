@@ -54,13 +54,11 @@ int Interp::convert_cycle_g81(block_pointer block,
                               CANON_PLANE plane, //!< selected plane                  
                               double x,  //!< x-value where cycle is executed 
                               double y,  //!< y-value where cycle is executed 
+                              double r,  //!< initial z-value                 
                               double clear_z,    //!< z-value of clearance plane      
                               double bottom_z)   //!< value of z at bottom of cycle   
 {
-    cycle_feed(block, plane, x, y, bottom_z);
-    cycle_traverse(block, plane, x, y, clear_z);
-
-  return INTERP_OK;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, 0.0, 0, 0.0);
 }
 
 /****************************************************************************/
@@ -92,15 +90,12 @@ int Interp::convert_cycle_g82(block_pointer block,
                               CANON_PLANE plane, //!< selected plane                  
                               double x,  //!< x-value where cycle is executed 
                               double y,  //!< y-value where cycle is executed 
+                              double r,  //!< initial z-value                 
                               double clear_z,    //!< z-value of clearance plane      
                               double bottom_z,   //!< value of z at bottom of cycle   
                               double dwell)      //!< dwell time                      
 {
-  cycle_feed(block, plane, x, y, bottom_z);
-  DWELL(dwell);
-  cycle_traverse(block, plane, x, y, clear_z);
-
-  return INTERP_OK;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, 0.0, DRILL_DWELL, dwell);
 }
 
 /****************************************************************************/
@@ -144,28 +139,13 @@ int Interp::convert_cycle_g83(block_pointer block,
                               double bottom_z,   //!< value of z at bottom of cycle   
                               double delta)      //!< size of z-axis feed increment   
 {
-  double current_depth;
-  double rapid_delta;
-
   /* Moved the check for negative Q values here as a sign
      may be used with user defined M functions
      Thanks to Billy Singleton for pointing it out... */
   CHKS((delta <= 0.0), NCE_NEGATIVE_OR_ZERO_Q_VALUE_USED);
 
-  rapid_delta = G83_RAPID_DELTA;
-  if (_setup.length_units == CANON_UNITS_MM)
-    rapid_delta = (rapid_delta * 25.4);
-
-  for (current_depth = (r - delta);
-       current_depth > bottom_z; current_depth = (current_depth - delta)) {
-    cycle_feed(block, plane, x, y, current_depth);
-    cycle_traverse(block, plane, x, y, r);
-    cycle_traverse(block, plane, x, y, current_depth + rapid_delta);
-  }
-  cycle_feed(block, plane, x, y, bottom_z);
-  cycle_traverse(block, plane, x, y, clear_z);
-
-  return INTERP_OK;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, delta,
+                     DRILL_FULL_RETRACT, 0.0);
 }
 
 /****************************************************************************/
@@ -208,27 +188,12 @@ int Interp::convert_cycle_g73(block_pointer block,
                               double bottom_z,   //!< value of z at bottom of cycle   
                               double delta)      //!< size of z-axis feed increment   
 {
-  double current_depth;
-  double rapid_delta;
-
   /* Moved the check for negative Q values here as a sign
      may be used with user defined M functions
      Thanks to Billy Singleton for pointing it out... */
   CHKS((delta <= 0.0), NCE_NEGATIVE_OR_ZERO_Q_VALUE_USED);
 
-  rapid_delta = G83_RAPID_DELTA;
-  if (_setup.length_units == CANON_UNITS_MM)
-    rapid_delta = (rapid_delta * 25.4);
-
-  for (current_depth = (r - delta);
-       current_depth > bottom_z; current_depth = (current_depth - delta)) {
-    cycle_feed(block, plane, x, y, current_depth);
-    cycle_traverse(block, plane, x, y, current_depth + rapid_delta);
-  }
-  cycle_feed(block, plane, x, y, bottom_z);
-  cycle_traverse(block, plane, x, y, clear_z);
-
-  return INTERP_OK;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, delta, 0, 0.0);
 }
 
 /****************************************************************************/
@@ -320,13 +285,12 @@ int Interp::convert_cycle_g85(block_pointer block,
                               CANON_PLANE plane, //!< selected plane                  
                               double x,  //!< x-value where cycle is executed 
                               double y,  //!< y-value where cycle is executed 
+                              double r,  //!< initial z-value                 
                               double clear_z,    //!< z-value of clearance plane      
                               double bottom_z)   //!< value of z at bottom of cycle   
 {
-  cycle_feed(block, plane, x, y, bottom_z);
-  cycle_feed(block, plane, x, y, clear_z);
-
-  return INTERP_OK;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, 0.0,
+                     DRILL_FEED_RETRACT, 0.0);
 }
 
 /****************************************************************************/
@@ -364,25 +328,22 @@ int Interp::convert_cycle_g86(block_pointer block,
                               CANON_PLANE plane, //!< selected plane                     
                               double x,  //!< x-value where cycle is executed    
                               double y,  //!< y-value where cycle is executed    
+                              double r,  //!< initial z-value                    
                               double clear_z,    //!< z-value of clearance plane         
                               double bottom_z,   //!< value of z at bottom of cycle      
                               double dwell,      //!< dwell time                         
                               CANON_DIRECTION direction) //!< direction spindle turning at outset
 {
+  int mode;
+
   CHKS(((direction != CANON_CLOCKWISE) &&
        (direction != CANON_COUNTERCLOCKWISE)),
       NCE_SPINDLE_NOT_TURNING_IN_G86);
 
-  cycle_feed(block, plane, x, y, bottom_z);
-  DWELL(dwell);
-  STOP_SPINDLE_TURNING();
-  cycle_traverse(block, plane, x, y, clear_z);
-  if (direction == CANON_CLOCKWISE)
-    START_SPINDLE_CLOCKWISE();
-  else
-    START_SPINDLE_COUNTERCLOCKWISE();
-
-  return INTERP_OK;
+  mode = DRILL_DWELL | DRILL_SPINDLE_STOP;
+  if (direction == CANON_COUNTERCLOCKWISE)
+    mode |= DRILL_SPINDLE_CCW;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, 0.0, mode, dwell);
 }
 
 /****************************************************************************/
@@ -566,15 +527,13 @@ int Interp::convert_cycle_g89(block_pointer block,
                               CANON_PLANE plane, //!< selected plane                  
                               double x,  //!< x-value where cycle is executed 
                               double y,  //!< y-value where cycle is executed 
+                              double r,  //!< initial z-value                 
                               double clear_z,    //!< z-value of clearance plane      
                               double bottom_z,   //!< value of z at bottom of cycle   
                               double dwell)      //!< dwell time                      
 {
-  cycle_feed(block, plane, x, y, bottom_z);
-  DWELL(dwell);
-  cycle_feed(block, plane, x, y, clear_z);
-
-  return INTERP_OK;
+  return cycle_drill(block, plane, r, clear_z, bottom_z, 0.0,
+                     DRILL_DWELL | DRILL_FEED_RETRACT, dwell);
 }
 
 static const char* plane_name(CANON_PLANE p) {
@@ -875,14 +834,14 @@ int Interp::convert_cycle_xy(int motion, //!< a g-code between G_81 and G_89, a
 
   switch (motion) {
   case G_81:
-      CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_XY, aa, bb, clear_cc, cc))
+      CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_XY, aa, bb, r, clear_cc, cc))
       break;
   case G_82:
     CHKS(((settings->motion_mode != G_82) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G82);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_XY, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_XY, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -909,14 +868,14 @@ int Interp::convert_cycle_xy(int motion, //!< a g-code between G_81 and G_89, a
                                   settings->spindle_turning,
                                   settings->speed_feed_mode)) break;
   case G_85:
-      CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_XY, aa, bb, clear_cc, cc))
+      CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_XY, aa, bb, r, clear_cc, cc))
       break;
   case G_86:
     CHKS(((settings->motion_mode != G_86) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G86);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_XY, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_XY, aa, bb, r, clear_cc, cc,
                                   block->p_number,
                                   settings->spindle_turning)) settings->
       cycle_p = block->p_number;
@@ -955,7 +914,7 @@ int Interp::convert_cycle_xy(int motion, //!< a g-code between G_81 and G_89, a
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G89);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_XY, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_XY, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1045,14 +1004,14 @@ int Interp::convert_cycle_uv(int motion, //!< a g-code between G_81 and G_89, a
 
   switch (motion) {
   case G_81:
-      CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_UV, aa, bb, clear_cc, cc))
+      CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_UV, aa, bb, r, clear_cc, cc))
       break;
   case G_82:
     CHKS(((settings->motion_mode != G_82) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G82);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_UV, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_UV, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1079,14 +1038,14 @@ int Interp::convert_cycle_uv(int motion, //!< a g-code between G_81 and G_89, a
                                   settings->spindle_turning,
                                   settings->speed_feed_mode)) break;
   case G_85:
-    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_UV, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_UV, aa, bb, r, clear_cc, cc))
       break;
   case G_86:
     CHKS(((settings->motion_mode != G_86) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G86);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_UV, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_UV, aa, bb, r, clear_cc, cc,
                                   block->p_number,
                                   settings->spindle_turning)) settings->
       cycle_p = block->p_number;
@@ -1124,7 +1083,7 @@ int Interp::convert_cycle_uv(int motion, //!< a g-code between G_81 and G_89, a
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G89);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_UV, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_UV, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1261,14 +1220,14 @@ int Interp::convert_cycle_yz(int motion, //!< a g-code between G_81 and G_89, a
 
   switch (motion) {
   case G_81:
-    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_YZ, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_YZ, aa, bb, r, clear_cc, cc))
       break;
   case G_82:
     CHKS(((settings->motion_mode != G_82) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G82);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_YZ, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_YZ, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1295,14 +1254,14 @@ int Interp::convert_cycle_yz(int motion, //!< a g-code between G_81 and G_89, a
                                   settings->spindle_turning,
                                   settings->speed_feed_mode)) break;
   case G_85:
-    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_YZ, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_YZ, aa, bb, r, clear_cc, cc))
       break;
   case G_86:
     CHKS(((settings->motion_mode != G_86) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G86);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_YZ, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_YZ, aa, bb, r, clear_cc, cc,
                                   block->p_number,
                                   settings->spindle_turning)) settings->
       cycle_p = block->p_number;
@@ -1340,7 +1299,7 @@ int Interp::convert_cycle_yz(int motion, //!< a g-code between G_81 and G_89, a
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G89);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_YZ, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_YZ, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1429,14 +1388,14 @@ int Interp::convert_cycle_vw(int motion, //!< a g-code between G_81 and G_89, a
 
   switch (motion) {
   case G_81:
-    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_VW, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_VW, aa, bb, r, clear_cc, cc))
       break;
   case G_82:
     CHKS(((settings->motion_mode != G_82) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G82);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_VW, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_VW, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1463,14 +1422,14 @@ int Interp::convert_cycle_vw(int motion, //!< a g-code between G_81 and G_89, a
                                   settings->spindle_turning,
                                   settings->speed_feed_mode)) break;
   case G_85:
-    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_VW, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_VW, aa, bb, r, clear_cc, cc))
       break;
   case G_86:
     CHKS(((settings->motion_mode != G_86) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G86);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_VW, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_VW, aa, bb, r, clear_cc, cc,
                                   block->p_number,
                                   settings->spindle_turning)) settings->
       cycle_p = block->p_number;
@@ -1508,7 +1467,7 @@ int Interp::convert_cycle_vw(int motion, //!< a g-code between G_81 and G_89, a
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G89);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_VW, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_VW, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1654,14 +1613,14 @@ int Interp::convert_cycle_zx(int motion, //!< a g-code between G_81 and G_89, a
 
   switch (motion) {
   case G_81:
-    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_XZ, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_XZ, aa, bb, r, clear_cc, cc))
       break;
   case G_82:
     CHKS(((settings->motion_mode != G_82) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G82);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_XZ, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_XZ, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1688,14 +1647,14 @@ int Interp::convert_cycle_zx(int motion, //!< a g-code between G_81 and G_89, a
                                   settings->spindle_turning,
                                   settings->speed_feed_mode)) break;
   case G_85:
-    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_XZ, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_XZ, aa, bb, r, clear_cc, cc))
       break;
   case G_86:
     CHKS(((settings->motion_mode != G_86) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G86);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_XZ, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_XZ, aa, bb, r, clear_cc, cc,
                                   block->p_number,
                                   settings->spindle_turning)) settings->
       cycle_p = block->p_number;
@@ -1733,7 +1692,7 @@ int Interp::convert_cycle_zx(int motion, //!< a g-code between G_81 and G_89, a
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G89);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_XZ, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_XZ, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1821,14 +1780,14 @@ int Interp::convert_cycle_wu(int motion, //!< a g-code between G_81 and G_89, a
 
   switch (motion) {
   case G_81:
-    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_UW, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g81(block, CANON_PLANE_UW, aa, bb, r, clear_cc, cc))
       break;
   case G_82:
     CHKS(((settings->motion_mode != G_82) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G82);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_UW, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g82(block, CANON_PLANE_UW, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1855,14 +1814,14 @@ int Interp::convert_cycle_wu(int motion, //!< a g-code between G_81 and G_89, a
                                   settings->spindle_turning,
                                   settings->speed_feed_mode)) break;
   case G_85:
-    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_UW, aa, bb, clear_cc, cc))
+    CYCLE_MACRO(convert_cycle_g85(block, CANON_PLANE_UW, aa, bb, r, clear_cc, cc))
       break;
   case G_86:
     CHKS(((settings->motion_mode != G_86) && (block->p_number == -1.0)),
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G86);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_UW, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g86(block, CANON_PLANE_UW, aa, bb, r, clear_cc, cc,
                                   block->p_number,
                                   settings->spindle_turning)) settings->
       cycle_p = block->p_number;
@@ -1900,7 +1859,7 @@ int Interp::convert_cycle_wu(int motion, //!< a g-code between G_81 and G_89, a
         NCE_DWELL_TIME_P_WORD_MISSING_WITH_G89);
     block->p_number =
       block->p_number == -1.0 ? settings->cycle_p : block->p_number;
-    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_UW, aa, bb, clear_cc, cc,
+    CYCLE_MACRO(convert_cycle_g89(block, CANON_PLANE_UW, aa, bb, r, clear_cc, cc,
                                   block->p_number))
       settings->cycle_p = block->p_number;
     break;
@@ -1919,23 +1878,66 @@ int Interp::convert_cycle_wu(int motion, //!< a g-code between G_81 and G_89, a
 }
 /****************************************************************************/
 
-/*! cycle_feed
+/*! cycle_drill
 
 Returned Value: int (INTERP_OK)
 
 Side effects:
-  STRAIGHT_FEED is called.
+  DRILL_CYCLE is called.
 
 Called by:
+  convert_cycle_g73
   convert_cycle_g81
   convert_cycle_g82
   convert_cycle_g83
-  convert_cycle_g84
   convert_cycle_g85
   convert_cycle_g86
+  convert_cycle_g89
+
+This writes the whole of a drilling cycle at the current position as a
+single DRILL_CYCLE command.  The canonical machining functions expand it
+into the feeds, traverses, dwell and spindle stop and start that these
+cycles used to write one by one; the trajectory planner does so while
+the cycle runs, so a hole with many pecks is one queue entry.
+
+The clearance left above the previous peck is G83_RAPID_DELTA, in the
+current length units.
+
+*/
+
+int Interp::cycle_drill(block_pointer block,
+                        CANON_PLANE plane,       //!< currently selected plane  
+                        double r,        //!< level the pecks start from
+                        double clear,    //!< level of the final retract
+                        double bottom,   //!< level of the bottom of the hole
+                        double delta,    //!< peck depth, 0 for no pecking
+                        int mode,        //!< DRILL_FULL_RETRACT, DRILL_DWELL, ...
+                        double dwell)    //!< dwell time at the bottom
+{
+  double rapid_delta;
+
+  rapid_delta = G83_RAPID_DELTA;
+  if (_setup.length_units == CANON_UNITS_MM)
+    rapid_delta = (rapid_delta * 25.4);
+
+  DRILL_CYCLE(block->line_number, plane, r, clear, bottom, delta,
+              rapid_delta, mode, dwell);
+  return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! cycle_feed
+
+Returned Value: int (INTERP_OK)
+
+Side effects:
+  STRAIGHT_FEED is called.
+
+Called by:
+  convert_cycle_g84
   convert_cycle_g87
   convert_cycle_g88
-  convert_cycle_g89
 
 This writes a STRAIGHT_FEED command appropriate for a cycle move with
 respect to the given plane. No rotary axis motion takes place.
@@ -1986,10 +1988,6 @@ Side effects:
 
 Called by:
   convert_cycle
-  convert_cycle_g81
-  convert_cycle_g82
-  convert_cycle_g83
-  convert_cycle_g86
   convert_cycle_g87
   convert_cycle_xy (via CYCLE_MACRO)
   convert_cycle_yz (via CYCLE_MACRO)
@@ -0,0 +1,289 @@
+/********************************************************************
+* Description: interp_expr.cc
+*
+* compiled expression cache
+*
+* The first time an expression at a given position of a program line
+* is read, the regular reader in interp_read.cc evaluates it while the
+* readers it calls record each value and operation into a postfix
+* program. Later reads of the same line - typically the body of a
+* while or repeat loop - run the program instead of tokenizing the
+* text again.
+*
+* Numbered parameters with a constant number are resolved to their
+* slot when compiling. Named parameters are interned when compiling
+* and looked up in the current frame at run time, since their scope
+* depends on the call level.
+*
+* The program is only used if the line still holds the text it was
+* compiled from, so edited or reopened files can not run stale code.
+* Errors are raised by the same functions with the same messages as
+* the uncompiled path.
+*
+* License: GPL Version 2
+* System: Linux
+*
+********************************************************************/
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <boost/python.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include "rs274ngc.hh"
+#include "rs274ngc_return.hh"
+#include "interp_internal.hh"
+#include "rs274ngc_interp.hh"
+
+/****************************************************************************/
+
+/*! record_expression
+
+Returned Value: none
+
+Side effects:
+   Appends one operation to the expression being compiled, if any.
+
+Called by:
+   read_atan
+   read_named_parameter
+   read_parameter
+   read_real_expression
+   read_real_number
+   read_real_value
+
+A constant parameter number is folded into EXPR_PARAM_INDEX, and the
+finite check after a constant is dropped.
+
+*/
+
+void Interp::record_expression(int opcode, int arg, double value,
+			       const char *name)
+{
+    expr_program *program = _setup.expr_recording;
+    expr_op op;
+
+    if (program == NULL)
+	return;
+
+    if (opcode == EXPR_CHECK && !program->ops.empty() &&
+	program->ops.back().opcode == EXPR_CONST &&
+	!isnan(program->ops.back().value) && !isinf(program->ops.back().value))
+	return;
+
+    if (opcode == EXPR_PARAM && !program->ops.empty() &&
+	program->ops.back().opcode == EXPR_CONST) {
+	double number = program->ops.back().value;
+	if (number == floor(number) &&
+	    number >= 1 && number < RS274NGC_MAX_PARAMETERS) {
+	    program->ops.back().opcode = EXPR_PARAM_INDEX;
+	    program->ops.back().arg = (int) number;
+	    return;
+	}
+    }
+
+    op.opcode = opcode;
+    op.arg = arg;
+    op.value = value;
+    op.name = name ? strstore(name) : NULL;
+    op.symbol = name ? param_symbol_intern(name) : NULL;
+    program->ops.push_back(op);
+
+    switch (opcode) {
+    case EXPR_CONST:
+    case EXPR_PARAM_INDEX:
+    case EXPR_NAMED:
+    case EXPR_NAMED_EXISTS:
+	program->depth++;
+	break;
+    case EXPR_ATAN:
+    case EXPR_BINARY:
+	program->depth--;
+	break;
+    }
+    if (program->depth > program->max_depth)
+	program->max_depth = program->depth;
+}
+
+/****************************************************************************/
+
+/*! execute_expression
+
+Returned Value: int
+   If any of the following functions returns an error code,
+   this returns that code.
+     execute_binary
+     execute_unary
+     find_named_param
+   If any of the following errors occur, this returns the error code shown.
+   Otherwise, it returns INTERP_OK.
+   1. A parameter number is not an integer: NCE_NON_INTEGER_VALUE_FOR_INTEGER
+   2. A parameter number is out of range: NCE_PARAMETER_NUMBER_OUT_OF_RANGE
+   3. A named parameter is not defined.
+   4. A value is not a number or infinite.
+
+Side effects:
+   The value of the expression is put into what value points at.
+
+Called by: read_cached_expression
+
+*/
+
+int Interp::execute_expression(expr_program *program, //!< compiled expression
+			       double *value,         //!< pointer to double to be computed
+			       double *parameters)    //!< array of system parameters
+{
+    double stack[EXPR_MAX_DEPTH];
+    int sp = 0;
+    int index;
+    int exists;
+    double number;
+    std::vector<expr_op>::const_iterator op;
+
+    for (op = program->ops.begin(); op != program->ops.end(); ++op) {
+	switch (op->opcode) {
+	case EXPR_CONST:
+	    stack[sp++] = op->value;
+	    break;
+
+	case EXPR_PARAM:
+	case EXPR_PARAM_EXISTS:
+	    number = stack[sp - 1];
+	    index = (int) floor(number);
+	    if ((number - index) > 0.9999) {
+		index = (int) ceil(number);
+	    } else if ((number - index) > 0.0001)
+		ERS(NCE_NON_INTEGER_VALUE_FOR_INTEGER);
+	    if (op->opcode == EXPR_PARAM_EXISTS) {
+		stack[sp - 1] = index >= 1 && index < RS274NGC_MAX_PARAMETERS;
+		break;
+	    }
+	    CHKS(((index < 1) || (index >= RS274NGC_MAX_PARAMETERS)),
+		 NCE_PARAMETER_NUMBER_OUT_OF_RANGE);
+	    CHKS(((index >= 5420) && (index <= 5428) && (_setup.cutter_comp_side)),
+		 _("Cannot read current position with cutter radius compensation on"));
+	    stack[sp - 1] = parameters[index];
+	    break;
+
+	case EXPR_PARAM_INDEX:
+	    CHKS(((op->arg >= 5420) && (op->arg <= 5428) && (_setup.cutter_comp_side)),
+		 _("Cannot read current position with cutter radius compensation on"));
+	    stack[sp++] = parameters[op->arg];
+	    break;
+
+	case EXPR_NAMED:
+	    CHP(find_named_param(op->symbol, op->name, &exists, stack + sp));
+	    if (!exists) {
+		logNP("read_named_parameter: referencing undefined named parameter '%s' level=%d",
+		      op->name, (op->name[0] == '_') ? 0 : _setup.call_level);
+		ERS(_("Named parameter #<%s> not defined"), op->name);
+	    }
+	    sp++;
+	    break;
+
+	case EXPR_NAMED_EXISTS:
+	    CHP(find_named_param(op->symbol, op->name, &exists, stack + sp));
+	    stack[sp++] = exists ? 1.0 : 0.0;
+	    break;
+
+	case EXPR_NEGATE:
+	    stack[sp - 1] = -stack[sp - 1];
+	    break;
+
+	case EXPR_CHECK:
+	    CHKS(isnan(stack[sp - 1]),
+		 _("Calculation resulted in 'not a number'"));
+	    CHKS(isinf(stack[sp - 1]),
+		 _("Calculation resulted in 'infinity'"));
+	    break;
+
+	case EXPR_UNARY:
+	    CHP(execute_unary(stack + sp - 1, op->arg));
+	    break;
+
+	case EXPR_ATAN:
+	    sp--;
+	    stack[sp - 1] = atan2(stack[sp - 1], stack[sp]);
+	    stack[sp - 1] = ((stack[sp - 1] * 180.0) / M_PIl);
+	    break;
+
+	case EXPR_BINARY:
+	    sp--;
+	    CHP(execute_binary(stack + sp - 1, op->arg, stack + sp));
+	    break;
+
+	default:
+	    ERS(NCE_BUG_UNKNOWN_OPERATION);
+	}
+    }
+    *value = stack[0];
+    return INTERP_OK;
+}
+
+/****************************************************************************/
+
+/*! read_cached_expression
+
+Returned Value: int
+   If execute_expression or read_real_expression returns an error code,
+   this returns that code. Otherwise, it returns INTERP_OK.
+
+Side effects:
+   The value of the expression is put into what value points at.
+   The counter is reset to point to the first character after the
+   expression. A newly compiled expression is added to the cache.
+
+Called by: read_real_expression
+
+This is only called for the outermost expression of a line read from
+a file. If the line was seen before at the same offset of the same
+file and still has the same text there, the compiled program is run.
+Otherwise read_real_expression compiles the expression while reading
+it the regular way.
+
+*/
+
+int Interp::read_cached_expression(char *line,         //!< string: line of RS274/NGC code being processed
+				   int *counter,       //!< pointer to a counter for position on the line
+				   double *value,      //!< pointer to double to be computed
+				   double *parameters) //!< array of system parameters
+{
+    expr_key key;
+    expr_cache_iterator it;
+    expr_program program;
+    int start = *counter;
+    int status;
+
+    key.filename = _setup.filename;
+    key.offset = _setup.expr_offset;
+    key.position = start;
+
+    it = _setup.expr_cache.find(key);
+    if (it != _setup.expr_cache.end()) {
+	expr_program *cached = &it->second;
+	if (strncmp(line + start, cached->text.c_str(), cached->text.size()) == 0) {
+	    CHP(execute_expression(cached, value, parameters));
+	    *counter = start + cached->text.size();
+	    return INTERP_OK;
+	}
+	_setup.expr_cache.erase(it);
+    }
+
+    program.depth = 0;
+    program.max_depth = 0;
+    _setup.expr_recording = &program;
+    status = read_real_expression(line, counter, value, parameters);
+    _setup.expr_recording = NULL;
+    CHP(status);
+
+    if (program.max_depth <= EXPR_MAX_DEPTH) {
+	if (_setup.expr_cache.size() >= EXPR_CACHE_MAX)
+	    _setup.expr_cache.clear();
+	program.text.assign(line + start, *counter - start);
+	key.filename = strstore(_setup.filename);
+	_setup.expr_cache[key] = program;
+    }
+    return INTERP_OK;
+}
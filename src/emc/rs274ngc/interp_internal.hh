@@ -17,8 +17,11 @@
 #include "config.h"
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
 #include <set>
 #include <map>
+#include <vector>
+#include <string>
 #include <bitset>
 #include "canon.hh"
 #include "emcpos.h"
@@ -261,6 +264,18 @@ RETRACT_MODE;
 // string table - to get rid of strdup/free
 const char *strstore(const char *s);
 
+// heap allocations made by the interpreter's pools, to see how often
+// calls and lines still reach the allocator
+typedef struct interp_alloc_counters_struct {
+    unsigned long frames;        // call frames entered
+    unsigned long table_allocs;  // slot arrays allocated by parameter tables
+    unsigned long strings;       // strings added by strstore()
+    unsigned long string_bytes;  // bytes they take, with the terminating 0
+    unsigned long string_chunks; // blocks allocated to hold them
+} interp_alloc_counters;
+
+extern interp_alloc_counters interp_allocs;
+
 
 // Block execution phases in execution order
 // very carefully check code for sequencing when
@@ -299,6 +314,27 @@ enum phases  {
     MAX_STEPS
 };
 
+// a set of phases, kept as a bitmask so copying a block does not allocate
+class step_set {
+public:
+    void insert(int step) { bits.set(step); }
+    void erase(int step) { if (valid(step)) bits.reset(step); }
+    size_t count(int step) const { return valid(step) && bits.test(step); }
+    size_t size() const { return bits.count(); }
+    bool empty() const { return bits.none(); }
+    void clear() { bits.reset(); }
+    // the phase executed first, -1 if the set is empty
+    int first() const {
+	for (int step = 0; step < MAX_STEPS; step++)
+	    if (bits.test(step))
+		return step;
+	return -1;
+    }
+private:
+    static bool valid(int step) { return step >= 0 && step < MAX_STEPS; }
+    std::bitset<MAX_STEPS> bits;
+};
+
 
 typedef struct remap_struct remap;
 typedef remap *remap_pointer;
@@ -334,6 +370,18 @@ typedef remap_map::iterator remap_iterator;
 typedef std::map<int, remap_pointer> int_remap_map;
 typedef int_remap_map::iterator int_remap_iterator;
 
+// Python handlers resolved by pycall(), keyed by module and function name
+typedef struct py_callable_key_struct {
+    const char *module;
+    const char *name;
+    bool operator<(const struct py_callable_key_struct &o) const {
+	int c = strcmp(module, o.module);
+	return c ? (c < 0) : (strcmp(name, o.name) < 0);
+    }
+} py_callable_key;
+
+typedef std::map<py_callable_key, PythonCallable> py_callable_map;
+
 #define REMAP_FUNC(r) (r->remap_ngc ? r->remap_ngc: \
 		       (r->remap_py ? r->remap_py : "BUG-no-remap-func"))
 
@@ -441,7 +489,7 @@ typedef struct block_struct
     // in time there's only one excuting
     // conceptually blocks[1..n] are also the 'remap frames'
     remap_pointer executing_remap; // refers to config descriptor
-    std::set<int> remappings; // all remappings in this block (enum phases)
+    step_set remappings; // all remappings in this block (enum phases)
     int phase; // current remap execution phase
 
     // the strategy to get the builtin behaviour of a code in a remap procedure is as follows:
@@ -450,7 +498,7 @@ typedef struct block_struct
     // in the convert_* procedures we test if the step is remapped with the macro below, and wether
     // it is the current code which is remapped (IS_USER_MCODE, IS_USER_GCODE etc). If both
     // are true, we execute the remap procedure; if not, use the builtin code.
-#define STEP_REMAPPED_IN_BLOCK(bp, step) (bp->remappings.find(step) != bp->remappings.end())
+#define STEP_REMAPPED_IN_BLOCK(bp, step) (bp->remappings.count(step))
 
     // true if in a remap procedure the code being remapped was
     // referenced, which caused execution of the builtin semantics
@@ -489,8 +537,62 @@ typedef struct parameter_value_struct {
 } parameter_value;
 
 typedef parameter_value *parameter_pointer;
-typedef std::map<const char *, parameter_value, nocase_cmp> parameter_map;
-typedef parameter_map::iterator parameter_map_iterator;
+
+// named parameter names are interned once, case-folded, with their hash
+typedef struct param_symbol_struct {
+    const char *name;     // spelling the name was first interned with
+    unsigned hash;        // hash of the lowercased name
+} param_symbol;
+
+// return the symbol for name, creating it if needed
+const param_symbol *param_symbol_intern(const char *name);
+// return the symbol for name, or NULL if it was never interned
+const param_symbol *param_symbol_find(const char *name);
+
+// named parameters of one call frame - an open addressing hash table
+// keyed by interned symbol. sub_context[0] holds the globals.
+class parameter_table {
+public:
+    struct entry {
+	const param_symbol *symbol;   // NULL if the slot is free
+	parameter_value value;
+    };
+
+    class iterator {
+    public:
+	iterator(entry *p, entry *e) : pos(p), end(e) { skip(); }
+	entry &operator*() const { return *pos; }
+	entry *operator->() const { return pos; }
+	iterator &operator++() { ++pos; skip(); return *this; }
+	bool operator==(const iterator &o) const { return pos == o.pos; }
+	bool operator!=(const iterator &o) const { return pos != o.pos; }
+    private:
+	void skip();
+	entry *pos, *end;
+    };
+
+    parameter_table() : used(0), filled(0) {}
+
+    // NULL if symbol has no entry in this table
+    parameter_value *find(const param_symbol *symbol);
+    // find, or add a zeroed entry
+    parameter_value &operator[](const param_symbol *symbol);
+    bool erase(const param_symbol *symbol);
+    // remove all entries but keep the slots for reuse
+    void clear();
+    size_t size() const { return used; }
+
+    iterator begin();
+    iterator end();
+
+private:
+    entry *lookup(const param_symbol *symbol);
+    void grow();
+
+    std::vector<entry> slots;   // size is zero or a power of two
+    size_t used;                // live entries
+    size_t filled;              // live and erased entries
+};
 
 #define PA_READONLY	1
 #define PA_GLOBAL	2
@@ -515,7 +617,7 @@ typedef struct context_struct {
     const char *filename;      // name of file for this context
     const char *subName;       // name of the subroutine (oword)
     double saved_params[INTERP_SUB_PARAMS];
-    parameter_map named_params;
+    parameter_table named_params;
     unsigned char context_status;		// see CONTEXT_ defines below
     int saved_g_codes[ACTIVE_G_CODES];  // array of active G codes
     int saved_m_codes[ACTIVE_M_CODES];  // array of active M codes
@@ -549,6 +651,77 @@ typedef struct offset_struct {
 typedef std::map<const char *, offset, nocase_cmp> offset_map_type;
 typedef std::map<const char *, offset, nocase_cmp>::iterator offset_map_iterator;
 
+// compiled expressions - see interp_expr.cc
+enum expr_opcodes {
+    EXPR_CONST,        // push value
+    EXPR_PARAM,        // pop index, push numbered parameter
+    EXPR_PARAM_INDEX,  // push numbered parameter arg
+    EXPR_PARAM_EXISTS, // pop index, push 1.0 if it is a valid parameter number
+    EXPR_NAMED,        // push named parameter name
+    EXPR_NAMED_EXISTS, // push 1.0 if named parameter name exists
+    EXPR_NEGATE,       // negate top of stack
+    EXPR_CHECK,        // fail if top of stack is nan or inf
+    EXPR_UNARY,        // apply unary operation arg to top of stack
+    EXPR_ATAN,         // pop two, push atan2 in degrees
+    EXPR_BINARY,       // pop two, push result of binary operation arg
+};
+
+// deepest value stack a compiled expression may use
+#define EXPR_MAX_DEPTH 32
+// number of compiled expressions kept before the cache is flushed
+#define EXPR_CACHE_MAX 4096
+
+typedef struct expr_op_struct {
+    int opcode;
+    int arg;              // operation or parameter number
+    double value;         // EXPR_CONST
+    const char *name;     // EXPR_NAMED*, from strstore()
+    const param_symbol *symbol; // EXPR_NAMED*
+} expr_op;
+
+typedef struct expr_program_struct {
+    std::vector<expr_op> ops;
+    std::string text;     // source the program was compiled from
+    int depth;            // current value stack depth while compiling
+    int max_depth;
+} expr_program;
+
+typedef struct expr_key_struct {
+    const char *filename; // from strstore() once cached
+    long offset;          // start of line in file
+    int position;         // position of the '[' on the line
+    bool operator<(const struct expr_key_struct &o) const {
+	if (offset != o.offset) return offset < o.offset;
+	if (position != o.position) return position < o.position;
+	return strcmp(filename, o.filename) < 0;
+    }
+} expr_key;
+
+typedef std::map<expr_key, expr_program> expr_cache_map;
+typedef expr_cache_map::iterator expr_cache_iterator;
+
+// run-from-line checkpoints - see interp_checkpoint.cc
+typedef std::pair<int, double> numbered_value;
+typedef std::pair<const param_symbol *, parameter_value> named_value;
+
+typedef struct checkpoint_struct {
+    int sequence_number;  // lines read when it was taken
+    long position;        // offset of the next line in the file
+    std::string state;    // packed fields of setup, see CHECKPOINT_FIELDS
+    std::vector<CANON_TOOL_TABLE> tool_table; // pockets 0..pockets_max-1
+    std::vector<numbered_value> parameters;   // numbered parameters that are not 0
+    std::vector<named_value> globals;         // named parameters of frame 0
+    offset_map_type offset_map;               // o-word labels read so far
+} checkpoint;
+
+typedef std::vector<checkpoint> checkpoint_list;
+
+// checkpoints kept per program; past that every other one is dropped
+// and the interval doubled
+#define CHECKPOINT_MAX 1024
+// default [RS274NGC]CHECKPOINT_INTERVAL
+#define CHECKPOINT_INTERVAL 1000
+
 /*
 
 The current_x, current_y, and current_z are the location of the tool
@@ -715,6 +888,23 @@ typedef struct setup_struct
   bool mdi_interrupt;
   int feature_set; 
 
+  expr_cache_map expr_cache;         // compiled expressions by source position
+  expr_program *expr_recording;      // expression being compiled, or NULL
+  long expr_offset;                  // offset of the current line, -1 if not from a file
+
+  double tolerance;                  // last G64 P, -1 if not set yet
+  double naivecam_tolerance;         // last G64 Q, -1 if not set yet
+  double css_maximum;                // last G96 D
+
+  checkpoint_list checkpoints;       // by increasing line, see interp_checkpoint.cc
+  int checkpoint_interval;           // lines between checkpoints, 0 for none
+  int checkpoint_spacing;            // the interval, doubled whenever thinned out
+  int checkpoint_next;               // line to take the next one at
+  unsigned long long checkpoint_inputs; // fingerprint of the model of the first
+  bool checkpoint_checked;           // fingerprint compared since open()
+  unsigned long long checkpoint_setup; // fingerprint without the modes at close()
+  bool checkpoint_left;              // checkpoint_setup is from the last reading
+
 #define FEATURE(x) (_setup.feature_set & FEATURE_ ## x)
 #define FEATURE_RETAIN_G43           0x00000001
 #define FEATURE_OWORD_N_ARGS         0x00000002
@@ -725,6 +915,8 @@ typedef struct setup_struct
 #define FEATURE_OWORD_WARNONLY       0x00000020
 
     boost::python::object pythis;  // boost::cref to 'this'
+    boost::python::object py_self_args; // (pythis,) - args tuple shared by handlers
+    py_callable_map py_callables;  // resolved handlers, see py_callable()
     const char *on_abort_command;
     int_remap_map  g_remapped,m_remapped;
     remap_map remaps;
@@ -92,6 +92,187 @@ enum predefined_named_parameters {
 
 /****************************************************************************/
 
+// interned named parameter symbols
+//
+// A name is hashed and compared case-insensitively once, when it is
+// interned. Frame tables are then keyed by symbol pointer and probe
+// with the stored hash, so a lookup never walks or compares strings.
+
+static std::vector<param_symbol *> symtab;  // open addressing, power of two
+static size_t symtab_used;
+
+// names are ASCII, so fold case without going through the locale
+static inline unsigned char fold(unsigned char c)
+{
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+static unsigned param_name_hash(const char *name)
+{
+    unsigned h = 2166136261u;    // FNV-1a
+    for (; *name; name++) {
+	h ^= fold(*name);
+	h *= 16777619u;
+    }
+    return h;
+}
+
+static bool param_name_equal(const char *a, const char *b)
+{
+    for (; fold(*a) == fold(*b); a++, b++) {
+	if (*a == 0)
+	    return true;
+    }
+    return false;
+}
+
+static param_symbol **symtab_slot(const char *name, unsigned hash)
+{
+    size_t mask = symtab.size() - 1;
+    size_t i;
+
+    for (i = hash & mask; symtab[i] != NULL; i = (i + 1) & mask) {
+	if (symtab[i]->hash == hash && param_name_equal(symtab[i]->name, name))
+	    break;
+    }
+    return &symtab[i];
+}
+
+const param_symbol *param_symbol_find(const char *name)
+{
+    if (symtab.empty())
+	return NULL;
+    return *symtab_slot(name, param_name_hash(name));
+}
+
+const param_symbol *param_symbol_intern(const char *name)
+{
+    unsigned hash = param_name_hash(name);
+    param_symbol **slot;
+
+    if (2 * (symtab_used + 1) > symtab.size()) {
+	std::vector<param_symbol *> old;
+	old.swap(symtab);
+	symtab.assign(old.empty() ? 256 : 2 * old.size(), (param_symbol *) NULL);
+	for (size_t i = 0; i < old.size(); i++) {
+	    if (old[i])
+		*symtab_slot(old[i]->name, old[i]->hash) = old[i];
+	}
+    }
+    slot = symtab_slot(name, hash);
+    if (*slot == NULL) {
+	param_symbol *symbol = new param_symbol;
+	symbol->name = strstore(name);
+	symbol->hash = hash;
+	*slot = symbol;
+	symtab_used++;
+    }
+    return *slot;
+}
+
+// marks an erased slot so probing continues past it
+static const param_symbol erased_symbol = { "", 0 };
+
+void parameter_table::iterator::skip()
+{
+    while (pos != end && (pos->symbol == NULL || pos->symbol == &erased_symbol))
+	++pos;
+}
+
+parameter_table::entry *parameter_table::lookup(const param_symbol *symbol)
+{
+    size_t mask = slots.size() - 1;
+    entry *erased = NULL;
+    size_t i;
+
+    for (i = symbol->hash & mask; slots[i].symbol != NULL; i = (i + 1) & mask) {
+	if (slots[i].symbol == symbol)
+	    return &slots[i];
+	if (slots[i].symbol == &erased_symbol && erased == NULL)
+	    erased = &slots[i];
+    }
+    return erased ? erased : &slots[i];
+}
+
+void parameter_table::grow()
+{
+    std::vector<entry> old;
+    entry empty = { NULL, { 0.0, 0 } };
+    size_t size;
+
+    old.swap(slots);
+    size = old.empty() ? 16 : old.size();
+    // keep the size if erased slots made up most of the load
+    if (4 * (used + 1) > size)
+	size *= 2;
+    slots.assign(size, empty);
+    interp_allocs.table_allocs++;
+    filled = used;
+    for (size_t i = 0; i < old.size(); i++) {
+	if (old[i].symbol != NULL && old[i].symbol != &erased_symbol)
+	    *lookup(old[i].symbol) = old[i];
+    }
+}
+
+parameter_value *parameter_table::find(const param_symbol *symbol)
+{
+    if (used == 0)
+	return NULL;
+    entry *e = lookup(symbol);
+    return (e->symbol == symbol) ? &e->value : NULL;
+}
+
+parameter_value &parameter_table::operator[](const param_symbol *symbol)
+{
+    if (2 * (filled + 1) > slots.size())
+	grow();
+    entry *e = lookup(symbol);
+    if (e->symbol != symbol) {
+	if (e->symbol == NULL)
+	    filled++;
+	e->symbol = symbol;
+	e->value.value = 0.0;
+	e->value.attr = 0;
+	used++;
+    }
+    return e->value;
+}
+
+bool parameter_table::erase(const param_symbol *symbol)
+{
+    if (used == 0)
+	return false;
+    entry *e = lookup(symbol);
+    if (e->symbol != symbol)
+	return false;
+    e->symbol = &erased_symbol;
+    used--;
+    return true;
+}
+
+void parameter_table::clear()
+{
+    if (filled == 0)
+	return;
+    for (size_t i = 0; i < slots.size(); i++)
+	slots[i].symbol = NULL;
+    used = filled = 0;
+}
+
+parameter_table::iterator parameter_table::begin()
+{
+    entry *base = slots.empty() ? NULL : &slots[0];
+    return iterator(base, base + slots.size());
+}
+
+parameter_table::iterator parameter_table::end()
+{
+    entry *base = slots.empty() ? NULL : &slots[0];
+    return iterator(base + slots.size(), base + slots.size());
+}
+
+/****************************************************************************/
+
 /*! read_named_parameter
 
 Returned Value: int
@@ -141,7 +322,6 @@ int Interp::read_named_parameter(
     char paramNameBuf[LINELEN+1];
     int exists;
     double value;
-    parameter_map_iterator pi;
 
     CHKS((line[*counter] != '<'),
 	 NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
@@ -150,10 +330,14 @@ int Interp::read_named_parameter(
     CHP(find_named_param(paramNameBuf, &exists, &value));
     if (check_exists) {
 	*double_ptr = exists ? 1.0 : 0.0;
+	if (_setup.expr_recording)
+	    record_expression(EXPR_NAMED_EXISTS, 0, 0.0, paramNameBuf);
 	return INTERP_OK;
     }
     if (exists) {
 	*double_ptr = value;
+	if (_setup.expr_recording)
+	    record_expression(EXPR_NAMED, 0, 0.0, paramNameBuf);
 	return INTERP_OK;
     } else {
 	logNP("%s: referencing undefined named parameter '%s' level=%d",
@@ -299,17 +483,29 @@ int Interp::find_named_param(
     int *status,    //!< pointer to return status 1 => found
     double *value   //!< pointer to value of found parameter
     )
+{
+  return find_named_param(param_symbol_find(nameBuf), nameBuf, status, value);
+}
+
+// symbol may be NULL if the name was never interned; nameBuf is still
+// used as spelled for INI, HAL and Python lookups
+int Interp::find_named_param(
+    const param_symbol *symbol, //!< interned name, or NULL
+    const char *nameBuf, //!< pointer to name to be read
+    int *status,    //!< pointer to return status 1 => found
+    double *value   //!< pointer to value of found parameter
+    )
 {
   context_pointer frame;
-  parameter_map_iterator pi;
+  parameter_pointer pv;
   int level;
 
   level = (nameBuf[0] == '_') ? 0 : _setup.call_level; // determine scope
   frame = &_setup.sub_context[level];
   *status = 0;
 
-  pi = frame->named_params.find(nameBuf);
-  if (pi == frame->named_params.end()) { // not found
+  pv = symbol ? frame->named_params.find(symbol) : NULL;
+  if (pv == NULL) { // not found
       int exists = 0;
       double inivalue;
       if (FEATURE(INI_VARS) && (strncasecmp(nameBuf,"_ini[",5) == 0)) {
@@ -321,7 +517,7 @@ int Interp::find_named_param(
 	      parameter_value param;  // cache the value
 	      param.value = inivalue;
 	      param.attr = PA_GLOBAL | PA_READONLY | PA_FROM_INI;
-	      _setup.sub_context[0].named_params[strstore(nameBuf)] = param;
+	      _setup.sub_context[0].named_params[param_symbol_intern(nameBuf)] = param;
 	      return INTERP_OK;
 	  } 
       }
@@ -337,21 +533,18 @@ int Interp::find_named_param(
       *value = 0.0;
       *status = 0;
   } else {
-      parameter_pointer pv = &pi->second;
       if (pv->attr & PA_UNSET)
 	  logNP("warning: referencing unset variable '%s'",nameBuf);
       if (pv->attr & PA_USE_LOOKUP) {
 	  CHP(lookup_named_param(nameBuf, pv->value, value));
 	  *status = 1;
       } else if (pv->attr & PA_PYTHON) {
-	  bp::object retval, tupleargs, kwargs;
-	  bp::list plist;
+	  bp::object retval;
+	  bp::dict kwargs;
 
-	  plist.append(_setup.pythis); // self
-	  tupleargs = bp::tuple(plist);
-	  kwargs = bp::dict();
-
-	  python_plugin->call(NAMEDPARAMS_MODULE, nameBuf, tupleargs, kwargs, retval);
+	  python_plugin->call(py_callable(NAMEDPARAMS_MODULE, nameBuf),
+			      NAMEDPARAMS_MODULE, nameBuf,
+			      _setup.py_self_args, kwargs, retval);
 	  CHKS(python_plugin->plugin_status() == PLUGIN_EXCEPTION,
 	       "named param - pycall(%s):\n%s", nameBuf,
 	       python_plugin->last_exception().c_str());
@@ -397,17 +590,17 @@ int Interp::store_named_param(setup_pointer settings,
 {
   context_pointer frame;
   int level;
-  parameter_map_iterator pi;
+  const param_symbol *symbol;
+  parameter_pointer pv;
 
   level = (nameBuf[0] == '_') ? 0 : _setup.call_level; // determine scope
   frame = &settings->sub_context[level];
 
-  pi = frame->named_params.find(nameBuf);
-  if (pi == frame->named_params.end()) {
+  symbol = param_symbol_find(nameBuf);
+  pv = symbol ? frame->named_params.find(symbol) : NULL;
+  if (pv == NULL) {
       ERS(_("Internal error: Could not assign #<%s>"), nameBuf);
   } else {
-      parameter_pointer pv = &pi->second;
-
       CHKS(((pv->attr & PA_GLOBAL)  && level),
 	   "BUG: variable '%s' marked global, but assigned at level %d", nameBuf, level);
 
@@ -452,7 +645,7 @@ int Interp::add_named_param(
   }
   param.value = 0.0;
   param.attr = attr;
-  _setup.sub_context[level].named_params[strstore(nameBuf)] = param;
+  _setup.sub_context[level].named_params[param_symbol_intern(nameBuf)] = param;
   return INTERP_OK;
 }
 
@@ -732,11 +925,11 @@ int Interp::init_python_predef_parameter(const char *name)
 	find_named_param(name, &exists, &value);
 	if (exists) {
 	    fprintf(stderr, "warning: redefining named parameter %s\n",name);
-	    _setup.sub_context[0].named_params.erase(name);
+	    _setup.sub_context[0].named_params.erase(param_symbol_intern(name));
 	}
 	param.value = 0.0;
 	param.attr = PA_READONLY|PA_PYTHON|PA_GLOBAL;
-	_setup.sub_context[0].named_params[strstore(name)] = param;
+	_setup.sub_context[0].named_params[param_symbol_intern(name)] = param;
     }
     return INTERP_OK;
 }
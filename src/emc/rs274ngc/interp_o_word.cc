@@ -244,7 +244,7 @@ int Interp::execute_call(setup_pointer settings,
 	    for(int i = 0; i < eblock->param_cnt; i++)
 		plist.append(eblock->params[i]); // positonal args
 	    current_frame->tupleargs = bp::tuple(plist);
-	    current_frame->kwargs = bp::dict();
+	    py_reset_kwargs(current_frame);
 
 	case CS_REEXEC_PYOSUB:
 	    if (settings->call_state ==  CS_REEXEC_PYOSUB)
@@ -277,9 +277,8 @@ int Interp::execute_call(setup_pointer settings,
 	    if (remap->remap_py || remap->prolog_func || remap->epilog_func) {
 		CHKS(!PYUSABLE, "%s (remapped) uses Python functions, but the Python plugin is not available", 
 		     remap->name);
-		plist.append(settings->pythis);   //self
-		current_frame->tupleargs = bp::tuple(plist);
-		current_frame->kwargs = bp::dict();
+		current_frame->tupleargs = settings->py_self_args;
+		py_reset_kwargs(current_frame);
 	    }
 	    if (remap->argspec && (strchr(remap->argspec, '@') == NULL)) {
 		// add_parameters will decorate kwargs as per argspec
@@ -592,6 +591,7 @@ int Interp::enter_context(setup_pointer settings, block_pointer block)
     if (settings->call_level >= INTERP_SUB_ROUTINE_LEVELS) {
 	ERS(NCE_TOO_MANY_SUBROUTINE_LEVELS);
     }
+    interp_allocs.frames++;
     context_pointer frame = &settings->sub_context[settings->call_level];
     // mark frame for finishing remap
     frame->context_status = (block->call_type  == CT_REMAP) ? REMAP_FRAME : 0;
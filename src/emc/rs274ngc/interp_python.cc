@@ -92,6 +92,34 @@ bool Interp::is_pycallable(setup_pointer settings,
     return python_plugin->is_callable(module,funcname);
 }
 
+// the cached handle for [module.]funcname - resolved on first use
+PythonCallable &Interp::py_callable(const char *module, const char *funcname)
+{
+    py_callable_key key;
+    py_callable_map::iterator it;
+
+    key.module = module ? module : "";
+    key.name = funcname;
+    it = _setup.py_callables.find(key);
+    if (it != _setup.py_callables.end())
+	return it->second;
+    key.module = strstore(key.module);
+    key.name = strstore(funcname);
+    return _setup.py_callables[key];
+}
+
+// empty the frame's kwargs for the next handler call. The dict is
+// reused unless a handler kept a reference to it.
+void Interp::py_reset_kwargs(context_pointer frame)
+{
+    bp::object &kwargs = frame->kwargs;
+
+    if (PyDict_CheckExact(kwargs.ptr()) && (kwargs.ptr()->ob_refcnt == 1))
+	PyDict_Clear(kwargs.ptr());
+    else
+	kwargs = bp::dict();
+}
+
 // all parameters to/results from Python calls go through the callframe, which looks a bit awkward
 // the reason is not to expose boost.python through the interpreter public interface
 int Interp::pycall(setup_pointer settings,
@@ -156,7 +184,8 @@ int Interp::pycall(setup_pointer settings,
 	}
 	break;
     default:
-	python_plugin->call(module,funcname, frame->tupleargs,frame->kwargs,retval);
+	python_plugin->call(py_callable(module, funcname), module, funcname,
+			    frame->tupleargs, frame->kwargs, retval);
 	CHKS(python_plugin->plugin_status() == PLUGIN_EXCEPTION,
 	     "pycall(%s):\n%s", funcname,
 	     python_plugin->last_exception().c_str());
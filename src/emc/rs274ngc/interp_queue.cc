@@ -52,10 +52,10 @@ static double latheorigin_z(setup_pointer settings, double z) {
 static double endpoint[2];
 static int endpoint_valid = 0;
 
-std::vector<queued_canon>& qc(void) {
-    static std::vector<queued_canon> c;
-    if(0) printf("len %d\n", (int)c.size());
-    return c;
+static canon_queue queue;
+
+canon_queue& qc(void) {
+    return queue;
 }
 
 void qc_reset(void) {
@@ -248,7 +248,7 @@ void enqueue_COMMENT(const char *c) {
     }
     queued_canon q;
     q.type = QCOMMENT;
-    q.data.comment.comment = strdup(c);
+    q.data.comment.offset = qc().store_comment(c);
     if(debug_qc) printf("enqueue comment \"%s\"\n", c);
     qc().push_back(q);
 }
@@ -396,10 +396,10 @@ void qc_scale(double scale) {
 
     if(debug_qc) printf("scaling qc by %f\n", scale);
 
-    for(unsigned int i = 0; i<qc().size(); i++) {
-        queued_canon &q = qc()[i];
-        endpoint[0] *= scale;
-        endpoint[1] *= scale;
+    endpoint[0] *= scale;
+    endpoint[1] *= scale;
+    for(unsigned int i = 0; i<qc().move_count(); i++) {
+        queued_canon &q = qc().move(i);
         switch(q.type) {
         case QARC_FEED:
             q.data.arc_feed.end1 *= scale;
@@ -524,8 +524,7 @@ void dequeue_canons(setup_pointer settings) {
             break;
         case QCOMMENT:
             if(debug_qc) printf("issuing comment\n");
-            COMMENT(q.data.comment.comment);
-            free(q.data.comment.comment);
+            COMMENT(qc().comment_text(q.data.comment.offset));
             break;
         case QM_USER_COMMAND:
             if(debug_qc) printf("issuing mcommand\n");
@@ -538,7 +537,6 @@ void dequeue_canons(setup_pointer settings) {
 	case QSTART_CHANGE:
             if(debug_qc) printf("issuing start_change\n");
             START_CHANGE();
-            free(q.data.comment.comment);
             break;
         case QORIENT_SPINDLE:
             if(debug_qc) printf("issuing orient spindle\n");
@@ -562,13 +560,13 @@ int Interp::move_endpoint_and_flush(setup_pointer settings, double x, double y)
 
     if(qc().empty()) return 0;
     
-    for(unsigned int i = 0; i<qc().size(); i++) {
+    for(unsigned int i = 0; i<qc().move_count(); i++) {
         // there may be several moves in the queue, and we need to
         // change all of them.  consider moving into a concave corner,
         // then up and back down, then continuing on.  there will be
         // three moves to change.
 
-        queued_canon &q = qc()[i];
+        queued_canon &q = qc().move(i);
 
         switch(q.type) {
         case QARC_FEED:
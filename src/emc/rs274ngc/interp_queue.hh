@@ -8,6 +8,9 @@
 * Copyright (c) 2009 All rights reserved.
 *
 ********************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <new>
 #include <vector>
 
 enum queued_canon_type {QSTRAIGHT_TRAVERSE, QSTRAIGHT_FEED, QARC_FEED, QSET_FEED_RATE, QDWELL, QSET_FEED_MODE,
@@ -58,7 +61,7 @@ struct set_spindle_speed {
 };
 
 struct comment {
-    char *comment;
+    size_t offset;      // of the text, see canon_queue::comment_text()
 };
 
 struct mcommand {
@@ -94,7 +97,78 @@ struct queued_canon {
     } data;
 };
 
-std::vector<queued_canon>& qc(void);
+// entries and comment bytes allocated up front
+#define QUEUE_CAPACITY 64
+#define QUEUE_TEXT_CAPACITY 1024
+
+// The canon calls held back while cutter compensation waits for the next
+// move. The queue is always issued and cleared as a whole, so it only
+// ever fills from the front and its storage is reused from one move to
+// the next; it grows only when more than QUEUE_CAPACITY calls pile up
+// between two moves. The motion entries are also listed by index, so
+// moving their endpoints and checking them for gouges does not walk the
+// other calls. Each queued move is checked once, when the next move
+// flushes the queue; comp does not look further ahead than that, so a
+// gouge that only shows over several segments is still not caught.
+// Comment texts are copied into one buffer that is cleared with the
+// queue.
+class canon_queue {
+public:
+    canon_queue() : entries(NULL), moves(NULL), count(0), nmoves(0),
+		    capacity(0) {
+	grow(QUEUE_CAPACITY);
+	text.reserve(QUEUE_TEXT_CAPACITY);
+    }
+    ~canon_queue() { free(entries); free(moves); }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+    queued_canon &operator[](size_t i) { return entries[i]; }
+    queued_canon &front() { return entries[0]; }
+
+    void push_back(const queued_canon &q) {
+	if (count == capacity)
+	    grow(2 * capacity);
+	if (q.type == QSTRAIGHT_TRAVERSE || q.type == QSTRAIGHT_FEED ||
+	    q.type == QARC_FEED)
+	    moves[nmoves++] = count;
+	entries[count++] = q;
+    }
+    void clear() { count = 0; nmoves = 0; text.clear(); }
+
+    // the motion entries, in queue order
+    size_t move_count() const { return nmoves; }
+    queued_canon &move(size_t i) { return entries[moves[i]]; }
+
+    // keep a copy of s until the queue is cleared
+    size_t store_comment(const char *s) {
+	size_t offset = text.size();
+	text.insert(text.end(), s, s + strlen(s) + 1);
+	return offset;
+    }
+    const char *comment_text(size_t offset) const { return &text[offset]; }
+
+private:
+    void grow(size_t n) {
+	queued_canon *e = (queued_canon *) realloc(entries, n * sizeof(*e));
+	size_t *m = (size_t *) realloc(moves, n * sizeof(*m));
+	if (e) entries = e;
+	if (m) moves = m;
+	if (!e || !m)
+	    throw std::bad_alloc();
+	capacity = n;
+    }
+
+    canon_queue(const canon_queue &);
+    canon_queue &operator=(const canon_queue &);
+
+    queued_canon *entries;
+    size_t *moves;              // indices of the motion entries
+    size_t count, nmoves, capacity;
+    std::vector<char> text;     // comment texts, 0 terminated
+};
+
+canon_queue& qc(void);
 
 void enqueue_SET_FEED_RATE(double feed);
 void enqueue_DWELL(double time);
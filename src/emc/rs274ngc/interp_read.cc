@@ -134,6 +134,7 @@ int Interp::read_atan(char *line,        //!< string: line of RS274/NGC code bei
   CHP(read_real_expression(line, counter, &argument2, parameters));
   *double_ptr = atan2(*double_ptr, argument2);  /* value in radians */
   *double_ptr = ((*double_ptr * 180.0) / M_PIl);   /* convert to degrees */
+  record_expression(EXPR_ATAN);
   return INTERP_OK;
 }
 
@@ -1917,6 +1918,7 @@ int Interp::read_parameter(
       if(check_exists)
       {
 	  *double_ptr = index >= 1 && index < RS274NGC_MAX_PARAMETERS;
+	  record_expression(EXPR_PARAM_EXISTS);
 	  return INTERP_OK;
       }
       CHKS(((index < 1) || (index >= RS274NGC_MAX_PARAMETERS)),
@@ -1924,6 +1926,7 @@ int Interp::read_parameter(
       CHKS(((index >= 5420) && (index <= 5428) && (_setup.cutter_comp_side)),
            _("Cannot read current position with cutter radius compensation on"));
       *double_ptr = parameters[index];
+      record_expression(EXPR_PARAM);
   }
   return INTERP_OK;
 }
@@ -2527,6 +2530,8 @@ int Interp::read_real_expression(char *line,     //!< string: line of RS274/NGC
   int stack_index;
 
   CHKS((line[*counter] != '['), NCE_BUG_FUNCTION_SHOULD_NOT_HAVE_BEEN_CALLED);
+  if ((_setup.expr_recording == NULL) && (_setup.expr_offset >= 0))
+    return read_cached_expression(line, counter, value, parameters);
   *counter = (*counter + 1);
   CHP(read_real_value(line, counter, values, parameters));
   CHP(read_operation(line, counter, operators));
@@ -2544,6 +2549,7 @@ int Interp::read_real_expression(char *line,     //!< string: line of RS274/NGC
         CHP(execute_binary((values + stack_index - 1),
                            operators[stack_index - 1],
                            (values + stack_index)));
+        record_expression(EXPR_BINARY, operators[stack_index - 1]);
         operators[stack_index - 1] = operators[stack_index];
         if ((stack_index > 1) &&
             (precedence(operators[stack_index - 1]) <=
@@ -2616,6 +2622,7 @@ int Interp::read_real_number(char *line, //!< string: line of RS274/NGC code bei
 
   *double_ptr = val;
   *counter = start + after - line;
+  record_expression(EXPR_CONST, 0, val);
   //fprintf(stderr, "got %f   rest of line=%s\n", val, line+*counter);
   return INTERP_OK;
 }
@@ -2695,6 +2702,7 @@ int Interp::read_real_value(char *line,  //!< string: line of RS274/NGC code bei
     (*counter)++;
     CHP(read_real_value(line, counter, double_ptr, parameters));
     *double_ptr = -*double_ptr;
+    record_expression(EXPR_NEGATE);
   }
   else if ((c >= 'a') && (c <= 'z'))
     CHP(read_unary(line, counter, double_ptr, parameters));
@@ -2705,6 +2713,7 @@ int Interp::read_real_value(char *line,  //!< string: line of RS274/NGC code bei
           _("Calculation resulted in 'not a number'"));
   CHKS(isinf(*double_ptr),
           _("Calculation resulted in 'infinity'"));
+  record_expression(EXPR_CHECK);
 
   return INTERP_OK;
 }
@@ -3095,8 +3104,10 @@ int Interp::read_unary(char *line,       //!< string: line of RS274/NGC code bei
 
   if (operation == ATAN)
     CHP(read_atan(line, counter, double_ptr, parameters));
-  else
+  else {
     CHP(execute_unary(double_ptr, operation));
+    record_expression(EXPR_UNARY, operation);
+  }
   return INTERP_OK;
 }
 
@@ -118,6 +118,32 @@ static bp::object wrap_find_tool_pocket(Interp &interp, int toolno)
     return bp::make_tuple(status, pocket);
 }
 
+// read-only mapping access to the named parameters of one call frame
+static parameter_value &parameter_table_getitem(parameter_table &t, const char *name)
+{
+    const param_symbol *symbol = param_symbol_find(name);
+    parameter_value *pv = symbol ? t.find(symbol) : NULL;
+    if (pv == NULL) {
+	PyErr_SetString(PyExc_KeyError, name);
+	bp::throw_error_already_set();
+    }
+    return *pv;
+}
+
+static bool parameter_table_contains(parameter_table &t, const char *name)
+{
+    const param_symbol *symbol = param_symbol_find(name);
+    return symbol && t.find(symbol);
+}
+
+static bp::list parameter_table_keys(parameter_table &t)
+{
+    bp::list result;
+    for (parameter_table::iterator it = t.begin(); it != t.end(); ++it)
+	result.append(it->symbol->name);
+    return result;
+}
+
 // access to named and numbered parameters via a pseudo-dictionary
 // either params["paramname"] or params[5400] is valid
 struct ParamClass {
@@ -170,8 +196,8 @@ struct ParamClass {
 
     bp::list namelist(context &c) const {
 	bp::list result;
-	for(parameter_map::iterator it = c.named_params.begin(); it != c.named_params.end(); ++it) {
-	    result.append( it->first);
+	for(parameter_table::iterator it = c.named_params.begin(); it != c.named_params.end(); ++it) {
+	    result.append( it->symbol->name);
 	}
 	return result;
     }
@@ -242,6 +268,17 @@ static int get_task(Interp &i) { return _task; };
 static const char *get_filename(Interp &i) { return i._setup.filename; };
 static const char *get_linetext(Interp &i) { return i._setup.linetext; };
 
+static bp::dict get_alloc_counters(Interp &i)
+{
+    bp::dict counters;
+    counters["frames"] = interp_allocs.frames;
+    counters["table_allocs"] = interp_allocs.table_allocs;
+    counters["strings"] = interp_allocs.strings;
+    counters["string_bytes"] = interp_allocs.string_bytes;
+    counters["string_chunks"] = interp_allocs.string_chunks;
+    return counters;
+}
+
 static void  set_x(EmcPose &p, double value) { p.tran.x = value; }
 static void  set_y(EmcPose &p, double value) { p.tran.y = value; }
 static void  set_z(EmcPose &p, double value) { p.tran.z = value; }
@@ -429,8 +466,11 @@ BOOST_PYTHON_MODULE(interpreter) {
 	.def_readwrite("value",&parameter_value_struct::value)
 	;
 
-    class_<parameter_map,noncopyable>("ParameterMap",no_init)
-        .def(map_indexing_suite<parameter_map>())
+    class_<parameter_table,noncopyable>("ParameterMap",no_init)
+	.def("__getitem__", &parameter_table_getitem, return_internal_reference<>())
+	.def("__contains__", &parameter_table_contains)
+	.def("__len__", &parameter_table::size)
+	.def("keys", &parameter_table_keys)
 	;
 
 
@@ -614,6 +654,7 @@ BOOST_PYTHON_MODULE(interpreter) {
 	.add_property("task", &get_task) // R/O
 	.add_property("filename", &get_filename) // R/O
 	.add_property("linetext", &get_linetext) // R/O
+	.add_property("alloc_counters", &get_alloc_counters) // R/O
 
 	.def_readwrite("a_axis_wrapped", &Interp::_setup.a_axis_wrapped)
 	.def_readwrite("b_axis_wrapped", &Interp::_setup.b_axis_wrapped)
@@ -8,7 +8,8 @@
  *
  ********************************************************************/
 
-/* Those functions are needed to calculate NURBS points */
+/* Those functions are needed to calculate NURBS points, and to follow
+   the curve with arcs */
 
 #include <math.h>
 #include <algorithm>
@@ -36,7 +37,7 @@ std::vector<unsigned int> knot_vector_creator(unsigned int n, unsigned int k) {
 }
 
 double Nmix(unsigned int i, unsigned int k, double u, 
-                    std::vector<unsigned int> knot_vector) {
+                    const std::vector<unsigned int> &knot_vector) {
 
     if (k == 1){
         if ((u >= knot_vector[i]) && (u <= knot_vector[i+1])) {
@@ -67,8 +68,8 @@ double Nmix(unsigned int i, unsigned int k, double u,
 
 
 double Rden(double u, unsigned int k,
-                  std::vector<CONTROL_POINT> nurbs_control_points,
-                  std::vector<unsigned int> knot_vector) {
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector) {
 
     unsigned int i;
     double d = 0.0;   
@@ -77,33 +78,252 @@ double Rden(double u, unsigned int k,
     return d;
 }
 
-PLANE_POINT nurbs_point(double u, unsigned int k, 
-                  std::vector<CONTROL_POINT> nurbs_control_points,
-                  std::vector<unsigned int> knot_vector) {
+/* De Boor's algorithm, run on the homogeneous control points (X*W, Y*W, W).
+   Only the k control points whose basis functions are nonzero at u take
+   part, so a point costs O(k^2) instead of the O(n * 2^k) of summing
+   Nmix over every control point.  d is scratch space for 3*k doubles.
+   The derivative falls out of the next-to-last step of the triangle. */
+static void deboor(double u, unsigned int k,
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector,
+                  double *d, PLANE_POINT &point, PLANE_POINT &deriv) {
 
-    unsigned int i;
-    PLANE_POINT point;
-    point.X = 0;
-    point.Y = 0;
-    for (i=0; i<(nurbs_control_points.size()); i++) {
-        point.X = point.X + nurbs_control_points[i].X*Nmix(i,k,u,knot_vector)
-	*nurbs_control_points[i].W/Rden(u,k,nurbs_control_points,knot_vector);
-        point.Y = point.Y + nurbs_control_points[i].Y*Nmix(i,k,u,knot_vector)
-	*nurbs_control_points[i].W/Rden(u,k,nurbs_control_points,knot_vector);
+    unsigned int n = nurbs_control_points.size() - 1;
+    unsigned int p = k - 1;
+    unsigned int s, j, r;
+    double dx = 0, dy = 0, dw = 0;
+
+    // the span with knot_vector[s] <= u < knot_vector[s+1], p <= s <= n
+    s = std::upper_bound(knot_vector.begin() + p + 1,
+                         knot_vector.begin() + n + 1, u)
+        - knot_vector.begin() - 1;
+
+    for (j=0; j<=p; j++) {
+        const CONTROL_POINT &cp = nurbs_control_points[s - p + j];
+        d[3*j+0] = cp.X * cp.W;
+        d[3*j+1] = cp.Y * cp.W;
+        d[3*j+2] = cp.W;
     }
+
+    for (r=1; r<=p; r++) {
+        if (r == p) {
+            double h = knot_vector[s+1] - knot_vector[s];
+            dx = p * (d[3*p+0] - d[3*p-3]) / h;
+            dy = p * (d[3*p+1] - d[3*p-2]) / h;
+            dw = p * (d[3*p+2] - d[3*p-1]) / h;
+        }
+        for (j=p; j>=r; j--) {
+            double lo = knot_vector[s - p + j];
+            double hi = knot_vector[s + 1 + j - r];
+            double alpha = hi == lo ? 0 : (u - lo) / (hi - lo);
+            d[3*j+0] = (1 - alpha) * d[3*j-3] + alpha * d[3*j+0];
+            d[3*j+1] = (1 - alpha) * d[3*j-2] + alpha * d[3*j+1];
+            d[3*j+2] = (1 - alpha) * d[3*j-1] + alpha * d[3*j+2];
+        }
+    }
+
+    point.X = d[3*p+0] / d[3*p+2];
+    point.Y = d[3*p+1] / d[3*p+2];
+    // quotient rule, back out of homogeneous coordinates
+    deriv.X = (dx - dw * point.X) / d[3*p+2];
+    deriv.Y = (dy - dw * point.Y) / d[3*p+2];
+}
+
+/* Small orders are evaluated in a stack buffer, only unusually high
+   orders need to go to the heap. */
+#define NURBS_SCRATCH_ORDER 16
+
+static void deboor_eval(double u, unsigned int k,
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector,
+                  PLANE_POINT &point, PLANE_POINT &deriv) {
+    if (k <= NURBS_SCRATCH_ORDER) {
+        double d[3 * NURBS_SCRATCH_ORDER];
+        deboor(u, k, nurbs_control_points, knot_vector, d, point, deriv);
+    } else {
+        std::vector<double> d(3 * k);
+        deboor(u, k, nurbs_control_points, knot_vector, &d[0], point, deriv);
+    }
+}
+
+PLANE_POINT nurbs_point(double u, unsigned int k, 
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector) {
+
+    PLANE_POINT point, deriv;
+    deboor_eval(u, k, nurbs_control_points, knot_vector, point, deriv);
     return point;
 }
 
 #define DU (1e-5)
+void nurbs_point_tangent(double u, unsigned int k,
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector,
+                  PLANE_POINT &point, PLANE_POINT &tangent) {
+    deboor_eval(u, k, nurbs_control_points, knot_vector, point, tangent);
+    if (tangent.X == 0 && tangent.Y == 0) {
+        // the derivative vanishes where control points coincide; the
+        // direction of travel is still the limit of the chord
+        unsigned int n = nurbs_control_points.size() - 1;
+        double umax = n - k + 2;
+        double ulo = std::max(0.0, u-DU), uhi = std::min(umax, u+DU);
+        PLANE_POINT P1 = nurbs_point(ulo, k, nurbs_control_points, knot_vector);
+        PLANE_POINT P3 = nurbs_point(uhi, k, nurbs_control_points, knot_vector);
+        tangent.X = P3.X - P1.X;
+        tangent.Y = P3.Y - P1.Y;
+    }
+    unit(tangent);
+}
+
 PLANE_POINT nurbs_tangent(double u, unsigned int k,
-                  std::vector<CONTROL_POINT> nurbs_control_points,
-                  std::vector<unsigned int> knot_vector) {
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  const std::vector<unsigned int> &knot_vector) {
+    PLANE_POINT point, tangent;
+    nurbs_point_tangent(u, k, nurbs_control_points, knot_vector, point, tangent);
+    return tangent;
+}
+
+static void unit(double *x, double *y) {
+    double h = hypot(*x, *y);
+    if(h != 0) { *x/=h; *y/=h; }
+}
+
+/* Center of the arc leaving (x0,y0) in direction (dx,dy) and ending at
+   (x1,y1).  Returns 0 if the arc degenerates into a straight line. */
+static int
+arc_center(double x0, double y0, double x1, double y1, double dx, double dy,
+           double *cx, double *cy, double *r) {
+    double small = 0.000001;
+    double x = x1-x0, y=y1-y0;
+    double den = 2 * (y*dx - x*dy);
+    if (fabs(den) <= small) return 0;
+    *r = -(x*x+y*y)/den;
+    *cx = x0 + dy * *r;
+    *cy = y0 - dx * *r;
+    return 1;
+}
+
+static void
+arc(int lineno, double x0, double y0, double x1, double y1, double dx, double dy,
+    nurbs_arc_fn feed) {
+    double cx, cy, r;
+    if (arc_center(x0, y0, x1, y1, dx, dy, &cx, &cy, &r)) {
+        feed(lineno, x1, y1, cx, cy, r<0 ? 1 : -1);
+    } else { 
+        feed(lineno, x1, y1, 0, 0, 0);
+    }
+}
+
+/* How far (qx,qy) is from the arc that arc() would make */
+static double
+arc_deviation(double x0, double y0, double x1, double y1, double dx, double dy,
+              double qx, double qy) {
+    double cx, cy, r;
+    if (arc_center(x0, y0, x1, y1, dx, dy, &cx, &cy, &r))
+        return fabs(hypot(qx - cx, qy - cy) - fabs(r));
+    double lx = x1 - x0, ly = y1 - y0;
+    double len = hypot(lx, ly);
+    if (len == 0) return hypot(qx - x0, qy - y0);
+    return fabs((qx - x0) * ly - (qy - y0) * lx) / len;
+}
+
+/* Find the point where the two arcs of a biarc meet, and the direction
+   of travel there.  Returns 0 if there is no biarc for these ends. */
+static int
+biarc_join(double p0x, double p0y, double &tsx, double &tsy,
+           double p4x, double p4y, double &tex, double &tey,
+           double &p2x, double &p2y, double &tmx, double &tmy, double r=1.0) {
+    unit(&tsx, &tsy);
+    unit(&tex, &tey);
+
+    double vx = p0x - p4x, vy = p0y - p4y;
+    double c = vx*vx + vy*vy;
+    double b = 2 * (vx * (r*tsx + tex) + vy * (r*tsy + tey));
+    double a = 2 * r * (tsx * tex + tsy * tey - 1);
+
+    double discr = b*b - 4*a*c;
+    if(discr < 0) return 0;
+
+    double disq = sqrt(discr);
+    double beta1 = (-b-disq) / 2 / a;
+    double beta2 = (-b+disq) / 2 / a;
+
+    if(beta1 > 0 && beta2 > 0)
+      return 0;
+    double beta = std::max(beta1, beta2);
+    double alpha = beta * r;
+    double ab = alpha + beta;
+    double p1x = p0x + alpha * tsx, p1y = p0y + alpha * tsy,
+         p3x = p4x - beta * tex, p3y = p4y - beta * tey;
+    p2x = (p1x*beta + p3x*alpha) / ab;
+    p2y = (p1y*beta + p3y*alpha) / ab;
+    tmx = p3x-p2x, tmy = p3y-p2y;
+    unit(&tmx, &tmy);
+    return 1;
+}
+
+/* The parameter interval is halved until the curve stays within the
+   tolerance of the biarc, so the number of moves follows the curvature
+   and not the number of control points. */
+#define NURBS_MAX_DEPTH 12
+
+static void
+biarcs(int lineno, unsigned int k,
+       const std::vector<CONTROL_POINT> &nurbs_control_points,
+       const std::vector<unsigned int> &knot_vector,
+       double u0, const PLANE_POINT &P0, const PLANE_POINT &P0T,
+       double u1, const PLANE_POINT &P1, const PLANE_POINT &P1T,
+       double tolerance, int depth, nurbs_arc_fn feed) {
+    double tsx = P0T.X, tsy = P0T.Y, tex = P1T.X, tey = P1T.Y;
+    double p2x, p2y, tmx, tmy;
+    PLANE_POINT PM, PMT;
+
+    if(biarc_join(P0.X, P0.Y, tsx, tsy, P1.X, P1.Y, tex, tey,
+                  p2x, p2y, tmx, tmy)) {
+        double dev = 0;
+        for(int i=1; i<4 && dev <= tolerance; i++) {
+            PLANE_POINT Q = nurbs_point(u0 + (u1 - u0) * i / 4, k,
+                                        nurbs_control_points, knot_vector);
+            double d1 = arc_deviation(P0.X, P0.Y, p2x, p2y, tsx, tsy, Q.X, Q.Y);
+            double d2 = arc_deviation(p2x, p2y, P1.X, P1.Y, tmx, tmy, Q.X, Q.Y);
+            dev = std::max(dev, d1 < d2 ? d1 : d2);
+        }
+        if(dev <= tolerance || depth >= NURBS_MAX_DEPTH) {
+            arc(lineno, P0.X, P0.Y, p2x, p2y, tsx, tsy, feed);
+            arc(lineno, p2x, p2y, P1.X, P1.Y, tmx, tmy, feed);
+            return;
+        }
+    } else if(depth >= NURBS_MAX_DEPTH) {
+        // no biarc fits, and the piece is tiny: go straight there
+        arc(lineno, P0.X, P0.Y, P1.X, P1.Y, P1.X - P0.X, P1.Y - P0.Y, feed);
+        return;
+    }
+
+    double um = (u0 + u1) / 2;
+    nurbs_point_tangent(um, k, nurbs_control_points, knot_vector, PM, PMT);
+    biarcs(lineno, k, nurbs_control_points, knot_vector,
+           u0, P0, P0T, um, PM, PMT, tolerance, depth + 1, feed);
+    biarcs(lineno, k, nurbs_control_points, knot_vector,
+           um, PM, PMT, u1, P1, P1T, tolerance, depth + 1, feed);
+}
+
+void nurbs_biarcs(int lineno,
+                  const std::vector<CONTROL_POINT> &nurbs_control_points,
+                  unsigned int k, double tolerance, nurbs_arc_fn feed) {
     unsigned int n = nurbs_control_points.size() - 1;
-    double umax = n - k + 2;
-    double ulo = std::max(0.0, u-DU), uhi = std::min(umax, u+DU);
-    PLANE_POINT P1 = nurbs_point(ulo, k, nurbs_control_points, knot_vector);
-    PLANE_POINT P3 = nurbs_point(uhi, k, nurbs_control_points, knot_vector);
-    PLANE_POINT r = {(P3.X - P1.X) / (uhi-ulo), (P3.Y - P1.Y) / (uhi-ulo)};
-    unit(r);
-    return r;
+    std::vector<unsigned int> knot_vector = knot_vector_creator(n, k);	
+    PLANE_POINT P0, P0T, P1, P1T;
+
+    nurbs_point_tangent(0, k, nurbs_control_points, knot_vector, P0, P0T);
+
+    // each knot span is a single polynomial piece; start from those
+    for(unsigned int i=k; i<=n+1; i++) {
+        double u0 = knot_vector[i-1], u1 = knot_vector[i];
+        if(u1 == u0) continue;
+        nurbs_point_tangent(u1, k, nurbs_control_points, knot_vector, P1, P1T);
+        biarcs(lineno, k, nurbs_control_points, knot_vector,
+               u0, P0, P0T, u1, P1, P1T, tolerance, 0, feed);
+        P0 = P1;
+        P0T = P1T;
+    }
 }
@@ -44,6 +44,11 @@ typedef context *context_pointer;
 typedef struct offset_struct offset;
 typedef offset *offset_pointer;
 
+typedef struct param_symbol_struct param_symbol;
+typedef struct expr_program_struct expr_program;
+typedef struct checkpoint_struct checkpoint;
+struct PythonCallable;
+
 // Declare class so that we can use it in the typedef.
 class Interp;
 typedef int (Interp::*read_function_pointer) (char *, int *, block_pointer, double *);
@@ -50,6 +50,9 @@ public:
 // synchronize your internal model with the external world
  int synch();
 
+// resume the open file from the last checkpoint taken before line
+ int restore_checkpoint(int line);
+
 /* Interface functions to call to get information from the interpreter.
    If a function has a return value, the return value contains the information.
    If a function returns nothing, information is copied into one of the
@@ -111,6 +114,8 @@ public:
 
     // for now, public - for boost.python access
  int find_named_param(const char *nameBuf, int *status, double *value);
+ int find_named_param(const param_symbol *symbol, const char *nameBuf,
+                      int *status, double *value);
  int store_named_param(setup_pointer settings,const char *nameBuf, double value, int override_readonly = 0);
  int add_named_param(const char *nameBuf, int attr = 0);
  int fetch_ini_param( const char *nameBuf, int *status, double *value);
@@ -199,9 +204,9 @@ public:
  int convert_cycle(int motion, block_pointer block,
                          setup_pointer settings);
  int convert_cycle_g81(block_pointer block, CANON_PLANE plane, double x, double y,
-                             double clear_z, double bottom_z);
+                             double r, double clear_z, double bottom_z);
  int convert_cycle_g82(block_pointer block, CANON_PLANE plane, double x, double y,
-                             double clear_z, double bottom_z, double dwell);
+                             double r, double clear_z, double bottom_z, double dwell);
  int convert_cycle_g73(block_pointer block, CANON_PLANE plane, double x, double y,
                              double r, double clear_z, double bottom_z,
                              double delta);
@@ -213,9 +218,9 @@ public:
                              CANON_DIRECTION direction,
                              CANON_SPEED_FEED_MODE mode);
  int convert_cycle_g85(block_pointer block, CANON_PLANE plane, double x, double y,
-                             double clear_z, double bottom_z);
+                             double r, double clear_z, double bottom_z);
  int convert_cycle_g86(block_pointer block, CANON_PLANE plane, double x, double y,
-                             double clear_z, double bottom_z, double dwell,
+                             double r, double clear_z, double bottom_z, double dwell,
                              CANON_DIRECTION direction);
  int convert_cycle_g87(block_pointer block, CANON_PLANE plane, double x, double offset_x,
                              double y, double offset_y, double r,
@@ -225,7 +230,7 @@ public:
                              double bottom_z, double dwell,
                              CANON_DIRECTION direction);
  int convert_cycle_g89(block_pointer block, CANON_PLANE plane, double x, double y,
-                             double clear_z, double bottom_z, double dwell);
+                             double r, double clear_z, double bottom_z, double dwell);
  int convert_cycle_xy(int motion, block_pointer block,
                             setup_pointer settings);
  int convert_cycle_yz(int motion, block_pointer block,
@@ -281,13 +286,22 @@ public:
  int convert_tool_length_offset(int g_code, block_pointer block,
                                       setup_pointer settings);
  int convert_tool_select(block_pointer block, setup_pointer settings);
+ int cycle_drill(block_pointer block, CANON_PLANE plane, double r,
+                 double clear, double bottom, double delta, int mode,
+                 double dwell);
  int cycle_feed(block_pointer block, CANON_PLANE plane, double end1,
                 double end2, double end3);
  int cycle_traverse(block_pointer block, CANON_PLANE plane, double end1, double end2,
                           double end3);
  int enhance_block(block_pointer block, setup_pointer settings);
+ int take_checkpoint();
+ int check_checkpoints();
+ int leave_checkpoints();
+ unsigned long long checkpoint_fingerprint(bool modes);
  int _execute(const char *command = 0);
  int execute_binary(double *left, int operation, double *right);
+ int execute_expression(expr_program *program, double *value,
+                        double *parameters);
  int execute_binary1(double *left, int operation, double *right);
  int execute_binary2(double *left, int operation, double *right);
     int execute_block(block_pointer block, setup_pointer settings);
@@ -414,6 +428,10 @@ public:
                   double *parameters);
  int read_real_expression(char *line, int *counter,
                                 double *hold2, double *parameters);
+ int read_cached_expression(char *line, int *counter,
+                                double *value, double *parameters);
+ void record_expression(int opcode, int arg = 0, double value = 0.0,
+                        const char *name = 0);
  int read_real_number(char *line, int *counter, double *double_ptr);
  int read_real_value(char *line, int *counter, double *double_ptr,
                            double *parameters);
@@ -576,6 +594,8 @@ int read_inputs(setup_pointer settings);
 	       const char *module,
 	       const char *funcname,
 	       int calltype);
+    PythonCallable &py_callable(const char *module, const char *funcname);
+    void py_reset_kwargs(context_pointer frame);
     int py_execute(const char *cmd, bool as_file = false); // for (py, ....) comments
     int py_reload();
     FILE *find_ngc_file(setup_pointer settings,const char *basename, char *foundhere = NULL);
@@ -81,6 +81,7 @@ include an option for suppressing superfluous commands.
 #include <libintl.h>
 #include <set>
 #include <stdexcept>
+#include <new>
 
 #include "inifile.hh"		// INIFILE
 #include "rs274ngc.hh"
@@ -111,6 +112,13 @@ Interp::Interp()
     : log_file(stderr)  
 {
     _setup.init_once = 1;  
+    _setup.expr_recording = NULL;
+    _setup.expr_offset = -1;
+    _setup.checkpoint_interval = CHECKPOINT_INTERVAL;
+    _setup.checkpoint_inputs = 0;
+    _setup.checkpoint_checked = true;
+    _setup.checkpoint_setup = 0;
+    _setup.checkpoint_left = false;
     init_named_parameters();  // need this before Python init.
  
     if (!PythonPlugin::instantiate(builtin_modules)) {  // factory
@@ -128,6 +136,7 @@ Interp::Interp()
 	// wrapper instance on every init(), abandoning the old one and all user attributes
 	// tacked onto it, so make sure this is done exactly once
 	_setup.pythis =  boost::python::object(boost::cref(this));
+	_setup.py_self_args = bp::make_tuple(_setup.pythis);
 	
 	// alias to 'interpreter.this' for the sake of ';py, .... ' comments
 	// besides 'this', eventually use proper instance names to handle
@@ -214,6 +223,12 @@ Called By: external programs
 int Interp::close()
 {
     logOword("close()");
+    logDebug("allocations so far: %lu frames entered, %lu parameter tables, "
+	     "%lu strings in %lu bytes, %lu string chunks",
+	     interp_allocs.frames, interp_allocs.table_allocs,
+	     interp_allocs.strings, interp_allocs.string_bytes,
+	     interp_allocs.string_chunks);
+    leave_checkpoints();
     // be "lazy" only if we're not aborting a call in progress
     // in which case we need to reset() the call stack
     // this does not reset the filename properly 
@@ -387,8 +402,7 @@ int Interp::_execute(const char *command)
       //   the current remapped block until done.
       //
       if (eblock->remappings.size() > 0) {
-	  std::set<int>::iterator it;
-	  int next_remap = *eblock->remappings.begin();
+	  int next_remap = eblock->remappings.first();
 	  logRemap("found remap %d in '%s', level=%d filename=%s line=%d",
 		  next_remap,_setup.blocktext,_setup.call_level,_setup.filename,_setup.sequence_number);
 
@@ -424,7 +438,7 @@ int Interp::_execute(const char *command)
 
 	      // the remap phase indicator was returned.
 	      // sanity:
-	      if (cblock->remappings.find(- status) == cblock->remappings.end()) {
+	      if (!cblock->remappings.count(- status)) {
 		  ERS("BUG: execute_block: got %d - not in remappings() !! (next_remap=%d)",- status,next_remap);
 	      }
 	      logRemap("inital phase %d",-status);
@@ -547,16 +561,15 @@ int Interp::remap_finished(int phase)
     // oword return/endsub code called in here.
     if (phase < 0) {
 	// paranoia.
-	if (cblock->remappings.find(-phase) == cblock->remappings.end()) {
+	if (!cblock->remappings.count(-phase)) {
 	    ERS("remap_finished: got %d - not in cblock.remappings!",phase);
 	}
 	// done with this phase.
 	cblock->remappings.erase(-phase);
 	// check the controlling block for the next remapped item
-	std::set<int>::iterator it  = cblock->remappings.begin();
+	next_remap = cblock->remappings.first();
 
-	if (it != cblock->remappings.end()) {
-	    next_remap = *it;
+	if (next_remap >= 0) {
 	    cblock->phase = next_remap;
 
 	    logRemap("starting phase %d  (remap_level=%d call_level=%d)",next_remap,_setup.remap_level,_setup.call_level);
@@ -816,6 +829,7 @@ int Interp::init()
           inifile.Find(&_setup.b_indexer, "LOCKING_INDEXER", "AXIS_4");
           inifile.Find(&_setup.c_indexer, "LOCKING_INDEXER", "AXIS_5");
           inifile.Find(&_setup.orient_offset, "ORIENT_OFFSET", "RS274NGC");
+          inifile.Find(&_setup.checkpoint_interval, "CHECKPOINT_INTERVAL", "RS274NGC");
 
           inifile.Find(&_setup.debugmask, "DEBUG", "EMC");
 
@@ -1062,6 +1076,9 @@ int Interp::init()
 //_setup.speed set in Interp::synch
   _setup.speed_feed_mode = CANON_INDEPENDENT;
   _setup.spindle_mode = CONSTANT_RPM;
+  _setup.css_maximum = 0;
+  _setup.tolerance = -1;
+  _setup.naivecam_tolerance = -1;
 //_setup.speed_override set in Interp::synch
 //_setup.spindle_turning set in Interp::synch
 //_setup.stack does not need initialization
@@ -1294,6 +1311,7 @@ int Interp::open(const char *filename) //!< string: the name of the input NC-pro
   }
   strcpy(_setup.filename, filename);
   reset();
+  _setup.checkpoint_checked = false;
   return INTERP_OK;
 }
 
@@ -1475,6 +1493,11 @@ int Interp::_read(const char *command)  //!< may be NULL or a string to read
   {
       EXECUTING_BLOCK(_setup).offset = ftell(_setup.file_pointer);
   }
+  if (command == NULL)
+      CHP(take_checkpoint());
+
+  // only lines read from a file have a stable position for the expression cache
+  _setup.expr_offset = command ? -1 : EXECUTING_BLOCK(_setup).offset;
 
   read_status =
     read_text(command, _setup.file_pointer, _setup.linetext,
@@ -1631,6 +1654,7 @@ int Interp::reset()
     _setup.linetext[0] = 0;
     _setup.blocktext[0] = 0;
     _setup.line_length = 0;
+    _setup.expr_cache.clear();
 
     unwind_call(INTERP_OK, __FILE__,__LINE__,__FUNCTION__);
     return INTERP_OK;
@@ -2441,16 +2465,56 @@ FILE *Interp::find_ngc_file(setup_pointer settings,const char *basename, char *f
     return newFP;
 }
 
-static std::set<std::string> stringtable;
+interp_alloc_counters interp_allocs;
+
+// strings are copied into large chunks that are never freed and looked
+// up by content, so storing a string that is already there does not
+// allocate
+#define STRSTORE_CHUNK 8192
+
+struct strstore_less {
+    bool operator()(const char *a, const char *b) const {
+	return strcmp(a, b) < 0;
+    }
+};
+
+static std::set<const char *, strstore_less> stringtable;
+static char *chunk_next, *chunk_end;
 
 const char *strstore(const char *s)
 {
     using namespace std;
+    char *copy;
+    size_t len;
 
     if (s == NULL)
         throw invalid_argument("strstore(): NULL argument");
-    pair< set<string>::iterator, bool > pair = stringtable.insert(s);
-    return string(*pair.first).c_str();
+    set<const char *, strstore_less>::iterator it = stringtable.find(s);
+    if (it != stringtable.end())
+	return *it;
+
+    len = strlen(s) + 1;
+    if (len > STRSTORE_CHUNK / 4) {
+	// long strings get a block of their own
+	copy = (char *) malloc(len);
+	interp_allocs.string_chunks++;
+    } else {
+	if ((size_t) (chunk_end - chunk_next) < len) {
+	    chunk_next = (char *) malloc(STRSTORE_CHUNK);
+	    chunk_end = chunk_next ? chunk_next + STRSTORE_CHUNK : NULL;
+	    interp_allocs.string_chunks++;
+	}
+	copy = chunk_next;
+	if (copy)
+	    chunk_next += len;
+    }
+    if (copy == NULL)
+	throw bad_alloc();
+    memcpy(copy, s, len);
+    stringtable.insert(copy);
+    interp_allocs.strings++;
+    interp_allocs.string_bytes += len;
+    return copy;
 }
 
 
@@ -0,0 +1,156 @@
+/* Times what cutter compensation does with the canon queue on a long
+   run of short segments: each segment queues a straight feed, every
+   fourth one also a feed rate and a comment, then the endpoints of the
+   queued moves are moved and the queue is issued and cleared.  Prints
+   the time per segment for canon_queue and for the std::vector of
+   tagged entries with strdup()ed comments it replaced.  If canon_queue
+   issues anything different from the vector, ****fail**** is printed.
+
+   usage: test_canon_queue [segments] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <vector>
+
+#include "rs274ngc.hh"
+#include "interp_queue.hh"
+
+static double sink;
+
+static double now(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static void make_feed(queued_canon &q, int n)
+{
+    memset(&q, 0, sizeof(q));
+    q.type = QSTRAIGHT_FEED;
+    q.data.straight_feed.line_number = n;
+    q.data.straight_feed.dx = 0.01;
+    q.data.straight_feed.x = n * 0.01;
+    q.data.straight_feed.y = 1.0;
+}
+
+static void make_feed_rate(queued_canon &q, int n)
+{
+    memset(&q, 0, sizeof(q));
+    q.type = QSET_FEED_RATE;
+    q.data.set_feed_rate.feed = 100.0 + n;
+}
+
+// issue one entry; sums what canon would be handed
+static void issue(const queued_canon &q, const char *text)
+{
+    switch (q.type) {
+    case QSTRAIGHT_FEED:
+	sink += q.data.straight_feed.x + q.data.straight_feed.y;
+	break;
+    case QSET_FEED_RATE:
+	sink += q.data.set_feed_rate.feed;
+	break;
+    case QCOMMENT:
+	sink += text[0];
+	break;
+    default:
+	break;
+    }
+}
+
+static double run_vector(int segments)
+{
+    std::vector<queued_canon> queue;
+    std::vector<char *> comments;
+    queued_canon q;
+    double start = now();
+
+    for (int n = 0; n < segments; n++) {
+	make_feed(q, n);
+	queue.push_back(q);
+	if (n % 4 == 0) {
+	    make_feed_rate(q, n);
+	    queue.push_back(q);
+	    memset(&q, 0, sizeof(q));
+	    q.type = QCOMMENT;
+	    q.data.comment.offset = comments.size();
+	    comments.push_back(strdup("segment comment"));
+	    queue.push_back(q);
+	}
+	// move the endpoints: every entry is looked at
+	for (size_t i = 0; i < queue.size(); i++) {
+	    if (queue[i].type == QSTRAIGHT_FEED)
+		queue[i].data.straight_feed.y += 0.001;
+	}
+	for (size_t i = 0; i < queue.size(); i++) {
+	    const char *text = "";
+	    if (queue[i].type == QCOMMENT)
+		text = comments[queue[i].data.comment.offset];
+	    issue(queue[i], text);
+	}
+	for (size_t i = 0; i < comments.size(); i++)
+	    free(comments[i]);
+	comments.clear();
+	queue.clear();
+    }
+    return now() - start;
+}
+
+static double run_canon_queue(int segments)
+{
+    canon_queue queue;
+    queued_canon q;
+    double start = now();
+
+    for (int n = 0; n < segments; n++) {
+	make_feed(q, n);
+	queue.push_back(q);
+	if (n % 4 == 0) {
+	    make_feed_rate(q, n);
+	    queue.push_back(q);
+	    memset(&q, 0, sizeof(q));
+	    q.type = QCOMMENT;
+	    q.data.comment.offset = queue.store_comment("segment comment");
+	    queue.push_back(q);
+	}
+	// move the endpoints: only the moves are looked at
+	for (size_t i = 0; i < queue.move_count(); i++)
+	    queue.move(i).data.straight_feed.y += 0.001;
+	for (size_t i = 0; i < queue.size(); i++) {
+	    const char *text = "";
+	    if (queue[i].type == QCOMMENT)
+		text = queue.comment_text(queue[i].data.comment.offset);
+	    issue(queue[i], text);
+	}
+	queue.clear();
+    }
+    return now() - start;
+}
+
+int main(int argc, char **argv)
+{
+    int segments = argc > 1 ? atoi(argv[1]) : 1000000;
+    double t_vector, t_queue, s_vector;
+
+    if (segments <= 0) {
+	fprintf(stderr, "usage: %s [segments]\n", argv[0]);
+	return 1;
+    }
+    t_vector = run_vector(segments);
+    s_vector = sink;
+    sink = 0;
+    t_queue = run_canon_queue(segments);
+    printf("%d segments\n", segments);
+    printf("std::vector, strdup comments: %8.1f ns/segment\n",
+	   t_vector * 1e9 / segments);
+    printf("canon_queue:                  %8.1f ns/segment\n",
+	   t_queue * 1e9 / segments);
+    if (sink != s_vector) {
+	printf("****fail**** canon_queue issued %f, the vector %f\n", sink,
+	       s_vector);
+	return 1;
+    }
+    return 0;
+}
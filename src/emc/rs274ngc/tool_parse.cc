@@ -20,78 +20,158 @@
 #include "emctool.h"
 #include "tool_parse.h"
 
-static bool scan_old_style(
-	char *buffer,
-	CANON_TOOL_TABLE toolTable[],
-	int fms[],
-	char *ttcomments[],
-	int random_toolchanger,
-	int &fakepocket) {
-    int scanned, toolno, pocket, orientation;
+static bool scan_old_style(char *buffer, CANON_TOOL_TABLE &tool,
+	int &pocket, char *comment) {
+    int scanned, toolno, p, orientation;
     double zoffset, xoffset, diameter, frontangle, backangle;
-    char comment[CANON_TOOL_ENTRY_LEN];
 
     if((scanned = sscanf(buffer, "%d %d %lf %lf %lf %lf %lf %d %[^\n]",
-			 &toolno, &pocket, &zoffset, &xoffset, &diameter,
+			 &toolno, &p, &zoffset, &xoffset, &diameter,
 			 &frontangle, &backangle, &orientation, comment)) &&
        (scanned == 8 || scanned == 9)) {
-	if(!random_toolchanger) {
-	    fakepocket++;
-	    if(fakepocket >= CANON_POCKETS_MAX) {
-		printf("too many tools. skipping tool %d\n", toolno);
-		return true;
-	    }
-	    if(fms) fms[fakepocket] = pocket;
-	    pocket = fakepocket;
-	}
-	if (pocket < 0 || pocket >= CANON_POCKETS_MAX) {
-	    printf("max pocket number is %d. skipping tool %d\n", CANON_POCKETS_MAX-1, toolno);
-	    return true;
-	} else {
-	    /* lathe tool */
-	    toolTable[pocket].toolno = toolno;
-	    toolTable[pocket].offset.tran.z = zoffset;
-	    toolTable[pocket].offset.tran.x = xoffset;
-	    toolTable[pocket].diameter = diameter;
-
-	    toolTable[pocket].frontangle = frontangle;
-	    toolTable[pocket].backangle = backangle;
-	    toolTable[pocket].orientation = orientation;
-	    if(ttcomments && scanned == 9) strcpy(ttcomments[pocket], comment);
-	    return true;
-	}
+	/* lathe tool */
+	tool.toolno = toolno;
+	tool.offset.tran.z = zoffset;
+	tool.offset.tran.x = xoffset;
+	tool.diameter = diameter;
+	tool.frontangle = frontangle;
+	tool.backangle = backangle;
+	tool.orientation = orientation;
+	if(scanned == 8) comment[0] = '\0';
+	pocket = p;
+	return true;
     } else if ((scanned = sscanf(buffer, "%d %d %lf %lf %[^\n]",
-				 &toolno, &pocket, &zoffset, &diameter, comment)) &&
+				 &toolno, &p, &zoffset, &diameter, comment)) &&
 	       (scanned == 4 || scanned == 5)) {
-	if(!random_toolchanger) {
-	    fakepocket++;
-	    if(fakepocket >= CANON_POCKETS_MAX) {
-		printf("too many tools. skipping tool %d\n", toolno);
-		return true;
-	    }
-	    if(fms) fms[fakepocket] = pocket;
-	    pocket = fakepocket;
-	}
-	if (pocket < 0 || pocket >= CANON_POCKETS_MAX) {
-	    printf("max pocket number is %d. skipping tool %d\n", CANON_POCKETS_MAX-1, toolno);
-	    return true;
-	} else {
-	    /* mill tool */
-	    toolTable[pocket].toolno = toolno;
-	    toolTable[pocket].offset.tran.z = zoffset;
-	    toolTable[pocket].diameter = diameter;
-
-	    // these aren't used on a mill
-	    toolTable[pocket].frontangle = toolTable[pocket].backangle = 0.0;
-	    toolTable[pocket].offset.tran.x = 0.0;
-	    toolTable[pocket].orientation = 0;
-	    if(ttcomments && scanned == 5) strcpy(ttcomments[pocket], comment);
-	    return true;
-	}
+	/* mill tool */
+	tool.toolno = toolno;
+	tool.offset.tran.z = zoffset;
+	tool.diameter = diameter;
+	if(scanned == 4) comment[0] = '\0';
+	pocket = p;
+	return true;
     }
     return false;
 }
 
+int parseToolLine(char *buffer, struct CANON_TOOL_TABLE *tool,
+	int *pocket, char *comment)
+{
+    const char *token;
+    char *buff, *c;
+    int valid = 1, has_pocket = 0;
+
+    tool->toolno = -1;
+    ZERO_EMC_POSE(tool->offset);
+    tool->diameter = tool->frontangle = tool->backangle = 0.0;
+    tool->orientation = 0;
+    comment[0] = '\0';
+
+    if(scan_old_style(buffer, *tool, *pocket, comment)) return 1;
+
+    buff = strtok(buffer, ";");
+    c = strtok(NULL, "\n");
+    if (c) {
+        strncpy(comment, c, CANON_TOOL_ENTRY_LEN - 1);
+        comment[CANON_TOOL_ENTRY_LEN - 1] = '\0';
+    }
+
+    token = strtok(buff, " ");
+    while (token != NULL) {
+        switch (toupper(token[0])) {
+        case 'T':
+            if (sscanf(&token[1], "%d", &tool->toolno) != 1)
+                valid = 0;
+            break;
+        case 'P':
+            if (sscanf(&token[1], "%d", pocket) != 1)
+                valid = 0;
+            else
+                has_pocket = 1;
+            break;
+        case 'D':
+            if (sscanf(&token[1], "%lf", &tool->diameter) != 1)
+                valid = 0;
+            break;
+        case 'X':
+            if (sscanf(&token[1], "%lf", &tool->offset.tran.x) != 1)
+                valid = 0;
+            break;
+        case 'Y':
+            if (sscanf(&token[1], "%lf", &tool->offset.tran.y) != 1)
+                valid = 0;
+            break;
+        case 'Z':
+            if (sscanf(&token[1], "%lf", &tool->offset.tran.z) != 1)
+                valid = 0;
+            break;
+        case 'A':
+            if (sscanf(&token[1], "%lf", &tool->offset.a) != 1)
+                valid = 0;
+            break;
+        case 'B':
+            if (sscanf(&token[1], "%lf", &tool->offset.b) != 1)
+                valid = 0;
+            break;
+        case 'C':
+            if (sscanf(&token[1], "%lf", &tool->offset.c) != 1)
+                valid = 0;
+            break;
+        case 'U':
+            if (sscanf(&token[1], "%lf", &tool->offset.u) != 1)
+                valid = 0;
+            break;
+        case 'V':
+            if (sscanf(&token[1], "%lf", &tool->offset.v) != 1)
+                valid = 0;
+            break;
+        case 'W':
+            if (sscanf(&token[1], "%lf", &tool->offset.w) != 1)
+                valid = 0;
+            break;
+        case 'I':
+            if (sscanf(&token[1], "%lf", &tool->frontangle) != 1)
+                valid = 0;
+            break;
+        case 'J':
+            if (sscanf(&token[1], "%lf", &tool->backangle) != 1)
+                valid = 0;
+            break;
+        case 'Q':
+            if (sscanf(&token[1], "%d", &tool->orientation) != 1)
+                valid = 0;
+            break;
+        default:
+            if (strncmp(token, "\n", 1) != 0)
+                valid = 0;
+            break;
+        }
+        token = strtok(NULL, " ");
+    }
+    if (!valid) return -1;
+    return has_pocket ? 1 : 0;
+}
+
+void formatToolLine(FILE *fp, const struct CANON_TOOL_TABLE *tool,
+	int pocket, const char *comment)
+{
+    fprintf(fp, "T%d P%d", tool->toolno, pocket);
+    if (tool->diameter) fprintf(fp, " D%f", tool->diameter);
+    if (tool->offset.tran.x) fprintf(fp, " X%+f", tool->offset.tran.x);
+    if (tool->offset.tran.y) fprintf(fp, " Y%+f", tool->offset.tran.y);
+    if (tool->offset.tran.z) fprintf(fp, " Z%+f", tool->offset.tran.z);
+    if (tool->offset.a) fprintf(fp, " A%+f", tool->offset.a);
+    if (tool->offset.b) fprintf(fp, " B%+f", tool->offset.b);
+    if (tool->offset.c) fprintf(fp, " C%+f", tool->offset.c);
+    if (tool->offset.u) fprintf(fp, " U%+f", tool->offset.u);
+    if (tool->offset.v) fprintf(fp, " V%+f", tool->offset.v);
+    if (tool->offset.w) fprintf(fp, " W%+f", tool->offset.w);
+    if (tool->frontangle) fprintf(fp, " I%+f", tool->frontangle);
+    if (tool->backangle) fprintf(fp, " J%+f", tool->backangle);
+    if (tool->orientation) fprintf(fp, " Q%d", tool->orientation);
+    fprintf(fp, " ;%s\n", comment ? comment : "");
+}
+
 int loadToolTable(const char *filename,
 			 CANON_TOOL_TABLE toolTable[],
 			 int fms[],
@@ -103,6 +183,7 @@ int loadToolTable(const char *filename,
     FILE *fp;
     char buffer[CANON_TOOL_ENTRY_LEN];
     char orig_line[CANON_TOOL_ENTRY_LEN];
+    char comment[CANON_TOOL_ENTRY_LEN];
     int pocket = 0;
 
     if(!filename) return -1;
@@ -135,11 +216,8 @@ int loadToolTable(const char *filename,
     */
 
     while (!feof(fp)) {
-        const char *token;
-        char *buff, *comment;
-        int toolno, orientation, valid = 1;
-        EmcPose offset;  // tlo
-        double diameter, frontangle, backangle;
+        CANON_TOOL_TABLE tool;
+        int result;
 
         // for nonrandom machines, just read the tools into pockets 1..n
         // no matter their tool numbers.  NB leave the spindle pocket 0
@@ -150,116 +228,27 @@ int loadToolTable(const char *filename,
         }
         strcpy(orig_line, buffer);
 
-        if(scan_old_style(buffer, toolTable, fms, ttcomments,
-                                random_toolchanger, fakepocket)) continue;
-
-        toolno = -1;
-        diameter = frontangle = backangle = 0.0;
-        orientation = 0;
-        ZERO_EMC_POSE(offset);
-        buff = strtok(buffer, ";");
-        comment = strtok(NULL, "\n");
-
-        token = strtok(buff, " ");
-        while (token != NULL) {
-            switch (toupper(token[0])) {
-            case 'T':
-                if (sscanf(&token[1], "%d", &toolno) != 1)
-                    valid = 0;
-                break;
-            case 'P':
-                if (sscanf(&token[1], "%d", &pocket) != 1) {
-                    valid = 0;
-                    break;
-                }
-                if (!random_toolchanger) {
-                    fakepocket++;
-                    if (fakepocket >= CANON_POCKETS_MAX) {
-                        printf("too many tools. skipping tool %d\n", toolno);
-                        valid = 0;
-                        break;
-                    }
-                    if(fms) fms[fakepocket] = pocket;
-                    pocket = fakepocket;
-                }
-                if (pocket < 0 || pocket >= CANON_POCKETS_MAX) {
-                    printf("max pocket number is %d. skipping tool %d\n", CANON_POCKETS_MAX - 1, toolno);
-                    valid = 0;
-                    break;
-                }
-                break;
-            case 'D':
-                if (sscanf(&token[1], "%lf", &diameter) != 1)
-                    valid = 0;
-                break;
-            case 'X':
-                if (sscanf(&token[1], "%lf", &offset.tran.x) != 1)
-                    valid = 0;
-                break;
-            case 'Y':
-                if (sscanf(&token[1], "%lf", &offset.tran.y) != 1)
-                    valid = 0;
-                break;
-            case 'Z':
-                if (sscanf(&token[1], "%lf", &offset.tran.z) != 1)
-                    valid = 0;
-                break;
-            case 'A':
-                if (sscanf(&token[1], "%lf", &offset.a) != 1)
-                    valid = 0;
-                break;
-            case 'B':
-                if (sscanf(&token[1], "%lf", &offset.b) != 1)
-                    valid = 0;
-                break;
-            case 'C':
-                if (sscanf(&token[1], "%lf", &offset.c) != 1)
-                    valid = 0;
-                break;
-            case 'U':
-                if (sscanf(&token[1], "%lf", &offset.u) != 1)
-                    valid = 0;
-                break;
-            case 'V':
-                if (sscanf(&token[1], "%lf", &offset.v) != 1)
-                    valid = 0;
-                break;
-            case 'W':
-                if (sscanf(&token[1], "%lf", &offset.w) != 1)
-                    valid = 0;
-                break;
-            case 'I':
-                if (sscanf(&token[1], "%lf", &frontangle) != 1)
-                    valid = 0;
-                break;
-            case 'J':
-                if (sscanf(&token[1], "%lf", &backangle) != 1)
-                    valid = 0;
-                break;
-            case 'Q':
-                if (sscanf(&token[1], "%d", &orientation) != 1)
-                    valid = 0;
-                break;
-            default:
-                if (strncmp(token, "\n", 1) != 0)
-                    valid = 0;
-                break;
+        result = parseToolLine(buffer, &tool, &pocket, comment);
+        if (result < 0) {
+            fprintf(stderr, "Unrecognized line skipped: %s", orig_line);
+            continue;
+        }
+        if (result > 0 && !random_toolchanger) {
+            fakepocket++;
+            if (fakepocket >= CANON_POCKETS_MAX) {
+                printf("too many tools. skipping tool %d\n", tool.toolno);
+                continue;
             }
-            token = strtok(NULL, " ");
+            if(fms) fms[fakepocket] = pocket;
+            pocket = fakepocket;
         }
-        if (valid) {
-            toolTable[pocket].toolno = toolno;
-            toolTable[pocket].offset = offset;
-            toolTable[pocket].diameter = diameter;
-            toolTable[pocket].frontangle = frontangle;
-            toolTable[pocket].backangle = backangle;
-            toolTable[pocket].orientation = orientation;
-
-            if (ttcomments && comment)
-                strcpy(ttcomments[pocket], comment);
-        } else {
-            fprintf(stderr, "Unrecognized line skipped: %s", orig_line);
+        if (pocket < 0 || pocket >= CANON_POCKETS_MAX) {
+            printf("max pocket number is %d. skipping tool %d\n", CANON_POCKETS_MAX - 1, tool.toolno);
+            continue;
         }
+        toolTable[pocket] = tool;
+        if (ttcomments) strcpy(ttcomments[pocket], comment);
+
         if (!random_toolchanger && toolTable[0].toolno == toolTable[pocket].toolno) {
             toolTable[0] = toolTable[pocket];
         }
@@ -16,11 +16,23 @@
 #ifndef TOOL_PARSE_H
 #define TOOL_PARSE_H
 
+#include <stdio.h>
 #include "emctool.h"
 #ifdef CPLUSPLUS
 extern "C"  {
 #endif
 
+/* parseToolLine() parses one line of a tool table file into tool and
+   comment (CANON_TOOL_ENTRY_LEN long).  pocket is only set if the line
+   names one.  Returns 1 if it did, 0 if not, or -1 if the line is not
+   valid.  buffer is modified. */
+int parseToolLine(char *buffer, struct CANON_TOOL_TABLE *tool,
+	int *pocket, char *comment);
+
+/* formatToolLine() writes tool as one line of a tool table file */
+void formatToolLine(FILE *fp, const struct CANON_TOOL_TABLE *tool,
+	int pocket, const char *comment);
+
 int loadToolTable(const char *filename,
 	struct CANON_TOOL_TABLE toolTable[CANON_POCKETS_MAX],
 	int fms[CANON_POCKETS_MAX],
@@ -0,0 +1,213 @@
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#include <stdio.h>
+#include <string.h>
+#include "tool_parse.h"
+#include "tool_store.hh"
+
+ToolStore::ToolStore() : random_toolchanger(0), change_count(0) {}
+
+int ToolStore::load(const char *filename, int random)
+{
+    FILE *fp;
+    char buffer[CANON_TOOL_ENTRY_LEN];
+    char orig_line[CANON_TOOL_ENTRY_LEN];
+    char comment[CANON_TOOL_ENTRY_LEN];
+    int pocket = 0;
+
+    if(!filename) return -1;
+    if (NULL == (fp = fopen(filename, "r"))) {
+	return -1;
+    }
+
+    random_toolchanger = random;
+    entries.clear();
+    by_tool.clear();
+    by_pocket.clear();
+
+    while (NULL != fgets(buffer, CANON_TOOL_ENTRY_LEN, fp)) {
+        TOOL_STORE_ENTRY e;
+
+        strcpy(orig_line, buffer);
+        if (parseToolLine(buffer, &e.tool, &pocket, comment) < 0) {
+            fprintf(stderr, "Unrecognized line skipped: %s", orig_line);
+            continue;
+        }
+        if (pocket < 0) {
+            printf("bad pocket number %d. skipping tool %d\n", pocket, e.tool.toolno);
+            continue;
+        }
+        e.pocket = pocket;
+        e.comment = comment;
+
+        std::map<int, int>::iterator it = by_pocket.find(pocket);
+        if (random_toolchanger && it != by_pocket.end()) {
+            // a later line for the same pocket replaces the earlier one
+            entries[it->second] = e;
+            continue;
+        }
+        entries.push_back(e);
+        by_pocket[pocket] = entries.size() - 1;
+    }
+    fclose(fp);
+
+    reindex();
+    change_count++;
+
+    if (!random_toolchanger && size() >= CANON_POCKETS_MAX) {
+        printf("%d tools in %s; only the first %d can be selected\n",
+               size(), filename, CANON_POCKETS_MAX - 1);
+    } else if (random_toolchanger && !by_pocket.empty()
+               && by_pocket.rbegin()->first >= CANON_POCKETS_MAX) {
+        printf("pockets above %d in %s can't be selected\n",
+               CANON_POCKETS_MAX - 1, filename);
+    }
+    return 0;
+}
+
+int ToolStore::save(const char *filename) const
+{
+    std::string tmpname = std::string(filename) + ".tmp";
+    FILE *fp;
+
+    // write a new file and rename it over the old one, so a crash
+    // while saving can't lose the table
+    if (NULL == (fp = fopen(tmpname.c_str(), "w"))) {
+	return -1;
+    }
+    if (random_toolchanger) {
+        std::map<int, int>::const_iterator it;
+        for (it = by_pocket.begin(); it != by_pocket.end(); it++) {
+            const TOOL_STORE_ENTRY &e = entries[it->second];
+            if (e.tool.toolno != -1)
+                formatToolLine(fp, &e.tool, e.pocket, e.comment.c_str());
+        }
+    } else {
+        for (size_t i = 0; i < entries.size(); i++) {
+            const TOOL_STORE_ENTRY &e = entries[i];
+            if (e.tool.toolno != -1)
+                formatToolLine(fp, &e.tool, e.pocket, e.comment.c_str());
+        }
+    }
+    if (fclose(fp) != 0 || rename(tmpname.c_str(), filename) != 0) {
+        remove(tmpname.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+int ToolStore::find_tool(int toolno) const
+{
+    std::map<int, int>::const_iterator it = by_tool.find(toolno);
+    return it == by_tool.end() ? -1 : it->second;
+}
+
+int ToolStore::find_slot(int slot) const
+{
+    if (random_toolchanger) {
+        std::map<int, int>::const_iterator it = by_pocket.find(slot);
+        return it == by_pocket.end() ? -1 : it->second;
+    }
+    return slot >= 1 && slot <= size() ? slot - 1 : -1;
+}
+
+void ToolStore::set_tool(int index, const CANON_TOOL_TABLE &tool)
+{
+    int renumbered = entries[index].tool.toolno != tool.toolno;
+
+    entries[index].tool = tool;
+    if (renumbered) reindex();
+    change_count++;
+}
+
+int ToolStore::add_tool(const CANON_TOOL_TABLE &tool, int pocket,
+                        const char *comment)
+{
+    TOOL_STORE_ENTRY e;
+    int index = entries.size();
+
+    e.tool = tool;
+    e.pocket = pocket;
+    e.comment = comment ? comment : "";
+    entries.push_back(e);
+    by_tool.insert(std::make_pair(tool.toolno, index));
+    by_pocket[pocket] = index;
+    change_count++;
+    return index;
+}
+
+int ToolStore::place_tool(int slot, const CANON_TOOL_TABLE &tool)
+{
+    int index = find_slot(slot);
+
+    if (index >= 0) {
+        set_tool(index, tool);
+        return index;
+    }
+    if (!random_toolchanger) {
+        // slot n is the n'th tool, so fill the gap with empty tools;
+        // save() leaves them out of the file
+        CANON_TOOL_TABLE empty;
+        memset(&empty, 0, sizeof(empty));
+        empty.toolno = -1;
+        while (size() < slot - 1)
+            add_tool(empty, size() + 1, "");
+    }
+    return add_tool(tool, slot, "");
+}
+
+void ToolStore::swap_pockets(int a, int b)
+{
+    int ia = find_slot(a), ib = find_slot(b);
+
+    by_pocket.erase(a);
+    by_pocket.erase(b);
+    if (ia >= 0) {
+        entries[ia].pocket = b;
+        by_pocket[b] = ia;
+    }
+    if (ib >= 0) {
+        entries[ib].pocket = a;
+        by_pocket[a] = ib;
+    }
+    change_count++;
+}
+
+void ToolStore::fill_table(CANON_TOOL_TABLE table[], int first) const
+{
+    for (int slot = first; slot < CANON_POCKETS_MAX; slot++) {
+        int index = find_slot(slot);
+        if (index >= 0) {
+            table[slot] = entries[index].tool;
+        } else {
+            table[slot].toolno = -1;
+            ZERO_EMC_POSE(table[slot].offset);
+            table[slot].diameter = 0.0;
+            table[slot].frontangle = 0.0;
+            table[slot].backangle = 0.0;
+            table[slot].orientation = 0;
+        }
+    }
+}
+
+void ToolStore::reindex()
+{
+    by_tool.clear();
+    by_pocket.clear();
+    for (size_t i = 0; i < entries.size(); i++) {
+        // the first tool with a number wins, as in the interpreter
+        by_tool.insert(std::make_pair(entries[i].tool.toolno, (int)i));
+        by_pocket[entries[i].pocket] = i;
+    }
+}
@@ -0,0 +1,80 @@
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+#ifndef TOOL_STORE_HH
+#define TOOL_STORE_HH
+
+#include <map>
+#include <string>
+#include <vector>
+#include "emctool.h"
+
+struct TOOL_STORE_ENTRY {
+    CANON_TOOL_TABLE tool;
+    int pocket;			// pocket as written in the tool table file
+    std::string comment;
+};
+
+/*
+  ToolStore holds every tool in a tool table file, with no limit on
+  their number, indexed by tool number and by pocket.  The fixed
+  CANON_POCKETS_MAX table in EMC_TOOL_STAT is filled from it as a view:
+  on a random toolchanger slot n of the view is pocket n, otherwise slot
+  n is the n'th tool in the file and slot 0 is left to the caller.
+  The interpreter, canon and the GUIs only ever see the view, so tools
+  outside it are kept and saved, but can't be selected.
+*/
+class ToolStore {
+public:
+    ToolStore();
+
+    // replace the contents with the tools in filename
+    int load(const char *filename, int random_toolchanger);
+    // write every tool back to filename
+    int save(const char *filename) const;
+
+    int size() const { return entries.size(); }
+    TOOL_STORE_ENTRY &operator[](int index) { return entries[index]; }
+
+    // index of the first tool with this tool number, or -1
+    int find_tool(int toolno) const;
+    // index of the tool in this view slot, or -1
+    int find_slot(int slot) const;
+
+    // change one tool in place, keeping its pocket and comment
+    void set_tool(int index, const CANON_TOOL_TABLE &tool);
+    // add a tool at the end; returns its index
+    int add_tool(const CANON_TOOL_TABLE &tool, int pocket, const char *comment);
+    // put a tool in a view slot, replacing the one there or adding it;
+    // returns its index
+    int place_tool(int slot, const CANON_TOOL_TABLE &tool);
+    // exchange the tools in two pockets of a random toolchanger
+    void swap_pockets(int a, int b);
+
+    // copy view slots first..CANON_POCKETS_MAX-1 into table
+    void fill_table(CANON_TOOL_TABLE table[], int first) const;
+
+    // incremented by every change to the store
+    int changes() const { return change_count; }
+
+private:
+    void reindex();
+
+    std::vector<TOOL_STORE_ENTRY> entries;
+    std::map<int, int> by_tool;
+    std::map<int, int> by_pocket;
+    int random_toolchanger;
+    int change_count;
+};
+
+#endif
@@ -237,20 +237,27 @@ If the do_next argument is 0, an error does not stop interpretation.
 
 If the do_next argument is 2, an error stops interpretation.
 
+If the stop_after argument is not 0, this stops after that many blocks
+have been read, as if the program had been aborted there.
+
 */
 
 int interpret_from_file( /* ARGUMENTS                  */
  int do_next,            /* what to do if error        */
  int block_delete,       /* switch which is ON or OFF  */
- int print_stack)        /* option which is ON or OFF  */
+ int print_stack,        /* option which is ON or OFF  */
+ int stop_after)         /* blocks to read, 0 for all  */
 {
   int status=0;
+  int blocks=0;
   char line[LINELEN];
 
   SET_BLOCK_DELETE(block_delete);
 
   for(; ;)
     {
+      if ((stop_after > 0) && (blocks++ == stop_after))
+        break;
       status = interp_read();
       if ((status == INTERP_EXECUTE_FINISH) && (block_delete == ON))
         continue;
@@ -307,6 +314,71 @@ int interpret_from_file( /* ARGUMENTS                  */
 
 /************************************************************************/
 
+/* resume_from_line
+
+Returned Value: int (0 or 1)
+   If any of the following errors occur, this returns 1.
+   Otherwise, it returns 0.
+   1. The interpreter is not the built-in one.
+   2. The open NC-program file cannot be interpreted or opened again.
+
+Side Effects:
+   The open NC-program file is interpreted with the canonical commands
+   thrown away, so the interpreter takes its checkpoints, all of it or
+   only the first stop_after blocks. The file is then opened again and
+   the interpreter is put back to the last checkpoint before the given
+   line.
+
+Called By:
+   main
+
+This emulates the way the EMC system runs a program from a line after
+it has been run, or aborted part way through.
+
+*/
+
+int resume_from_line( /* ARGUMENTS                  */
+ const char *filename,   /* name of the open file     */
+ int line,               /* line to run from          */
+ int stop_after,         /* blocks to read, 0 for all  */
+ int block_delete,       /* switch which is ON or OFF  */
+ int print_stack)        /* option which is ON or OFF  */
+{
+  Interp *interp = dynamic_cast<Interp*>(pinterp);
+  FILE *outfile = _outfile;
+  int status = 0;
+
+  if (interp == NULL)
+    {
+      fprintf(stderr, "-r needs the built-in interpreter\n");
+      return 1;
+    }
+  _outfile = fopen("/dev/null", "w");
+  if (_outfile == NULL)
+    {
+      _outfile = outfile;
+      fprintf(stderr, "could not open /dev/null\n");
+      return 1;
+    }
+  status = interpret_from_file(2, block_delete, print_stack, stop_after);
+  interp_close();
+  fclose(_outfile);
+  _outfile = outfile;
+  if (status != 0)
+    return 1;
+
+  status = interp_open(filename);
+  if (status != INTERP_OK)
+    {
+      report_error(status, print_stack);
+      return 1;
+    }
+  fprintf(stderr, "resuming after line %d\n", interp->restore_checkpoint(line));
+  return 0;
+}
+
+/************************************************************************/
+
 /* read_tool_file
 
 Returned Value: int
@@ -546,6 +618,8 @@ int main (int argc, char ** argv)
   int go_flag;
   char *inifile = NULL;
   int log_level = -1;
+  int resume_line = 0;
+  int stop_after = 0;
   std::string interp;
 
   do_next = 2;  /* 2=stop */
@@ -557,7 +631,7 @@ int main (int argc, char ** argv)
   go_flag = 0;
 
   while(1) {
-      int c = getopt(argc, argv, "p:t:v:bsn:gi:l:T");
+      int c = getopt(argc, argv, "p:t:v:bsn:gi:l:Tr:R:");
       if(c == -1) break;
 
       switch(c) {
@@ -571,6 +645,8 @@ int main (int argc, char ** argv)
           case 'g': go_flag = !go_flag; break;
           case 'i': inifile = optarg; break;
           case 'T': _task = 1; break;
+          case 'r': resume_line = atoi(optarg); break;
+          case 'R': stop_after = atoi(optarg); break;
           case '?': default: goto usage;
       }
   }
@@ -580,7 +656,7 @@ int main (int argc, char ** argv)
 usage:
       fprintf(stderr,
             "Usage: %s [-p interp.so] [-t tool.tbl] [-v var-file.var] [-n 0|1|2]\n"
-            "          [-b] [-s] [-g] [input file [output file]]\n"
+            "          [-b] [-s] [-g] [-r line [-R blocks]] [input file [output file]]\n"
             "\n"
             "    -p: Specify the pluggable interpreter to use\n"
             "    -t: Specify the .tbl (tool table) file to use\n"
@@ -595,6 +671,9 @@ usage:
             "    -i: specify the .ini file (default: no ini file)\n"
             "    -T: call task_init()\n"
             "    -l: specify the log_level (default: -1)\n"
+            "    -r: read the file once, then run it from the last checkpoint\n"
+            "        before the given line\n"
+            "    -R: with -r, only read this many blocks the first time\n"
             , argv[0]);
       exit(1);
     }
@@ -681,7 +760,11 @@ usage:
           report_error(status, print_stack);
           exit(1);
         }
-      status = interpret_from_file(do_next, block_delete, print_stack);
+      if ((resume_line > 0) &&
+          (resume_from_line(argv[1], resume_line, stop_after, block_delete,
+                            print_stack) != 0))
+        exit(1);
+      status = interpret_from_file(do_next, block_delete, print_stack, 0);
       file_name(buffer, 5);  /* called to exercise the function */
       file_name(buffer, 79); /* called to exercise the function */
       interp_close();
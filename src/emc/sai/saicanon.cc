@@ -419,15 +419,34 @@ void STOP_SPEED_FEED_SYNCH()
 
 /* Machining Functions */
 
+static void nurbs_arc(int lineno, double x, double y,
+ double cx, double cy, int rotation)
+{
+  if (rotation)
+    ARC_FEED(lineno, x, y, cx, cy, rotation, _program_position_z,
+             _program_position_a, _program_position_b, _program_position_c,
+             0, 0, 0);
+  else
+    STRAIGHT_FEED(lineno, x, y, _program_position_z,
+                  _program_position_a, _program_position_b,
+                  _program_position_c, 0, 0, 0);
+}
+
+/* Prints the call, then the moves the canon in task makes of the curve,
+   so the curve can be checked in the output. */
 void NURBS_FEED(int lineno,
 std::vector<CONTROL_POINT> nurbs_control_points, unsigned int k)
 {
+  double tolerance = motion_tolerance;
+
   fprintf(_outfile, "%5d ", _line_number++);
   print_nc_line_number();
   fprintf(_outfile, "NURBS_FEED(%lu, ...)\n", (unsigned long)nurbs_control_points.size());
 
-  _program_position_x = nurbs_control_points[nurbs_control_points.size()].X;
-  _program_position_y = nurbs_control_points[nurbs_control_points.size()].Y;
+  if (tolerance <= 0)
+    tolerance = (_length_unit_type == CANON_UNITS_MM) ?
+      NURBS_DEFAULT_TOLERANCE : NURBS_DEFAULT_TOLERANCE / 25.4;
+  nurbs_biarcs(lineno, nurbs_control_points, k, tolerance, nurbs_arc);
 }
 
 void ARC_FEED(int line_number,
@@ -569,6 +588,69 @@ void RIGID_TAP(int line_number, double x, double y, double z)
 
 }
 
+/* The drill cycle is printed as the moves it is made of, the way the
+interpreter used to write them itself. The u, v and w axes are not
+tracked here, so cycles in the UV, VW and UW planes start from 0. */
+
+void DRILL_CYCLE(int line_number, CANON_PLANE plane,
+                 double r, double clear, double bottom,
+                 double peck, double backoff, int mode, double dwell)
+{
+  DRILL_CYCLE_PARAMS params;
+  DRILL_CYCLE_STATE state;
+  DRILL_CYCLE_STEP step;
+  double pos[9] = {_program_position_x, _program_position_y,
+                   _program_position_z, _program_position_a,
+                   _program_position_b, _program_position_c, 0, 0, 0};
+  int axis;
+
+  if (plane == CANON_PLANE_XY) axis = 2;
+  else if (plane == CANON_PLANE_YZ) axis = 0;
+  else if (plane == CANON_PLANE_XZ) axis = 1;
+  else if (plane == CANON_PLANE_UV) axis = 8;
+  else if (plane == CANON_PLANE_VW) axis = 6;
+  else axis = 7;
+
+  params.start = pos[axis];
+  params.r = r;
+  params.bottom = bottom;
+  params.clear = clear;
+  params.peck = peck;
+  params.backoff = backoff;
+  params.dwell = dwell;
+  params.mode = mode;
+
+  drillCycleInit(&params, &state);
+  while (drillCycleStep(&params, &state, &step))
+    {
+      if (step.kind == DRILL_STEP_DWELL)
+        {
+          DWELL(step.seconds);
+          continue;
+        }
+      if (step.kind == DRILL_STEP_SPINDLE_STOP)
+        {
+          STOP_SPINDLE_TURNING();
+          continue;
+        }
+      if (step.kind == DRILL_STEP_SPINDLE_START)
+        {
+          if (mode & DRILL_SPINDLE_CCW)
+            START_SPINDLE_COUNTERCLOCKWISE();
+          else
+            START_SPINDLE_CLOCKWISE();
+          continue;
+        }
+      pos[axis] = step.to;
+      if (step.kind == DRILL_STEP_FEED)
+        STRAIGHT_FEED(line_number, pos[0], pos[1], pos[2], pos[3], pos[4],
+                      pos[5], pos[6], pos[7], pos[8]);
+      else
+        STRAIGHT_TRAVERSE(line_number, pos[0], pos[1], pos[2], pos[3],
+                          pos[4], pos[5], pos[6], pos[7], pos[8]);
+    }
+}
+
 
 void DWELL(double seconds)
 {PRINT1("DWELL(%.4f)\n", seconds);}
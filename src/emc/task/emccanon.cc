@@ -1042,6 +1042,131 @@ void RIGID_TAP(int line_number, double x, double y, double z)
 }
 
 
+/*
+  DRILL_CYCLE sends the whole cycle as a single message, which motion
+  queues as one segment and expands into its moves while it runs.  Its
+  levels stay in program units; unit is how far the tool moves in
+  machine coordinates for one unit of level, and the cycle starts at
+  the current position.  In feed per revolution mode the traverses need
+  the synchronization turned off and on, so there the cycle is sent as
+  separate moves like before.
+*/
+
+void DRILL_CYCLE(int line_number, CANON_PLANE plane,
+                 double r, double clear, double bottom,
+                 double peck, double backoff, int mode, double dwell)
+{
+    double pos[9], end[9], unit[9];
+    double vel, ini_maxvel, rapid_vel, acc;
+    int axis;
+    EMC_TRAJ_DRILL_CYCLE drillCycleMsg;
+    CANON_POSITION prog;
+
+    if (plane == CANON_PLANE_XY) axis = 2;
+    else if (plane == CANON_PLANE_YZ) axis = 0;
+    else if (plane == CANON_PLANE_XZ) axis = 1;
+    else if (plane == CANON_PLANE_UV) axis = 8;
+    else if (plane == CANON_PLANE_VW) axis = 6;
+    else axis = 7;
+
+    flush_segments();
+
+    prog = unoffset_and_unrotate_pos(canonEndPoint);
+    to_prog(prog);
+    pos[0] = prog.x; pos[1] = prog.y; pos[2] = prog.z;
+    pos[3] = prog.a; pos[4] = prog.b; pos[5] = prog.c;
+    pos[6] = prog.u; pos[7] = prog.v; pos[8] = prog.w;
+
+    drillCycleMsg.start = pos[axis];
+    drillCycleMsg.r = r;
+    drillCycleMsg.bottom = bottom;
+    drillCycleMsg.clear = clear;
+    drillCycleMsg.peck = peck;
+    drillCycleMsg.backoff = backoff;
+    drillCycleMsg.dwell = dwell;
+    drillCycleMsg.mode = mode;
+
+    if (feed_mode) {
+        DRILL_CYCLE_PARAMS params;
+        DRILL_CYCLE_STATE state;
+        DRILL_CYCLE_STEP step;
+
+        params.start = drillCycleMsg.start;
+        params.r = r;
+        params.bottom = bottom;
+        params.clear = clear;
+        params.peck = peck;
+        params.backoff = backoff;
+        params.dwell = dwell;
+        params.mode = mode;
+
+        drillCycleInit(&params, &state);
+        while (drillCycleStep(&params, &state, &step)) {
+            if (step.kind == DRILL_STEP_DWELL) {
+                DWELL(step.seconds);
+                continue;
+            }
+            if (step.kind == DRILL_STEP_SPINDLE_STOP) {
+                STOP_SPINDLE_TURNING();
+                continue;
+            }
+            if (step.kind == DRILL_STEP_SPINDLE_START) {
+                if (mode & DRILL_SPINDLE_CCW)
+                    START_SPINDLE_COUNTERCLOCKWISE();
+                else
+                    START_SPINDLE_CLOCKWISE();
+                continue;
+            }
+            pos[axis] = step.to;
+            if (step.kind == DRILL_STEP_FEED)
+                STRAIGHT_FEED(line_number, pos[0], pos[1], pos[2], pos[3],
+                              pos[4], pos[5], pos[6], pos[7], pos[8]);
+            else
+                STRAIGHT_TRAVERSE(line_number, pos[0], pos[1], pos[2],
+                                  pos[3], pos[4], pos[5], pos[6], pos[7],
+                                  pos[8]);
+        }
+        return;
+    }
+
+    // the move for one unit of level, in machine coordinates
+    memcpy(end, pos, sizeof(end));
+    end[axis] += 1.0;
+    from_prog(pos[0], pos[1], pos[2], pos[3], pos[4], pos[5], pos[6], pos[7], pos[8]);
+    rotate_and_offset_pos(pos[0], pos[1], pos[2], pos[3], pos[4], pos[5], pos[6], pos[7], pos[8]);
+    from_prog(end[0], end[1], end[2], end[3], end[4], end[5], end[6], end[7], end[8]);
+    rotate_and_offset_pos(end[0], end[1], end[2], end[3], end[4], end[5], end[6], end[7], end[8]);
+    for (int i = 0; i < 9; i++)
+        unit[i] = end[i] - pos[i];
+    drillCycleMsg.unit = to_ext_pose(unit[0], unit[1], unit[2], 0, 0, 0,
+                                     unit[6], unit[7], unit[8]);
+
+    // velocity and acceleration only depend on the direction of the move
+    rapid_vel = ini_maxvel = vel =
+        getStraightVelocity(end[0], end[1], end[2], end[3], end[4], end[5],
+                            end[6], end[7], end[8]);
+    if (vel > currentLinearFeedRate)
+        vel = currentLinearFeedRate;
+    acc = getStraightAcceleration(end[0], end[1], end[2], end[3], end[4],
+                                  end[5], end[6], end[7], end[8]);
+
+    drillCycleMsg.vel = toExtVel(vel);
+    drillCycleMsg.ini_maxvel = toExtVel(ini_maxvel);
+    drillCycleMsg.rapid_vel = toExtVel(rapid_vel);
+    drillCycleMsg.acc = toExtAcc(acc);
+
+    if (vel && acc) {
+        interp_list.set_line_number(line_number);
+        interp_list.append(drillCycleMsg);
+    }
+
+    // after the cycle we are at the clearance level
+    for (int i = 0; i < 9; i++)
+        end[i] = pos[i] + unit[i] * (clear - drillCycleMsg.start);
+    canonUpdateEndPoint(end[0], end[1], end[2], end[3], end[4], end[5],
+                        end[6], end[7], end[8]);
+}
+
 /*
   STRAIGHT_PROBE is exactly the same as STRAIGHT_FEED, except that it
   uses a probe message instead of a linear move message.
@@ -1195,94 +1320,29 @@ static double chord_deviation(double sx, double sy, double ex, double ey, double
     return dev;
 }
 
-/* Spline and NURBS additional functions; */
-
-static double max(double a, double b) {
-    if(a < b) return b;
-    return a;
-}
-static void unit(double *x, double *y) {
-    double h = hypot(*x, *y);
-    if(h != 0) { *x/=h; *y/=h; }
-}
-
+/* NURBS moves, from the biarcs nurbs_biarcs() fits to the curve */
 static void
-arc(int lineno, double x0, double y0, double x1, double y1, double dx, double dy) {
-    double small = 0.000001;
-    double x = x1-x0, y=y1-y0;
-    double den = 2 * (y*dx - x*dy);
+nurbs_arc(int lineno, double x, double y, double cx, double cy, int rotation) {
     CANON_POSITION p = unoffset_and_unrotate_pos(canonEndPoint);
     to_prog(p);
-    if (fabs(den) > small) {
-        double r = -(x*x+y*y)/den;
-        double i = dy*r, j = -dx*r;
-        double cx = x1+i, cy=y1+j;
-        ARC_FEED(lineno, x1, y1, cx, cy, r<0 ? 1 : -1,
+    if (rotation) {
+        ARC_FEED(lineno, x, y, cx, cy, rotation,
                  p.z, p.a, p.b, p.c, p.u, p.v, p.w);
     } else { 
-        STRAIGHT_FEED(lineno, x1, y1, p.z, p.a, p.b, p.c, p.u, p.v, p.w);
+        STRAIGHT_FEED(lineno, x, y, p.z, p.a, p.b, p.c, p.u, p.v, p.w);
     }
 }
 
-static int
-biarc(int lineno, double p0x, double p0y, double tsx, double tsy,
-      double p4x, double p4y, double tex, double tey, double r=1.0) {
-    unit(&tsx, &tsy);
-    unit(&tex, &tey);
-
-    double vx = p0x - p4x, vy = p0y - p4y;
-    double c = vx*vx + vy*vy;
-    double b = 2 * (vx * (r*tsx + tex) + vy * (r*tsy + tey));
-    double a = 2 * r * (tsx * tex + tsy * tey - 1);
-
-    double discr = b*b - 4*a*c;
-    if(discr < 0) return 0;
-
-    double disq = sqrt(discr);
-    double beta1 = (-b-disq) / 2 / a;
-    double beta2 = (-b+disq) / 2 / a;
-
-    if(beta1 > 0 && beta2 > 0)
-      return 0;
-    double beta = max(beta1, beta2);
-    double alpha = beta * r;
-    double ab = alpha + beta;
-    double p1x = p0x + alpha * tsx, p1y = p0y + alpha * tsy,
-         p3x = p4x - beta * tex, p3y = p4y - beta * tey,
-         p2x = (p1x*beta + p3x*alpha) / ab,
-         p2y = (p1y*beta + p3y*alpha) / ab;
-    double tmx = p3x-p2x, tmy = p3y-p2y;
-    unit(&tmx, &tmy);
-
-    arc(lineno, p0x, p0y, p2x, p2y, tsx, tsy);
-    arc(lineno, p2x, p2y, p4x, p4y, tmx, tmy);
-    return 1;
-}
-
 
 /* Canon calls */
 
 void NURBS_FEED(int lineno, std::vector<CONTROL_POINT> nurbs_control_points, unsigned int k) {
     flush_segments();
 
-    unsigned int n = nurbs_control_points.size() - 1;
-    double umax = n - k + 2;
-    unsigned int div = nurbs_control_points.size()*4;
-    std::vector<unsigned int> knot_vector = knot_vector_creator(n, k);	
-    PLANE_POINT P0, P0T, P1, P1T;
-
-    P0 = nurbs_point(0,k,nurbs_control_points,knot_vector);
-    P0T = nurbs_tangent(0, k, nurbs_control_points, knot_vector);
-
-    for(unsigned int i=1; i<=div; i++) {
-	double u = umax * i / div;
-        P1 = nurbs_point(u,k,nurbs_control_points,knot_vector);
-	P1T = nurbs_tangent(u,k,nurbs_control_points,knot_vector);
-        biarc(lineno, P0.X,P0.Y, P0T.X,P0T.Y, P1.X,P1.Y, P1T.X,P1T.Y);
-        P0 = P1;
-        P0T = P1T;
-    }
-    knot_vector.clear();
+    nurbs_biarcs(lineno, nurbs_control_points, k,
+                 TO_PROG_LEN(canonMotionTolerance > 0 ?
+                             canonMotionTolerance : NURBS_DEFAULT_TOLERANCE),
+                 nurbs_arc);
 }
 
 
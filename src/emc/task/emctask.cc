@@ -551,6 +551,32 @@ int emcTaskPlanRead()
     return retval;
 }
 
+// Skips the lines of the program up to the last checkpoint the
+// interpreter took before line, if it has one; returns the lines skipped.
+int emcTaskPlanRestore(int line)
+{
+    Interp *i = dynamic_cast<Interp*>(pinterp);
+    if (!i) {
+	return 0;		// other interpreters step through every line
+    }
+    int retval = i->restore_checkpoint(line);
+    if (retval < 0 && emcStatus->task.file[0] != 0) {
+	if (emcTaskPlanOpen(emcStatus->task.file) > INTERP_MIN_ERROR) {
+	    return 0;
+	}
+	retval = i->restore_checkpoint(line);
+    }
+    if (retval < 0) {
+	retval = 0;
+    }
+
+    if (emc_debug & EMC_DEBUG_INTERP) {
+        rcs_print("emcTaskPlanRestore(%d) returned %d\n", line, retval);
+    }
+
+    return retval;
+}
+
 int emcTaskPlanExecute(const char *command)
 {
     int inpos = emcStatus->motion.traj.inpos;	// 1 if in position, 0 if not.
@@ -123,6 +123,15 @@ static double EMC_TASK_CYCLE_TIME_ORIG = 0.0;
 // delay counter
 static double taskExecDelayTimeout = 0.0;
 
+// interval at which the end-of-cycle wait checks for motion status
+// changes while motion is busy, from [TASK] EVENT_POLL_TIME; 0 means
+// sleep for the whole cycle as before
+static double emcTaskEventPollTime = 0.001;
+static int lastCommandCount = 0;
+// the command buffer has a blocking semaphore to sleep on, until a wait
+// on it fails
+static int emcTaskCommandBsem = 1;
+
 // emcTaskIssueCommand issues command immediately
 static int emcTaskIssueCommand(NMLmsg * cmd);
 
@@ -381,6 +390,7 @@ static EMC_TRAJ_SET_VELOCITY *emcTrajSetVelocityMsg;
 static EMC_TRAJ_SET_ACCELERATION *emcTrajSetAccelerationMsg;
 static EMC_TRAJ_LINEAR_MOVE *emcTrajLinearMoveMsg;
 static EMC_TRAJ_CIRCULAR_MOVE *emcTrajCircularMoveMsg;
+static EMC_TRAJ_DRILL_CYCLE *emcTrajDrillCycleMsg;
 static EMC_TRAJ_DELAY *emcTrajDelayMsg;
 static EMC_TRAJ_SET_TERM_COND *emcTrajSetTermCondMsg;
 static EMC_TRAJ_SET_SPINDLESYNC *emcTrajSetSpindlesyncMsg;
@@ -1488,6 +1498,7 @@ static int emcTaskCheckPreconditions(NMLmsg * cmd)
 
     case EMC_TRAJ_LINEAR_MOVE_TYPE:
     case EMC_TRAJ_CIRCULAR_MOVE_TYPE:
+    case EMC_TRAJ_DRILL_CYCLE_TYPE:
     case EMC_TRAJ_SET_VELOCITY_TYPE:
     case EMC_TRAJ_SET_ACCELERATION_TYPE:
     case EMC_TRAJ_SET_TERM_COND_TYPE:
@@ -1812,6 +1823,17 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
                 emcTrajCircularMoveMsg->acc);
 	break;
 
+    case EMC_TRAJ_DRILL_CYCLE_TYPE:
+	emcTrajDrillCycleMsg = (EMC_TRAJ_DRILL_CYCLE *) cmd;
+	retval = emcTrajDrillCycle(emcTrajDrillCycleMsg->unit,
+		emcTrajDrillCycleMsg->start, emcTrajDrillCycleMsg->r,
+		emcTrajDrillCycleMsg->bottom, emcTrajDrillCycleMsg->clear,
+		emcTrajDrillCycleMsg->peck, emcTrajDrillCycleMsg->backoff,
+		emcTrajDrillCycleMsg->dwell, emcTrajDrillCycleMsg->mode,
+		emcTrajDrillCycleMsg->vel, emcTrajDrillCycleMsg->ini_maxvel,
+		emcTrajDrillCycleMsg->rapid_vel, emcTrajDrillCycleMsg->acc);
+	break;
+
     case EMC_TRAJ_PAUSE_TYPE:
 	emcStatus->task.task_paused = 1;
 	retval = emcTrajPause();
@@ -2249,6 +2271,11 @@ static int emcTaskIssueCommand(NMLmsg * cmd)
 	}
 	run_msg = (EMC_TASK_PLAN_RUN *) cmd;
 	programStartLine = run_msg->line;
+	if (programStartLine > 1) {
+	    // line programStartLine - 1 is still read, so that the
+	    // stepping below synchs the interpreter when it gets there
+	    emcTaskPlanRestore(programStartLine - 1);
+	}
 	emcStatus->task.interpState = EMC_TASK_INTERP_READING;
 	emcStatus->task.task_paused = 0;
 	retval = 0;
@@ -2375,6 +2402,7 @@ static int emcTaskCheckPostconditions(NMLmsg * cmd)
 
     case EMC_TRAJ_LINEAR_MOVE_TYPE:
     case EMC_TRAJ_CIRCULAR_MOVE_TYPE:
+    case EMC_TRAJ_DRILL_CYCLE_TYPE:
     case EMC_TRAJ_SET_VELOCITY_TYPE:
     case EMC_TRAJ_SET_ACCELERATION_TYPE:
     case EMC_TRAJ_SET_TERM_COND_TYPE:
@@ -3160,6 +3188,15 @@ static int iniLoad(const char *filename)
     }
 
 
+    if (NULL != (inistring = inifile.Find("EVENT_POLL_TIME", "TASK"))) {
+	if (1 != sscanf(inistring, "%lf", &emcTaskEventPollTime)) {
+	    emcTaskEventPollTime = 0.001;
+	    rcs_print
+		("invalid [TASK] EVENT_POLL_TIME in %s (%s); using default %f\n",
+		 filename, inistring, emcTaskEventPollTime);
+	}
+    }
+
     if (NULL != (inistring = inifile.Find("NO_FORCE_HOMING", "TRAJ"))) {
 	if (1 == sscanf(inistring, "%d", &no_force_homing)) {
 	    // found it
@@ -3198,11 +3235,97 @@ static int iniLoad(const char *filename)
 /*
   syntax: a.out {-d -ini <inifile>} {-nml <nmlfile>} {-shm <key>}
   */
+/*
+  emcTaskMotionBusy() returns non-zero if motion is moving, homing or
+  has moves queued, or task is waiting for it, as of the last status.
+*/
+static int emcTaskMotionBusy()
+{
+    int axis;
+
+    switch (emcStatus->task.execState) {
+    case EMC_TASK_EXEC_WAITING_FOR_MOTION:
+    case EMC_TASK_EXEC_WAITING_FOR_MOTION_QUEUE:
+    case EMC_TASK_EXEC_WAITING_FOR_MOTION_AND_IO:
+    case EMC_TASK_EXEC_WAITING_FOR_SPINDLE_ORIENTED:
+	return 1;
+    default:
+	break;
+    }
+    if (emcStatus->motion.traj.status == RCS_EXEC) {
+	return 1;
+    }
+    for (axis = 0; axis < emcStatus->motion.traj.axes; axis++) {
+	if (emcStatus->motion.axis[axis].homing) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+/*
+  emcTaskWait() sleeps out the rest of the task cycle begun at
+  cycleStart, but returns as soon as a new command arrives, iocontrol
+  or motion report a change task is waiting on, or a pending delay or
+  wait timeout expires.
+
+  User interfaces and iocontrol write to NML buffers which share one
+  blocking semaphore (bsem= in the NML file), so task sleeps on that.
+  Motion status is written by the servo thread, which can not post the
+  semaphore, so its change count is looked at every EVENT_POLL_TIME,
+  but only while motion is busy. Without the semaphore, the command and
+  io status are looked at as often, and the interval doubles every time
+  nothing has changed while motion is idle.
+*/
+static void emcTaskWait(double cycleStart)
+{
+    double deadline = cycleStart + emc_task_cycle_time;
+    double interval = emcTaskEventPollTime;
+    double left;
+    int count, busy;
+
+    if (taskExecDelayTimeout > 0.0 && taskExecDelayTimeout < deadline) {
+	deadline = taskExecDelayTimeout;
+    }
+    busy = emcTaskMotionBusy();
+
+    for (;;) {
+	count = emcCommandBuffer->get_msg_count();
+	if (count != lastCommandCount) {
+	    lastCommandCount = count;
+	    return;
+	}
+	if (emcMotionStatusChanged() || emcIoStatusChanged()) {
+	    return;
+	}
+	left = deadline - etime();
+	if (left <= 0.0) {
+	    return;
+	}
+	if (emcTaskCommandBsem) {
+	    if (busy && left > interval) {
+		left = interval;
+	    }
+	    if (emcCommandBuffer->wait_for_write(left) >= 0) {
+		continue;
+	    }
+	    emcTaskCommandBsem = 0;
+	    rcs_print("no blocking semaphore on the command buffer; task "
+		      "polls for commands every %f s\n", emcTaskEventPollTime);
+	}
+	esleep(left < interval ? left : interval);
+	if (!busy) {
+	    interval *= 2;
+	}
+    }
+}
+
 int main(int argc, char *argv[])
 {
     int taskPlanError = 0;
     int taskExecuteError = 0;
     double startTime, endTime, deltaTime;
+    double cycleStart;
     double minTime, maxTime;
 
     bindtextdomain("linuxcnc", EMC2_PO_DIR);
@@ -3291,6 +3414,7 @@ int main(int argc, char *argv[])
     maxTime = 0.0;		// set to value that can never be underset
 
     while (!done) {
+	cycleStart = etime();
 	// read command
 	if (0 != emcCommandBuffer->peek()) {
 	    // got a new command, so clear out errors
@@ -3469,6 +3593,8 @@ int main(int argc, char *argv[])
 
 	if ((emcTaskNoDelay) || (emcTaskEager)) {
 	    emcTaskEager = 0;
+	} else if (emcTaskEventPollTime > 0.0) {
+	    emcTaskWait(cycleStart);
 	} else {
 	    timer->wait();
 	}
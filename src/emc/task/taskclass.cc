@@ -738,6 +738,45 @@ int Task::emcIoUpdate(EMC_IO_STAT * stat)
     return 0;
 }
 
+/*
+  emcIoStatusChanged() returns non-zero if iocontrol has published a
+  status that differs from the last one seen in anything task waits on.
+  iocontrol rewrites its status every cycle, so the message count alone
+  would wake task at the io cycle rate.
+*/
+int emcIoStatusChanged()
+{
+    static int last_count = 0;
+    static int last_serial = 0, last_status = 0, last_estop = 0;
+    static int last_prepped = 0, last_in_spindle = 0, last_fault = 0;
+    int count, changed;
+
+    if (0 == emcIoStatusBuffer || !emcIoStatusBuffer->valid()) {
+	return 0;
+    }
+    count = emcIoStatusBuffer->get_msg_count();
+    if (count == last_count) {
+	return 0;
+    }
+    last_count = count;
+    if (emcIoStatusBuffer->peek() != EMC_IO_STAT_TYPE) {
+	return 0;
+    }
+    changed = emcIoStatus->echo_serial_number != last_serial ||
+	emcIoStatus->status != last_status ||
+	emcIoStatus->aux.estop != last_estop ||
+	emcIoStatus->tool.pocketPrepped != last_prepped ||
+	emcIoStatus->tool.toolInSpindle != last_in_spindle ||
+	emcIoStatus->fault != last_fault;
+    last_serial = emcIoStatus->echo_serial_number;
+    last_status = emcIoStatus->status;
+    last_estop = emcIoStatus->aux.estop;
+    last_prepped = emcIoStatus->tool.pocketPrepped;
+    last_in_spindle = emcIoStatus->tool.toolInSpindle;
+    last_fault = emcIoStatus->fault;
+    return changed;
+}
+
 int Task::emcIoPluginCall(int len, const char *msg)
 {
     if (emc_debug & EMC_DEBUG_PYTHON_TASK) {
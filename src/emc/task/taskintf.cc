@@ -1085,6 +1085,38 @@ int emcTrajRigidTap(EmcPose pos, double vel, double ini_maxvel, double acc)
     return usrmotWriteEmcmotCommand(&emcmotCommand);
 }
 
+int emcTrajDrillCycle(EmcPose unit, double start, double r, double bottom,
+		      double clear, double peck, double backoff, double dwell,
+		      int mode, double vel, double ini_maxvel,
+		      double rapid_vel, double acc)
+{
+#ifdef ISNAN_TRAP
+    if (isnan(bottom) || isnan(clear) || isnan(unit.tran.x) ||
+	isnan(unit.tran.y) || isnan(unit.tran.z)) {
+	printf("isnan error in emcTrajDrillCycle()\n");
+	return 0;		// ignore it for now, just don't send it
+    }
+#endif
+
+    emcmotCommand.command = EMCMOT_DRILL_CYCLE;
+    emcmotCommand.pos = unit;
+    emcmotCommand.drill.start = start;
+    emcmotCommand.drill.r = r;
+    emcmotCommand.drill.bottom = bottom;
+    emcmotCommand.drill.clear = clear;
+    emcmotCommand.drill.peck = peck;
+    emcmotCommand.drill.backoff = backoff;
+    emcmotCommand.drill.dwell = dwell;
+    emcmotCommand.drill.mode = mode;
+    emcmotCommand.id = localEmcTrajMotionId;
+    emcmotCommand.vel = vel;
+    emcmotCommand.ini_maxvel = ini_maxvel;
+    emcmotCommand.rapid_vel = rapid_vel;
+    emcmotCommand.acc = acc;
+
+    return usrmotWriteEmcmotCommand(&emcmotCommand);
+}
+
 
 static int last_id = 0;
 static int last_id_printed = 0;
@@ -1434,6 +1466,26 @@ int emcSpindleConstant()
 
 
 
+/*
+  emcMotionStatusChanged() returns non-zero if motion has moved any of
+  the state task waits on since the last call, by checking only the
+  change count instead of copying the whole status struct.
+*/
+int emcMotionStatusChanged()
+{
+    static unsigned int last_count = 0;
+    unsigned int count;
+
+    if (0 != usrmotReadEmcmotChangeCount(&count)) {
+	return 0;
+    }
+    if (count == last_count) {
+	return 0;
+    }
+    last_count = count;
+    return 1;
+}
+
 int emcMotionUpdate(EMC_MOTION_STAT * stat)
 {
     int r1;
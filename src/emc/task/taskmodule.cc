@@ -442,6 +442,8 @@ BOOST_PYTHON_MODULE(emctask) {
     class_ <EMC_TOOL_STAT, noncopyable>("EMC_TOOL_STAT",no_init)
 	.def_readwrite("pocketPrepped", &EMC_TOOL_STAT::pocketPrepped )
 	.def_readwrite("toolInSpindle", &EMC_TOOL_STAT::toolInSpindle )
+	.def_readwrite("toolPrepped", &EMC_TOOL_STAT::toolPrepped )
+	.def_readwrite("toolTableChanges", &EMC_TOOL_STAT::toolTableChanges )
 	.add_property( "toolTable",
 		       bp::make_function( tool_w(&tool_wrapper),
 					  bp::with_custodian_and_ward_postcall< 0, 1 >()))
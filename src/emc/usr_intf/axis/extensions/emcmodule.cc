@@ -18,7 +18,6 @@
 
 #include <Python.h>
 #include <structseq.h>
-#include <pthread.h>
 #include <structmember.h>
 #include "config.h"
 #include "rcs.hh"
@@ -30,6 +29,8 @@
 #include "timer.hh"
 #include "nml_oi.hh"
 #include "rcs_print.hh"
+#include "rtapi.h"
+#include "poslog.h"
 
 #include <cmath>
 
@@ -276,9 +277,14 @@ static bool check_stat(RCS_STAT_CHANNEL *emcStatusBuffer) {
 
 static PyObject *poll(pyStatChannel *s, PyObject *o) {
     if(!check_stat(s->c)) return NULL;
-    if(s->c->peek() == EMC_STAT_TYPE) {
+    if(s->c->peek_in_place() == EMC_STAT_TYPE) {
         EMC_STAT *emcStatus = static_cast<EMC_STAT*>(s->c->get_address());
         memcpy(&s->status, emcStatus, sizeof(EMC_STAT));
+        if(!s->c->in_place_valid() && s->c->peek() == EMC_STAT_TYPE) {
+            // task wrote a new status while it was being copied
+            emcStatus = static_cast<EMC_STAT*>(s->c->get_address());
+            memcpy(&s->status, emcStatus, sizeof(EMC_STAT));
+        }
     }
     Py_INCREF(Py_None);
     return Py_None;
@@ -360,6 +366,8 @@ static PyMemberDef Stat_members[] = {
 // EMC_TOOL_STAT io.tool
     {(char*)"pocket_prepped", T_INT, O(io.tool.pocketPrepped), READONLY},
     {(char*)"tool_in_spindle", T_INT, O(io.tool.toolInSpindle), READONLY},
+    {(char*)"tool_prepped", T_INT, O(io.tool.toolPrepped), READONLY},
+    {(char*)"tool_table_changes", T_INT, O(io.tool.toolTableChanges), READONLY},
 
 // EMC_COOLANT_STAT io.cooland
     {(char*)"mist", T_INT, O(io.coolant.mist), READONLY},
@@ -1799,12 +1807,33 @@ struct logger_point {
 
 #define NUMCOLORS (6)
 #define MAX_POINTS (10000)
+
+/* The logger thread works on its own array of points and hands copies
+   to the renderer through three buffers: the one the thread fills, the
+   one published last, and the one being drawn.  Each side swaps its
+   buffer for the published one with an atomic exchange, so neither of
+   them ever waits for the other. */
+#define LOGGER_FRESH (4) /* in ready: not taken by the renderer yet */
+
+struct logger_buffer {
+    struct logger_point *p;
+    int npts, mpts;
+    unsigned int epoch;
+};
+
 typedef struct {
     PyObject_HEAD
     int npts, mpts, lpts;
     struct logger_point *p;
+    unsigned int epoch; // changes whenever points go away
+    bool dirty;
+    struct logger_buffer buffers[3];
+    int back, front;
+    volatile int ready;
+    struct logger_point last; // last point drawn, if lpts
+    unsigned int lost;
     struct color colors[NUMCOLORS];
-    bool exit, clear, changed;
+    bool exit, clear;
     char *geometry;
     int is_xyuv;
     double foam_z, foam_w;
@@ -1826,18 +1855,31 @@ static inline bool colinear(float xa, float ya, float za, float xb, float yb, fl
     return false;
 }
 
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
-
-static void LOCK() { pthread_mutex_lock(&mutex); }
-static void UNLOCK() { pthread_mutex_unlock(&mutex); }
+static int exchange(volatile int *slot, int value) {
+    int old;
+    do {
+        old = *slot;
+    } while(!__sync_bool_compare_and_swap(slot, old, value));
+    return old;
+}
 
 static int Logger_init(pyPositionLogger *self, PyObject *a, PyObject *k) {
     char *geometry;
     struct color *c = self->colors;
     self->p = (logger_point*)malloc(0);
-    self->npts = self->mpts = 0;
+    self->npts = self->mpts = self->lpts = 0;
+    self->epoch = 0;
+    self->dirty = 0;
+    for(int i = 0; i < 3; i++) {
+        self->buffers[i].p = 0;
+        self->buffers[i].npts = self->buffers[i].mpts = 0;
+        self->buffers[i].epoch = 0;
+    }
+    self->back = 0;
+    self->ready = 1;
+    self->front = 2;
+    self->lost = 0;
     self->exit = self->clear = 0;
-    self->changed = 1;
     self->st = 0;
     self->is_xyuv = 0;
     self->foam_z = 0;
@@ -1860,6 +1902,7 @@ static int Logger_init(pyPositionLogger *self, PyObject *a, PyObject *k) {
 
 static void Logger_dealloc(pyPositionLogger *s) {
     free(s->p);
+    for(int i = 0; i < 3; i++) free(s->buffers[i].p);
     Py_XDECREF(s->st);
     free(s->geometry);
     PyObject_Del(s);
@@ -1880,9 +1923,160 @@ static double dist2(double x1, double y1, double x2, double y2) {
     return dx*dx + dy*dy;
 }
 
+// Called by the logger thread for every position it samples
+static void Logger_add(pyPositionLogger *s, EMC_STAT *status,
+        const EmcPose &pos, int colornum) {
+    if(colornum < 0 || colornum > NUMCOLORS) colornum = 0;
+    struct color c = s->colors[colornum];
+    struct logger_point *op = &s->p[s->npts-1];
+    struct logger_point *oop = &s->p[s->npts-2];
+    bool add_point = s->npts < 2 || c != op->c;
+    double x, y, z, rx, ry, rz;
+    if(s->is_xyuv) {
+        x = pos.tran.x - status->task.toolOffset.tran.x,
+        y = pos.tran.y - status->task.toolOffset.tran.y,
+        z = s->foam_z;
+        rx = pos.u - status->task.toolOffset.u,
+        ry = pos.v - status->task.toolOffset.v,
+        rz = s->foam_w;
+        /* TODO .01, the distance at which a preview line is dropped,
+         * should either be dependent on units or configurable, because
+         * 0.1 is inappropriate for mm systems
+         */
+        add_point = add_point || (dist2(x, y, oop->x, oop->y) > .01)
+            || (dist2(rx, ry, oop->rx, oop->ry) > .01);
+        add_point = add_point || !colinear( x, y, z,
+                        op->x, op->y, op->z,
+                        oop->x, oop->y, oop->z);
+        add_point = add_point || !colinear( rx, ry, rz,
+                        op->rx, op->ry, op->rz,
+                        oop->rx, oop->ry, oop->rz);
+    } else {
+        double pt[9] = {
+            pos.tran.x - status->task.toolOffset.tran.x,
+            pos.tran.y - status->task.toolOffset.tran.y,
+            pos.tran.z - status->task.toolOffset.tran.z,
+            pos.a - status->task.toolOffset.a,
+            pos.b - status->task.toolOffset.b,
+            pos.c - status->task.toolOffset.c,
+            pos.u - status->task.toolOffset.u,
+            pos.v - status->task.toolOffset.v,
+            pos.w - status->task.toolOffset.w};
+
+        double p[3];
+        vertex9(pt, p, s->geometry);
+        x = p[0]; y = p[1]; z = p[2];
+        rx = pt[3]; ry = -pt[4]; rz = pt[5];
+
+        add_point = add_point || !colinear( x, y, z,
+                        op->x, op->y, op->z,
+                        oop->x, oop->y, oop->z);
+    }
+    s->dirty = 1;
+    if(add_point) {
+        // 1 or 2 points may be added, make room whenever
+        // fewer than 2 are left
+        bool changed_color = s->npts && c != op->c;
+        if(s->npts+2 > s->mpts) {
+            if(s->mpts >= MAX_POINTS) {
+                int adjust = MAX_POINTS / 10;
+                if(adjust < 2) adjust = 2;
+                s->npts -= adjust;
+                s->epoch++;
+                memmove(s->p, s->p + adjust, 
+                        sizeof(struct logger_point) * s->npts);
+            } else {
+                s->mpts = 2 * s->mpts + 2;
+                s->p = (struct logger_point*) realloc(s->p,
+                            sizeof(struct logger_point) * s->mpts);
+            }
+            op = &s->p[s->npts-1];
+            oop = &s->p[s->npts-2];
+        }
+        if(changed_color) {
+            {
+            struct logger_point &np = s->p[s->npts];
+            np.x = op->x; np.y = op->y; np.z = op->z;
+            np.rx = rx; np.ry = ry; np.rz = rz;
+            np.c = np.c2 = c;
+            }
+            {
+            struct logger_point &np = s->p[s->npts+1];
+            np.x = x; np.y = y; np.z = z;
+            np.rx = rx; np.ry = ry; np.rz = rz;
+            np.c = np.c2 = c;
+            }
+            s->npts += 2;
+        } else {
+            struct logger_point &np = s->p[s->npts];
+            np.x = x; np.y = y; np.z = z;
+            np.rx = rx; np.ry = ry; np.rz = rz;
+            np.c = np.c2 = c;
+            s->npts++;
+        }
+    } else {
+        struct logger_point &np = s->p[s->npts-1];
+        np.x = x; np.y = y; np.z = z;
+        np.rx = rx; np.ry = ry; np.rz = rz;
+    }
+}
+
+// Called by the logger thread to hand its points to the renderer.  The
+// buffer it gets back is brought up to date the next time, copying only
+// the points added since unless some were dropped in between.
+static void Logger_publish(pyPositionLogger *s) {
+    struct logger_buffer *b = &s->buffers[s->back];
+    int from = 0;
+    if(b->epoch == s->epoch && b->npts > 0 && b->npts <= s->npts)
+        from = b->npts - 1; // the last point may have moved since
+    if(b->mpts < s->mpts) {
+        b->mpts = s->mpts;
+        b->p = (struct logger_point*) realloc(b->p,
+                    sizeof(struct logger_point) * b->mpts);
+    }
+    memcpy(b->p + from, s->p + from,
+            sizeof(struct logger_point) * (s->npts - from));
+    b->npts = s->npts;
+    b->epoch = s->epoch;
+    s->back = exchange(&s->ready, s->back | LOGGER_FRESH) & 3;
+    s->dirty = 0;
+}
+
+// Called by the renderer to pick up the most recently published points
+static struct logger_buffer *Logger_take(pyPositionLogger *s) {
+    if(s->ready & LOGGER_FRESH)
+        s->front = exchange(&s->ready, s->front) & 3;
+    return &s->buffers[s->front];
+}
+
+// Attaches to the ring motion writes its position into every servo
+// cycle.  Returns NULL if there is none, e.g. when motion runs on
+// another machine, and the logger samples the status buffer instead.
+static poslog_t *Logger_attach(int *comp_id, int *shmem_id) {
+    char name[RTAPI_NAME_LEN + 1];
+    void *ptr;
+
+    *shmem_id = -1;
+    snprintf(name, sizeof(name), "poslog%d", getpid());
+    *comp_id = rtapi_init(name);
+    if(*comp_id < 0) return NULL;
+    *shmem_id = rtapi_shmem_new(POSLOG_SHMEM_KEY, *comp_id, sizeof(poslog_t));
+    if(*shmem_id >= 0 && rtapi_shmem_getptr(*shmem_id, &ptr) >= 0
+            && ((poslog_t*)ptr)->magic == POSLOG_MAGIC_NUM)
+        return (poslog_t*)ptr;
+    if(*shmem_id >= 0) rtapi_shmem_delete(*shmem_id, *comp_id);
+    rtapi_exit(*comp_id);
+    *comp_id = -1;
+    return NULL;
+}
+
 static PyObject *Logger_start(pyPositionLogger *s, PyObject *o) {
     double interval;
     struct timespec ts;
+    poslog_t *log;
+    poslog_entry_t *entries = 0;
+    unsigned int tail = 0;
+    int comp_id, shmem_id;
 
     if(!PyArg_ParseTuple(o, "d:logger.start", &interval)) return NULL;
     ts.tv_sec = (int)interval;
@@ -1893,115 +2087,42 @@ static PyObject *Logger_start(pyPositionLogger *s, PyObject *o) {
     s->exit = 0;
     s->clear = 0;
     s->npts = 0;
+    s->epoch++;
 
     Py_BEGIN_ALLOW_THREADS
+    log = Logger_attach(&comp_id, &shmem_id);
+    if(log) {
+        entries = (poslog_entry_t*) malloc(sizeof(poslog_entry_t) * POSLOG_DEPTH);
+        tail = log->head;
+    }
     while(!s->exit) {
         if(s->clear) {
             s->npts = 0;
             s->lpts = 0;
+            s->epoch++;
+            Logger_publish(s);
             s->clear = 0;
         }
         if(s->st->c->valid() && s->st->c->peek() == EMC_STAT_TYPE) {
             EMC_STAT *status = static_cast<EMC_STAT*>(s->st->c->get_address());
-            int colornum = 2;
-            colornum = status->motion.traj.motion_type;
-            if(colornum < 0 || colornum > NUMCOLORS) colornum = 0;
-            struct color c = s->colors[colornum];
-            struct logger_point *op = &s->p[s->npts-1];
-            struct logger_point *oop = &s->p[s->npts-2];
-            bool add_point = s->npts < 2 || c != op->c;
-            double x, y, z, rx, ry, rz;
-            if(s->is_xyuv) {
-                x = status->motion.traj.position.tran.x - status->task.toolOffset.tran.x,
-                y = status->motion.traj.position.tran.y - status->task.toolOffset.tran.y,
-                z = s->foam_z;
-                rx = status->motion.traj.position.u - status->task.toolOffset.u,
-                ry = status->motion.traj.position.v - status->task.toolOffset.v,
-                rz = s->foam_w;
-                /* TODO .01, the distance at which a preview line is dropped,
-                 * should either be dependent on units or configurable, because
-                 * 0.1 is inappropriate for mm systems
-                 */
-                add_point = add_point || (dist2(x, y, oop->x, oop->y) > .01)
-                    || (dist2(rx, ry, oop->rx, oop->ry) > .01);
-                add_point = add_point || !colinear( x, y, z,
-                                op->x, op->y, op->z,
-                                oop->x, oop->y, oop->z);
-                add_point = add_point || !colinear( rx, ry, rz,
-                                op->rx, op->ry, op->rz,
-                                oop->rx, oop->ry, oop->rz);
-            } else {
-                double pt[9] = {
-                    status->motion.traj.position.tran.x - status->task.toolOffset.tran.x,
-                    status->motion.traj.position.tran.y - status->task.toolOffset.tran.y,
-                    status->motion.traj.position.tran.z - status->task.toolOffset.tran.z,
-                    status->motion.traj.position.a - status->task.toolOffset.a,
-                    status->motion.traj.position.b - status->task.toolOffset.b,
-                    status->motion.traj.position.c - status->task.toolOffset.c,
-                    status->motion.traj.position.u - status->task.toolOffset.u,
-                    status->motion.traj.position.v - status->task.toolOffset.v,
-                    status->motion.traj.position.w - status->task.toolOffset.w};
-
-                double p[3];
-                vertex9(pt, p, s->geometry);
-                x = p[0]; y = p[1]; z = p[2];
-                rx = pt[3]; ry = -pt[4]; rz = pt[5];
-
-                add_point = add_point || !colinear( x, y, z,
-                                op->x, op->y, op->z,
-                                oop->x, oop->y, oop->z);
-            }
-            if(add_point) {
-                // 1 or 2 points may be added, make room whenever
-                // fewer than 2 are left
-                bool changed_color = s->npts && c != op->c;
-                if(s->npts+2 > s->mpts) {
-                    LOCK();
-                    if(s->mpts >= MAX_POINTS) {
-                        int adjust = MAX_POINTS / 10;
-                        if(adjust < 2) adjust = 2;
-                        s->npts -= adjust;
-                        memmove(s->p, s->p + adjust, 
-                                sizeof(struct logger_point) * s->npts);
-                    } else {
-                        s->mpts = 2 * s->mpts + 2;
-                        s->changed = 1;
-                        s->p = (struct logger_point*) realloc(s->p,
-                                    sizeof(struct logger_point) * s->mpts);
-                    }
-                    UNLOCK();
-                    op = &s->p[s->npts-1];
-                    oop = &s->p[s->npts-2];
-                }
-                if(changed_color) {
-                    {
-                    struct logger_point &np = s->p[s->npts];
-                    np.x = op->x; np.y = op->y; np.z = op->z;
-                    np.rx = rx; np.ry = ry; np.rz = rz;
-                    np.c = np.c2 = c;
-                    }
-                    {
-                    struct logger_point &np = s->p[s->npts+1];
-                    np.x = x; np.y = y; np.z = z;
-                    np.rx = rx; np.ry = ry; np.rz = rz;
-                    np.c = np.c2 = c;
-                    }
-                    s->npts += 2;
-                } else {
-                    struct logger_point &np = s->p[s->npts];
-                    np.x = x; np.y = y; np.z = z;
-                    np.rx = rx; np.ry = ry; np.rz = rz;
-                    np.c = np.c2 = c;
-                    s->npts++;
-                }
+            if(log) {
+                // everything motion did since last time, in one go
+                int n = poslogRead(log, &tail, entries, POSLOG_DEPTH, &s->lost);
+                for(int i = 0; i < n; i++)
+                    Logger_add(s, status, entries[i].cmd, entries[i].motion_type);
             } else {
-                struct logger_point &np = s->p[s->npts-1];
-                np.x = x; np.y = y; np.z = z;
-                np.rx = rx; np.ry = ry; np.rz = rz;
+                Logger_add(s, status, status->motion.traj.position,
+                        status->motion.traj.motion_type);
             }
+            if(s->dirty) Logger_publish(s);
         }
         nanosleep(&ts, NULL);
     }
+    if(log) {
+        free(entries);
+        rtapi_shmem_delete(shmem_id, comp_id);
+        rtapi_exit(comp_id);
+    }
     Py_END_ALLOW_THREADS
     Py_DECREF(s->st);
     Py_INCREF(Py_None);
@@ -2022,33 +2143,28 @@ static PyObject* Logger_stop(pyPositionLogger *s, PyObject *o) {
 
 static PyObject* Logger_call(pyPositionLogger *s, PyObject *o) {
     if(!s->clear) {
-        LOCK();
-        if(s->is_xyuv) {
-            if(s->changed) {
+        struct logger_buffer *b = Logger_take(s);
+        if(b->npts) {
+            if(s->is_xyuv) {
                 glVertexPointer(3, GL_FLOAT,
-                        sizeof(struct logger_point)/2, &s->p->x);
+                        sizeof(struct logger_point)/2, &b->p->x);
                 glColorPointer(4, GL_UNSIGNED_BYTE,
-                        sizeof(struct logger_point)/2, &s->p->c);
+                        sizeof(struct logger_point)/2, &b->p->c);
                 glEnableClientState(GL_COLOR_ARRAY);
                 glEnableClientState(GL_VERTEX_ARRAY);
-                s->changed = 0;
-            }
-            s->lpts = s->npts;
-            glDrawArrays(GL_LINES, 0, 2*s->npts);
-        } else {
-            if(s->changed) {
+                glDrawArrays(GL_LINES, 0, 2*b->npts);
+            } else {
                 glVertexPointer(3, GL_FLOAT,
-                        sizeof(struct logger_point), &s->p->x);
+                        sizeof(struct logger_point), &b->p->x);
                 glColorPointer(4, GL_UNSIGNED_BYTE,
-                        sizeof(struct logger_point), &s->p->c);
+                        sizeof(struct logger_point), &b->p->c);
                 glEnableClientState(GL_COLOR_ARRAY);
                 glEnableClientState(GL_VERTEX_ARRAY);
-                s->changed = 0;
+                glDrawArrays(GL_LINE_STRIP, 0, b->npts);
             }
-            s->lpts = s->npts;
-            glDrawArrays(GL_LINE_STRIP, 0, s->npts);
+            s->last = b->p[b->npts-1];
         }
-        UNLOCK();
+        s->lpts = b->npts;
     }
     Py_INCREF(Py_None);
     return Py_None;
@@ -2057,28 +2173,30 @@ static PyObject* Logger_call(pyPositionLogger *s, PyObject *o) {
 static PyObject *Logger_last(pyPositionLogger *s, PyObject *o) {
     int flag=1;
     if(!PyArg_ParseTuple(o, "|i:emc.positionlogger.last", &flag)) return NULL;
-    PyObject *result = NULL;
-    LOCK();
-    int idx = flag ? s->lpts : s->npts;
-    if(!idx) {
-        Py_INCREF(Py_None);
-        result = Py_None;
+    struct logger_point *p = NULL;
+    if(flag) {
+        if(s->lpts) p = &s->last;
     } else {
-        result = PyTuple_New(6);
-        struct logger_point &p = s->p[idx-1];
-        PyTuple_SET_ITEM(result, 0, PyFloat_FromDouble(p.x));
-        PyTuple_SET_ITEM(result, 1, PyFloat_FromDouble(p.y));
-        PyTuple_SET_ITEM(result, 2, PyFloat_FromDouble(p.z));
-        PyTuple_SET_ITEM(result, 3, PyFloat_FromDouble(p.rx));
-        PyTuple_SET_ITEM(result, 4, PyFloat_FromDouble(p.ry));
-        PyTuple_SET_ITEM(result, 5, PyFloat_FromDouble(p.rz));
+        struct logger_buffer *b = Logger_take(s);
+        if(b->npts) p = &b->p[b->npts-1];
+    }
+    if(!p) {
+        Py_INCREF(Py_None);
+        return Py_None;
     }
-    UNLOCK();
+    PyObject *result = PyTuple_New(6);
+    PyTuple_SET_ITEM(result, 0, PyFloat_FromDouble(p->x));
+    PyTuple_SET_ITEM(result, 1, PyFloat_FromDouble(p->y));
+    PyTuple_SET_ITEM(result, 2, PyFloat_FromDouble(p->z));
+    PyTuple_SET_ITEM(result, 3, PyFloat_FromDouble(p->rx));
+    PyTuple_SET_ITEM(result, 4, PyFloat_FromDouble(p->ry));
+    PyTuple_SET_ITEM(result, 5, PyFloat_FromDouble(p->rz));
     return result;
 }
 
 static PyMemberDef Logger_members[] = {
     {(char*)"npts", T_INT, offsetof(pyPositionLogger, npts), READONLY},
+    {(char*)"lost", T_UINT, offsetof(pyPositionLogger, lost), READONLY},
     {0, 0, 0, 0},
 };
 
@@ -2183,7 +2301,6 @@ initlinuxcnc(void) {
 
     PyType_Ready(&PositionLoggerType);
     PyModule_AddObject(m, "positionlogger", (PyObject*)&PositionLoggerType);
-    pthread_mutex_init(&mutex, NULL);
 
     PyModule_AddStringConstant(m, "nmlfile", EMC2_DEFAULT_NMLFILE);
 
@@ -43,6 +43,8 @@
 #define POLYNOMIAL 0xD8  /* 11011 followed by 0's */
 #define WIDTH  (8 * sizeof(crc))
 #define TOPBIT (1 << (WIDTH - 1))
+#define MAX_JOB_STATS 100
+#define HANDOFF_DELAY 0.01 // how long to sleep between checks while a job finishes
 
 typedef uint32_t crc;
 crc crcTable[256];
@@ -60,6 +62,7 @@ class SchedEntry {
     float feedOverride;
     float spindleOverride;
     int tool;
+    double queued;
 
   public:
     SchedEntry();
@@ -83,6 +86,8 @@ class SchedEntry {
     void setSpindleOverride(float s);
     int getTool() const;
     void setTool(int t);
+    double getQueued() const;
+    void setQueued(double t);
   };
 
 SchedEntry::SchedEntry() {
@@ -96,6 +101,7 @@ SchedEntry::SchedEntry() {
     feedOverride = 100.0;
     spindleOverride = 100.0;
     tool = 1;
+    queued = 0.0;
   }
 
 list<SchedEntry> q;
@@ -187,6 +193,37 @@ void SchedEntry::setTool(int t) {
   tool = t;
   }
 
+double SchedEntry::getQueued() const {
+  return queued;
+  }
+
+void SchedEntry::setQueued(double t) {
+  queued = t;
+  }
+
+// The job at the front of the queue, made ready while the one before it
+// runs, so that starting it takes nothing but sending the commands.
+static struct {
+  int tagId;            // -1 if none is ready
+  bool readable;
+  char path[255];
+  string setup[2];      // MDI blocks that set up its origin
+  int setupCount;
+  } nextJob;
+
+// The job that is running, if it was started by the queue
+static struct {
+  bool running;
+  double runTime;       // when its program was run
+  jobStatType stat;
+  } currentJob;
+
+// When the previous job was done, or 0 if the queue has not gone
+// straight from one job to the next since
+static double lastEnd = 0.0;
+
+list<jobStatType> stats;
+
 static void crcInit() {
   crc rmdr;
   int i;
@@ -245,77 +282,143 @@ bool interlocksOk() {
   return true;
 }
 
-void updateQueue() {
-  char fileStr[255];
-  float x, y, z;
+static void prepareJob(SchedEntry &e) {
+  static const char *zones[] = {
+    "G54", "G55", "G56", "G57", "G58", "G59", "G59.1", "G59.2", "G59.3"};
+  char buf[4096];
   char cmd[80];
+  float x, y, z;
+  FILE *f;
+
+  nextJob.tagId = e.getTagId();
+  snprintf(nextJob.path, sizeof(nextJob.path), "%s%s", defaultPath,
+    e.getFileName().c_str());
+  // Read it through once, so that it is in the page cache by the time
+  // the interpreter opens it and a missing file is known beforehand
+  f = fopen(nextJob.path, "r");
+  nextJob.readable = (f != NULL);
+  if (f != NULL) {
+    while (fread(buf, 1, sizeof(buf), f) == sizeof(buf));
+    fclose(f);
+    }
+  // The interpreter selects the coordinate system before it runs G92.1,
+  // but G92.1 only clears the G92 offsets, which the G54-G59.3 origin
+  // offsets do not depend on, so the order makes no difference.  The
+  // motion of a block runs after both, so it already sees the cleared
+  // offsets.  Each of these used to be two blocks.
+  if ((e.getZone() >= 1) && (e.getZone() <= 9)) {
+    sprintf(cmd, "G92.1 %s\n", zones[e.getZone() - 1]);
+    nextJob.setup[0] = cmd;
+    nextJob.setupCount = 1;
+    }
+  else if (e.getZone() == 0) {
+    e.getOffsets(x, y, z);
+    sprintf(cmd, "G92.1 G0 X%f Y%f Z%f\n", x, y, z);
+    nextJob.setup[0] = cmd;
+    nextJob.setup[1] = "G92 X0 Y0 Z0\n";
+    nextJob.setupCount = 2;
+    }
+  else {
+    nextJob.setup[0] = "G92.1\n";
+    nextJob.setupCount = 1;
+    }
+  }
 
-  if (queueStatus == qsRun) {
-    if (isIdle() && q.empty()) {
-      queueStatus = qsStop;
+static void finishJob() {
+  double now;
+
+  if (!currentJob.running) return;
+  now = etime();
+  currentJob.running = false;
+  currentJob.stat.run = now - currentJob.runTime;
+  stats.push_back(currentJob.stat);
+  if (stats.size() > MAX_JOB_STATS) stats.pop_front();
+  lastEnd = now;
+  }
+
+// Once the interpreter has read all of the current job and only motion
+// is left, waits for it here instead of until the next poll, so that the
+// next job can start as soon as the machine is done.
+static bool waitForEnd() {
+  while ((queueStatus == qsRun) && 
+    (emcStatus->task.interpState == EMC_TASK_INTERP_WAITING)) {
+    esleep(HANDOFF_DELAY);
+    updateStatus();
+    }
+  return (queueStatus == qsRun) && isIdle();
+  }
+
+static void startJob() {
+  SchedEntry &e = q.front();
+  double start = etime();
+  int i;
+
+  e.setPriority(MAX_PRIORITY); // Lock job as first job
+  if (!interlocksOk()) {
+    queueStatus = qsError;
+    return;
+    }
+  if (nextJob.tagId != e.getTagId()) prepareJob(e);
+  nextJob.tagId = -1;
+  if (!nextJob.readable) {
+    queueStatus = qsError;
+    return;
+    }
+  currentJob.stat.tagId = e.getTagId();
+  snprintf(currentJob.stat.fileName, sizeof(currentJob.stat.fileName), "%s",
+    e.getFileName().c_str());
+  currentJob.stat.wait = start - e.getQueued();
+
+  sendFeedOverride(((double) e.getFeedOverride()) / 100.0);
+  sendSpindleOverride(((double) e.getSpindleOverride()) / 100.0);             
+  sendMdi();
+  for (i = 0; i < nextJob.setupCount; i++) {
+    sendMdiCmd(nextJob.setup[i].c_str());
+    if (emcCommandWaitDone(emcCommandSerialNumber) != 0) {
+      queueStatus = qsError;
       return;
       }
-    if (!q.empty()) {
+    }
+  if (sendTaskPlanInit() != 0) {
+    queueStatus = qsError;
+    return;
+    }
+  sendAuto();
+  if (sendProgramOpen(nextJob.path) != 0) {
+    queueStatus = qsError;
+    return;
+    }
+  if (sendProgramRun(0) != 0) {
+    queueStatus = qsError;
+    }
+  else {
+    currentJob.running = true;
+    currentJob.runTime = etime();
+    currentJob.stat.setup = currentJob.runTime - start;
+    currentJob.stat.gap = (lastEnd > 0.0) ? currentJob.runTime - lastEnd : -1.0;
+    }
+  lastEnd = 0.0;
+  q.remove(q.front());
+  }
+
+void updateQueue() {
+  updateStatus();
+  if (isIdle()) finishJob();
+
+  if (queueStatus == qsRun) {
+    if (q.empty()) {
       if (isIdle()) {
-        q.front().setPriority(MAX_PRIORITY); // Lock job as first job
-        if (interlocksOk()) {
-          sendFeedOverride(((double) q.front().getFeedOverride()) / 100.0);
-          sendSpindleOverride(((double) q.front().getSpindleOverride()) / 100.0);             
-          sendMdi();
-          sendMdiCmd("G92.1\n");
-          if (emcCommandWaitDone(emcCommandSerialNumber) != 0) {
-            queueStatus = qsError;
-            return;
-            }
-          if (q.front().getZone() != 0) {
-            switch (q.front().getZone()) {
-              case 1: sendMdiCmd("G54\n"); break;
-              case 2: sendMdiCmd("G55\n"); break;
-              case 3: sendMdiCmd("G56\n"); break;
-              case 4: sendMdiCmd("G57\n"); break;
-              case 5: sendMdiCmd("G58\n"); break;
-              case 6: sendMdiCmd("G59\n"); break;
-              case 7: sendMdiCmd("G59.1\n"); break;
-              case 8: sendMdiCmd("G59.2\n"); break;
-              case 9: sendMdiCmd("G59.3\n");
-              }
-            if (emcCommandWaitDone(emcCommandSerialNumber) != 0) {
-              queueStatus = qsError;
-              return;
-              }
-            }
-          else {
-             q.front().getOffsets(x, y, z);
-             sprintf(cmd, "G0 X%f Y%f Z%f\n", x, y, z); 
-             sendMdiCmd(cmd);
-             if (emcCommandWaitDone(emcCommandSerialNumber) != 0) {
-               queueStatus = qsError;
-               return;
-               }
-             sendMdiCmd("G92 X0 Y0 Z0\n");
-             if (emcCommandWaitDone(emcCommandSerialNumber) != 0) {
-               queueStatus = qsError;
-               return;
-               }
-             }
-          if (sendTaskPlanInit() != 0) {
-            queueStatus = qsError;
-            }
-          sendAuto();
-          strcpy(fileStr, defaultPath);
-          strcat(fileStr, q.front().getFileName().c_str());
-          if (sendProgramOpen(fileStr) != 0) {
-            queueStatus = qsError;
-            return;
-            }
-          if (sendProgramRun(0) != 0) {
-            queueStatus = qsError;
-            }
-          q.remove(q.front());
-          }
-        else queueStatus = qsError;
-        } 
+        queueStatus = qsStop;
+        lastEnd = 0.0;
+        }
+      return;
+      }
+    if (!isIdle()) {
+      if (nextJob.tagId != q.front().getTagId()) prepareJob(q.front());
+      if (!waitForEnd()) return;
+      finishJob();
       }
+    startJob();
     }
   }
 
@@ -331,6 +434,7 @@ int addProgram(int pri, int tag, float x, float y, float z, int azone, string pr
   p.setFeedOverride(feedOvr);
   p.setSpindleOverride(spindleOvr);
   p.setTool(toolNum);
+  p.setQueued(etime());
   q.push_back(p);
   q.sort();
   return q.size();
@@ -352,15 +456,18 @@ int getStatus() {
 
 void queueStart() {
   setQueueStatus(qsRun);
+  lastEnd = 0.0;
   }
 
 void queueStop() {
   setQueueStatus(qsStop);
   clearQueue();
+  lastEnd = 0.0;
   }
 
 void queuePause() {
   setQueueStatus(qsPause);
+  lastEnd = 0.0;
   }
 
 int getProgramById(int id, qRecType *qRec) {
@@ -517,6 +624,30 @@ void resetTagIds(int startId) {
   autoTagId = startId;
   }
 
+int getJobStatCount() {
+  return stats.size();
+  }
+
+int getJobStatByIndex(int idx, jobStatType *stat) {
+  list<jobStatType>::iterator i;
+  int index = 0;
+
+  for (i=stats.begin(); i!=stats.end(); ++i) {
+    if (index == idx) {
+      *stat = *i;
+      return 0;
+      }
+    index++;
+    }
+  return -1;
+  }
+
+void clearJobStats() {
+  stats.clear();
+  }
+
 void schedInit() {
   crcInit();
+  nextJob.tagId = -1;
+  currentJob.running = false;
   }
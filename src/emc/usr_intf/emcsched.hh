@@ -37,6 +37,18 @@ typedef struct {
     int tool;
     } qRecType;
 
+typedef struct {
+    int tagId;
+    char fileName[255];
+    double wait;        // seconds in the queue before its setup began
+    double setup;       // seconds from the start of setup to program run
+    double run;         // seconds from program run until it was done
+    double gap;         // seconds the machine was idle between the end of
+                        // the previous job and the start of this one, or
+                        // -1 if the queue did not go straight from one to
+                        // the other
+    } jobStatType;
+
 extern int addProgram(int pri, int tag, float x, float y, float z, int azone, string progName, float feedOvr, float spindleOvr, int toolNum);
 extern void updateQueue();
 extern int getQueueSize();
@@ -58,6 +70,9 @@ extern int getPriorityById(int id, int &pri);
 extern int getPriorityByIndex(int idx, int &pri);
 extern int getNextTagId();
 extern void resetTagIds(int startId);
+extern int getJobStatCount();
+extern int getJobStatByIndex(int idx, jobStatType *stat);
+extern void clearJobStats();
 extern void schedInit();
 
 #endif				/* ifndef SHCOM_HH */
@@ -220,6 +220,14 @@
   PollRate <rate>
   With set, sets the rate at which the scheduler polls for information. The default is 1.0 or one
   second. With get, returns the current poll rate.
+
+  JobStats clear
+  With get, returns the timing of the last 100 programs the queue ran, oldest first, each in the
+  form "JOBSTATS <tag id> <file name> <wait> <setup> <run> <gap>" with cr lf at the end of each
+  record. Wait is the time in seconds the program spent in the queue, setup the time from the start
+  of its setup until it was run, and run the time it took to run. Gap is the time from the end of
+  the previous program until this one was run, or -1 if the queue stopped or paused in between.
+  With set and "clear", forgets the timing of the programs run so far.
 */
 
 // EMC_STAT *emcStatus;
@@ -230,7 +238,7 @@ typedef enum {
 typedef enum {
   scEcho, scVerbose, scEnable, scConfig, scCommMode, scCommProt, scIniFile, scPlat, scIni, scDebug, 
   scQMode, scQStatus, scAutoTagId, scPgmAdd, scPgmById, scPgmByIndex, scPgmAll, scPriorityById, 
-  scPriorityByIndex, scDeleteById, scDeleteByIndex, scPollRate, scUnknown} setCommandType;
+  scPriorityByIndex, scDeleteById, scDeleteByIndex, scPollRate, scJobStats, scUnknown} setCommandType;
   
 typedef enum {
   rtNoError, rtHandledNoError, rtStandardError, rtCustomError, rtCustomHandledError
@@ -269,7 +277,7 @@ float pollDelay = 1.0;
 const char *setCommands[] = {
    "ECHO", "VERBOSE", "ENABLE", "CONFIG", "COMM_MODE", "COMM_PROT", "INIFILE", "PLAT", "INI", "DEBUG",
    "QMODE", "QSTATUS", "AUTOTAGID", "PGMADD", "PGMBYID", "PGMBYINDEX", "PGMALL", "PRIORITYBYID", 
-   "PRIORITYBYINDEX", "DELETEBYID", "DELETEBYINDEX", "POLLRATE",
+   "PRIORITYBYINDEX", "DELETEBYID", "DELETEBYINDEX", "POLLRATE", "JOBSTATS",
    ""};
 
 const char *commands[] = {"HELLO", "SET", "GET", "QUIT", "SHUTDOWN", "HELP", ""};
@@ -618,6 +626,15 @@ static cmdResponseType setDeleteByIndex(char *s, connectionRecType *context)
   return rtNoError;
 }
 
+static cmdResponseType setJobStats(char *s, connectionRecType *context)
+{
+  if (s == NULL) return rtStandardError;
+  strupr(s);
+  if (strcmp(s, "CLEAR") != 0) return rtStandardError;
+  clearJobStats();
+  return rtNoError;
+}
+
 static cmdResponseType setPollRate(char *s, connectionRecType *context)
 {
   float rate;
@@ -670,6 +687,7 @@ int commandSet(connectionRecType *context)
     case scDeleteById: ret = setDeleteById(strtok(NULL, delims), context); break;
     case scDeleteByIndex: ret = setDeleteByIndex(strtok(NULL, delims), context); break;
     case scPollRate: ret = setPollRate(strtok(NULL, delims), context); break;
+    case scJobStats: ret = setJobStats(strtok(NULL, delims), context); break;
     case scUnknown: ret = rtStandardError;
     }
   switch (ret) {
@@ -876,6 +894,22 @@ static cmdResponseType getPollRate(connectionRecType *context)
   return rtNoError;
 }
 
+static cmdResponseType getJobStats(connectionRecType *context)
+{
+  jobStatType stat;
+  int i;
+  int sz;
+
+  sz = getJobStatCount();
+  for (i = 0; i < sz; i++) {
+    if (getJobStatByIndex(i, &stat) != 0) continue;
+    sprintf(context->outBuf, "JOBSTATS %d %s %f %f %f %f", 
+      stat.tagId, stat.fileName, stat.wait, stat.setup, stat.run, stat.gap);
+    sockWrite(context);
+    }
+  return rtHandledNoError;
+}
+
 int commandGet(connectionRecType *context)
 {
   static const char *setNakStr = "GET NAK\r\n";
@@ -916,6 +950,7 @@ int commandGet(connectionRecType *context)
     case scDeleteById: break;
     case scDeleteByIndex: break;
     case scPollRate: ret = getPollRate(context); break;
+    case scJobStats: ret = getJobStats(context); break;
     case scUnknown: ret = rtStandardError;
     }
   switch (ret) {
@@ -996,6 +1031,7 @@ static int helpGet(connectionRecType *context)
   strcat(context->outBuf, "    Echo\n\r");
   strcat(context->outBuf, "    Enable\n\r");
   strcat(context->outBuf, "    Inifile\n\r");
+  strcat(context->outBuf, "    JobStats\n\r");
   strcat(context->outBuf, "    PgmById <Tag Id>\n\r");
   strcat(context->outBuf, "    PgmByIndex <Index>\n\r");
   strcat(context->outBuf, "    PriorityById <Tag Id>\n\r");
@@ -1022,6 +1058,7 @@ static int helpSet(connectionRecType *context)
   strcat(context->outBuf, "    Verbose <On | Off>\n\r\n\r");
   strcat(context->outBuf, "  The set commands requiring control enabled are:\n\r");
   strcat(context->outBuf, "    AutoTagId <Start Id>\n\r");
+  strcat(context->outBuf, "    JobStats Clear\n\r");
   strcat(context->outBuf, "    PgmAdd <Priority> <Tag Id> <X> <Y> <Z> <Zone> <File Name> <Feed Override> <Spindle Override> <Tool No>\n\r");
   strcat(context->outBuf, "    PriorityById <Tag Id> <Priority>\n\r");
   strcat(context->outBuf, "    PriorityByIndex <Index> <Priority>\n\r");
@@ -1143,7 +1180,7 @@ void *checkQueue(void *arg)
 {
   while (1) {
     updateQueue();
-    sleep((unsigned)pollDelay);
+    esleep(pollDelay);
     }
   return 0;
 }  
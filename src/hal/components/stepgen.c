@@ -51,6 +51,24 @@
     values of the position feedback counters.  Both 'update-freq' and
     'capture-position' use floating point, 'make-pulses' does not.
 
+    Timed channels:
+
+    A third command line parameter, "timed", moves the work of a
+    channel out of 'make-pulses'.  For a channel with timed=1,
+    'update-freq' works out the exact time of every step of the next
+    servo period and queues them (see stepgen_queue.h), instead of
+    handing a frequency to a DDS.  'make-pulses' then only compares
+    the time of the next queued step with the clock, and a hardware
+    driver that can time edges by itself can take the steps from the
+    queue instead, without a fast thread at all.  The timing
+    parameters below apply as usual; a step that is due is delayed
+    by them, never dropped.  The position feedback counts steps as
+    they are queued.  When 'enable' goes false, 'make-pulses' throws
+    away the steps still queued and 'update-freq' takes them back off
+    the feedback.
+
+	insmod stepgen step_type=0,0,0 timed=1,1,1
+
     Polarity:
 
     All signals from this module have fixed polarity (active high
@@ -303,6 +321,7 @@
 
 #include <float.h>
 #include "rtapi_math.h"
+#include "stepgen_queue.h"	/* step event queue of timed channels */
 
 #define MAX_CHAN 8
 #define MAX_CYCLE 10
@@ -316,6 +335,8 @@ int step_type[MAX_CHAN] = { -1, -1, -1, -1, -1, -1, -1, -1 };
 RTAPI_MP_ARRAY_INT(step_type,MAX_CHAN,"stepping types for up to 8 channels");
 const char *ctrl_type[MAX_CHAN];
 RTAPI_MP_ARRAY_STRING(ctrl_type,MAX_CHAN,"control type (pos or vel) for up to 8 channels");
+int timed[MAX_CHAN];
+RTAPI_MP_ARRAY_INT(timed,MAX_CHAN,"queue exact step times (1) instead of running a DDS (0) for up to 8 channels");
 int user_step_type[MAX_CYCLE] = {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1};
 RTAPI_MP_ARRAY_INT(user_step_type, MAX_CYCLE,
 	"lookup table for user-defined step type");
@@ -340,6 +361,8 @@ typedef struct {
     hal_s32_t rawcount;		/* param: position feedback in counts */
     int curr_dir;		/* current direction */
     int state;			/* current position in state table */
+    stepgen_queue_t *queue;	/* step events of a timed channel, or 0 */
+    volatile int dropped;	/* timed: net steps thrown away unmade */
     /* stuff that is read but not written by makepulses */
     hal_bit_t *enable;		/* pin for enable stepgen */
     long target_addval;		/* desired freq generator add value */
@@ -371,6 +394,9 @@ typedef struct {
     hal_u32_t old_dir_hold_dly;
     hal_u32_t old_dir_setup;
     int printed_error;		/* flag to avoid repeated printing */
+    double tpos;		/* timed: position queued so far (counts) */
+    int dropped_seen;		/* timed: 'dropped' already taken back */
+    hal_u32_t queue_overruns;	/* param: periods the queue was full */
 } stepgen_t;
 
 /* ptr to array of stepgen_t structs in shared memory, 1 per channel */
@@ -415,6 +441,8 @@ static unsigned char num_phases_lut[] =
 /* other globals */
 static int comp_id;		/* component ID */
 static int num_chan = 0;	/* number of step generators configured */
+static int num_timed = 0;	/* how many of them are timed */
+static int shmem_id[MAX_CHAN];	/* step event queues of timed channels */
 static long periodns;		/* makepulses function period in nanosec */
 static long old_periodns;	/* used to detect changes in periodns */
 static double periodfp;		/* makepulses function period in seconds */
@@ -430,7 +458,7 @@ typedef enum CONTROL { POSITION, VELOCITY, INVALID } CONTROL;
 *                  LOCAL FUNCTION DECLARATIONS                         *
 ************************************************************************/
 
-static int export_stepgen(int num, stepgen_t * addr, int step_type, int pos_mode);
+static int export_stepgen(int num, stepgen_t * addr, int step_type, int pos_mode, int timed);
 static void make_pulses(void *arg, long period);
 static void update_freq(void *arg, long period);
 static void update_pos(void *arg, long period);
@@ -464,6 +492,9 @@ int rtapi_app_main(void)
 			    ctrl_type[n], n);
 	    return -1;
 	}
+	if (timed[n]) {
+	    num_timed++;
+	}
 	num_chan++;
     }
     if (num_chan == 0) {
@@ -471,6 +502,10 @@ int rtapi_app_main(void)
 			"STEPGEN: ERROR: no channels configured\n");
 	return -1;
     }
+    /* clear shmem IDs */
+    for (n = 0; n < MAX_CHAN; n++) {
+	shmem_id[n] = -1;
+    }
     /* periodns will be set to the proper value when 'make_pulses()' runs for 
        the first time.  We load a default value here to avoid glitches at
        startup, but all these 'constants' are recomputed inside
@@ -502,7 +537,8 @@ int rtapi_app_main(void)
     for (n = 0; n < num_chan; n++) {
 	/* export all vars */
 	retval = export_stepgen(n, &(stepgen_array[n]),
-	    step_type[n], (parse_ctrl_type(ctrl_type[n]) == POSITION));
+	    step_type[n], (parse_ctrl_type(ctrl_type[n]) == POSITION),
+	    timed[n]);
 	if (retval != 0) {
 	    rtapi_print_msg(RTAPI_MSG_ERR,
 		"STEPGEN: ERROR: stepgen %d var export failed\n", n);
@@ -543,6 +579,14 @@ int rtapi_app_main(void)
 
 void rtapi_app_exit(void)
 {
+    int n;
+
+    /* free the step event queues */
+    for (n = 0; n < MAX_CHAN; n++) {
+	if (shmem_id[n] >= 0) {
+	    rtapi_shmem_delete(shmem_id[n], comp_id);
+	}
+    }
     hal_exit(comp_id);
 }
 
@@ -550,20 +594,166 @@ void rtapi_app_exit(void)
 *              REALTIME STEP PULSE GENERATION FUNCTIONS                *
 ************************************************************************/
 
+/* moves to the next (or previous) state of step types 2 and up */
+static void advance_state(stepgen_t *stepgen)
+{
+    if ( stepgen->step_type >= 2 ) {
+	/* update state */
+	stepgen->state += stepgen->curr_dir;
+	if ( stepgen->state < 0 ) {
+	    stepgen->state = stepgen->cycle_max;
+	} else if ( stepgen->state > stepgen->cycle_max ) {
+	    stepgen->state = 0;
+	}
+    }
+}
+
 /** The frequency generator works by adding a signed value proportional
     to frequency to an accumulator.  When bit PICKOFF of the accumulator
     toggles, a step is generated.
 */
 
+static void dds_step(stepgen_t *stepgen)
+{
+    long old_addval, target_addval, new_addval, step_now;
+
+    if ( !stepgen->hold_dds && *(stepgen->enable) ) {
+	/* update addval (ramping) */
+	old_addval = stepgen->addval;
+	target_addval = stepgen->target_addval;
+	if (stepgen->deltalim != 0) {
+	    /* implement accel/decel limit */
+	    if (target_addval > (old_addval + stepgen->deltalim)) {
+		/* new value is too high, increase addval as far as possible */
+		new_addval = old_addval + stepgen->deltalim;
+	    } else if (target_addval < (old_addval - stepgen->deltalim)) {
+		/* new value is too low, decrease addval as far as possible */
+		new_addval = old_addval - stepgen->deltalim;
+	    } else {
+		/* new value can be reached in one step - do it */
+		new_addval = target_addval;
+	    }
+	} else {
+	    /* go to new freq without any ramping */
+	    new_addval = target_addval;
+	}
+	/* save result */
+	stepgen->addval = new_addval;
+	/* check for direction reversal */
+	if (((new_addval >= 0) && (old_addval < 0)) ||
+	    ((new_addval < 0) && (old_addval >= 0))) {
+	    /* reversal required, can we do so now? */
+	    if ( stepgen->timer3 != 0 ) {
+		/* no - hold everything until delays time out */
+		stepgen->hold_dds = 1;
+	    }
+	}
+    }
+    /* update DDS */
+    if ( !stepgen->hold_dds && *(stepgen->enable) ) {
+	/* save current value of low half of accum */
+	step_now = stepgen->accum;
+	/* update the accumulator */
+	stepgen->accum += stepgen->addval;
+	/* test for changes in low half of accum */
+	step_now ^= stepgen->accum;
+	/* we only care about the pickoff bit */
+	step_now &= (1L << PICKOFF);
+	/* update rawcounts parameter */
+	stepgen->rawcount = stepgen->accum >> PICKOFF;
+    } else {
+	/* DDS is in hold, no steps */
+	step_now = 0;
+    }
+    if ( stepgen->timer2 == 0 ) {
+	/* update direction - do not change if addval = 0 */
+	if ( stepgen->addval > 0 ) {
+	    stepgen->curr_dir = 1;
+	} else if ( stepgen->addval < 0 ) {
+	    stepgen->curr_dir = -1;
+	}
+    }
+    if ( step_now ) {
+	/* (re)start various timers */
+	/* timer 1 = time till end of step pulse */
+	stepgen->timer1 = stepgen->step_len;
+	/* timer 2 = time till allowed to change dir pin */
+	stepgen->timer2 = stepgen->timer1 + stepgen->dir_hold_dly;
+	/* timer 3 = time till allowed to step the other way */
+	stepgen->timer3 = stepgen->timer2 + stepgen->dir_setup;
+	advance_state(stepgen);
+    }
+}
+
+/* Takes the next step of a timed channel off its queue, once it is due
+   and the timing parameters allow it.  The timers mean something a bit
+   different here: timer1 runs until the end of the step pulse, timer2
+   until the next step may start, and timer3 until the direction may
+   change. */
+static void queued_step(stepgen_t *stepgen, long long now)
+{
+    stepgen_queue_t *queue;
+    stepgen_event_t *event;
+
+    queue = stepgen->queue;
+    if ( !*(stepgen->enable) ) {
+	/* disabled: throw away what is queued, update-freq takes it back
+	   off the feedback */
+	unsigned int out, in;
+	in = queue->in;
+	for ( out = queue->out ; out != in ; out++ ) {
+	    stepgen->dropped += queue->event[out % STEPGEN_QUEUE_LEN].dir;
+	}
+	/* done with the events before their slots go back to update-freq */
+	__sync_synchronize();
+	queue->out = in;
+	return;
+    }
+    if ( queue->out == queue->in ) {
+	/* nothing queued */
+	return;
+    }
+    event = &(queue->event[queue->out % STEPGEN_QUEUE_LEN]);
+    if ( event->time > now ) {
+	/* not due yet */
+	return;
+    }
+    if ( event->dir != stepgen->curr_dir ) {
+	if ( stepgen->timer3 != 0 ) {
+	    /* too soon after the last step to change direction */
+	    return;
+	}
+	stepgen->curr_dir = event->dir;
+	if ( stepgen->timer2 < stepgen->dir_setup ) {
+	    stepgen->timer2 = stepgen->dir_setup;
+	}
+    }
+    if ( ( stepgen->timer1 != 0 ) || ( stepgen->timer2 != 0 ) ) {
+	return;
+    }
+    stepgen->timer1 = stepgen->step_len;
+    stepgen->timer2 = stepgen->step_len + stepgen->step_space;
+    stepgen->timer3 = stepgen->step_len + stepgen->dir_hold_dly;
+    advance_state(stepgen);
+    /* done with the event before its slot goes back to update-freq */
+    __sync_synchronize();
+    queue->out++;
+}
+
 static void make_pulses(void *arg, long period)
 {
     stepgen_t *stepgen;
-    long old_addval, target_addval, new_addval, step_now;
+    long long now;
     int n, p;
     unsigned char outbits;
 
     /* store period so scaling constants can be (re)calculated */
     periodns = period;
+    /* timed channels compare the queued step times with this */
+    now = 0;
+    if ( num_timed ) {
+	now = rtapi_get_time();
+    }
     /* point to stepgen data structures */
     stepgen = arg;
 
@@ -592,79 +782,16 @@ static void make_pulses(void *arg, long period)
 		stepgen->hold_dds = 0;
 	    }
 	}
-	if ( !stepgen->hold_dds && *(stepgen->enable) ) {
-	    /* update addval (ramping) */
-	    old_addval = stepgen->addval;
-	    target_addval = stepgen->target_addval;
-	    if (stepgen->deltalim != 0) {
-		/* implement accel/decel limit */
-		if (target_addval > (old_addval + stepgen->deltalim)) {
-		    /* new value is too high, increase addval as far as possible */
-		    new_addval = old_addval + stepgen->deltalim;
-		} else if (target_addval < (old_addval - stepgen->deltalim)) {
-		    /* new value is too low, decrease addval as far as possible */
-		    new_addval = old_addval - stepgen->deltalim;
-		} else {
-		    /* new value can be reached in one step - do it */
-		    new_addval = target_addval;
-		}
-	    } else {
-		/* go to new freq without any ramping */
-		new_addval = target_addval;
-	    }
-	    /* save result */
-	    stepgen->addval = new_addval;
-	    /* check for direction reversal */
-	    if (((new_addval >= 0) && (old_addval < 0)) ||
-		((new_addval < 0) && (old_addval >= 0))) {
-		/* reversal required, can we do so now? */
-		if ( stepgen->timer3 != 0 ) {
-		    /* no - hold everything until delays time out */
-		    stepgen->hold_dds = 1;
-		}
+	if ( stepgen->queue ) {
+	    /* timed channel, the steps are already worked out */
+	    if ( stepgen->queue->claimed ) {
+		/* and a driver takes care of them */
+		stepgen++;
+		continue;
 	    }
-	}
-	/* update DDS */
-	if ( !stepgen->hold_dds && *(stepgen->enable) ) {
-	    /* save current value of low half of accum */
-	    step_now = stepgen->accum;
-	    /* update the accumulator */
-	    stepgen->accum += stepgen->addval;
-	    /* test for changes in low half of accum */
-	    step_now ^= stepgen->accum;
-	    /* we only care about the pickoff bit */
-	    step_now &= (1L << PICKOFF);
-	    /* update rawcounts parameter */
-	    stepgen->rawcount = stepgen->accum >> PICKOFF;
+	    queued_step(stepgen, now);
 	} else {
-	    /* DDS is in hold, no steps */
-	    step_now = 0;
-	}
-	if ( stepgen->timer2 == 0 ) {
-	    /* update direction - do not change if addval = 0 */
-	    if ( stepgen->addval > 0 ) {
-		stepgen->curr_dir = 1;
-	    } else if ( stepgen->addval < 0 ) {
-		stepgen->curr_dir = -1;
-	    }
-	}
-	if ( step_now ) {
-	    /* (re)start various timers */
-	    /* timer 1 = time till end of step pulse */
-	    stepgen->timer1 = stepgen->step_len;
-	    /* timer 2 = time till allowed to change dir pin */
-	    stepgen->timer2 = stepgen->timer1 + stepgen->dir_hold_dly;
-	    /* timer 3 = time till allowed to step the other way */
-	    stepgen->timer3 = stepgen->timer2 + stepgen->dir_setup;
-	    if ( stepgen->step_type >= 2 ) {
-		/* update state */
-		stepgen->state += stepgen->curr_dir;
-		if ( stepgen->state < 0 ) {
-		    stepgen->state = stepgen->cycle_max;
-		} else if ( stepgen->state > stepgen->cycle_max ) {
-		    stepgen->state = 0;
-		}
-	    }
+	    dds_step(stepgen);
 	}
 	/* generate output, based on stepping type */
 	if (stepgen->step_type == 0) {
@@ -762,6 +889,96 @@ static unsigned long ulceil(unsigned long value, unsigned long increment)
     return increment*(((value-1)/increment)+1);
 }
 
+/* Queues the steps of a timed channel where its position, starting at
+   p0 at time t0 (sec after start) with velocity v0 and acceleration a,
+   crosses the middle between two counts on its way to p1.  The position
+   must move one way only.  Returns -1 if the queue filled up, after
+   leaving tpos on the last count that made it into the queue. */
+static int queue_segment(stepgen_t *stepgen, long long start, double t0,
+    double p0, double v0, double a, double p1)
+{
+    stepgen_queue_t *queue;
+    stepgen_event_t *event;
+    double s, b, d, disc, den, t;
+    long k;
+
+    queue = stepgen->queue;
+    if ( p1 > p0 ) {
+	s = 1.0;
+	/* first boundary above p0 */
+	k = floor(p0 - 0.5) + 1;
+    } else if ( p1 < p0 ) {
+	s = -1.0;
+	/* first boundary below p0 */
+	k = ceil(p0 - 0.5) - 1;
+    } else {
+	return 0;
+    }
+    for ( b = k + 0.5 ; s * (p1 - b) >= 0.0 ; b += s ) {
+	if ( queue->in - queue->out >= STEPGEN_QUEUE_LEN ) {
+	    /* the consumer is not keeping up */
+	    stepgen->tpos = b - s * 0.5;
+	    return -1;
+	}
+	/* solve d = v0*t + a*t*t/2 for the first t >= 0, in a form that
+	   holds up when a is zero */
+	d = b - p0;
+	disc = v0 * v0 + 2.0 * a * d;
+	if ( disc < 0.0 ) {
+	    disc = 0.0;
+	}
+	den = v0 + s * sqrt(disc);
+	t = t0;
+	if ( den != 0.0 ) {
+	    t += 2.0 * d / den;
+	}
+	if ( t > dt ) {
+	    t = dt;
+	}
+	event = &(queue->event[queue->in % STEPGEN_QUEUE_LEN]);
+	event->time = start + (long)(t * 1000000000.0);
+	event->dir = (s > 0.0) ? 1 : -1;
+	/* the event has to be complete before 'in' says it is there */
+	__sync_synchronize();
+	queue->in++;
+	/* the feedback counts the step now */
+	stepgen->accum += event->dir * (1LL << PICKOFF);
+	stepgen->rawcount = stepgen->accum >> PICKOFF;
+    }
+    return 0;
+}
+
+/* Queues the steps of a timed channel for the period starting at 'start',
+   in which its velocity ramps from v0 to v1 (counts/sec).  Returns the
+   velocity reached, which is zero if the queue filled up. */
+static double queue_steps(stepgen_t *stepgen, long long start,
+    double v0, double v1)
+{
+    double p0, a, tr, pr, p1;
+
+    p0 = stepgen->tpos;
+    a = (v1 - v0) * recip_dt;
+    if ( ( v0 > 0.0 && v1 < 0.0 ) || ( v0 < 0.0 && v1 > 0.0 ) ) {
+	/* it reverses when the velocity goes through zero */
+	tr = -v0 / a;
+	pr = p0 + 0.5 * v0 * tr;
+	p1 = pr + 0.5 * v1 * (dt - tr);
+	if ( queue_segment(stepgen, start, 0.0, p0, v0, a, pr) != 0 ||
+	    queue_segment(stepgen, start, tr, pr, 0.0, a, p1) != 0 ) {
+	    stepgen->queue_overruns++;
+	    return 0.0;
+	}
+    } else {
+	p1 = p0 + 0.5 * (v0 + v1) * dt;
+	if ( queue_segment(stepgen, start, 0.0, p0, v0, a, p1) != 0 ) {
+	    stepgen->queue_overruns++;
+	    return 0.0;
+	}
+    }
+    stepgen->tpos = p1;
+    return v1;
+}
+
 static void update_freq(void *arg, long period)
 {
     stepgen_t *stepgen;
@@ -771,6 +988,7 @@ static void update_freq(void *arg, long period)
     double pos_cmd, vel_cmd, curr_pos, curr_vel, avg_v, max_freq, max_ac;
     double match_ac, match_time, est_out, est_cmd, est_err, dp, dv, new_vel;
     double desired_freq;
+    long long now;
     /*! \todo FIXME - while this code works just fine, there are a bunch of
        internal variables, many of which hold intermediate results that
        don't really need their own variables.  They are used either for
@@ -803,6 +1021,11 @@ static void update_freq(void *arg, long period)
 	recip_dt = 1.0 / dt;
     }
 
+    /* timed channels queue their steps from this time on */
+    now = 0;
+    if ( num_timed ) {
+	now = rtapi_get_time();
+    }
     /* point at stepgen data */
     stepgen = arg;
 
@@ -859,6 +1082,14 @@ static void update_freq(void *arg, long period)
 	    stepgen->old_dir_hold_dly = ulceil(stepgen->dir_hold_dly, periodns);
 	    stepgen->dir_hold_dly = stepgen->old_dir_hold_dly;
 	}
+	if ( stepgen->queue && stepgen->dropped != stepgen->dropped_seen ) {
+	    /* make-pulses threw away queued steps, they were never made */
+	    int lost = stepgen->dropped - stepgen->dropped_seen;
+	    stepgen->dropped_seen += lost;
+	    stepgen->accum -= (long long) lost << PICKOFF;
+	    stepgen->rawcount = stepgen->accum >> PICKOFF;
+	    stepgen->tpos -= lost;
+	}
 	/* test for disabled stepgen */
 	if (*stepgen->enable == 0) {
 	    /* disabled: keep updating old_pos_cmd (if in pos ctrl mode) */
@@ -876,6 +1107,11 @@ static void update_freq(void *arg, long period)
 	/* calculate frequency limit */
 	min_step_period = stepgen->step_len + stepgen->step_space;
 	max_freq = 1.0 / (min_step_period * 0.000000001);
+	if ( stepgen->queue
+	    && max_freq > (STEPGEN_QUEUE_LEN / 2) * recip_dt ) {
+	    /* leave room in the queue for a period that runs late */
+	    max_freq = (STEPGEN_QUEUE_LEN / 2) * recip_dt;
+	}
 	/* check for user specified frequency limit parameter */
 	if (stepgen->maxvel <= 0.0) {
 	    /* set to zero if negative */
@@ -936,6 +1172,10 @@ static void update_freq(void *arg, long period)
 	    /* convert from fixed point to double, after subtracting
 	       the one-half step offset */
 	    curr_pos = (accum_a-(1<< (PICKOFF-1))) * (1.0 / (1L << PICKOFF));
+	    if ( stepgen->queue ) {
+		/* timed channels know exactly where they will be */
+		curr_pos = stepgen->tpos;
+	    }
 	    /* get velocity in counts/sec */
 	    curr_vel = stepgen->freq;
 	    /* At this point we have good values for pos_cmd, curr_pos,
@@ -1014,6 +1254,10 @@ static void update_freq(void *arg, long period)
 	    }
 	    /* end of velocity mode */
 	}
+	if ( stepgen->queue ) {
+	    /* work out the steps of the coming period now */
+	    new_vel = queue_steps(stepgen, now, stepgen->freq, new_vel);
+	}
 	stepgen->freq = new_vel;
 	/* calculate new addval */
 	stepgen->target_addval = stepgen->freq * freqscale;
@@ -1029,9 +1273,10 @@ static void update_freq(void *arg, long period)
 *                   LOCAL FUNCTION DEFINITIONS                         *
 ************************************************************************/
 
-static int export_stepgen(int num, stepgen_t * addr, int step_type, int pos_mode)
+static int export_stepgen(int num, stepgen_t * addr, int step_type, int pos_mode, int timed)
 {
     int n, retval, msg;
+    void *shmem_ptr;
 
     /* This function exports a lot of stuff, which results in a lot of
        logging if msg_level is at INFO or ALL. So we save the current value
@@ -1105,6 +1350,12 @@ static int export_stepgen(int num, stepgen_t * addr, int step_type, int pos_mode
 	    comp_id, "stepgen.%d.dirdelay", num);
 	if (retval != 0) { return retval; }
     }
+    if ( timed ) {
+	/* export param for periods in which the step queue was full */
+	retval = hal_param_u32_newf(HAL_RO, &(addr->queue_overruns),
+	    comp_id, "stepgen.%d.queue-overruns", num);
+	if (retval != 0) { return retval; }
+    }
     /* export output pins */
     if ( step_type == 0 ) {
 	/* step and direction */
@@ -1187,6 +1438,33 @@ static int export_stepgen(int num, stepgen_t * addr, int step_type, int pos_mode
     /* other init */
     addr->printed_error = 0;
     addr->old_pos_cmd = 0.0;
+    addr->tpos = 0.0;
+    addr->dropped = 0;
+    addr->dropped_seen = 0;
+    addr->queue_overruns = 0;
+    addr->queue = 0;
+    if ( timed ) {
+	/* alloc shmem for the step queue, so a driver can find it */
+	shmem_id[num] = rtapi_shmem_new(STEPGEN_QUEUE_KEY+num, comp_id,
+	    sizeof(stepgen_queue_t));
+	if ( shmem_id[num] < 0 ) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"STEPGEN: ERROR: couldn't allocate step queue shared memory\n");
+	    return -1;
+	}
+	retval = rtapi_shmem_getptr(shmem_id[num], &shmem_ptr);
+	if ( retval < 0 ) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"STEPGEN: ERROR: couldn't map step queue shared memory\n");
+	    return -1;
+	}
+	addr->queue = shmem_ptr;
+	addr->queue->in = 0;
+	addr->queue->out = 0;
+	addr->queue->claimed = 0;
+	/* mark it inited for drivers */
+	addr->queue->magic = STEPGEN_QUEUE_MAGIC;
+    }
     /* set initial pin values */
     *(addr->count) = 0;
     *(addr->pos_fb) = 0.0;
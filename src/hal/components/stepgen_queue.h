@@ -0,0 +1,42 @@
+/********************************************************************
+* Description:  stepgen_queue.h
+*               Step event queue of the "stepgen" HAL component
+*
+*   A channel loaded with timed=1 does not run a DDS in make-pulses.
+*   Instead update-freq works out when each step of the next servo
+*   period is due and puts it into a queue in RTAPI shared memory, at
+*   key STEPGEN_QUEUE_KEY plus the channel number.  stepgen.make-pulses
+*   emits the queued steps as their time comes, with the resolution of
+*   the thread it runs in.  A driver that can time edges on its own
+*   can attach to the queue, set 'claimed' and take the steps itself;
+*   make-pulses then leaves that channel alone.
+*
+*   update-freq is the only writer of 'in' and the single consumer the
+*   only writer of 'out', so neither takes a lock.
+*
+* License: GPL Version 2
+*
+********************************************************************/
+#ifndef STEPGEN_QUEUE_H
+#define STEPGEN_QUEUE_H
+
+#define STEPGEN_QUEUE_KEY	0x53545130
+#define STEPGEN_QUEUE_MAGIC	0x53545051
+/* a power of two, so that the entry index stays right when in and out
+   wrap; a channel never queues more than half of it per servo period */
+#define STEPGEN_QUEUE_LEN	1024
+
+typedef struct {
+    long long time;		/* rtapi_get_time() at which the step is due */
+    int dir;			/* +1 or -1 */
+} stepgen_event_t;
+
+typedef struct {
+    unsigned int magic;
+    volatile unsigned int in;	/* number of events ever queued */
+    volatile unsigned int out;	/* number of events ever taken */
+    volatile int claimed;	/* a driver emits the steps, not make-pulses */
+    stepgen_event_t event[STEPGEN_QUEUE_LEN];
+} stepgen_queue_t;
+
+#endif
@@ -47,11 +47,20 @@
     <portnum> is the port number, starting from zero.  <pinnum> is
     the physical pin number on the DB-25 connector.
 
-    The realtime version of the driver exports two HAL functions for
-    each port, 'parport.<portnum>.read' and 'parport.<portnum>.write'.
-    It also exports two additional functions, 'parport.read-all' and
-    'parport.write-all'.  Any or all of these functions can be added
-    to realtime HAL threads to update the port data periodically.
+    The realtime version of the driver exports three HAL functions for
+    each port, 'parport.<portnum>.read', 'parport.<portnum>.write' and
+    'parport.<portnum>.reset'.  It also exports 'parport.read-all',
+    'parport.write-all' and 'parport.reset-all', which do the same for
+    every port.  Any or all of these functions can be added to realtime
+    HAL threads to update the port data periodically.
+
+    Each port access costs about a microsecond, so the driver keeps a
+    copy of what it last wrote to each output register.  With the
+    parameter 'parport.<portnum>.cache-outputs' set, 'write' and 'reset'
+    skip registers that already hold the new value.  'reset-all' waits
+    once for the latest deadline of all ports, then resets them all.
+    The parameters 'parport.<portnum>.read-io', '.write-io' and
+    '.reset-io' count the port accesses each function has made.
 
     The user space version of the driver cannot export functions,
     instead it exports parameters with the same names.  The main()
@@ -153,9 +162,19 @@ typedef struct {
     unsigned char outdata_ctrl;
     unsigned char reset_mask_ctrl;  /* reset flag for pin 1, 14, 16, 17 */
     unsigned char reset_val_ctrl;   /* reset values for pin 1, 14, 16, 17 */
+    hal_bit_t cache_outputs;	/* param: skip writes that change nothing */
+    unsigned char hw_valid;	/* HW_DATA, HW_CTRL: which copy below is good */
+    unsigned char hw_data;	/* byte last written to the data register */
+    unsigned char hw_ctrl;	/* byte last written to the control register */
+    hal_u32_t read_io;		/* param: port accesses made by read */
+    hal_u32_t write_io;		/* param: port accesses made by write */
+    hal_u32_t reset_io;		/* param: port accesses made by reset */
     struct hal_parport_t portdata;
 } parport_t;
 
+#define HW_DATA 1
+#define HW_CTRL 2
+
 /* pointer to array of parport_t structs in shared memory, 1 per port */
 static parport_t *port_data_array;
 
@@ -179,6 +198,7 @@ static void reset_port(void *arg, long period);
 static void write_port(void *arg, long period);
 static void read_all(void *arg, long period);
 static void write_all(void *arg, long period);
+static void reset_all(void *arg, long period);
 
 /* 'pins_and_params()' does most of the work involved in setting up
    the driver.  It parses the command line (argv[]), then if the
@@ -311,6 +331,14 @@ rtapi_print ( "config string '%s'\n", cfg );
 	hal_exit(comp_id);
 	return -1;
     }
+    retval = hal_export_funct("parport.reset-all", reset_all,
+	port_data_array, 0, 0, comp_id);
+    if (retval != 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "PARPORT: ERROR: reset all funct export failed\n");
+	hal_exit(comp_id);
+	return -1;
+    }
     rtapi_print_msg(RTAPI_MSG_INFO,
 	"PARPORT: installed driver for %d ports\n", num_ports);
     hal_ready(comp_id);
@@ -339,6 +367,7 @@ static void read_port(void *arg, long period)
     port = arg;
     /* read the status port */
     indata = rtapi_inb(port->base_addr + 1);
+    port->read_io++;
     /* invert bit 7 (pin 11) to compensate for hardware inverter */
     indata ^= 0x80;
     /* split the bits into 10 variables (5 regular, 5 inverted) */
@@ -352,6 +381,7 @@ static void read_port(void *arg, long period)
     if (port->data_dir != 0) {
 	/* yes, read the data port */
 	indata = rtapi_inb(port->base_addr);
+	port->read_io++;
 	/* split the bits into 16 variables (8 regular, 8 inverted) */
 	mask = 0x01;
 	for (b = 0; b < 16; b += 2) {
@@ -365,6 +395,7 @@ static void read_port(void *arg, long period)
         mask = 0x01;
         /* correct for hardware inverters on pins 1, 14, & 17 */
         indata = rtapi_inb(port->base_addr + 2) ^ 0x0B;
+        port->read_io++;
         for (b = 0; b < 8; b += 2) {
             *(port->control_in[b]) = indata & mask;
             *(port->control_in[b + 1]) = !(indata & mask);
@@ -373,31 +404,86 @@ static void read_port(void *arg, long period)
     }
 }
 
-static void reset_port(void *arg, long period) {
-    parport_t *port = arg;
-    long long deadline, reset_time_tsc;
-    unsigned char outdata = (port->outdata&~port->reset_mask) ^ port->reset_val;
-   
-    if(port->reset_time > period/4) port->reset_time = period/4;
-    reset_time_tsc = ns2tsc(port->reset_time);
+/* These write a byte to the data or control register, unless the
+   register is known to hold it already and 'cache-outputs' is set.
+   They return the number of port accesses made. */
+static int out_data(parport_t *port, unsigned char outdata)
+{
+    if (port->cache_outputs && (port->hw_valid & HW_DATA)
+	&& (outdata == port->hw_data)) {
+	return 0;
+    }
+    rtapi_outb(outdata, port->base_addr);
+    port->hw_data = outdata;
+    port->hw_valid |= HW_DATA;
+    return 1;
+}
 
-    if(outdata != port->outdata) {
-        deadline = port->write_time + reset_time_tsc;
-        while(rtapi_get_clocks() < deadline) {}
-        rtapi_outb(outdata, port->base_addr);
+static int out_ctrl(parport_t *port, unsigned char outdata)
+{
+    if (port->cache_outputs && (port->hw_valid & HW_CTRL)
+	&& (outdata == port->hw_ctrl)) {
+	return 0;
     }
+    rtapi_outb(outdata, port->base_addr + 2);
+    port->hw_ctrl = outdata;
+    port->hw_valid |= HW_CTRL;
+    return 1;
+}
 
-    outdata = (port->outdata_ctrl&~port->reset_mask_ctrl)^port->reset_val_ctrl;
+/* Resets 'count' ports.  It waits only once, until the last of their
+   deadlines, so that all the pins go back at the same time. */
+static void reset_ports(parport_t *port, int count, long period)
+{
+    long long deadline, reset_time_tsc;
+    unsigned char outdata[MAX_PORTS], outdata_ctrl[MAX_PORTS];
+    int n, busy;
+
+    deadline = 0;
+    busy = 0;
+    for (n = 0; n < count; n++) {
+	if(port[n].reset_time > period/4) port[n].reset_time = period/4;
+	reset_time_tsc = ns2tsc(port[n].reset_time);
+
+	outdata[n] = (port[n].outdata&~port[n].reset_mask) ^ port[n].reset_val;
+	if(outdata[n] != port[n].outdata) {
+	    if(deadline < port[n].write_time + reset_time_tsc) {
+		deadline = port[n].write_time + reset_time_tsc;
+	    }
+	    busy = 1;
+	}
 
-    if(outdata != port->outdata_ctrl) {
-	/* correct for hardware inverters on pins 1, 14, & 17 */
-	outdata ^= 0x0B;
-        deadline = port->write_time_ctrl + reset_time_tsc;
-        while(rtapi_get_clocks() < deadline) {}
-        rtapi_outb(outdata, port->base_addr + 2);
+	outdata_ctrl[n] = (port[n].outdata_ctrl&~port[n].reset_mask_ctrl)
+	    ^ port[n].reset_val_ctrl;
+	if(outdata_ctrl[n] != port[n].outdata_ctrl) {
+	    if(deadline < port[n].write_time_ctrl + reset_time_tsc) {
+		deadline = port[n].write_time_ctrl + reset_time_tsc;
+	    }
+	    busy = 1;
+	}
+    }
+    if(!busy) {
+	/* no pin needs a reset */
+	return;
+    }
+    while(rtapi_get_clocks() < deadline) {}
+
+    for (n = 0; n < count; n++) {
+	if(outdata[n] != port[n].outdata) {
+	    port[n].reset_io += out_data(&port[n], outdata[n]);
+	}
+	if(outdata_ctrl[n] != port[n].outdata_ctrl) {
+	    /* correct for hardware inverters on pins 1, 14, & 17 */
+	    port[n].reset_io += out_ctrl(&port[n], outdata_ctrl[n] ^ 0x0B);
+	}
     }
 }
 
+static void reset_port(void *arg, long period)
+{
+    reset_ports(arg, 1, period);
+}
+
 static void write_port(void *arg, long period)
 {
     parport_t *port;
@@ -426,9 +512,11 @@ static void write_port(void *arg, long period)
 	    }
 	    mask <<= 1;
 	}
-	/* write it to the hardware */
-	rtapi_outb(outdata, port->base_addr);
-	port->write_time = rtapi_get_clocks();
+	/* write it to the hardware, if it is not there already */
+	if (out_data(port, outdata)) {
+	    port->write_io++;
+	    port->write_time = rtapi_get_clocks();
+	}
 	port->reset_val = reset_val;
 	port->reset_mask = reset_mask;
 	port->outdata = outdata;
@@ -466,9 +554,11 @@ static void write_port(void *arg, long period)
     }
     /* correct for hardware inverters on pins 1, 14, & 17 */
     outdata ^= 0x0B;
-    /* write it to the hardware */
-    rtapi_outb(outdata, port->base_addr + 2);
-    port->write_time_ctrl = rtapi_get_clocks();
+    /* write it to the hardware, if it is not there already */
+    if (out_ctrl(port, outdata)) {
+	port->write_io++;
+	port->write_time_ctrl = rtapi_get_clocks();
+    }
 }
 
 void read_all(void *arg, long period)
@@ -491,6 +581,11 @@ void write_all(void *arg, long period)
     }
 }
 
+void reset_all(void *arg, long period)
+{
+    reset_ports(arg, num_ports, period);
+}
+
 /***********************************************************************
 *                   LOCAL FUNCTION DEFINITIONS                         *
 ************************************************************************/
@@ -705,6 +800,21 @@ static int export_port(int portnum, parport_t * port)
         retval += export_input_pin(portnum, 17, port->control_in, 3);
     }
 
+    /* output cache and I/O counters */
+    retval += hal_param_bit_newf(HAL_RW, &port->cache_outputs, comp_id,
+	"parport.%d.cache-outputs", portnum);
+    retval += hal_param_u32_newf(HAL_RO, &port->read_io, comp_id,
+	"parport.%d.read-io", portnum);
+    retval += hal_param_u32_newf(HAL_RO, &port->write_io, comp_id,
+	"parport.%d.write-io", portnum);
+    retval += hal_param_u32_newf(HAL_RO, &port->reset_io, comp_id,
+	"parport.%d.reset-io", portnum);
+    port->cache_outputs = 0;
+    port->hw_valid = 0;
+    port->read_io = 0;
+    port->write_io = 0;
+    port->reset_io = 0;
+
     /* restore saved message level */
     rtapi_set_msg_level(msg);
     return retval;
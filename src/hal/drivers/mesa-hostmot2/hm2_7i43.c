@@ -151,6 +151,56 @@ static inline void hm2_7i43_epp_write_control(uint8_t control_byte, hm2_7i43_t *
     LL_PRINT_IF(debug_epp, "wrote control 0x%02X\n", control_byte);
 }
 
+// 
+// Block transfers.  With EPP debugging off, these use the string I/O
+// instructions so the parallel port runs its EPP data cycles back to back
+// instead of one loop iteration (and one debug check) per word.
+// 
+
+static inline void hm2_7i43_epp_read_block(void *buffer, int size, hm2_7i43_t *board) {
+    if (!debug_epp) {
+        if (board->epp_wide) {
+            insl(board->port.base + HM2_7I43_EPP_DATA_OFFSET, buffer, size / 4);
+            buffer += size & ~3;
+            size &= 3;
+        }
+        insb(board->port.base + HM2_7I43_EPP_DATA_OFFSET, buffer, size);
+        return;
+    }
+
+    for (; size > 3; size -= 4) {
+        *((u32*)buffer) = hm2_7i43_epp_read32(board);
+        buffer += 4;
+    }
+
+    for ( ; size > 0; size --) {
+        *((u8*)buffer) = hm2_7i43_epp_read(board);
+        buffer ++;
+    }
+}
+
+static inline void hm2_7i43_epp_write_block(void *buffer, int size, hm2_7i43_t *board) {
+    if (!debug_epp) {
+        if (board->epp_wide) {
+            outsl(board->port.base + HM2_7I43_EPP_DATA_OFFSET, buffer, size / 4);
+            buffer += size & ~3;
+            size &= 3;
+        }
+        outsb(board->port.base + HM2_7I43_EPP_DATA_OFFSET, buffer, size);
+        return;
+    }
+
+    for (; size > 3; size -= 4) {
+        hm2_7i43_epp_write32(*((u32*)buffer), board);
+        buffer += 4;
+    }
+
+    for ( ; size > 0; size --) {
+        hm2_7i43_epp_write(*((u8*)buffer), board);
+        buffer ++;
+    }
+}
+
 // returns TRUE if there's a timeout
 static inline int hm2_7i43_epp_check_for_timeout(hm2_7i43_t *board) {
     return (hm2_7i43_epp_read_status(board) & 0x01);
@@ -206,20 +256,10 @@ static void hm2_7i43_nanosleep(unsigned long int nanoseconds) {
 //
 
 int hm2_7i43_read(hm2_lowlevel_io_t *this, u32 addr, void *buffer, int size) {
-    int bytes_remaining = size;
     hm2_7i43_t *board = this->private;
 
     hm2_7i43_epp_addr16(addr | HM2_7I43_ADDR_AUTOINCREMENT, board);
-
-    for (; bytes_remaining > 3; bytes_remaining -= 4) {
-        *((u32*)buffer) = hm2_7i43_epp_read32(board);
-        buffer += 4;
-    }
-
-    for ( ; bytes_remaining > 0; bytes_remaining --) {
-        *((u8*)buffer) = hm2_7i43_epp_read(board);
-        buffer ++;
-    }
+    hm2_7i43_epp_read_block(buffer, size, board);
 
     if (hm2_7i43_epp_check_for_timeout(board)) {
         THIS_PRINT("EPP timeout on data cycle of read(addr=0x%04x, size=%d)\n", addr, size);
@@ -236,20 +276,10 @@ int hm2_7i43_read(hm2_lowlevel_io_t *this, u32 addr, void *buffer, int size) {
 
 
 int hm2_7i43_write(hm2_lowlevel_io_t *this, u32 addr, void *buffer, int size) {
-    int bytes_remaining = size;
     hm2_7i43_t *board = this->private;
 
     hm2_7i43_epp_addr16(addr | HM2_7I43_ADDR_AUTOINCREMENT, board);
-
-    for (; bytes_remaining > 3; bytes_remaining -= 4) {
-        hm2_7i43_epp_write32(*((u32*)buffer), board);
-        buffer += 4;
-    }
-
-    for ( ; bytes_remaining > 0; bytes_remaining --) {
-        hm2_7i43_epp_write(*((u8*)buffer), board);
-        buffer ++;
-    }
+    hm2_7i43_epp_write_block(buffer, size, board);
 
     if (hm2_7i43_epp_check_for_timeout(board)) {
         THIS_PRINT("EPP timeout on data cycle of write(addr=0x%04x, size=%d)\n", addr, size);
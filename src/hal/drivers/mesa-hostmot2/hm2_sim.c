@@ -0,0 +1,573 @@
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+
+//
+//  This driver behaves like a HostMot2 "low-level I/O" driver for a
+//  board that exists only in memory.  It builds an IDROM describing
+//  as many encoders, stepgens, pwmgens and Smart Serial ports as the
+//  user asks for, and models the registers of those Modules closely
+//  enough for the hostmot2 driver to load and run against them: encoders
+//  count and timestamp, stepgen accumulators follow the commanded rate,
+//  and Smart Serial ports answer with simulated 8i20 remotes.
+//
+//  Each read and write can be made to take a configurable time, to
+//  stand in for the bus.  Its job is to let hm2_read() and hm2_write()
+//  be profiled for large configurations without any hardware attached.
+//
+
+
+#include "rtapi.h"
+#include "rtapi_app.h"
+#include "rtapi_string.h"
+
+#include "hal.h"
+
+#include "hostmot2.h"
+#include "hostmot2-lowlevel.h"
+#include "hm2_sim.h"
+
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Simulated AnyIO board for the hostmot2 driver, does not talk to any hardware");
+
+
+static char *config[1];
+static int num_config_strings = 1;
+module_param_array(config, charp, &num_config_strings, S_IRUGO);
+MODULE_PARM_DESC(config, "config string for the simulated board (see hostmot2(9) manpage)");
+
+int num_connectors = 2;
+RTAPI_MP_INT(num_connectors, "Number of 24-pin I/O connectors on the simulated board");
+
+int num_encoders = 8;
+RTAPI_MP_INT(num_encoders, "Number of encoder instances on the simulated board");
+
+int num_stepgens = 8;
+RTAPI_MP_INT(num_stepgens, "Number of stepgen instances on the simulated board");
+
+int num_pwmgens = 8;
+RTAPI_MP_INT(num_pwmgens, "Number of pwmgen instances on the simulated board");
+
+int num_sserials = 1;
+RTAPI_MP_INT(num_sserials, "Number of Smart Serial ports on the simulated board");
+
+int sserial_remotes = 4;
+RTAPI_MP_INT(sserial_remotes, "Number of simulated 8i20 remotes on each Smart Serial port");
+
+int encoder_rate = 1000;
+RTAPI_MP_INT(encoder_rate, "Count rate of the first simulated encoder, in counts per second");
+
+int read_latency = 0;
+RTAPI_MP_INT(read_latency, "Simulated bus time per read call, in nanoseconds");
+
+int write_latency = 0;
+RTAPI_MP_INT(write_latency, "Simulated bus time per write call, in nanoseconds");
+
+int word_latency = 0;
+RTAPI_MP_INT(word_latency, "Simulated bus time per 32-bit word transferred, in nanoseconds");
+
+
+static int comp_id;
+
+static hm2_sim_t board[1];
+
+
+
+
+//
+// helpers for getting at the simulated registers
+//
+
+
+static inline u32 *hm2_sim_reg(hm2_sim_t *me, u32 addr) {
+    return &me->reg[addr / 4];
+}
+
+
+static inline u32 *hm2_sim_module_reg(hm2_sim_t *me, u32 base, int reg, int instance) {
+    return hm2_sim_reg(me, base + (reg * HM2_SIM_REGISTER_STRIDE) + (instance * 4));
+}
+
+
+static inline u32 *hm2_sim_sserial_reg(hm2_sim_t *me, int reg, int port, int channel) {
+    return hm2_sim_reg(
+        me,
+        HM2_SIM_SSERIAL_BASE + (reg * HM2_SIM_REGISTER_STRIDE) + (port * HM2_SIM_SSERIAL_STRIDE) + (channel * 4)
+    );
+}
+
+
+static inline int hm2_sim_overlaps(u32 addr, int size, u32 start, u32 len) {
+    return (addr < (start + len)) && (start < (addr + size));
+}
+
+
+static void hm2_sim_delay(long ns) {
+    long max = rtapi_delay_max();
+
+    while (ns > 0) {
+        rtapi_delay(ns < max ? ns : max);
+        ns -= max;
+    }
+}
+
+
+
+
+//
+// the Modules that change on their own: encoder counters and the
+// timestamp counter, and the stepgen accumulators
+//
+
+
+static void hm2_sim_update(hm2_sim_t *me) {
+    long long now = rtapi_get_time();
+    long long delta = now - me->last_update;
+    double dt, tsc_hz;
+    u32 ts_div;
+    int i;
+
+    if (me->last_update == 0 || delta <= 0) {
+        me->last_update = now;
+        return;
+    }
+    me->last_update = now;
+
+    // clamp it so a long pause (like during setup) can't blow anything up
+    if (delta > 1000000000) delta = 1000000000;
+    dt = (long)delta * 1e-9;
+
+    if (me->num_encoders > 0) {
+        ts_div = *hm2_sim_module_reg(me, HM2_SIM_ENCODER_BASE, 2, 0) & 0xFFFF;
+        tsc_hz = (double)HM2_SIM_CLOCK_LOW / (double)(ts_div + 2);
+
+        me->tsc += dt * tsc_hz;
+        while (me->tsc >= 65536.0) me->tsc -= 65536.0;
+        *hm2_sim_module_reg(me, HM2_SIM_ENCODER_BASE, 3, 0) = (u32)me->tsc;
+
+        for (i = 0; i < me->num_encoders; i ++) {
+            double rate = (double)encoder_rate * (i + 1);
+            double event_tsc;
+            u32 old_count = (u32)me->encoder_position[i];
+            u32 new_count;
+
+            me->encoder_position[i] += rate * dt;
+            while (me->encoder_position[i] >= 65536.0) me->encoder_position[i] -= 65536.0;
+            new_count = (u32)me->encoder_position[i];
+            if (new_count == old_count) continue;
+
+            // timestamp the most recent count edge, not the time of this read
+            event_tsc = me->tsc - ((me->encoder_position[i] - new_count) / rate) * tsc_hz;
+            if (event_tsc < 0.0) event_tsc += 65536.0;
+
+            *hm2_sim_module_reg(me, HM2_SIM_ENCODER_BASE, 0, i) = (new_count & 0xFFFF) | (((u32)event_tsc & 0xFFFF) << 16);
+        }
+    }
+
+    for (i = 0; i < me->num_stepgens; i ++) {
+        s32 rate = *hm2_sim_module_reg(me, HM2_SIM_STEPGEN_BASE, 0, i);
+
+        // the rate register is added to a 48-bit accumulator every clock,
+        // the top 32 bits of which (16.16 steps) are what we get to see
+        me->stepgen_position[i] += (double)rate * dt * HM2_SIM_CLOCK_LOW / 65536.0;
+        while (me->stepgen_position[i] >= 2147483648.0) me->stepgen_position[i] -= 4294967296.0;
+        while (me->stepgen_position[i] < -2147483648.0) me->stepgen_position[i] += 4294967296.0;
+        *hm2_sim_module_reg(me, HM2_SIM_STEPGEN_BASE, 1, i) = (u32)(s32)me->stepgen_position[i];
+    }
+}
+
+
+
+
+//
+// Smart Serial: every command completes immediately, and every enabled
+// channel below sserial_remotes has an 8i20 on it
+//
+
+
+static void hm2_sim_sserial_command(hm2_sim_t *me, int port) {
+    u32 *command = hm2_sim_sserial_reg(me, 0, port, 0);
+    u32 *data = hm2_sim_sserial_reg(me, 1, port, 0);
+    u32 cmd = *command;
+    int c;
+
+    *data = 0;
+
+    if (cmd & 0x80000000) {
+        // ignored command, nothing to do
+    } else if (cmd == 0x2003) {
+        *data = HM2_SIM_SSERIAL_FIRMWARE_VERSION;
+    } else if ((cmd & 0xF000) == 0x1000) {
+        // Do It
+        for (c = 0; c < me->num_remotes; c ++) {
+            u32 cs = me->sserial_cs[port][c];
+            u32 *reg_0 = hm2_sim_sserial_reg(me, 3, port, c);
+
+            if (!(cmd & (1 << c))) continue;
+
+            switch (cs & 0xFF000000) {
+                case 0x45000000:  // read parameter
+                    *reg_0 = ((cs & 0xFFFF) == 0x8E8) ? 1000 : 0;  // nv max current, 10.00 A
+                    me->sserial_cs[port][c] = 0;
+                    break;
+
+                case 0x4C000000:  // read config byte
+                    *reg_0 = 0;
+                    me->sserial_cs[port][c] = 0;
+                    break;
+
+                default:
+                    *reg_0 = (4800 << 16) | 35;  // 48.00 V bus, 35 C
+                    *hm2_sim_sserial_reg(me, 4, port, c) = 0;
+                    break;
+            }
+        }
+    } else if ((cmd & 0xF00) == 0xF00) {
+        // start in setup mode, the remotes identify themselves
+        for (c = 0; c < HM2_SIM_MAX_SSERIAL_CHANNELS; c ++) {
+            if (!(cmd & (1 << c))) continue;
+            *hm2_sim_sserial_reg(me, 4, port, c) = (c < me->num_remotes) ? HM2_SSERIAL_TYPE_8I20 : 0;
+            *hm2_sim_sserial_reg(me, 5, port, c) = 0;
+            *hm2_sim_sserial_reg(me, 3, port, c) = 0x100000 + (port * HM2_SIM_MAX_SSERIAL_CHANNELS) + c;  // serial number
+        }
+    } else if ((cmd & 0xF00) == 0x900) {
+        // start in normal mode
+        for (c = 0; c < HM2_SIM_MAX_SSERIAL_CHANNELS; c ++) {
+            if (!(cmd & (1 << c))) continue;
+            *hm2_sim_sserial_reg(me, 3, port, c) = 0;
+            *hm2_sim_sserial_reg(me, 4, port, c) = 0;
+        }
+    }
+
+    // Reset, Clear and Stop just complete
+
+    *command = 0;
+}
+
+
+// called for each 32-bit register the hostmot2 driver writes
+static void hm2_sim_store(hm2_sim_t *me, u32 addr) {
+    u32 offset;
+
+    if (addr == HM2_SIM_WATCHDOG_BASE + (1 * HM2_SIM_REGISTER_STRIDE)) {
+        // the simulated watchdog never bites
+        *hm2_sim_reg(me, addr) = 0;
+        return;
+    }
+
+    if (!hm2_sim_overlaps(addr, 4, HM2_SIM_SSERIAL_BASE, 6 * HM2_SIM_REGISTER_STRIDE)) return;
+
+    offset = addr - HM2_SIM_SSERIAL_BASE;
+
+    if (offset < HM2_SIM_REGISTER_STRIDE) {
+        if ((offset % HM2_SIM_SSERIAL_STRIDE) == 0 && (offset / HM2_SIM_SSERIAL_STRIDE) < me->num_sserials) {
+            hm2_sim_sserial_command(me, offset / HM2_SIM_SSERIAL_STRIDE);
+        }
+        return;
+    }
+
+    if (offset >= (2 * HM2_SIM_REGISTER_STRIDE) && offset < (3 * HM2_SIM_REGISTER_STRIDE)) {
+        int port, channel;
+
+        offset -= 2 * HM2_SIM_REGISTER_STRIDE;
+        port = offset / HM2_SIM_SSERIAL_STRIDE;
+        channel = (offset % HM2_SIM_SSERIAL_STRIDE) / 4;
+        if (channel >= HM2_SIM_MAX_SSERIAL_CHANNELS) return;
+
+        // the CS register is a command going out to the remote, what
+        // reads back is the (error-free) status
+        me->sserial_cs[port][channel] = *hm2_sim_reg(me, addr);
+        *hm2_sim_reg(me, addr) = 0;
+    }
+}
+
+
+
+
+//
+// these are the "low-level I/O" functions exported up
+//
+
+
+static int hm2_sim_read(hm2_lowlevel_io_t *this, u32 addr, void *buffer, int size) {
+    hm2_sim_t *me = this->private;
+    int words = (size + 3) / 4;
+
+    if ((addr + size) > HM2_SIM_ADDR_SPACE) {
+        THIS_ERR("read of %d bytes at 0x%04x is outside the board\n", size, addr);
+        return 0;
+    }
+
+    if (
+        hm2_sim_overlaps(addr, size, HM2_SIM_ENCODER_BASE, 4 * HM2_SIM_REGISTER_STRIDE)
+        || hm2_sim_overlaps(addr, size, HM2_SIM_STEPGEN_BASE + HM2_SIM_REGISTER_STRIDE, HM2_SIM_REGISTER_STRIDE)
+    ) {
+        hm2_sim_update(me);
+    }
+
+    memcpy(buffer, (u8 *)me->reg + addr, size);
+
+    (*me->hal->read_calls) ++;
+    (*me->hal->read_words) += words;
+    hm2_sim_delay(read_latency + (long)word_latency * words);
+
+    return 1;  // success
+}
+
+
+static int hm2_sim_write(hm2_lowlevel_io_t *this, u32 addr, void *buffer, int size) {
+    hm2_sim_t *me = this->private;
+    int words = (size + 3) / 4;
+    u32 a;
+
+    if ((addr + size) > HM2_SIM_ADDR_SPACE) {
+        THIS_ERR("write of %d bytes at 0x%04x is outside the board\n", size, addr);
+        return 0;
+    }
+
+    memcpy((u8 *)me->reg + addr, buffer, size);
+
+    for (a = addr & ~3; a < (addr + size); a += 4) {
+        hm2_sim_store(me, a);
+    }
+
+    (*me->hal->write_calls) ++;
+    (*me->hal->write_words) += words;
+    hm2_sim_delay(write_latency + (long)word_latency * words);
+
+    return 1;  // success
+}
+
+
+static int hm2_sim_program_fpga(hm2_lowlevel_io_t *this, const bitfile_t *bitfile) {
+    return 0;
+}
+
+
+static int hm2_sim_reset(hm2_lowlevel_io_t *this) {
+    return 0;
+}
+
+
+
+
+//
+// building the simulated firmware's IDROM
+//
+
+
+static void hm2_sim_add_md(
+    hm2_sim_t *me,
+    int *md_index,
+    u8 gtag,
+    u8 version,
+    u8 clock_tag,
+    u8 instances,
+    u16 base_address,
+    u8 num_registers,
+    u8 instance_stride_sel,
+    u32 multiple_registers
+) {
+    u32 addr = HM2_SIM_IDROM_ADDR + HM2_SIM_MD_OFFSET + (*md_index * 12);
+
+    if (instances == 0) return;
+
+    *hm2_sim_reg(me, addr + 0) = gtag | (version << 8) | (clock_tag << 16) | (instances << 24);
+    *hm2_sim_reg(me, addr + 4) = base_address | (num_registers << 16) | (0 << 24) | (instance_stride_sel << 28);
+    *hm2_sim_reg(me, addr + 8) = multiple_registers;
+
+    (*md_index) ++;
+}
+
+
+static void hm2_sim_build_idrom(hm2_sim_t *me) {
+    u8 *pd = (u8 *)me->reg + HM2_SIM_IDROM_ADDR + HM2_SIM_PD_OFFSET;
+    int num_pins = num_connectors * 24;
+    int md_index = 0;
+    int port, c, pin;
+
+    *hm2_sim_reg(me, HM2_ADDR_IOCOOKIE) = HM2_IOCOOKIE;
+    memcpy((u8 *)me->reg + HM2_ADDR_CONFIGNAME, "HOSTMOT2", 8);
+    *hm2_sim_reg(me, HM2_ADDR_IDROM_OFFSET) = HM2_SIM_IDROM_ADDR;
+
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x00) = 2;  // IDROM type
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x04) = HM2_SIM_MD_OFFSET;
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x08) = HM2_SIM_PD_OFFSET;
+    memcpy((u8 *)me->reg + HM2_SIM_IDROM_ADDR + 0x0c, "SIMULATE", 8);
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x1c) = num_connectors;  // IOPorts
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x20) = num_pins;        // IOWidth
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x24) = 24;              // PortWidth
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x28) = HM2_SIM_CLOCK_LOW;
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x2c) = HM2_SIM_CLOCK_HIGH;
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x30) = 4;                        // InstanceStride0
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x34) = HM2_SIM_SSERIAL_STRIDE;   // InstanceStride1
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x38) = HM2_SIM_REGISTER_STRIDE;  // RegisterStride0
+    *hm2_sim_reg(me, HM2_SIM_IDROM_ADDR + 0x3c) = 4;                        // RegisterStride1
+
+    hm2_sim_add_md(me, &md_index, HM2_GTAG_WATCHDOG,    0, 1, 1,                  HM2_SIM_WATCHDOG_BASE,  3, 0, 0x0000);
+    hm2_sim_add_md(me, &md_index, HM2_GTAG_IOPORT,      0, 1, num_connectors,     HM2_SIM_IOPORT_BASE,    5, 0, 0x001F);
+    hm2_sim_add_md(me, &md_index, HM2_GTAG_ENCODER,     2, 1, me->num_encoders,   HM2_SIM_ENCODER_BASE,   5, 0, 0x0003);
+    hm2_sim_add_md(me, &md_index, HM2_GTAG_STEPGEN,     2, 1, me->num_stepgens,   HM2_SIM_STEPGEN_BASE,  10, 0, 0x01FF);
+    hm2_sim_add_md(me, &md_index, HM2_GTAG_PWMGEN,      0, 2, me->num_pwmgens,    HM2_SIM_PWMGEN_BASE,    5, 0, 0x0003);
+    hm2_sim_add_md(me, &md_index, HM2_GTAG_SMARTSERIAL, 0, 1, me->num_sserials,   HM2_SIM_SSERIAL_BASE,   6, 1, 0x003C);
+
+    // every pin is an I/O port pin; the Smart Serial channels need theirs
+    // to be found by the driver, and get an rx and a tx pin each from the
+    // start of the first connector
+    for (pin = 0; pin < num_pins; pin ++) {
+        pd[(pin * 4) + 3] = HM2_GTAG_IOPORT;
+    }
+    pin = 0;
+    for (port = 0; port < me->num_sserials; port ++) {
+        for (c = 0; c < me->num_remotes; c ++) {
+            pd[(pin * 4) + 0] = c + 1;
+            pd[(pin * 4) + 1] = HM2_GTAG_SMARTSERIAL;
+            pd[(pin * 4) + 2] = port;
+            pin ++;
+            pd[(pin * 4) + 0] = 0x80 | (c + 1);
+            pd[(pin * 4) + 1] = HM2_GTAG_SMARTSERIAL;
+            pd[(pin * 4) + 2] = port;
+            pin ++;
+        }
+    }
+}
+
+
+
+
+int rtapi_app_main(void) {
+    hm2_sim_t *me;
+    hm2_lowlevel_io_t *this;
+    int r = 0;
+    int i;
+
+    LL_PRINT("loading HostMot2 simulator\n");
+
+    if (num_connectors < 1 || num_connectors > ANYIO_MAX_IOPORT_CONNECTORS) {
+        LL_ERR("num_connectors must be between 1 and %d\n", ANYIO_MAX_IOPORT_CONNECTORS);
+        return -EINVAL;
+    }
+    if (
+        num_encoders < 0 || num_encoders > HM2_SIM_MAX_INSTANCES
+        || num_stepgens < 0 || num_stepgens > HM2_SIM_MAX_INSTANCES
+        || num_pwmgens < 0 || num_pwmgens > HM2_SIM_MAX_INSTANCES
+    ) {
+        LL_ERR("num_encoders, num_stepgens and num_pwmgens must be between 0 and %d\n", HM2_SIM_MAX_INSTANCES);
+        return -EINVAL;
+    }
+    if (num_sserials < 0 || num_sserials > HM2_SIM_MAX_SSERIALS) {
+        LL_ERR("num_sserials must be between 0 and %d\n", HM2_SIM_MAX_SSERIALS);
+        return -EINVAL;
+    }
+    if (sserial_remotes < 0 || sserial_remotes > HM2_SIM_MAX_SSERIAL_CHANNELS) {
+        LL_ERR("sserial_remotes must be between 0 and %d\n", HM2_SIM_MAX_SSERIAL_CHANNELS);
+        return -EINVAL;
+    }
+    if ((2 * num_sserials * sserial_remotes) > (24 * num_connectors)) {
+        LL_ERR("not enough pins for %d Smart Serial ports with %d remotes each\n", num_sserials, sserial_remotes);
+        return -EINVAL;
+    }
+    if (read_latency < 0 || write_latency < 0 || word_latency < 0) {
+        LL_ERR("latencies can't be negative\n");
+        return -EINVAL;
+    }
+
+    comp_id = hal_init(HM2_LLIO_NAME);
+    if (comp_id < 0) return comp_id;
+
+    me = &board[0];
+
+    this = &me->llio;
+    memset(me, 0, sizeof(hm2_sim_t));
+
+    me->num_encoders = num_encoders;
+    me->num_stepgens = num_stepgens;
+    me->num_pwmgens = num_pwmgens;
+    me->num_sserials = (sserial_remotes > 0) ? num_sserials : 0;
+    me->num_remotes = sserial_remotes;
+
+    hm2_sim_build_idrom(me);
+
+    me->llio.num_ioport_connectors = num_connectors;
+    me->llio.pins_per_connector = 24;
+    for (i = 0; i < num_connectors; i ++) {
+        static const char *names[ANYIO_MAX_IOPORT_CONNECTORS] = { "P1", "P2", "P3", "P4", "P5", "P6", "P7", "P8" };
+        me->llio.ioport_connector_name[i] = names[i];
+    }
+
+    rtapi_snprintf(me->llio.name, sizeof(me->llio.name), "hm2_sim.0");
+
+    me->llio.fpga_part_number = "none";
+
+    me->llio.program_fpga = hm2_sim_program_fpga;
+    me->llio.reset = hm2_sim_reset;
+
+    me->llio.comp_id = comp_id;
+    me->llio.private = me;
+
+    me->llio.threadsafe = 1;
+
+    me->llio.read = hm2_sim_read;
+    me->llio.write = hm2_sim_write;
+
+    me->hal = (hm2_sim_hal_t *)hal_malloc(sizeof(hm2_sim_hal_t));
+    if (me->hal == NULL) {
+        THIS_ERR("out of memory!\n");
+        hal_exit(comp_id);
+        return -ENOMEM;
+    }
+
+    r = hal_pin_u32_newf(HAL_OUT, &me->hal->read_calls, comp_id, "%s.read-calls", me->llio.name);
+    if (r == 0) r = hal_pin_u32_newf(HAL_OUT, &me->hal->read_words, comp_id, "%s.read-words", me->llio.name);
+    if (r == 0) r = hal_pin_u32_newf(HAL_OUT, &me->hal->write_calls, comp_id, "%s.write-calls", me->llio.name);
+    if (r == 0) r = hal_pin_u32_newf(HAL_OUT, &me->hal->write_words, comp_id, "%s.write-words", me->llio.name);
+    if (r != 0) {
+        THIS_ERR("error adding pins, aborting\n");
+        hal_exit(comp_id);
+        return r;
+    }
+
+    r = hm2_register(&me->llio, config[0]);
+    if (r != 0) {
+        THIS_ERR("hm2_sim fails HM2 registration\n");
+        hal_exit(comp_id);
+        return -EIO;
+    }
+
+    THIS_PRINT(
+        "initialized simulated board: %d connectors, %d encoders, %d stepgens, %d pwmgens, %d sserial ports with %d remotes\n",
+        num_connectors,
+        me->num_encoders,
+        me->num_stepgens,
+        me->num_pwmgens,
+        me->num_sserials,
+        me->num_remotes
+    );
+
+    hal_ready(comp_id);
+    return 0;
+}
+
+
+void rtapi_app_exit(void) {
+    hm2_sim_t *me = &board[0];
+
+    hm2_unregister(&me->llio);
+
+    LL_PRINT("driver unloaded\n");
+    hal_exit(comp_id);
+}
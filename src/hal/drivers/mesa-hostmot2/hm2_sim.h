@@ -0,0 +1,80 @@
+//
+//    This program is free software; you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation; either version 2 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program; if not, write to the Free Software
+//    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301 USA
+//
+
+
+#define HM2_LLIO_NAME "hm2_sim"
+
+
+//
+// the simulated board's address space and register map
+//
+
+#define HM2_SIM_ADDR_SPACE (64 * 1024)
+
+#define HM2_SIM_IDROM_ADDR      (0x0400)
+#define HM2_SIM_MD_OFFSET       (0x0040)  // relative to the IDROM
+#define HM2_SIM_PD_OFFSET       (0x0200)  // relative to the IDROM
+
+#define HM2_SIM_CLOCK_LOW       (50000000)
+#define HM2_SIM_CLOCK_HIGH      (100000000)
+
+#define HM2_SIM_REGISTER_STRIDE (0x0100)
+#define HM2_SIM_SSERIAL_STRIDE  (0x0040)
+
+#define HM2_SIM_WATCHDOG_BASE   (0x0C00)
+#define HM2_SIM_IOPORT_BASE     (0x1000)
+#define HM2_SIM_STEPGEN_BASE    (0x2000)
+#define HM2_SIM_ENCODER_BASE    (0x3000)
+#define HM2_SIM_PWMGEN_BASE     (0x4100)
+#define HM2_SIM_SSERIAL_BASE    (0x5A00)
+
+#define HM2_SIM_MAX_INSTANCES   (HM2_SIM_REGISTER_STRIDE / 4)
+#define HM2_SIM_MAX_SSERIALS    (HM2_SIM_REGISTER_STRIDE / HM2_SIM_SSERIAL_STRIDE)
+#define HM2_SIM_MAX_SSERIAL_CHANNELS (8)
+
+#define HM2_SIM_SSERIAL_FIRMWARE_VERSION (43)
+
+
+typedef struct {
+    hal_u32_t *read_calls;
+    hal_u32_t *read_words;
+    hal_u32_t *write_calls;
+    hal_u32_t *write_words;
+} hm2_sim_hal_t;
+
+
+typedef struct {
+    u32 reg[HM2_SIM_ADDR_SPACE / 4];
+
+    int num_encoders;
+    int num_stepgens;
+    int num_pwmgens;
+    int num_sserials;
+    int num_remotes;
+
+    // the free-running state behind the registers that change on their own
+    long long last_update;
+    double tsc;
+    double encoder_position[HM2_SIM_MAX_INSTANCES];
+    double stepgen_position[HM2_SIM_MAX_INSTANCES];
+
+    // the last value written to each sserial channel's CS register
+    u32 sserial_cs[HM2_SIM_MAX_SSERIALS][HM2_SIM_MAX_SSERIAL_CHANNELS];
+
+    hm2_sim_hal_t *hal;
+
+    hm2_lowlevel_io_t llio;
+} hm2_sim_t;
@@ -74,7 +74,10 @@ static void hm2_read(void *void_hm2, long period) {
     hostmot2_t *hm2 = void_hm2;
 
     // if there are comm problems, wait for the user to fix it
-    if ((*hm2->llio->io_error) != 0) return;
+    if ((*hm2->llio->io_error) != 0) {
+        hm2->tram_read_prefetched = 0;
+        return;
+    }
 
     // is there a watchdog?
     if (hm2->watchdog.num_instances > 0) {
@@ -84,8 +87,13 @@ static void hm2_read(void *void_hm2, long period) {
         hm2_watchdog_read(hm2);  // look for bite
     }
 
-    hm2_tram_read(hm2);
-    if ((*hm2->llio->io_error) != 0) return;
+    if (hm2->tram_read_prefetched) {
+        // hm2_write() already read the TRAM at the end of the last cycle
+        hm2->tram_read_prefetched = 0;
+    } else {
+        hm2_tram_read(hm2);
+        if ((*hm2->llio->io_error) != 0) return;
+    }
 
     hm2_ioport_gpio_process_tram_read(hm2);
     hm2_encoder_process_tram_read(hm2, period);
@@ -133,6 +141,16 @@ static void hm2_write(void *void_hm2, long period) {
     hm2_led_write(hm2);	      // Update on-board LEDs
 
     hm2_raw_write(hm2);
+
+    // in split-read mode, get the bus reads for the next hm2_read() out
+    // of the way now, so that they don't delay the computation between
+    // hm2_read() and hm2_write()
+    if (hm2->config.split_read) {
+        if ((*hm2->llio->io_error) != 0) return;
+        if (hm2_tram_read(hm2) == 0) {
+            hm2->tram_read_prefetched = 1;
+        }
+    }
 }
 
 
@@ -271,6 +289,7 @@ static int hm2_parse_config_string(hostmot2_t *hm2, char *config_string) {
     hm2->config.num_uarts = -1;
     hm2->config.num_leds = -1;
     hm2->config.enable_raw = 0;
+    hm2->config.split_read = 0;
     hm2->config.firmware = NULL;
 
     if (config_string == NULL) return 0;
@@ -344,6 +363,9 @@ static int hm2_parse_config_string(hostmot2_t *hm2, char *config_string) {
         } else if (strncmp(token, "enable_raw", 10) == 0) {
             hm2->config.enable_raw = 1;
 
+        } else if (strncmp(token, "split_read", 10) == 0) {
+            hm2->config.split_read = 1;
+
         } else if (strncmp(token, "firmware=", 9) == 0) {
             // FIXME: we leak this in hm2_register
             hm2->config.firmware = kstrdup(token + 9, GFP_KERNEL);
@@ -374,6 +396,7 @@ static int hm2_parse_config_string(hostmot2_t *hm2, char *config_string) {
     HM2_DBG("    num_bspis=%d\n", hm2->config.num_bspis);
     HM2_DBG("    num_uarts=%d\n", hm2->config.num_uarts);
     HM2_DBG("    enable_raw=%d\n",   hm2->config.enable_raw);
+    HM2_DBG("    split_read=%d\n",   hm2->config.split_read);
     HM2_DBG("    firmware=%s\n",   hm2->config.firmware ? hm2->config.firmware : "(NULL)");
 
     argv_free(argv);
@@ -1006,6 +1006,19 @@ typedef struct {
 } hm2_tram_entry_t;
 
 
+// 
+// TRAM entries whose register addresses (and so also buffer offsets) are
+// contiguous get merged into one of these, so each turns into a single
+// llio read or write
+//
+
+typedef struct {
+    u16 addr;
+    u16 size;
+    u32 *buffer;
+} hm2_tram_burst_t;
+
+
 
 
 // 
@@ -1027,6 +1040,7 @@ typedef struct {
         int num_uarts;
         char sserial_modes[4][8];
         int enable_raw;
+        int split_read;
         char *firmware;
     } config;
 
@@ -1045,10 +1059,18 @@ typedef struct {
     struct list_head tram_read_entries;
     u32 *tram_read_buffer;
     u16 tram_read_size;
+    hm2_tram_burst_t *tram_read_bursts;
+    int num_tram_read_bursts;
 
     struct list_head tram_write_entries;
     u32 *tram_write_buffer;
     u16 tram_write_size;
+    hm2_tram_burst_t *tram_write_bursts;
+    int num_tram_write_bursts;
+
+    // with config.split_read, hm2_write() reads the TRAM for the next
+    // hm2_read(), and sets this when that read succeeded
+    int tram_read_prefetched;
 
     // the hostmot2 "Functions"
     hm2_encoder_t encoder;
@@ -80,9 +80,68 @@ int hm2_register_tram_write_region(hostmot2_t *hm2, u16 addr, u16 size, u32 **bu
 }
 
 
+//
+// Build the list of bus transfers for a TRAM region list.  Consecutive
+// entries whose register ranges are contiguous are also contiguous in the
+// TRAM buffer (entries are laid out in registration order), so they can be
+// moved with one llio call.  Entries are never reordered, since some
+// modules depend on the order of their register accesses (for example
+// sserial writes the data registers before the command register).
+//
+
+static int hm2_build_tram_bursts(hostmot2_t *hm2, struct list_head *entries, hm2_tram_burst_t **bursts_out, int *num_bursts_out) {
+    struct list_head *ptr;
+    hm2_tram_burst_t *bursts;
+    int num_entries, num_bursts;
+
+    num_entries = 0;
+    list_for_each(ptr, entries) {
+        num_entries ++;
+    }
+
+    if (*bursts_out != NULL) kfree(*bursts_out);
+    *bursts_out = NULL;
+    *num_bursts_out = 0;
+    if (num_entries == 0) return 0;
+
+    bursts = kmalloc(num_entries * sizeof(hm2_tram_burst_t), GFP_KERNEL);
+    if (bursts == NULL) {
+        HM2_ERR("out of memory!\n");
+        return -ENOMEM;
+    }
+
+    num_bursts = 0;
+    list_for_each(ptr, entries) {
+        hm2_tram_entry_t *tram_entry = list_entry(ptr, hm2_tram_entry_t, list);
+
+        if (num_bursts > 0) {
+            hm2_tram_burst_t *prev = &bursts[num_bursts - 1];
+
+            if (
+                (tram_entry->addr == prev->addr + prev->size)
+                && (*tram_entry->buffer == (u32*)((u8*)prev->buffer + prev->size))
+            ) {
+                prev->size += tram_entry->size;
+                continue;
+            }
+        }
+
+        bursts[num_bursts].addr = tram_entry->addr;
+        bursts[num_bursts].size = tram_entry->size;
+        bursts[num_bursts].buffer = *tram_entry->buffer;
+        num_bursts ++;
+    }
+
+    *bursts_out = bursts;
+    *num_bursts_out = num_bursts;
+    return 0;
+}
+
+
 int hm2_allocate_tram_regions(hostmot2_t *hm2) {
     struct list_head *ptr;
     u16 offset;
+    int r;
     
     hm2->tram_read_size = 0;
     list_for_each(ptr, &hm2->tram_read_entries) {
@@ -131,22 +190,32 @@ int hm2_allocate_tram_regions(hostmot2_t *hm2) {
         offset += tram_entry->size;
         HM2_DBG("    addr=0x%04x, size=%d, buffer=%p\n", tram_entry->addr, tram_entry->size, *tram_entry->buffer);
     }
-    
+
+    r = hm2_build_tram_bursts(hm2, &hm2->tram_read_entries, &hm2->tram_read_bursts, &hm2->num_tram_read_bursts);
+    if (r != 0) return r;
+
+    r = hm2_build_tram_bursts(hm2, &hm2->tram_write_entries, &hm2->tram_write_bursts, &hm2->num_tram_write_bursts);
+    if (r != 0) return r;
+
+    HM2_DBG(
+        "Translation RAM transfers per cycle: %d reads, %d writes\n",
+        hm2->num_tram_read_bursts,
+        hm2->num_tram_write_bursts
+    );
+
     return 0;
 }
 
 
 int hm2_tram_read(hostmot2_t *hm2) {
     static u32 tram_read_iteration = 0;
-    struct list_head *ptr;
-    u16 offset;
+    int i;
 
-    offset = 0;
-    list_for_each(ptr, &hm2->tram_read_entries) {
-        hm2_tram_entry_t *tram_entry = list_entry(ptr, hm2_tram_entry_t, list);
+    for (i = 0; i < hm2->num_tram_read_bursts; i ++) {
+        hm2_tram_burst_t *burst = &hm2->tram_read_bursts[i];
 
-        if (!hm2->llio->read(hm2->llio, tram_entry->addr, *tram_entry->buffer, tram_entry->size)) {
-            HM2_ERR("TRAM read error! (addr=0x%04x, size=%d, iter=%u)\n", tram_entry->addr, tram_entry->size, tram_read_iteration);
+        if (!hm2->llio->read(hm2->llio, burst->addr, burst->buffer, burst->size)) {
+            HM2_ERR("TRAM read error! (addr=0x%04x, size=%d, iter=%u)\n", burst->addr, burst->size, tram_read_iteration);
             return -EIO;
         }
     }
@@ -159,13 +228,13 @@ int hm2_tram_read(hostmot2_t *hm2) {
 
 int hm2_tram_write(hostmot2_t *hm2) {
     static u32 tram_write_iteration = 0;
-    struct list_head *ptr;
+    int i;
 
-    list_for_each(ptr, &hm2->tram_write_entries) {
-        hm2_tram_entry_t *tram_entry = list_entry(ptr, hm2_tram_entry_t, list);
+    for (i = 0; i < hm2->num_tram_write_bursts; i ++) {
+        hm2_tram_burst_t *burst = &hm2->tram_write_bursts[i];
 
-        if (!hm2->llio->write(hm2->llio, tram_entry->addr, *tram_entry->buffer, tram_entry->size)) {
-            HM2_ERR("TRAM write error! (addr=0x%04x, size=%d, iter=%u)\n", tram_entry->addr, tram_entry->size, tram_write_iteration);
+        if (!hm2->llio->write(hm2->llio, burst->addr, burst->buffer, burst->size)) {
+            HM2_ERR("TRAM write error! (addr=0x%04x, size=%d, iter=%u)\n", burst->addr, burst->size, tram_write_iteration);
             return -EIO;
         }
     }
@@ -193,5 +262,7 @@ void hm2_tram_cleanup(hostmot2_t *hm2) {
     // free the tram buffers
     if (hm2->tram_read_buffer != NULL) kfree(hm2->tram_read_buffer);
     if (hm2->tram_write_buffer != NULL) kfree(hm2->tram_write_buffer);
+    if (hm2->tram_read_bursts != NULL) kfree(hm2->tram_read_bursts);
+    if (hm2->tram_write_bursts != NULL) kfree(hm2->tram_write_bursts);
 }
 
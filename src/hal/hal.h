@@ -454,6 +454,42 @@ extern int hal_link(const char *pin_name, const char *sig_name);
 */
 extern int hal_unlink(const char *pin_name);
 
+#ifdef ULAPI
+/***********************************************************************
+*                     "PIN WATCH" FUNCTIONS                            *
+************************************************************************/
+
+/** A pin watch lets a user space component tell whether any of a set
+    of its pins changed value since it last looked, without keeping a
+    copy of each.  Realtime code cannot signal user space, so a watch
+    does not wake anybody: the component has to poll it, as often as it
+    needs to see a change.
+*/
+typedef struct hal_watch hal_watch_t;
+
+/** 'hal_watch_new()' creates an empty pin watch.  Returns NULL if
+    out of memory.
+*/
+extern hal_watch_t *hal_watch_new(void);
+
+/** 'hal_watch_pin()' adds a pin to watch 'w'.  'data_ptr_addr' is the
+    same address that was passed to hal_pin_new() for the pin, so the
+    watch follows the pin if it is later linked to a different signal.
+    'type' is the type of the pin.  Returns 0, or a negative error code.
+*/
+extern int hal_watch_pin(hal_watch_t *w, void *data_ptr_addr,
+    hal_type_t type);
+
+/** 'hal_watch_changed()' returns non-zero if any watched pin differs
+    from the value seen by the previous call, and takes a new snapshot.
+*/
+extern int hal_watch_changed(hal_watch_t *w);
+
+/** 'hal_watch_delete()' frees a pin watch created by hal_watch_new().
+*/
+extern void hal_watch_delete(hal_watch_t *w);
+#endif /* ULAPI */
+
 /***********************************************************************
 *                     "PARAMETER" FUNCTIONS                            *
 ************************************************************************/
@@ -690,6 +726,18 @@ extern int hal_add_funct_to_thread(const char *funct_name, const char *thread_na
 */
 extern int hal_del_funct_from_thread(const char *funct_name, const char *thread_name);
 
+/** hal_set_thread_timing() turns the timing of individual functions
+    in a thread on or off.  'thread_name' is the name of the thread.
+    If 'enable' is non-zero (the default for a new thread), the
+    runtime and maxtime of each function are updated every time it
+    runs.  If it is zero, only the thread as a whole is timed, which
+    saves two clock reads per function in threads with many short
+    functions.
+    Returns 0, or a negative error code.  Call only from within user
+    space or init code, not from realtime code.
+*/
+extern int hal_set_thread_timing(const char *thread_name, int enable);
+
 /** hal_start_threads() starts all threads that have been created.
     This is the point at which realtime functions start being called.
     On success it returns 0, on failure a negative
@@ -70,6 +70,7 @@ MODULE_LICENSE("GPL");
 #if defined(ULAPI)
 #include <sys/types.h>		/* pid_t */
 #include <unistd.h>		/* getpid() */
+#include <stdlib.h>		/* malloc(), realloc(), free() */
 #endif
 
 char *hal_shmem_base = 0;
@@ -149,9 +150,24 @@ static void free_funct_entry_struct(hal_funct_entry_t * funct_entry);
 static void free_thread_struct(hal_thread_t * thread);
 #endif /* RTAPI */
 
+/** 'update_funct_chain()' rebuilds the compiled function chain of
+    'thread' from its function list, and switches the thread over to
+    the new chain.  It must be called (with the mutex held) after any
+    change to the function list.  When it returns, the thread is no
+    longer running the old chain, so a function removed from the list
+    will not be called again.  It returns 0, or -ENOMEM if there is
+    not enough shared memory for the new chain, in which case the
+    thread keeps running the old one.
+*/
+static int update_funct_chain(hal_thread_t * thread);
+
+/* full memory barrier, for the handshake between update_funct_chain()
+   and thread_task() */
+#define hal_mb() __sync_synchronize()
+
 #ifdef RTAPI
 /** 'thread_task()' is a function that is invoked as a realtime task.
-    It implements a thread, by running down the thread's function list
+    It implements a thread, by running down the thread's function chain
     and calling each function in turn.
 */
 static void thread_task(void *arg);
@@ -844,10 +860,7 @@ int hal_pin_alias(const char *pin_name, const char *alias)
 
 int hal_signal_new(const char *name, hal_type_t type)
 {
-
-    int *prev, next, cmp;
-    hal_sig_t *new, *ptr;
-    void *data_addr;
+    int retval;
 
     if (hal_data == 0) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
@@ -869,13 +882,42 @@ int hal_signal_new(const char *name, hal_type_t type)
     rtapi_print_msg(RTAPI_MSG_DBG, "HAL: creating signal '%s'\n", name);
     /* get mutex before accessing shared data */
     rtapi_mutex_get(&(hal_data->mutex));
-    /* check for an existing signal with the same name */
-    if (halpr_find_sig_by_name(name) != 0) {
-	rtapi_mutex_give(&(hal_data->mutex));
+    retval = halpr_signal_new(name, type, 0);
+    rtapi_mutex_give(&(hal_data->mutex));
+    return retval;
+}
+
+int halpr_signal_new(const char *name, hal_type_t type, hal_sig_t **sig_out)
+{
+    int *prev, next, cmp;
+    hal_sig_t *new, *ptr;
+    void *data_addr;
+
+    if (strlen(name) > HAL_NAME_LEN) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
-	    "HAL: ERROR: duplicate signal '%s'\n", name);
+	    "HAL: ERROR: signal name '%s' is too long\n", name);
 	return -EINVAL;
     }
+    /* search the (sorted) list for the insertion point, checking for
+       an existing signal with the same name on the way */
+    prev = &(hal_data->sig_list_ptr);
+    next = *prev;
+    while (next != 0) {
+	ptr = SHMPTR(next);
+	cmp = strcmp(ptr->name, name);
+	if (cmp == 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"HAL: ERROR: duplicate signal '%s'\n", name);
+	    return -EINVAL;
+	}
+	if (cmp > 0) {
+	    /* found the right place for it */
+	    break;
+	}
+	/* didn't find it yet, look at next one */
+	prev = &(ptr->next_ptr);
+	next = *prev;
+    }
     /* allocate memory for the signal value */
     switch (type) {
     case HAL_BIT:
@@ -891,7 +933,6 @@ int hal_signal_new(const char *name, hal_type_t type)
 	data_addr = shmalloc_up(sizeof(hal_float_t));
 	break;
     default:
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "HAL: ERROR: illegal signal type %d'\n", type);
 	return -EINVAL;
@@ -901,7 +942,6 @@ int hal_signal_new(const char *name, hal_type_t type)
     new = alloc_sig_struct();
     if ((new == 0) || (data_addr == 0)) {
 	/* alloc failed */
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "HAL: ERROR: insufficient memory for signal '%s'\n", name);
 	return -ENOMEM;
@@ -930,30 +970,13 @@ int hal_signal_new(const char *name, hal_type_t type)
     new->writers = 0;
     new->bidirs = 0;
     rtapi_snprintf(new->name, sizeof(new->name), "%s", name);
-    /* search list for 'name' and insert new structure */
-    prev = &(hal_data->sig_list_ptr);
-    next = *prev;
-    while (1) {
-	if (next == 0) {
-	    /* reached end of list, insert here */
-	    new->next_ptr = next;
-	    *prev = SHMOFF(new);
-	    rtapi_mutex_give(&(hal_data->mutex));
-	    return 0;
-	}
-	ptr = SHMPTR(next);
-	cmp = strcmp(ptr->name, new->name);
-	if (cmp > 0) {
-	    /* found the right place for it, insert here */
-	    new->next_ptr = next;
-	    *prev = SHMOFF(new);
-	    rtapi_mutex_give(&(hal_data->mutex));
-	    return 0;
-	}
-	/* didn't find it yet, look at next one */
-	prev = &(ptr->next_ptr);
-	next = *prev;
+    /* and insert it at the spot found above */
+    new->next_ptr = next;
+    *prev = SHMOFF(new);
+    if (sig_out) {
+	*sig_out = new;
     }
+    return 0;
 }
 
 int hal_signal_delete(const char *name)
@@ -1005,8 +1028,7 @@ int hal_link(const char *pin_name, const char *sig_name)
 {
     hal_pin_t *pin;
     hal_sig_t *sig;
-    hal_comp_t *comp;
-    void **data_ptr_addr, *data_addr;
+    int retval;
 
     if (hal_data == 0) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
@@ -1051,43 +1073,52 @@ int hal_link(const char *pin_name, const char *sig_name)
 	    "HAL: ERROR: signal '%s' not found\n", sig_name);
 	return -EINVAL;
     }
-    /* found both pin and signal, are they already connected? */
+    /* found both pin and signal, make the link */
+    retval = halpr_link(pin, sig);
+    /* done, release the mutex and return */
+    rtapi_mutex_give(&(hal_data->mutex));
+    return retval;
+}
+
+int halpr_link(hal_pin_t *pin, hal_sig_t *sig)
+{
+    hal_comp_t *comp;
+    void **data_ptr_addr, *data_addr;
+
+    /* are they already connected? */
     if (SHMPTR(pin->signal) == sig) {
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_WARN,
-	    "HAL: Warning: pin '%s' already linked to '%s'\n", pin_name, sig_name);
+	    "HAL: Warning: pin '%s' already linked to '%s'\n",
+	    pin->name, sig->name);
 	return 0;
     }
     /* is the pin connected to something else? */
     if(pin->signal) {
-	rtapi_mutex_give(&(hal_data->mutex));
-	sig = SHMPTR(pin->signal);
+	hal_sig_t *osig = SHMPTR(pin->signal);
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "HAL: ERROR: pin '%s' is linked to '%s', cannot link to '%s'\n",
-	    pin_name, sig->name, sig_name);
+	    pin->name, osig->name, sig->name);
 	return -EINVAL;
     }
     /* check types */
     if (pin->type != sig->type) {
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
-	    "HAL: ERROR: type mismatch '%s' <- '%s'\n", pin_name, sig_name);
+	    "HAL: ERROR: type mismatch '%s' <- '%s'\n", pin->name, sig->name);
 	return -EINVAL;
     }
     /* linking output pin to sig that already has output or I/O pins? */
     if ((pin->dir == HAL_OUT) && ((sig->writers > 0) || (sig->bidirs > 0 ))) {
 	/* yes, can't do that */
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
-	    "HAL: ERROR: signal '%s' already has output or I/O pin(s)\n", sig_name);
+	    "HAL: ERROR: signal '%s' already has output or I/O pin(s)\n",
+	    sig->name);
 	return -EINVAL;
     }
     /* linking bidir pin to sig that already has output pin? */
     if ((pin->dir == HAL_IO) && (sig->writers > 0)) {
 	/* yes, can't do that */
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
-	    "HAL: ERROR: signal '%s' already has output pin\n", sig_name);
+	    "HAL: ERROR: signal '%s' already has output pin\n", sig->name);
 	return -EINVAL;
     }
     /* everything is OK, make the new link */
@@ -1107,8 +1138,6 @@ int hal_link(const char *pin_name, const char *sig_name)
     }
     /* and update the pin */
     pin->signal = SHMOFF(sig);
-    /* done, release the mutex and return */
-    rtapi_mutex_give(&(hal_data->mutex));
     return 0;
 }
 
@@ -1914,9 +1943,7 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
 {
     hal_thread_t *thread;
     hal_funct_t *funct;
-    hal_list_t *list_root, *list_entry;
-    int n;
-    hal_funct_entry_t *funct_entry;
+    int retval;
 
     if (hal_data == 0) {
 	rtapi_print_msg(RTAPI_MSG_ERR,
@@ -1935,13 +1962,6 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
 	funct_name, thread_name);
     /* get mutex before accessing data structures */
     rtapi_mutex_get(&(hal_data->mutex));
-    /* make sure position is valid */
-    if (position == 0) {
-	/* zero is not allowed */
-	rtapi_mutex_give(&(hal_data->mutex));
-	rtapi_print_msg(RTAPI_MSG_ERR, "HAL: ERROR: bad position: 0\n");
-	return -EINVAL;
-    }
     /* make sure we were given a function name */
     if (funct_name == 0) {
 	/* no name supplied */
@@ -1965,13 +1985,6 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
 	    "HAL: ERROR: function '%s' not found\n", funct_name);
 	return -EINVAL;
     }
-    /* found the function, is it available? */
-    if ((funct->users > 0) && (funct->reentrant == 0)) {
-	rtapi_mutex_give(&(hal_data->mutex));
-	rtapi_print_msg(RTAPI_MSG_ERR,
-	    "HAL: ERROR: function '%s' may only be added to one thread\n", funct_name);
-	return -EINVAL;
-    }
     /* search thread list for thread_name */
     thread = halpr_find_thread_by_name(thread_name);
     if (thread == 0) {
@@ -1981,11 +1994,35 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
 	    "HAL: ERROR: thread '%s' not found\n", thread_name);
 	return -EINVAL;
     }
-    /* ok, we have thread and function, are they compatible? */
+    retval = halpr_add_funct_to_thread(funct, thread, position);
+    rtapi_mutex_give(&(hal_data->mutex));
+    return retval;
+}
+
+int halpr_add_funct_to_thread(hal_funct_t *funct, hal_thread_t *thread,
+    int position)
+{
+    hal_list_t *list_root, *list_entry;
+    int n;
+    hal_funct_entry_t *funct_entry;
+
+    /* make sure position is valid */
+    if (position == 0) {
+	/* zero is not allowed */
+	rtapi_print_msg(RTAPI_MSG_ERR, "HAL: ERROR: bad position: 0\n");
+	return -EINVAL;
+    }
+    /* is the function available? */
+    if ((funct->users > 0) && (funct->reentrant == 0)) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: function '%s' may only be added to one thread\n",
+	    funct->name);
+	return -EINVAL;
+    }
+    /* are the thread and function compatible? */
     if ((funct->uses_fp) && (!thread->uses_fp)) {
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
-	    "HAL: ERROR: function '%s' needs FP\n", funct_name);
+	    "HAL: ERROR: function '%s' needs FP\n", funct->name);
 	return -EINVAL;
     }
     /* find insertion point */
@@ -1999,7 +2036,6 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
 	    list_entry = list_next(list_entry);
 	    if (list_entry == list_root) {
 		/* reached end of list */
-		rtapi_mutex_give(&(hal_data->mutex));
 		rtapi_print_msg(RTAPI_MSG_ERR,
 		    "HAL: ERROR: position '%d' is too high\n", position);
 		return -EINVAL;
@@ -2012,7 +2048,6 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
 	    list_entry = list_prev(list_entry);
 	    if (list_entry == list_root) {
 		/* reached end of list */
-		rtapi_mutex_give(&(hal_data->mutex));
 		rtapi_print_msg(RTAPI_MSG_ERR,
 		    "HAL: ERROR: position '%d' is too low\n", position);
 		return -EINVAL;
@@ -2025,7 +2060,6 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
     funct_entry = alloc_funct_entry_struct();
     if (funct_entry == 0) {
 	/* alloc failed */
-	rtapi_mutex_give(&(hal_data->mutex));
 	rtapi_print_msg(RTAPI_MSG_ERR,
 	    "HAL: ERROR: insufficient memory for thread->function link\n");
 	return -ENOMEM;
@@ -2038,7 +2072,16 @@ int hal_add_funct_to_thread(const char *funct_name, const char *thread_name, int
     list_add_after((hal_list_t *) funct_entry, list_entry);
     /* update the function usage count */
     funct->users++;
-    rtapi_mutex_give(&(hal_data->mutex));
+    /* and put the new list into effect */
+    if (update_funct_chain(thread) != 0) {
+	list_remove_entry((hal_list_t *) funct_entry);
+	free_funct_entry_struct(funct_entry);
+	funct->users--;
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: insufficient memory for thread '%s' function chain\n",
+	    thread->name);
+	return -ENOMEM;
+    }
     return 0;
 }
 
@@ -2121,6 +2164,9 @@ int hal_del_funct_from_thread(const char *funct_name, const char *thread_name)
 	if (SHMPTR(funct_entry->funct_ptr) == funct) {
 	    /* this funct entry points to our funct, unlink */
 	    list_remove_entry(list_entry);
+	    /* stop the thread from calling it (a smaller chain
+	       never needs new memory, so this can't fail) */
+	    update_funct_chain(thread);
 	    /* and delete it */
 	    free_funct_entry_struct(funct_entry);
 	    /* done */
@@ -2132,6 +2178,35 @@ int hal_del_funct_from_thread(const char *funct_name, const char *thread_name)
     }
 }
 
+int hal_set_thread_timing(const char *thread_name, int enable)
+{
+    hal_thread_t *thread;
+
+    if (hal_data == 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: set_thread_timing called before init\n");
+	return -EINVAL;
+    }
+    /* make sure we were given a thread name */
+    if (thread_name == 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR, "HAL: ERROR: missing thread name\n");
+	return -EINVAL;
+    }
+    /* get mutex before accessing data structures */
+    rtapi_mutex_get(&(hal_data->mutex));
+    thread = halpr_find_thread_by_name(thread_name);
+    if (thread == 0) {
+	/* thread not found */
+	rtapi_mutex_give(&(hal_data->mutex));
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: thread '%s' not found\n", thread_name);
+	return -EINVAL;
+    }
+    thread->funct_timing = (enable != 0);
+    rtapi_mutex_give(&(hal_data->mutex));
+    return 0;
+}
+
 int hal_start_threads(void)
 {
     /* a trivial function for a change! */
@@ -2173,6 +2248,130 @@ int hal_stop_threads(void)
     return 0;
 }
 
+#ifdef ULAPI
+/***********************************************************************
+*                     "PIN WATCH" FUNCTIONS                            *
+************************************************************************/
+
+typedef struct {
+    void **data_ptr_addr;	/* the component's pointer to the pin data */
+    hal_type_t type;		/* type of the pin */
+    hal_data_u last;		/* value at the last snapshot */
+} hal_watch_entry_t;
+
+struct hal_watch {
+    int count;			/* number of watched pins */
+    int size;			/* allocated length of 'entry' */
+    hal_watch_entry_t *entry;
+};
+
+static void watch_read(hal_watch_entry_t *e, hal_data_u *val)
+{
+    volatile void *data = *(void * volatile *) e->data_ptr_addr;
+
+    switch (e->type) {
+    case HAL_BIT:
+	val->b = *(volatile hal_bit_t *) data;
+	break;
+    case HAL_FLOAT:
+	val->f = *(volatile hal_float_t *) data;
+	break;
+    case HAL_S32:
+	val->s = *(volatile hal_s32_t *) data;
+	break;
+    case HAL_U32:
+	val->u = *(volatile hal_u32_t *) data;
+	break;
+    }
+}
+
+static int watch_differs(hal_watch_entry_t *e, hal_data_u *val)
+{
+    switch (e->type) {
+    case HAL_BIT:
+	return val->b != e->last.b;
+    case HAL_FLOAT:
+	return val->f != e->last.f;
+    case HAL_S32:
+	return val->s != e->last.s;
+    case HAL_U32:
+	return val->u != e->last.u;
+    }
+    return 0;
+}
+
+hal_watch_t *hal_watch_new(void)
+{
+    hal_watch_t *w;
+
+    w = malloc(sizeof(hal_watch_t));
+    if (w == 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR, "HAL: ERROR: out of memory for watch\n");
+	return 0;
+    }
+    w->count = 0;
+    w->size = 0;
+    w->entry = 0;
+    return w;
+}
+
+int hal_watch_pin(hal_watch_t *w, void *data_ptr_addr, hal_type_t type)
+{
+    hal_watch_entry_t *e;
+
+    if (w == 0 || data_ptr_addr == 0) {
+	rtapi_print_msg(RTAPI_MSG_ERR, "HAL: ERROR: bad pin watch\n");
+	return -EINVAL;
+    }
+    if (type < HAL_BIT || type > HAL_U32) {
+	rtapi_print_msg(RTAPI_MSG_ERR,
+	    "HAL: ERROR: pin watch: bad type %d\n", type);
+	return -EINVAL;
+    }
+    if (w->count == w->size) {
+	int size = w->size ? w->size * 2 : 8;
+	e = realloc(w->entry, size * sizeof(hal_watch_entry_t));
+	if (e == 0) {
+	    rtapi_print_msg(RTAPI_MSG_ERR,
+		"HAL: ERROR: out of memory for watch\n");
+	    return -ENOMEM;
+	}
+	w->entry = e;
+	w->size = size;
+    }
+    e = &w->entry[w->count++];
+    e->data_ptr_addr = data_ptr_addr;
+    e->type = type;
+    watch_read(e, &e->last);
+    return 0;
+}
+
+int hal_watch_changed(hal_watch_t *w)
+{
+    hal_data_u val;
+    int n, changed;
+
+    changed = 0;
+    for (n = 0; n < w->count; n++) {
+	watch_read(&w->entry[n], &val);
+	if (watch_differs(&w->entry[n], &val)) {
+	    w->entry[n].last = val;
+	    changed = 1;
+	}
+    }
+    return changed;
+}
+
+void hal_watch_delete(hal_watch_t *w)
+{
+    if (w == 0) {
+	return;
+    }
+    free(w->entry);
+    free(w);
+}
+#endif /* ULAPI */
+
 /***********************************************************************
 *                    PRIVATE FUNCTION CODE                             *
 ************************************************************************/
@@ -2661,38 +2860,54 @@ static void thread_task(void *arg)
 {
     hal_thread_t *thread;
     hal_funct_t *funct;
-    hal_funct_entry_t *funct_root, *funct_entry;
+    hal_chain_entry_t *entry, *end;
     long long int start_time, end_time;
     long long int thread_start_time;
+    int n;
 
     thread = arg;
     while (1) {
 	if (hal_data->threads_running > 0) {
-	    /* point at first function on function list */
-	    funct_root = (hal_funct_entry_t *) & (thread->funct_list);
-	    funct_entry = SHMPTR(funct_root->links.next);
+	    /* claim the current chain; if update_funct_chain() switched
+	       chains before it could see the claim, claim the new one */
+	    do {
+		n = thread->chain_active;
+		thread->chain_busy = n;
+		hal_mb();
+	    } while (n != thread->chain_active);
+	    entry = SHMPTR(thread->chain_ptr[n]);
+	    end = entry + thread->chain_len[n];
 	    /* execution time logging */
 	    start_time = rtapi_get_clocks();
 	    end_time = start_time;
 	    thread_start_time = start_time;
-	    /* run thru function list */
-	    while (funct_entry != funct_root) {
-		/* call the function */
-		funct_entry->funct(funct_entry->arg, thread->period);
-		/* capture execution time */
-		end_time = rtapi_get_clocks();
-		/* point to function structure */
-		funct = SHMPTR(funct_entry->funct_ptr);
-		/* update execution time data */
-		funct->runtime = (hal_s32_t)(end_time - start_time);
-		if (funct->runtime > funct->maxtime) {
-		    funct->maxtime = funct->runtime;
+	    if (thread->funct_timing) {
+		/* run thru function chain, timing each function */
+		for (; entry < end; entry++) {
+		    /* call the function */
+		    entry->funct(entry->arg, thread->period);
+		    /* capture execution time */
+		    end_time = rtapi_get_clocks();
+		    /* point to function structure */
+		    funct = SHMPTR(entry->funct_ptr);
+		    /* update execution time data */
+		    funct->runtime = (hal_s32_t)(end_time - start_time);
+		    if (funct->runtime > funct->maxtime) {
+			funct->maxtime = funct->runtime;
+		    }
+		    /* prepare to measure time for next funct */
+		    start_time = end_time;
+		}
+	    } else {
+		/* run thru function chain, timing only the whole thread */
+		for (; entry < end; entry++) {
+		    entry->funct(entry->arg, thread->period);
 		}
-		/* point to next next entry in list */
-		funct_entry = SHMPTR(funct_entry->links.next);
-		/* prepare to measure time for next funct */
-		start_time = end_time;
+		end_time = rtapi_get_clocks();
 	    }
+	    /* done with the chain */
+	    hal_mb();
+	    thread->chain_busy = -1;
 	    /* update thread execution time */
 	    thread->runtime = (hal_s32_t)(end_time - thread_start_time);
 	    if (thread->runtime > thread->maxtime) {
@@ -3020,6 +3235,11 @@ static hal_thread_t *alloc_thread_struct(void)
     } else {
 	/* nothing on free list, allocate a brand new one */
 	p = shmalloc_dn(sizeof(hal_thread_t));
+	if (p) {
+	    /* no chains yet (a recycled struct keeps its old ones) */
+	    p->chain_ptr[0] = p->chain_ptr[1] = 0;
+	    p->chain_max[0] = p->chain_max[1] = 0;
+	}
     }
     if (p) {
 	/* make sure it's empty */
@@ -3029,6 +3249,10 @@ static hal_thread_t *alloc_thread_struct(void)
 	p->priority = 0;
 	p->task_id = 0;
 	list_init_entry(&(p->funct_list));
+	p->funct_timing = 1;
+	p->chain_len[0] = p->chain_len[1] = 0;
+	p->chain_active = 0;
+	p->chain_busy = -1;
 	p->name[0] = '\0';
     }
     return p;
@@ -3205,7 +3429,7 @@ static void free_oldname_struct(hal_oldname_t * oldname)
 #ifdef RTAPI
 static void free_funct_struct(hal_funct_t * funct)
 {
-    int next_thread;
+    int next_thread, removed;
     hal_thread_t *thread;
     hal_list_t *list_root, *list_entry;
     hal_funct_entry_t *funct_entry;
@@ -3225,6 +3449,7 @@ static void free_funct_struct(hal_funct_t * funct)
 	    /* start at root of funct_entry list */
 	    list_root = &(thread->funct_list);
 	    list_entry = list_next(list_root);
+	    removed = 0;
 	    /* run thru funct_entry list */
 	    while (list_entry != list_root) {
 		/* point to funct entry */
@@ -3235,11 +3460,16 @@ static void free_funct_struct(hal_funct_t * funct)
 		    list_entry = list_remove_entry(list_entry);
 		    /* and delete it */
 		    free_funct_entry_struct(funct_entry);
+		    removed = 1;
 		} else {
 		    /* no match, try the next one */
 		    list_entry = list_next(list_entry);
 		}
 	    }
+	    if (removed) {
+		/* make sure the thread is done with the function */
+		update_funct_chain(thread);
+	    }
 	    /* move on to the next thread */
 	    next_thread = thread->next_ptr;
 	}
@@ -3258,6 +3488,60 @@ static void free_funct_struct(hal_funct_t * funct)
 }
 #endif /* RTAPI */
 
+static int update_funct_chain(hal_thread_t * thread)
+{
+    hal_list_t *list_root, *list_entry;
+    hal_funct_entry_t *funct_entry;
+    hal_chain_entry_t *chain;
+    int n, len, max;
+
+    list_root = &(thread->funct_list);
+    /* count the functions */
+    len = 0;
+    list_entry = list_next(list_root);
+    while (list_entry != list_root) {
+	len++;
+	list_entry = list_next(list_entry);
+    }
+    /* rebuild the chain that the thread isn't using.  The last call
+       waited until the thread let go of it, so it is free. */
+    n = !thread->chain_active;
+    if (len > thread->chain_max[n]) {
+	/* too small, get a bigger one (shmem is never freed, so grow in
+	   big steps to keep the number of abandoned chains low) */
+	max = thread->chain_max[n] ? thread->chain_max[n] : 8;
+	while (max < len) {
+	    max *= 2;
+	}
+	chain = shmalloc_up(max * sizeof(hal_chain_entry_t));
+	if (chain == 0) {
+	    return -ENOMEM;
+	}
+	thread->chain_ptr[n] = SHMOFF(chain);
+	thread->chain_max[n] = max;
+    }
+    chain = SHMPTR(thread->chain_ptr[n]);
+    list_entry = list_next(list_root);
+    while (list_entry != list_root) {
+	funct_entry = (hal_funct_entry_t *) list_entry;
+	chain->funct = funct_entry->funct;
+	chain->arg = funct_entry->arg;
+	chain->funct_ptr = funct_entry->funct_ptr;
+	chain++;
+	list_entry = list_next(list_entry);
+    }
+    thread->chain_len[n] = len;
+    /* make the new chain visible before switching to it */
+    hal_mb();
+    thread->chain_active = n;
+    hal_mb();
+    /* wait for the thread to finish any pass over the old chain.  This
+       takes at most the execution time of one pass of the thread. */
+    while (thread->chain_busy == !n) {
+    }
+    return 0;
+}
+
 static void free_funct_entry_struct(hal_funct_entry_t * funct_entry)
 {
     hal_funct_t *funct;
@@ -3308,6 +3592,8 @@ static void free_thread_struct(hal_thread_t * thread)
 	/* free the removed entry */
 	free_funct_entry_struct(funct_entry);
     }
+    /* the task is gone, so the chains can simply be emptied */
+    thread->chain_len[0] = thread->chain_len[1] = 0;
 /*! \todo Another #if 0 */
 #if 0
 /* Currently these don't get created, so we don't have to worry
@@ -3396,6 +3682,7 @@ EXPORT_SYMBOL(hal_create_thread);
 
 EXPORT_SYMBOL(hal_add_funct_to_thread);
 EXPORT_SYMBOL(hal_del_funct_from_thread);
+EXPORT_SYMBOL(hal_set_thread_timing);
 
 EXPORT_SYMBOL(hal_start_threads);
 EXPORT_SYMBOL(hal_stop_threads);
@@ -3415,4 +3702,8 @@ EXPORT_SYMBOL(halpr_find_funct_by_owner);
 
 EXPORT_SYMBOL(halpr_find_pin_by_sig);
 
+EXPORT_SYMBOL(halpr_signal_new);
+EXPORT_SYMBOL(halpr_link);
+EXPORT_SYMBOL(halpr_add_funct_to_thread);
+
 #endif /* rtapi */
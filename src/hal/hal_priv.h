@@ -287,6 +287,18 @@ typedef struct {
     int funct_ptr;		/* pointer to function */
 } hal_funct_entry_t;
 
+/** The function list of a thread is convenient to edit, but slow to
+    walk in realtime.  Each time it changes, it is compiled into a
+    'chain', a plain array of these structs, which is what the
+    thread actually runs.  Each thread has two chains; one is being
+    run while the other is rebuilt, then they are swapped.
+*/
+typedef struct {
+    void (*funct) (void *, long);	/* ptr to function code */
+    void *arg;			/* argument for function */
+    int funct_ptr;		/* pointer to function (for timing) */
+} hal_chain_entry_t;
+
 #define HAL_STACKSIZE 16384	/* realtime task stacksize */
 
 typedef struct {
@@ -298,6 +310,12 @@ typedef struct {
     hal_s32_t runtime;		/* duration of last run, in nsec */
     hal_s32_t maxtime;		/* duration of longest run, in nsec */
     hal_list_t funct_list;	/* list of functions to run */
+    int funct_timing;		/* non-zero to time each function */
+    int chain_ptr[2];		/* compiled function chains */
+    int chain_len[2];		/* number of entries in each chain */
+    int chain_max[2];		/* allocated size of each chain */
+    volatile int chain_active;	/* chain the thread should run */
+    volatile int chain_busy;	/* chain the thread is running, or -1 */
     char name[HAL_NAME_LEN + 1];	/* thread name */
 } hal_thread_t;
 
@@ -324,7 +342,7 @@ typedef struct {
 */
 
 #define HAL_KEY   0x48414C32	/* key used to open HAL shared memory */
-#define HAL_VER   0x0000000C	/* version code */
+#define HAL_VER   0x0000000D	/* version code */
 #define HAL_SIZE  262000
 
 /* These pointers are set by hal_init() to point to the shmem block
@@ -421,5 +439,22 @@ extern hal_funct_t *halpr_find_funct_by_owner(hal_comp_t * owner,
 */
 extern hal_pin_t *halpr_find_pin_by_sig(hal_sig_t * sig, hal_pin_t * start);
 
+/** The following functions do the work of hal_signal_new(), hal_link()
+    and hal_add_funct_to_thread() on objects that the caller has already
+    located.  They let a caller that holds the mutex make many changes
+    (for example, a whole .hal file worth of 'net' and 'addf' commands)
+    without releasing it and searching the lists again for every item.
+    They return 0 on success or a negative errno value on failure, and
+    leave the data structures untouched if they fail.
+
+    'halpr_signal_new()' creates a signal, and if 'sig_out' is not
+    NULL, stores a pointer to the new signal there.
+*/
+extern int halpr_signal_new(const char *name, hal_type_t type,
+    hal_sig_t ** sig_out);
+extern int halpr_link(hal_pin_t * pin, hal_sig_t * sig);
+extern int halpr_add_funct_to_thread(hal_funct_t * funct,
+    hal_thread_t * thread, int position);
+
 RTAPI_END_DECLS
 #endif /* HAL_PRIV_H */
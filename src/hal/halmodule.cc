@@ -19,6 +19,7 @@
 #include <Python.h>
 #include <string>
 #include <map>
+#include <vector>
 using namespace std;
 
 #include "config.h"
@@ -71,6 +72,7 @@ struct pyhalitem {
 };
 
 static PyObject * pyhal_pin_new(halitem * pin, const char *name);
+static PyObject *pyhal_get_group(PyObject *_self, PyObject *o);
 
 typedef std::map<std::string, struct halitem> itemmap;
 
@@ -474,6 +476,8 @@ static PyMethodDef hal_methods[] = {
         "Create a new pin"},
     {"getitem", pyhal_get_pin, METH_VARARGS,
         "Get existing pin object"},
+    {"getgroup", pyhal_get_group, METH_O,
+        "Get a group object for a sequence of existing pins and params"},
     {"exit", pyhal_exit, METH_NOARGS,
         "Call hal_exit"},
     {"ready", pyhal_ready, METH_NOARGS,
@@ -692,6 +696,353 @@ static PyObject * pyhal_pin_new(halitem * pin, const char * name) {
     return (PyObject *) pypin;
 }
 
+// A pin group looks up a list of pins and params once and then reads or
+// writes all of them per call, so that a panel refreshing hundreds of
+// pins does not pay for a name lookup and a Python call on each of them.
+struct groupentry {
+    std::string name;
+    halitem item;
+    union paramunion last;      // value as of the last changed()
+};
+
+typedef std::vector<groupentry> groupentries;
+
+struct halgroup {
+    PyObject_HEAD
+    halobject *comp;
+    groupentries *entries;
+    bool primed;                // changed() has been called
+};
+
+static void read_raw(halitem *item, union paramunion *v) {
+    if(item->is_pin) {
+        switch(item->type) {
+            case HAL_BIT: v->b = *item->u->pin.b; break;
+            case HAL_U32: v->u32 = *item->u->pin.u32; break;
+            case HAL_S32: v->s32 = *item->u->pin.s32; break;
+            case HAL_FLOAT: v->f = *item->u->pin.f; break;
+            default: break;
+        }
+    } else {
+        *v = item->u->param;
+    }
+}
+
+static bool raw_equal(hal_type_t type, union paramunion *a, union paramunion *b) {
+    switch(type) {
+        case HAL_BIT: return a->b == b->b;
+        case HAL_U32: return a->u32 == b->u32;
+        case HAL_S32: return a->s32 == b->s32;
+        // bitwise, so that a NaN that stays a NaN is not a change
+        case HAL_FLOAT: {
+            double fa = a->f, fb = b->f;
+            return memcmp(&fa, &fb, sizeof(fa)) == 0;
+        }
+        default: return true;
+    }
+}
+
+static double raw_to_double(hal_type_t type, union paramunion *v) {
+    switch(type) {
+        case HAL_BIT: return v->b;
+        case HAL_U32: return v->u32;
+        case HAL_S32: return v->s32;
+        case HAL_FLOAT: return v->f;
+        default: return 0;
+    }
+}
+
+static int write_double(groupentry *e, double value) {
+    halitem *item = &e->item;
+    union paramunion v;
+
+    switch(item->type) {
+        case HAL_BIT: v.b = value != 0; break;
+        case HAL_U32:
+            if(!(value >= 0 && value <= 0xffffffffu)) goto rangeerr;
+            v.u32 = (hal_u32_t)value;
+            break;
+        case HAL_S32:
+            if(!(value >= -0x80000000LL && value <= 0x7fffffff)) goto rangeerr;
+            v.s32 = (hal_s32_t)value;
+            break;
+        case HAL_FLOAT: v.f = value; break;
+        default:
+            PyErr_Format(pyhal_error_type, "Invalid pin type %d", item->type);
+            return -1;
+    }
+    if(!item->is_pin) {
+        item->u->param = v;
+        return 0;
+    }
+    switch(item->type) {
+        case HAL_BIT: *item->u->pin.b = v.b; break;
+        case HAL_U32: *item->u->pin.u32 = v.u32; break;
+        case HAL_S32: *item->u->pin.s32 = v.s32; break;
+        case HAL_FLOAT: *item->u->pin.f = v.f; break;
+        default: break;
+    }
+    return 0;
+rangeerr:
+    // PyErr_Format has no %g
+    char buf[HAL_NAME_LEN + 64];
+    snprintf(buf, sizeof(buf), "Value %g out of range for pin %s",
+            value, e->name.c_str());
+    PyErr_SetString(PyExc_OverflowError, buf);
+    return -1;
+}
+
+static int pyhalgroup_init(PyObject *_self, PyObject *, PyObject *) {
+    PyErr_Format(PyExc_RuntimeError,
+	    "Cannot be constructed directly");
+    return -1;
+}
+
+static void pyhalgroup_delete(PyObject *_self) {
+    halgroup *self = (halgroup *)_self;
+
+    if(self->entries) delete self->entries;
+    Py_XDECREF(self->comp);
+
+    PyObject_Del(self);
+}
+
+static PyObject *pyhalgroup_repr(PyObject *_self) {
+    halgroup *self = (halgroup *)_self;
+    return PyString_FromFormat("<hal pin group of %s with %d pins and params>",
+            self->comp->name, (int)self->entries->size());
+}
+
+static Py_ssize_t pyhalgroup_len(PyObject *_self) {
+    halgroup *self = (halgroup *)_self;
+    return self->entries->size();
+}
+
+static PyObject *pyhalgroup_get(PyObject *_self, PyObject *) {
+    halgroup *self = (halgroup *)_self;
+    groupentries &entries = *self->entries;
+    PyObject *result = PyTuple_New(entries.size());
+    if(!result) return NULL;
+
+    for(unsigned i = 0; i < entries.size(); i++) {
+        PyObject *v = pyhal_read_common(&entries[i].item);
+        if(!v) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(result, i, v);
+    }
+    return result;
+}
+
+static PyObject *pyhalgroup_set(PyObject *_self, PyObject *o) {
+    halgroup *self = (halgroup *)_self;
+    groupentries &entries = *self->entries;
+    PyObject *seq = PySequence_Fast(o, "pin group values must be a sequence");
+    if(!seq) return NULL;
+
+    if((size_t)PySequence_Fast_GET_SIZE(seq) != entries.size()) {
+        PyErr_Format(PyExc_ValueError, "Expected %d values, got %d",
+                (int)entries.size(), (int)PySequence_Fast_GET_SIZE(seq));
+        Py_DECREF(seq);
+        return NULL;
+    }
+    for(unsigned i = 0; i < entries.size(); i++) {
+        if(pyhal_write_common(&entries[i].item,
+                    PySequence_Fast_GET_ITEM(seq, i)) == -1) {
+            Py_DECREF(seq);
+            return NULL;
+        }
+    }
+    Py_DECREF(seq);
+    Py_RETURN_NONE;
+}
+
+static PyObject *pyhalgroup_read_into(PyObject *_self, PyObject *o) {
+    halgroup *self = (halgroup *)_self;
+    groupentries &entries = *self->entries;
+    void *buf;
+    Py_ssize_t len;
+
+    if(PyObject_AsWriteBuffer(o, &buf, &len) == -1) return NULL;
+    if((size_t)len < entries.size() * sizeof(double)) {
+        PyErr_Format(PyExc_ValueError,
+                "Buffer holds %d bytes, %d needed",
+                (int)len, (int)(entries.size() * sizeof(double)));
+        return NULL;
+    }
+
+    double *d = (double *)buf;
+    for(unsigned i = 0; i < entries.size(); i++) {
+        union paramunion v;
+        read_raw(&entries[i].item, &v);
+        d[i] = raw_to_double(entries[i].item.type, &v);
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *pyhalgroup_write_from(PyObject *_self, PyObject *o) {
+    halgroup *self = (halgroup *)_self;
+    groupentries &entries = *self->entries;
+    const void *buf;
+    Py_ssize_t len;
+
+    if(PyObject_AsReadBuffer(o, &buf, &len) == -1) return NULL;
+    if((size_t)len < entries.size() * sizeof(double)) {
+        PyErr_Format(PyExc_ValueError,
+                "Buffer holds %d bytes, %d needed",
+                (int)len, (int)(entries.size() * sizeof(double)));
+        return NULL;
+    }
+
+    const double *d = (const double *)buf;
+    for(unsigned i = 0; i < entries.size(); i++) {
+        if(write_double(&entries[i], d[i]) == -1) return NULL;
+    }
+    Py_RETURN_NONE;
+}
+
+static PyObject *pyhalgroup_changed(PyObject *_self, PyObject *) {
+    halgroup *self = (halgroup *)_self;
+    groupentries &entries = *self->entries;
+    PyObject *result = PyList_New(0);
+    if(!result) return NULL;
+
+    for(unsigned i = 0; i < entries.size(); i++) {
+        groupentry &e = entries[i];
+        union paramunion v;
+        read_raw(&e.item, &v);
+        if(self->primed && raw_equal(e.item.type, &v, &e.last)) continue;
+        e.last = v;
+
+        PyObject *value = pyhal_read_common(&e.item);
+        PyObject *pair = value ? Py_BuildValue("(iN)", (int)i, value) : NULL;
+        if(!pair || PyList_Append(result, pair) == -1) {
+            Py_XDECREF(pair);
+            Py_DECREF(result);
+            return NULL;
+        }
+        Py_DECREF(pair);
+    }
+    self->primed = true;
+    return result;
+}
+
+static PyObject *pyhalgroup_get_names(PyObject *_self, PyObject *) {
+    halgroup *self = (halgroup *)_self;
+    groupentries &entries = *self->entries;
+    PyObject *result = PyTuple_New(entries.size());
+    if(!result) return NULL;
+
+    for(unsigned i = 0; i < entries.size(); i++) {
+        PyObject *name = PyString_FromString(entries[i].name.c_str());
+        if(!name) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(result, i, name);
+    }
+    return result;
+}
+
+static PyMethodDef halgroup_methods[] = {
+    {"get", pyhalgroup_get, METH_NOARGS,
+        "Get the values of all items as a tuple"},
+    {"set", pyhalgroup_set, METH_O,
+        "Set all items from a sequence of values"},
+    {"read_into", pyhalgroup_read_into, METH_O,
+        "Store the values of all items as doubles into a writable buffer"},
+    {"write_from", pyhalgroup_write_from, METH_O,
+        "Set all items from a buffer of doubles"},
+    {"changed", pyhalgroup_changed, METH_NOARGS,
+        "Get (index, value) of the items that changed since the last call; "
+        "the first call returns all of them"},
+    {"get_names", pyhalgroup_get_names, METH_NOARGS,
+        "Get the names of the items"},
+    {NULL},
+};
+
+static PySequenceMethods halgroup_sequence = {
+    pyhalgroup_len,             /*sq_length*/
+};
+
+static 
+PyTypeObject halgroup_type = {
+    PyObject_HEAD_INIT(NULL)
+    0,                         /*ob_size*/
+    "hal.pingroup",            /*tp_name*/
+    sizeof(halgroup),          /*tp_basicsize*/
+    0,                         /*tp_itemsize*/
+    pyhalgroup_delete,         /*tp_dealloc*/
+    0,                         /*tp_print*/
+    0,                         /*tp_getattr*/
+    0,                         /*tp_setattr*/
+    0,                         /*tp_compare*/
+    pyhalgroup_repr,           /*tp_repr*/
+    0,                         /*tp_as_number*/
+    &halgroup_sequence,        /*tp_as_sequence*/
+    0,                         /*tp_as_mapping*/
+    0,                         /*tp_hash */
+    0,                         /*tp_call*/
+    0,                         /*tp_str*/
+    0,                         /*tp_getattro*/
+    0,                         /*tp_setattro*/
+    0,                         /*tp_as_buffer*/
+    Py_TPFLAGS_DEFAULT,        /*tp_flags*/
+    "HAL Pin Group",           /*tp_doc*/
+    0,                         /*tp_traverse*/
+    0,                         /*tp_clear*/
+    0,                         /*tp_richcompare*/
+    0,                         /*tp_weaklistoffset*/
+    0,                         /*tp_iter*/
+    0,                         /*tp_iternext*/
+    halgroup_methods,          /*tp_methods*/
+    0,                         /*tp_members*/
+    0,                         /*tp_getset*/
+    0,                         /*tp_base*/
+    0,                         /*tp_dict*/
+    0,                         /*tp_descr_get*/
+    0,                         /*tp_descr_set*/
+    0,                         /*tp_dictoffset*/
+    pyhalgroup_init,           /*tp_init*/
+    0,                         /*tp_alloc*/
+    PyType_GenericNew,         /*tp_new*/
+    0,                         /*tp_free*/
+    0,                         /*tp_is_gc*/
+};
+
+static PyObject *pyhal_get_group(PyObject *_self, PyObject *o) {
+    halobject *self = (halobject *)_self;
+    PyObject *seq = PySequence_Fast(o, "getgroup needs a sequence of names");
+    if(!seq) return NULL;
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(seq);
+    groupentries *entries = new groupentries(n);
+    for(Py_ssize_t i = 0; i < n; i++) {
+        char *name = PyString_AsString(PySequence_Fast_GET_ITEM(seq, i));
+        halitem *item = find_item(self, name);
+        if(!item) {
+            delete entries;
+            Py_DECREF(seq);
+            return NULL;
+        }
+        (*entries)[i].name = name;
+        (*entries)[i].item = *item;
+    }
+    Py_DECREF(seq);
+
+    halgroup *group = PyObject_New(halgroup, &halgroup_type);
+    if(!group) {
+        delete entries;
+        return NULL;
+    }
+    group->entries = entries;
+    group->primed = false;
+    group->comp = self;
+    Py_INCREF(self);
+    return (PyObject *)group;
+}
+
 PyObject *pin_has_writer(PyObject *self, PyObject *args) {
     char *name;
     if(!PyArg_ParseTuple(args, "s", &name)) return NULL;
@@ -1103,9 +1454,11 @@ void init_hal(void) {
     PyType_Ready(&halobject_type);
     PyType_Ready(&shm_type);
     PyType_Ready(&halpin_type);
+    PyType_Ready(&halgroup_type);
     PyModule_AddObject(m, "component", (PyObject*)&halobject_type);
     PyModule_AddObject(m, "shm", (PyObject*)&shm_type);
     PyModule_AddObject(m, "item", (PyObject*)&halpin_type);
+    PyModule_AddObject(m, "pingroup", (PyObject*)&halgroup_type);
 
     PyModule_AddIntConstant(m, "MSG_NONE", RTAPI_MSG_NONE);
     PyModule_AddIntConstant(m, "MSG_ERR", RTAPI_MSG_ERR);
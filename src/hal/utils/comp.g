@@ -283,6 +283,7 @@ static int comp_id;
 
 
     has_data = options.get("data")
+    array_funct = options.get("array_function")
 
     has_array = False
     has_personality = False
@@ -308,7 +309,26 @@ static int comp_id;
     if has_personality:
         print >>f, "    int _personality;"
 
+    if array_funct:
+        # With array functions, pins, params and variables of every
+        # instance live in one array per item, indexed by instance
+        # number, and the instance struct only records that number.
+        print >>f, "    int _index;"
+        print >>f, "};"
+        print >>f
+        print >>f, "struct __comp_arrays {"
+        print >>f, "    int _count, _max;"
+        for name, type, array, dir, value, personality in pins:
+            print >>f, "    hal_%s_t **%s;" % (type, to_c(name))
+            names[name] = 1
+        for name, type, array, dir, value, personality in params:
+            print >>f, "    hal_%s_t *%s;" % (type, to_c(name))
+            names[name] = 1
+        for type, name, array, value in variables:
+            print >>f, "    %s *%s;" % (type, name)
+
     for name, type, array, dir, value, personality in pins:
+        if array_funct: break
         if array:
             if isinstance(array, tuple): array = array[0]
             print >>f, "    hal_%s_t *%s[%s];" % (type, to_c(name), array)
@@ -317,6 +337,7 @@ static int comp_id;
         names[name] = 1
 
     for name, type, array, dir, value, personality in params:
+        if array_funct: break
         if array:
             if isinstance(array, tuple): array = array[0]
             print >>f, "    hal_%s_t %s[%s];" % (type, to_c(name), array)
@@ -325,6 +346,7 @@ static int comp_id;
         names[name] = 1
 
     for type, name, array, value in variables:
+        if array_funct: break
         if array:
             print >>f, "    %s %s[%d];\n" % (type, name, array)
         else:
@@ -348,6 +370,25 @@ static int comp_id;
         names[name] = 1
 
     print >>f, "static int __comp_get_data_size(void);"
+    if array_funct:
+        print >>f, "static struct __comp_arrays *__comp_arrays;"
+        for name, fp in functions:
+            print >>f, "static void __comp_all_%s(struct __comp_arrays *__comp_a, long period);" % to_c(name)
+        print >>f
+        print >>f, "static int __comp_arrays_init(int n) {"
+        print >>f, "    __comp_arrays = hal_malloc(sizeof(struct __comp_arrays));"
+        print >>f, "    if(!__comp_arrays) return -ENOMEM;"
+        print >>f, "    memset(__comp_arrays, 0, sizeof(struct __comp_arrays));"
+        print >>f, "    __comp_arrays->_max = n;"
+        print >>f, "    if(n == 0) return 0;"
+        members = [to_c(p[0]) for p in pins] + [to_c(p[0]) for p in params] \
+            + [v[1].replace("*", "") for v in variables]
+        for m in members:
+            print >>f, "    __comp_arrays->%s = hal_malloc(n * sizeof(*__comp_arrays->%s));" % (m, m)
+            print >>f, "    if(!__comp_arrays->%s) return -ENOMEM;" % m
+            print >>f, "    memset((void*)__comp_arrays->%s, 0, n * sizeof(*__comp_arrays->%s));" % (m, m)
+        print >>f, "    return 0;"
+        print >>f, "}"
     if options.get("extra_setup"):
         print >>f, "static int extra_setup(struct __comp_state *__comp_inst, char *prefix, long extra_arg);"
     if options.get("extra_cleanup"):
@@ -372,13 +413,22 @@ static int comp_id;
     print >>f, "    int r = 0;"
     if has_array:
         print >>f, "    int j = 0;"
+    if array_funct:
+        print >>f, "    int idx = __comp_arrays->_count;"
+        def member(name): return "__comp_arrays->%s[idx]" % name
+    else:
+        def member(name): return "inst->%s" % name
     print >>f, "    int sz = sizeof(struct __comp_state) + __comp_get_data_size();"
     print >>f, "    struct __comp_state *inst = hal_malloc(sz);"
+    if array_funct:
+        print >>f, "    if(idx >= __comp_arrays->_max) return -ENOMEM;"
     print >>f, "    memset(inst, 0, sz);"
     if has_data:
         print >>f, "    inst->_data = (char*)inst + sizeof(struct __comp_state);"
     if has_personality:
         print >>f, "    inst->_personality = personality;"
+    if array_funct:
+        print >>f, "    inst->_index = idx;"
     if options.get("extra_setup"):
         print >>f, "    r = extra_setup(inst, prefix, extra_arg);"
 	print >>f, "    if(r != 0) return r;"
@@ -398,12 +448,12 @@ static int comp_id;
                 print >>f, "    *(inst->%s[j]) = %s;" % (to_c(name), value)
             print >>f, "    }"
         else:
-            print >>f, "    r = hal_pin_%s_newf(%s, &(inst->%s), comp_id," % (
-                type, dirmap[dir], to_c(name))
+            print >>f, "    r = hal_pin_%s_newf(%s, &(%s), comp_id," % (
+                type, dirmap[dir], member(to_c(name)))
             print >>f, "        \"%%s%s\", prefix);" % to_hal("." + name)
             print >>f, "    if(r != 0) return r;"
             if value is not None:
-                print >>f, "    *(inst->%s) = %s;" % (to_c(name), value)
+                print >>f, "    *(%s) = %s;" % (member(to_c(name)), value)
         if personality:
             print >>f, "}"
 
@@ -421,11 +471,11 @@ static int comp_id;
                 print >>f, "    inst->%s[j] = %s;" % (to_c(name), value)
             print >>f, "    }"
         else:
-            print >>f, "    r = hal_param_%s_newf(%s, &(inst->%s), comp_id," % (
-                type, dirmap[dir], to_c(name))
+            print >>f, "    r = hal_param_%s_newf(%s, &(%s), comp_id," % (
+                type, dirmap[dir], member(to_c(name)))
             print >>f, "        \"%%s%s\", prefix);" % to_hal("." + name)
             if value is not None:
-                print >>f, "    inst->%s = %s;" % (to_c(name), value)
+                print >>f, "    %s = %s;" % (member(to_c(name)), value)
             print >>f, "    if(r != 0) return r;"
         if personality:
             print >>f, "}"
@@ -437,7 +487,7 @@ static int comp_id;
             print >>f, "        inst->%s[j] = %s;" % (name, value)
             print >>f, "    }"
         else:
-            print >>f, "    inst->%s = %s;" % (name, value)
+            print >>f, "    %s = %s;" % (member(name.replace("*", "")), value)
 
     for name, fp in functions:
         print >>f, "    rtapi_snprintf(buf, sizeof(buf), \"%%s%s\", prefix);"\
@@ -448,6 +498,8 @@ static int comp_id;
     print >>f, "    if(__comp_last_inst) __comp_last_inst->_next = inst;"
     print >>f, "    __comp_last_inst = inst;"
     print >>f, "    if(!__comp_first_inst) __comp_first_inst = inst;"
+    if array_funct:
+        print >>f, "    __comp_arrays->_count++;"
     print >>f, "    return 0;"
     print >>f, "}"
 
@@ -491,6 +543,12 @@ static int comp_id;
                 print >>f, "    r = export(\"%s\", 0);" % \
                         to_hal(removeprefix(comp_name, "hal_"))
         elif options.get("count_function"):
+            if array_funct:
+                print >>f, "    r = __comp_arrays_init(count);"
+                print >>f, "    if(r) {"
+                print >>f, "        hal_exit(comp_id);"
+                print >>f, "        return r;"
+                print >>f, "    }"
             print >>f, "    for(i=0; i<count; i++) {"
             print >>f, "        char buf[HAL_NAME_LEN + 1];"
             print >>f, "        rtapi_snprintf(buf, sizeof(buf), " \
@@ -508,6 +566,17 @@ static int comp_id;
             print >>f, "        return -EINVAL;"
             print >>f, "    }"
             print >>f, "    if(!count && !names[0]) count = default_count;"
+            if array_funct:
+                print >>f, "    if(count) {"
+                print >>f, "        r = __comp_arrays_init(count);"
+                print >>f, "    } else {"
+                print >>f, "        for(i=0; names[i]; i++) ;"
+                print >>f, "        r = __comp_arrays_init(i);"
+                print >>f, "    }"
+                print >>f, "    if(r) {"
+                print >>f, "        hal_exit(comp_id);"
+                print >>f, "        return r;"
+                print >>f, "    }"
             print >>f, "    if(count) {"
             print >>f, "        for(i=0; i<count; i++) {"
             print >>f, "            char buf[HAL_NAME_LEN + 1];"
@@ -532,6 +601,13 @@ static int comp_id;
 
         if options.get("constructable") and not options.get("singleton"):
             print >>f, "    hal_set_constructor(comp_id, export_1);"
+        if array_funct:
+            for name, fp in functions:
+                print >>f, "    if(!r && __comp_arrays->_count) {"
+                print >>f, "        r = hal_export_funct(\"%s.all%s\", (void(*)(void *inst, long))__comp_all_%s, __comp_arrays, %s, 0, comp_id);" % (
+                    to_hal(removeprefix(comp_name, "hal_")), to_hal("." + name),
+                    to_c(name), int(fp))
+                print >>f, "    }"
         print >>f, "    if(r) {"
 	if options.get("extra_cleanup"):
             print >>f, "    extra_cleanup();"
@@ -569,7 +645,10 @@ static int comp_id;
     print >>f
     if not options.get("no_convenience_defines"):
         print >>f, "#undef FUNCTION"
-        print >>f, "#define FUNCTION(name) static void name(struct __comp_state *__comp_inst, long period)"
+        if array_funct:
+            print >>f, "#define FUNCTION(name) static inline void __comp_body_##name(struct __comp_arrays *__comp_a, int __comp_i, long period)"
+        else:
+            print >>f, "#define FUNCTION(name) static void name(struct __comp_state *__comp_inst, long period)"
         print >>f, "#undef EXTRA_SETUP"
         print >>f, "#define EXTRA_SETUP() static int extra_setup(struct __comp_state *__comp_inst, char *prefix, long extra_arg)"
         print >>f, "#undef EXTRA_CLEANUP"
@@ -578,7 +657,12 @@ static int comp_id;
         print >>f, "#define fperiod (period * 1e-9)"
         for name, type, array, dir, value, personality in pins:
             print >>f, "#undef %s" % to_c(name)
-            if array:
+            if array_funct:
+                if dir == 'in':
+                    print >>f, "#define %s (0+*__comp_a->%s[__comp_i])" % (to_c(name), to_c(name))
+                else:
+                    print >>f, "#define %s (*__comp_a->%s[__comp_i])" % (to_c(name), to_c(name))
+            elif array:
                 if dir == 'in':
                     print >>f, "#define %s(i) (0+*(__comp_inst->%s[i]))" % (to_c(name), to_c(name))
                 else:
@@ -590,7 +674,9 @@ static int comp_id;
                     print >>f, "#define %s (*__comp_inst->%s)" % (to_c(name), to_c(name))
         for name, type, array, dir, value, personality in params:
             print >>f, "#undef %s" % to_c(name)
-            if array:
+            if array_funct:
+                print >>f, "#define %s (__comp_a->%s[__comp_i])" % (to_c(name), to_c(name))
+            elif array:
                 print >>f, "#define %s(i) (__comp_inst->%s[i])" % (to_c(name), to_c(name))
             else:
                 print >>f, "#define %s (__comp_inst->%s)" % (to_c(name), to_c(name))
@@ -598,7 +684,10 @@ static int comp_id;
         for type, name, array, value in variables:
             name = name.replace("*", "")
             print >>f, "#undef %s" % name
-            print >>f, "#define %s (__comp_inst->%s)" % (name, name)
+            if array_funct:
+                print >>f, "#define %s (__comp_a->%s[__comp_i])" % (name, name)
+            else:
+                print >>f, "#define %s (__comp_inst->%s)" % (name, name)
 
         if has_data:
             print >>f, "#undef data"
@@ -616,6 +705,18 @@ static int comp_id;
 def epilogue(f):
     data = options.get('data')
     print >>f
+    if options.get("array_function"):
+        for name, fp in functions:
+            print >>f, "static void %s(struct __comp_state *__comp_inst, long period) {" % to_c(name)
+            print >>f, "    __comp_body_%s(__comp_arrays, __comp_inst->_index, period);" % to_c(name)
+            print >>f, "}"
+            print >>f
+            print >>f, "static void __comp_all_%s(struct __comp_arrays *__comp_a, long period) {" % to_c(name)
+            print >>f, "    int __comp_i, __comp_n = __comp_a->_count;"
+            print >>f, "    for(__comp_i = 0; __comp_i < __comp_n; __comp_i++)"
+            print >>f, "        __comp_body_%s(__comp_a, __comp_i, period);" % to_c(name)
+            print >>f, "}"
+            print >>f
     if data:
         print >>f, "static int __comp_get_data_size(void) { return sizeof(%s); }" % data
     else:
@@ -804,6 +905,16 @@ def document(filename, outfilename):
             else:
                 print >>f
             print >>f, doc
+        if options.get("array_function"):
+            for _, name, fp, doc in finddocs('funct'):
+                print >>f, ".TP"
+                print >>f, "\\fB%s.all%s\\fR" % (comp_name,
+                    to_hal("." + name)),
+                if fp:
+                    print >>f, "(requires a floating-point thread)"
+                else:
+                    print >>f
+                print >>f, "Updates every instance in one call, in instance order. Add either this function or the per-instance functions to a thread, not both."
 
     lead = ".TP"
     print >>f, ".SH PINS"
@@ -874,6 +985,20 @@ def document(filename, outfilename):
         print >>f, ".SH LICENSE\n"
         print >>f, "%s" % doc[1]
 
+def check_array_function():
+    for o in ("singleton", "userspace", "constructable", "data",
+            "extra_setup", "no_convenience_defines"):
+        if options.get(o):
+            raise SystemExit, "option array_function may not be combined with option %s" % o
+    if not options.get("rtapi_app", 1):
+        raise SystemExit, "option array_function requires option rtapi_app"
+    for name, type, array, dir, value, personality in pins + params:
+        if array or personality:
+            raise SystemExit, "option array_function does not support arrays or personality (%s)" % name
+    for type, name, array, value in variables:
+        if array:
+            raise SystemExit, "option array_function does not support array variables (%s)" % name
+
 def process(filename, mode, outfilename):
     tempdir = tempfile.mkdtemp()
     try:
@@ -892,6 +1017,8 @@ def process(filename, mode, outfilename):
                 raise SystemExit, "Userspace components may not have functions"
         if not pins:
             raise SystemExit, "Component must have at least one pin"
+        if options.get("array_function"):
+            check_array_function()
         prologue(f)
         lineno = a.count("\n") + 3
 
@@ -46,8 +46,10 @@ extern void halcmd_shutdown();
 extern int halcmd_parse_cmd(char * tokens[]);
 extern int halcmd_parse_line(char * line);
 extern void halcmd_shutdown(void);
-extern int prompt_mode, errorcount, halcmd_done;
+extern int prompt_mode, errorcount, halcmd_done, hal_flag;
 extern int halcmd_preprocess_line ( char *line, char **tokens);
+extern int halcmd_batch_cmd(char *tokens[]);
+extern int halcmd_batch_flush(void);
 
 void halcmd_info(const char *format,...) __attribute__((format(printf,1,2)));
 void halcmd_output(const char *format,...) __attribute__((format(printf,1,2)));
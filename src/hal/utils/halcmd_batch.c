@@ -0,0 +1,668 @@
+/* halcmd_batch.c - batch ("transaction") mode for halcmd -f
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of version 2 of the GNU General
+ *  Public License as published by the Free Software Foundation.
+ *  This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111 USA
+ *
+ *  THE AUTHORS OF THIS LIBRARY ACCEPT ABSOLUTELY NO LIABILITY FOR
+ *  ANY HARM OR LOSS RESULTING FROM ITS USE.  IT IS _EXTREMELY_ UNWISE
+ *  TO RELY ON SOFTWARE ALONE FOR SAFETY.  Any machinery capable of
+ *  harming persons must have provisions for completely removing power
+ *  from all motors, etc, before persons enter any danger area.  All
+ *  machinery must be designed to comply with local and national safety
+ *  codes, and the authors of this software can not, and do not, take
+ *  any responsibility for such compliance.
+ *
+ *  This code was written as part of the EMC HAL project.  For more
+ *  information, go to www.linuxcnc.org.
+ */
+
+/* In batch mode, 'net', 'setp' and 'addf' commands are not executed
+   as they are read.  Instead they are queued, and the queue is
+   flushed when a command that is not batchable (loadrt, loadusr,
+   start, show, ...) is read, or at the end of the file.
+
+   A flush takes the HAL mutex once, builds a hash index of every
+   pin, parameter, signal, function and thread name, checks every
+   queued command against a "shadow" copy of the state it would
+   change (signal writers, pin links, function users, thread list
+   lengths), and only if all of them pass, applies them all before
+   releasing the mutex.  This replaces the linear list search and
+   mutex round trip that each command does in normal mode.
+*/
+
+#include "config.h"
+#include "rtapi.h"		/* RTAPI realtime OS API */
+#include "hal.h"		/* HAL public API decls */
+#include "../hal_priv.h"	/* private HAL decls */
+#include "halcmd.h"
+#include "halcmd_commands.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/time.h>
+
+typedef enum {
+    BATCH_NET,
+    BATCH_SETP,
+    BATCH_ADDF,
+} batch_op_t;
+
+typedef enum {
+    BK_PIN,
+    BK_PARAM,
+    BK_SIG,
+    BK_FUNCT,
+    BK_THREAD,
+} batch_kind_t;
+
+/* one queued command; 'argv' and the strings it points to are
+   allocated in a single block along with the struct */
+typedef struct {
+    batch_op_t op;
+    int linenumber;
+    int argc;
+    char **argv;
+    hal_type_t type;		/* setp: type of the target */
+    void *target;		/* setp: address to write */
+} batch_cmd_t;
+
+/* one slot of the name index.  The shadow fields start out as a copy
+   of the HAL state and are updated as commands are validated. */
+typedef struct batch_entry {
+    const char *name;
+    unsigned int hash;
+    batch_kind_t kind;
+    void *obj;			/* HAL object, NULL for a new signal */
+    struct batch_entry *alias_of;	/* pins/params found by old name */
+    struct batch_entry *sig;	/* pins: signal linked (or to be) */
+    hal_type_t type;		/* signals: data type */
+    int writers;		/* signals: number of output pins */
+    int bidirs;			/* signals: number of I/O pins */
+    const char *writer_name;	/* signals: output or I/O pin name */
+    const char *bidir_name;	/* signals: I/O pin name */
+    int count;			/* functs: users, threads: functions */
+} batch_entry_t;
+
+static batch_cmd_t **batch_cmds = NULL;
+static int batch_ncmds = 0;
+static int batch_maxcmds = 0;
+static double batch_parse_time = 0.0;
+
+static batch_entry_t *index_table = NULL;
+static unsigned int index_mask = 0;
+
+static double elapsed_ms(struct timeval *since)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    return (now.tv_sec - since->tv_sec) * 1e3 +
+	(now.tv_usec - since->tv_usec) * 1e-3;
+}
+
+/***********************************************************************
+*                          NAME INDEX                                  *
+************************************************************************/
+
+static unsigned int name_hash(batch_kind_t kind, const char *name)
+{
+    /* FNV-1a, with the kind mixed in so each kind has its own namespace */
+    unsigned int h = 2166136261u ^ kind;
+    while (*name) {
+	h ^= (unsigned char) *name++;
+	h *= 16777619u;
+    }
+    return h;
+}
+
+static batch_entry_t *index_lookup(batch_kind_t kind, const char *name)
+{
+    unsigned int h = name_hash(kind, name);
+    unsigned int i = h & index_mask;
+    batch_entry_t *e;
+
+    while ((e = &index_table[i])->name != NULL) {
+	if (e->hash == h && e->kind == kind && strcmp(e->name, name) == 0) {
+	    return e->alias_of ? e->alias_of : e;
+	}
+	i = (i + 1) & index_mask;
+    }
+    return NULL;
+}
+
+static batch_entry_t *index_insert(batch_kind_t kind, const char *name,
+    void *obj)
+{
+    unsigned int h = name_hash(kind, name);
+    unsigned int i = h & index_mask;
+    batch_entry_t *e;
+
+    while ((e = &index_table[i])->name != NULL) {
+	i = (i + 1) & index_mask;
+    }
+    e->name = name;
+    e->hash = h;
+    e->kind = kind;
+    e->obj = obj;
+    return e;
+}
+
+/* build the index from the HAL lists; the mutex must be held.
+   'extra' is the number of slots to reserve for new signals. */
+static int index_build(int extra)
+{
+    int next, n, size;
+    hal_pin_t *pin;
+    hal_param_t *param;
+    hal_sig_t *sig;
+    hal_funct_t *funct;
+    hal_thread_t *thread;
+    hal_oldname_t *oldname;
+    hal_list_t *list_root, *list_entry;
+    batch_entry_t *e, *s;
+
+    /* count everything so the table never has to grow */
+    n = extra;
+    for (next = hal_data->pin_list_ptr; next; next = pin->next_ptr) {
+	pin = SHMPTR(next);
+	n += pin->oldname ? 2 : 1;
+    }
+    for (next = hal_data->param_list_ptr; next; next = param->next_ptr) {
+	param = SHMPTR(next);
+	n += param->oldname ? 2 : 1;
+    }
+    for (next = hal_data->sig_list_ptr; next; next = sig->next_ptr) {
+	sig = SHMPTR(next);
+	n++;
+    }
+    for (next = hal_data->funct_list_ptr; next; next = funct->next_ptr) {
+	funct = SHMPTR(next);
+	n++;
+    }
+    for (next = hal_data->thread_list_ptr; next; next = thread->next_ptr) {
+	thread = SHMPTR(next);
+	n++;
+    }
+    /* keep the load factor at or below one half */
+    for (size = 64; size < 2 * n; size <<= 1);
+    index_table = calloc(size, sizeof(batch_entry_t));
+    if (index_table == NULL) {
+	halcmd_error("out of memory building name index\n");
+	return -ENOMEM;
+    }
+    index_mask = size - 1;
+
+    /* signals first, so pins can refer to them */
+    for (next = hal_data->sig_list_ptr; next; next = sig->next_ptr) {
+	sig = SHMPTR(next);
+	e = index_insert(BK_SIG, sig->name, sig);
+	e->type = sig->type;
+	e->writers = sig->writers;
+	e->bidirs = sig->bidirs;
+    }
+    for (next = hal_data->pin_list_ptr; next; next = pin->next_ptr) {
+	pin = SHMPTR(next);
+	e = index_insert(BK_PIN, pin->name, pin);
+	if (pin->oldname != 0) {
+	    oldname = SHMPTR(pin->oldname);
+	    index_insert(BK_PIN, oldname->name, pin)->alias_of = e;
+	}
+	if (pin->signal != 0) {
+	    sig = SHMPTR(pin->signal);
+	    s = index_lookup(BK_SIG, sig->name);
+	    e->sig = s;
+	    if (pin->dir == HAL_OUT) {
+		s->writer_name = pin->name;
+	    } else if (pin->dir == HAL_IO) {
+		s->bidir_name = s->writer_name = pin->name;
+	    }
+	}
+    }
+    for (next = hal_data->param_list_ptr; next; next = param->next_ptr) {
+	param = SHMPTR(next);
+	e = index_insert(BK_PARAM, param->name, param);
+	if (param->oldname != 0) {
+	    oldname = SHMPTR(param->oldname);
+	    index_insert(BK_PARAM, oldname->name, param)->alias_of = e;
+	}
+    }
+    for (next = hal_data->funct_list_ptr; next; next = funct->next_ptr) {
+	funct = SHMPTR(next);
+	e = index_insert(BK_FUNCT, funct->name, funct);
+	e->count = funct->users;
+    }
+    for (next = hal_data->thread_list_ptr; next; next = thread->next_ptr) {
+	thread = SHMPTR(next);
+	e = index_insert(BK_THREAD, thread->name, thread);
+	list_root = &(thread->funct_list);
+	for (list_entry = list_next(list_root); list_entry != list_root;
+	    list_entry = list_next(list_entry)) {
+	    e->count++;
+	}
+    }
+    return 0;
+}
+
+static void index_free(void)
+{
+    free(index_table);
+    index_table = NULL;
+    index_mask = 0;
+}
+
+/***********************************************************************
+*                          VALIDATION                                  *
+************************************************************************/
+
+/* these mirror the checks done by preflight_net_cmd(), do_setp_cmd()
+   and hal_add_funct_to_thread(), but against the shadow state */
+
+static int validate_net(batch_cmd_t *cmd)
+{
+    char *signal = cmd->argv[1];
+    char **pins = &cmd->argv[2];
+    batch_entry_t *sig, *pin;
+    int i, type = -1, writers = 0, bidirs = 0, pincnt = 0;
+    const char *writer_name = NULL, *bidir_name = NULL;
+
+    sig = index_lookup(BK_SIG, signal);
+    if (sig) {
+	type = sig->type;
+	writers = sig->writers;
+	bidirs = sig->bidirs;
+	writer_name = sig->writer_name;
+	bidir_name = sig->bidir_name;
+    }
+    for (i = 0; pins[i]; i++) {
+	pin = index_lookup(BK_PIN, pins[i]);
+	if (!pin) {
+	    halcmd_error("Pin '%s' does not exist\n", pins[i]);
+	    return -ENOENT;
+	}
+	if (sig && pin->sig == sig) {
+	    /* Already on this signal */
+	    pincnt++;
+	    continue;
+	} else if (pin->sig) {
+	    halcmd_error("Pin '%s' was already linked to signal '%s'\n",
+		pins[i], pin->sig->name);
+	    return -EINVAL;
+	}
+	if (type == -1) {
+	    /* no pre-existing type, use this pin's type */
+	    type = ((hal_pin_t *) pin->obj)->type;
+	}
+	if (type != ((hal_pin_t *) pin->obj)->type) {
+	    halcmd_error("Signal '%s' cannot add pin '%s' of a different type\n",
+		signal, pins[i]);
+	    return -EINVAL;
+	}
+	switch (((hal_pin_t *) pin->obj)->dir) {
+	case HAL_OUT:
+	    if (writers || bidirs) {
+		goto dir_error;
+	    }
+	    writer_name = pins[i];
+	    writers++;
+	    break;
+	case HAL_IO:
+	    if (writers) {
+		goto dir_error;
+	    }
+	    bidir_name = pins[i];
+	    bidirs++;
+	    break;
+	default:
+	    break;
+	}
+	pincnt++;
+	continue;
+      dir_error:
+	halcmd_error("Signal '%s' can not add pin '%s', it already has %s pin '%s'\n",
+	    signal, pins[i], bidir_name ? "I/O" : "OUT",
+	    bidir_name ? bidir_name : writer_name);
+	return -EINVAL;
+    }
+    if (pincnt == 0) {
+	halcmd_error("'net' requires at least one pin, none given\n");
+	return -EINVAL;
+    }
+    if (index_lookup(BK_PIN, signal)) {
+	halcmd_error("Signal name '%s' must not be the same as a pin.  "
+	    "Did you omit the signal name?\n", signal);
+	return -ENOENT;
+    }
+    if (!sig) {
+	if (strlen(signal) > HAL_NAME_LEN) {
+	    halcmd_error("Signal name '%s' is too long\n", signal);
+	    return -EINVAL;
+	}
+	/* created in the apply phase, with the type of the first pin */
+	sig = index_insert(BK_SIG, signal, NULL);
+	sig->type = ((hal_pin_t *) index_lookup(BK_PIN, pins[0])->obj)->type;
+    }
+    /* everything checks out, update the shadow state */
+    sig->writers = writers;
+    sig->bidirs = bidirs;
+    sig->writer_name = writer_name;
+    sig->bidir_name = bidir_name;
+    for (i = 0; pins[i]; i++) {
+	index_lookup(BK_PIN, pins[i])->sig = sig;
+    }
+    return 0;
+}
+
+static int validate_setp(batch_cmd_t *cmd)
+{
+    char *name = cmd->argv[1];
+    batch_entry_t *e;
+    hal_data_u scratch;
+
+    if ((e = index_lookup(BK_PARAM, name)) != NULL) {
+	hal_param_t *param = e->obj;
+	if (param->dir == HAL_RO) {
+	    halcmd_error("param '%s' is not writable\n", name);
+	    return -EINVAL;
+	}
+	cmd->type = param->type;
+	cmd->target = SHMPTR(param->data_ptr);
+    } else if ((e = index_lookup(BK_PIN, name)) != NULL) {
+	hal_pin_t *pin = e->obj;
+	if (pin->dir == HAL_OUT) {
+	    halcmd_error("pin '%s' is not writable\n", name);
+	    return -EINVAL;
+	}
+	if (e->sig) {
+	    halcmd_error("pin '%s' is connected to a signal\n", name);
+	    return -EINVAL;
+	}
+	cmd->type = pin->type;
+	cmd->target = &pin->dummysig;
+    } else {
+	halcmd_error("parameter or pin '%s' not found\n", name);
+	return -EINVAL;
+    }
+    /* check the value now, so a typo can't leave a half-applied batch */
+    return set_common(cmd->type, &scratch, cmd->argv[2]);
+}
+
+static int validate_addf(batch_cmd_t *cmd)
+{
+    batch_entry_t *f, *t;
+    hal_funct_t *funct;
+    hal_thread_t *thread;
+    int position = -1;
+
+    if (cmd->argc > 3 && *cmd->argv[3]) {
+	position = atoi(cmd->argv[3]);
+    }
+    if (position == 0) {
+	halcmd_error("bad position: 0\n");
+	return -EINVAL;
+    }
+    f = index_lookup(BK_FUNCT, cmd->argv[1]);
+    if (!f) {
+	halcmd_error("function '%s' not found\n", cmd->argv[1]);
+	return -EINVAL;
+    }
+    t = index_lookup(BK_THREAD, cmd->argv[2]);
+    if (!t) {
+	halcmd_error("thread '%s' not found\n", cmd->argv[2]);
+	return -EINVAL;
+    }
+    funct = f->obj;
+    thread = t->obj;
+    if (f->count > 0 && funct->reentrant == 0) {
+	halcmd_error("function '%s' may only be added to one thread\n",
+	    funct->name);
+	return -EINVAL;
+    }
+    if (funct->uses_fp && !thread->uses_fp) {
+	halcmd_error("function '%s' needs FP\n", funct->name);
+	return -EINVAL;
+    }
+    if ((position > 0 ? position : -position) - 1 > t->count) {
+	halcmd_error("position '%d' is too %s\n", position,
+	    position > 0 ? "high" : "low");
+	return -EINVAL;
+    }
+    f->count++;
+    t->count++;
+    return 0;
+}
+
+/***********************************************************************
+*                            APPLY                                     *
+************************************************************************/
+
+static int apply_cmd(batch_cmd_t *cmd)
+{
+    batch_entry_t *sig;
+    hal_sig_t *s;
+    int i, retval = 0;
+
+    switch (cmd->op) {
+    case BATCH_NET:
+	sig = index_lookup(BK_SIG, cmd->argv[1]);
+	if (sig->obj == NULL) {
+	    retval = halpr_signal_new(cmd->argv[1], sig->type, &s);
+	    if (retval != 0) {
+		return retval;
+	    }
+	    sig->obj = s;
+	}
+	for (i = 2; retval == 0 && i < cmd->argc; i++) {
+	    retval = halpr_link(index_lookup(BK_PIN, cmd->argv[i])->obj,
+		sig->obj);
+	    if (retval == 0) {
+		halcmd_info("Pin '%s' linked to signal '%s'\n",
+		    cmd->argv[i], cmd->argv[1]);
+	    }
+	}
+	break;
+    case BATCH_SETP:
+	retval = set_common(cmd->type, cmd->target, cmd->argv[2]);
+	if (retval == 0) {
+	    halcmd_info("'%s' set to %s\n", cmd->argv[1], cmd->argv[2]);
+	}
+	break;
+    case BATCH_ADDF:
+	retval = halpr_add_funct_to_thread(
+	    index_lookup(BK_FUNCT, cmd->argv[1])->obj,
+	    index_lookup(BK_THREAD, cmd->argv[2])->obj,
+	    (cmd->argc > 3 && *cmd->argv[3]) ? atoi(cmd->argv[3]) : -1);
+	if (retval == 0) {
+	    halcmd_info("Function '%s' added to thread '%s'\n",
+		cmd->argv[1], cmd->argv[2]);
+	}
+	break;
+    }
+    return retval;
+}
+
+/***********************************************************************
+*                          PUBLIC FUNCTIONS                            *
+************************************************************************/
+
+static void free_cmds(void)
+{
+    int i;
+
+    for (i = 0; i < batch_ncmds; i++) {
+	free(batch_cmds[i]);
+    }
+    batch_ncmds = 0;
+    batch_parse_time = 0.0;
+}
+
+int halcmd_batch_flush(void)
+{
+    struct timeval t0, t1;
+    double t_index, t_validate, t_apply;
+    int i, nnets = 0, retval = 0, errors = 0;
+    int lineno_save = halcmd_get_linenumber();
+
+    if (batch_ncmds == 0) {
+	return 0;
+    }
+    for (i = 0; i < batch_ncmds; i++) {
+	if (batch_cmds[i]->op == BATCH_NET) {
+	    nnets++;
+	}
+    }
+
+    hal_flag = 1;
+    gettimeofday(&t0, NULL);
+    rtapi_mutex_get(&(hal_data->mutex));
+
+    /* phase 1: snapshot every name into the index */
+    gettimeofday(&t1, NULL);
+    retval = index_build(nnets);
+    t_index = elapsed_ms(&t1);
+
+    /* phase 2: check every command against the shadow state */
+    gettimeofday(&t1, NULL);
+    for (i = 0; retval == 0 && i < batch_ncmds; i++) {
+	batch_cmd_t *cmd = batch_cmds[i];
+	int result = 0;
+
+	halcmd_set_linenumber(cmd->linenumber);
+	if (cmd->op != BATCH_SETP && (hal_data->lock & HAL_LOCK_CONFIG)) {
+	    halcmd_error("%s not allowed while HAL is locked\n", cmd->argv[0]);
+	    result = -EPERM;
+	} else if (cmd->op == BATCH_NET) {
+	    result = validate_net(cmd);
+	} else if (cmd->op == BATCH_SETP) {
+	    result = validate_setp(cmd);
+	} else {
+	    result = validate_addf(cmd);
+	}
+	if (result != 0) {
+	    /* keep going to report every problem in the batch */
+	    errors++;
+	}
+    }
+    t_validate = elapsed_ms(&t1);
+
+    /* phase 3: apply, only if the whole batch is good */
+    gettimeofday(&t1, NULL);
+    for (i = 0; retval == 0 && errors == 0 && i < batch_ncmds; i++) {
+	halcmd_set_linenumber(batch_cmds[i]->linenumber);
+	retval = apply_cmd(batch_cmds[i]);
+	if (retval != 0) {
+	    /* only shmem exhaustion should get here; the commands before
+	       this one have been applied, the rest are dropped */
+	    halcmd_error("%s failed, %d commands not applied\n",
+		batch_cmds[i]->argv[0], batch_ncmds - i);
+	}
+    }
+    t_apply = elapsed_ms(&t1);
+
+    rtapi_mutex_give(&(hal_data->mutex));
+    hal_flag = 0;
+
+    halcmd_set_linenumber(lineno_save);
+    halcmd_info("batch: %d commands, parse %.3f ms, index %.3f ms, "
+	"validate %.3f ms, apply %.3f ms, mutex held %.3f ms\n",
+	batch_ncmds, batch_parse_time, t_index, t_validate, t_apply,
+	elapsed_ms(&t0));
+    if (errors) {
+	halcmd_error("batch of %d commands not applied, %d errors\n",
+	    batch_ncmds, errors);
+	retval = -EINVAL;
+    }
+    index_free();
+    free_cmds();
+    return retval;
+}
+
+int halcmd_batch_cmd(char *tokens[])
+{
+    struct timeval t0;
+    batch_cmd_t *cmd;
+    batch_op_t op;
+    int i, argc, len, retval;
+    char *p;
+
+    gettimeofday(&t0, NULL);
+    for (argc = 0; tokens[argc] && tokens[argc][0]; argc++);
+    if (argc == 0) {
+	return 0;
+    }
+    /* only queue well formed commands; anything else goes through
+       the normal parser, which also prints the usual error messages */
+    if (strcmp(tokens[0], "net") == 0) {
+	/* remove arrows, as parse_cmd1() does */
+	int s, d;
+	for (s = d = 0; s < argc; s++) {
+	    if (tokens[s][0] != '<' && tokens[s][0] != '=') {
+		tokens[d++] = tokens[s];
+	    }
+	}
+	tokens[d] = "";
+	argc = d;
+	op = BATCH_NET;
+	if (argc < 3) {
+	    goto not_batchable;
+	}
+    } else if (strcmp(tokens[0], "setp") == 0 && argc == 3) {
+	op = BATCH_SETP;
+    } else if (strcmp(tokens[0], "addf") == 0 && argc >= 3) {
+	op = BATCH_ADDF;
+    } else {
+	goto not_batchable;
+    }
+
+    /* copy the tokens, they point into a buffer that will be reused */
+    len = sizeof(batch_cmd_t) + (argc + 1) * sizeof(char *);
+    for (i = 0; i < argc; i++) {
+	len += strlen(tokens[i]) + 1;
+    }
+    cmd = malloc(len);
+    if (cmd == NULL) {
+	halcmd_error("out of memory\n");
+	return -ENOMEM;
+    }
+    cmd->op = op;
+    cmd->linenumber = halcmd_get_linenumber();
+    cmd->argc = argc;
+    cmd->argv = (char **) (cmd + 1);
+    p = (char *) (cmd->argv + argc + 1);
+    for (i = 0; i < argc; i++) {
+	strcpy(p, tokens[i]);
+	cmd->argv[i] = p;
+	p += strlen(p) + 1;
+    }
+    cmd->argv[argc] = NULL;
+
+    if (batch_ncmds == batch_maxcmds) {
+	int newmax = batch_maxcmds ? 2 * batch_maxcmds : 256;
+	batch_cmd_t **n = realloc(batch_cmds, newmax * sizeof(batch_cmd_t *));
+	if (n == NULL) {
+	    free(cmd);
+	    halcmd_error("out of memory\n");
+	    return -ENOMEM;
+	}
+	batch_cmds = n;
+	batch_maxcmds = newmax;
+    }
+    batch_cmds[batch_ncmds++] = cmd;
+    batch_parse_time += elapsed_ms(&t0);
+    return 0;
+
+  not_batchable:
+    /* the queued commands must take effect before this one runs */
+    retval = halcmd_batch_flush();
+    i = halcmd_parse_cmd(tokens);
+    return retval ? retval : i;
+}
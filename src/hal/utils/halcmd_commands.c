@@ -366,6 +366,27 @@ int do_delf_cmd(char *func, char *thread) {
     return retval;
 }
 
+int do_functiming_cmd(char *thread, char *onoff) {
+    int retval, enable;
+
+    if (strcasecmp(onoff, "on") == 0) {
+	enable = 1;
+    } else if (strcasecmp(onoff, "off") == 0) {
+	enable = 0;
+    } else {
+	halcmd_error("functiming: expected 'on' or 'off', got '%s'\n", onoff);
+	return -EINVAL;
+    }
+    retval = hal_set_thread_timing(thread, enable);
+    if(retval == 0) {
+        halcmd_info("Function timing in thread '%s' turned %s\n",
+                    thread, enable ? "on" : "off");
+    } else {
+        halcmd_error("functiming failed\n");
+    }
+    return retval;
+}
+
 static int preflight_net_cmd(char *signal, hal_sig_t *sig, char *pins[]) {
     int i, type=-1, writers=0, bidirs=0, pincnt=0;
     char *writer_name=0, *bidir_name=0;
@@ -622,7 +643,7 @@ int do_newsig_cmd(char *name, char *type)
     return retval;
 }
 
-static int set_common(hal_type_t type, void *d_ptr, char *value) {
+int set_common(hal_type_t type, void *d_ptr, char *value) {
     // This function assumes that the mutex is held
     int retval = 0;
     double fval;
@@ -2595,6 +2616,9 @@ static void save_threads(FILE *dst)
 	    fprintf(dst, "addf %s %s\n", funct->name, tptr->name);
 	    list_entry = list_next(list_entry);
 	}
+	if (!tptr->funct_timing) {
+	    fprintf(dst, "functiming %s off\n", tptr->name);
+	}
 	next_thread = tptr->next_ptr;
     }
     rtapi_mutex_give(&(hal_data->mutex));
@@ -2739,6 +2763,12 @@ int do_help_cmd(char *command)
     } else if (strcmp(command, "delf") == 0) {
 	printf("delf functname threadname\n");
 	printf("  Removes function 'functname' from thread 'threadname'.\n");
+    } else if (strcmp(command, "functiming") == 0) {
+	printf("functiming threadname on|off\n");
+	printf("  Turns the timing of each function in 'threadname' on (the\n");
+	printf("  default) or off.  When off, only the time of the thread\n");
+	printf("  as a whole is measured, which lowers the overhead of\n");
+	printf("  threads with many small functions.\n");
     } else if (strcmp(command, "show") == 0) {
 	printf("show [type] [pattern]\n");
 	printf("  Prints info about HAL items of the specified type.\n");
@@ -2826,6 +2856,7 @@ static void print_help_commands(void)
     printf("  ptype, stype        Get the type of a pin, parameter or signal\n");
     printf("  setp, sets          Set the value of a pin, parameter or signal\n");
     printf("  addf, delf          Add/remove function to/from a thread\n");
+    printf("  functiming          Turn per-function timing on/off for a thread\n");
     printf("  show                Display info about HAL objects\n");
     printf("  list                Display names of HAL objects\n");
     printf("  source              Execute commands from another .hal file\n");
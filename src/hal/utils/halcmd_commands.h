@@ -46,6 +46,7 @@ extern int do_addf_cmd(char *funct, char *thread, char *tokens[]);
 extern int do_alias_cmd(char *pinparam, char *name, char *alias);
 extern int do_unalias_cmd(char *pinparam, char *name);
 extern int do_delf_cmd(char *funct, char *thread);
+extern int do_functiming_cmd(char *thread, char *onoff);
 extern int do_linkps_cmd(char *pin, char *signal);
 extern int do_linksp_cmd(char *signal, char *pin);
 extern int do_start_cmd();
@@ -79,6 +80,7 @@ extern int do_loadusr_cmd(char *args[]);
 extern int do_waitusr_cmd(char *comp_name);
 extern int do_save_cmd(char *type, char *filename);
 extern int do_setexact_cmd(void);
+extern int set_common(hal_type_t type, void *d_ptr, char *value);
 
 pid_t hal_systemv_nowait(char *const argv[]);
 int hal_systemv(char *const argv[]);
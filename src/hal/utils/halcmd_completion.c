@@ -49,11 +49,13 @@ static const char *command_table[] = {
     "loadrt", "loadusr", "unload", "lock", "unlock",
     "linkps", "linksp", "linkpp", "unlinkp",
     "net", "newsig", "delsig", "getp", "gets", "setp", "sets", "ptype", "stype",
-    "addf", "delf", "show", "list", "status", "save", "source",
+    "addf", "delf", "functiming", "show", "list", "status", "save", "source",
     "start", "stop", "quit", "exit", "help", "alias", "unalias", 
     NULL,
 };
 
+static const char *functiming_table[] = { "on", "off", NULL };
+
 static const char *nonRT_command_table[] = {
     "-h",
     NULL,
@@ -705,6 +707,10 @@ char **halcmd_completer(const char *text, int start, int end, hal_completer_func
         result = func(text, attached_funct_generator);
     } else if(startswith(buffer, "delf ") && argno == 2) {
         result = func(text, thread_generator);
+    } else if(startswith(buffer, "functiming ") && argno == 1) {
+        result = func(text, thread_generator);
+    } else if(startswith(buffer, "functiming ") && argno == 2) {
+        result = completion_matches_table(text, functiming_table, func);
     } else if(startswith(buffer, "help ") && argno == 1) {
         result = completion_matches_table(text, command_table, func);
     } else if(startswith(buffer, "unloadusr ") && argno == 1) {
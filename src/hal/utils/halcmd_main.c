@@ -74,6 +74,7 @@ int main(int argc, char **argv)
     int c, fd;
     int keep_going, retval, errorcount;
     int filemode = 0;
+    int batchmode = 0;
     char *filename = NULL;
     FILE *srcfile = NULL;
     char raw_buf[MAX_CMD_LEN+1];
@@ -91,7 +92,7 @@ int main(int argc, char **argv)
     keep_going = 0;
     /* start parsing the command line, options first */
     while(1) {
-        c = getopt(argc, argv, "+RCfi:kqQsvVh");
+        c = getopt(argc, argv, "+RCbfi:kqQsvVh");
         if(c == -1) break;
         switch(c) {
             case 'R':
@@ -138,6 +139,10 @@ int main(int argc, char **argv)
 	    case 'f':
                 filemode = 1;
 		break;
+	    case 'b':
+		/* -b = batch net/setp/addf commands (with -f) */
+		batchmode = 1;
+		break;
 	    case 'C':
                 cl = getenv("COMP_LINE");
                 cw = getenv("COMP_POINT");
@@ -250,7 +255,11 @@ int main(int argc, char **argv)
 		    break;
 		}
 		/* process command */
-		retval = halcmd_parse_cmd(tokens);
+		if (batchmode) {
+		    retval = halcmd_batch_cmd(tokens);
+		} else {
+		    retval = halcmd_parse_cmd(tokens);
+		}
 	    }
 	    /* did a signal happen while we were busy? */
 	    if ( halcmd_done ) {
@@ -267,6 +276,13 @@ int main(int argc, char **argv)
 		break;
 	    }
 	}
+	/* apply whatever is still queued, unless we are bailing out */
+	if (batchmode && !halcmd_done &&
+	    (errorcount == 0 || keep_going)) {
+	    if (halcmd_batch_flush() != 0) {
+		errorcount++;
+	    }
+	}
     }
     /* all done */
     halcmd_shutdown();
@@ -349,6 +365,8 @@ static void print_help_general(int showR)
     printf("options:\n\n");
     printf("  -f [filename]  Read commands from 'filename', not command\n");
     printf("                 line.  If no filename, read from stdin.\n");
+    printf("  -b             Batch mode (with -f).  Apply net, setp and addf\n");
+    printf("                 commands in groups, under a single HAL lock.\n");
 #ifndef NO_INI
     printf("  -i filename    Open .ini file 'filename', allow commands\n");
     printf("                 to get their values from ini file.\n");
@@ -367,7 +385,8 @@ static void print_help_general(int showR)
     printf("commands:\n\n");
     printf("  loadrt, loadusr, waitusr, unload, lock, unlock, net, linkps, linksp,\n");
     printf("  unlinkp, newsig, delsig, setp, getp, ptype, sets, gets, stype,\n");
-    printf("  addf, delf, show, list, save, status, start, stop, source, quit, exit\n");
+    printf("  addf, delf, functiming, show, list, save, status, start, stop, source,\n");
+    printf("  quit, exit\n");
     printf("  help           Lists all commands with short descriptions\n");
     printf("  help command   Prints detailed help for 'command'\n\n");
 }
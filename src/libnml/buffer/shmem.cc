@@ -72,6 +72,8 @@ SHMEM::SHMEM(const char *n, long s, int nt, key_t k, int m):CMS(s)
     /* save constructor args */
     master = m;
     key = k;
+    lock_free = 0;
+    lock_free_slots = 0;
 
     /* open the shared mem buffer and create mutual exclusion semaphore */
     open();
@@ -91,6 +93,8 @@ SHMEM::SHMEM(const char *bufline, const char *procline, int set_to_server,
     mutex_type = OS_SEM_MUTEX;
     bsem_key = -1;
     second_read = 0;
+    lock_free = 0;
+    lock_free_slots = 0;
 
     if (status < 0) {
 	rcs_print_error("SHMEM: status = %d\n", status);
@@ -156,6 +160,14 @@ SHMEM::SHMEM(const char *bufline, const char *procline, int set_to_server,
 	use_os_sem_only = 0;
     }
 
+    if (NULL != strstr(buflineupper, "LOCKFREE")) {
+	lock_free = 1;
+    }
+
+    if (NULL != (semdelay_equation = strstr(buflineupper, "SLOTS="))) {
+	lock_free_slots = strtol(semdelay_equation + 6, (char **) NULL, 0);
+    }
+
     /* Open the shared memory buffer and create mutual exclusion semaphore. */
     open();
 }
@@ -166,15 +178,63 @@ SHMEM::~SHMEM()
     close();
 }
 
+/* Writers bump a counter that follows the buffer before and after every
+   change, so that readers looking at a message in place can tell when it
+   changed under them.  The counter makes the segment this much longer. */
+#define SHMEM_SEQ_OFFSET(s) (((s) + 7) & ~7L)
+#define SHMEM_SEQ_SIZE 8
+
+/* A queued raw buffer with LOCKFREE on its line keeps its messages in a
+   ring of equal slots after the skip area instead of the CMS queue.
+   Writers claim a slot by moving head on with a compare-and-swap, the
+   reader frees one by moving tail on, and the seq of each slot says
+   whose turn it is: pos while it is free for the writer of message pos,
+   pos + 1 once that message is in it, and pos + nslots once the reader
+   is done with it.  Nobody takes the mutex, so a writer that is preempted
+   in the middle does not hold up the other writers.  It does hold up the
+   reader, which takes messages in order and stops at the first slot that
+   is not filled yet, so the messages after it wait until it is done. */
+#define SHMEM_LOCK_FREE_MAGIC 0x4C465145
+#define SHMEM_LOCK_FREE_DEFAULT_SLOTS 16
+
+struct SHMEM_LOCK_FREE_QUEUE {
+    unsigned int magic;
+    unsigned int nslots;	/* a power of two */
+    long slot_size;		/* bytes per slot, slot header included */
+    /* the writers keep hitting head and the reader tail, so they get a
+       cache line each */
+    volatile unsigned int head __attribute__ ((aligned(64)));
+    volatile unsigned int tail __attribute__ ((aligned(64)));
+};
+
+struct SHMEM_LOCK_FREE_SLOT {
+    volatile unsigned int seq;
+    CMS_HEADER header;
+};
+
+#define SHMEM_LOCK_FREE_DATA_OFFSET \
+    ((sizeof(SHMEM_LOCK_FREE_SLOT) + 7) & ~7L)
+
+static inline SHMEM_LOCK_FREE_SLOT *lock_free_slot(SHMEM_LOCK_FREE_QUEUE *
+    q, unsigned int pos)
+{
+    return (SHMEM_LOCK_FREE_SLOT *) ((char *) (q + 1) +
+	(pos & (q->nslots - 1)) * q->slot_size);
+}
+
 /*
   Open the SHMEM buffer
   */
 int SHMEM::open()
 {
+    long shm_size = size;
+
     /* Set pointers to NULL incase error occurs. */
     sem = NULL;
     shm = NULL;
     bsem = NULL;
+    seq = NULL;
+    lfq = NULL;
     shm_addr_offset = NULL;
     second_read = 0;
     autokey_table_size = 0;
@@ -186,7 +246,8 @@ int SHMEM::open()
 #endif
     /* set up the shared memory address and semaphore, in given state */
     if (master) {
-	shm = new RCS_SHAREDMEM(key, size, RCS_SHAREDMEM_CREATE, (int) MODE);
+	shm = new RCS_SHAREDMEM(key, SHMEM_SEQ_OFFSET(size) + SHMEM_SEQ_SIZE,
+	    RCS_SHAREDMEM_CREATE, (int) MODE);
 	if (shm->addr == NULL) {
 	    switch (shm->create_errno) {
 	    case EACCES:
@@ -242,7 +303,8 @@ int SHMEM::open()
 	}
 	in_buffer_id = 0;
     } else {
-	shm = new RCS_SHAREDMEM(key, size, RCS_SHAREDMEM_NOCREATE);
+	shm = new RCS_SHAREDMEM(key, SHMEM_SEQ_OFFSET(size) + SHMEM_SEQ_SIZE,
+	    RCS_SHAREDMEM_NOCREATE);
 	if (NULL == shm) {
 	    rcs_print_error
 		("CMS: couldn't create RCS_SHAREDMEM(%d(0x%X), %ld(0x%lX), RCS_SHAREDMEM_NOCREATE).\n",
@@ -307,6 +369,9 @@ int SHMEM::open()
 	}
     }
 
+    seq = (volatile unsigned int *) ((char *) shm->addr +
+	SHMEM_SEQ_OFFSET(size));
+
     if (min_compatible_version < 3.44 && min_compatible_version > 0) {
 	total_subdivisions = 1;
     }
@@ -389,6 +454,56 @@ int SHMEM::open()
     mao.read_only = 0;
     mao.sem = sem;
 
+    if (lock_free) {
+	if (!queuing_enabled || neutral || split_buffer || enable_diagnostics
+	    || total_subdivisions > 1 || (min_compatible_version <= 2.58
+		&& min_compatible_version >= 1E-6)) {
+	    rcs_print_error
+		("SHMEM: %s is not a raw queued buffer and can not be LOCKFREE.\n",
+		BufferName);
+	    lock_free = 0;
+	}
+    }
+    if (lock_free) {
+	long lfq_offset = (skip_area + 63) & ~63L;
+	unsigned int nslots = SHMEM_LOCK_FREE_DEFAULT_SLOTS;
+	unsigned int i;
+	long slot_size;
+
+	if (lock_free_slots >= 2) {
+	    for (nslots = 2; nslots * 2 <= (unsigned int) lock_free_slots;
+		nslots *= 2);
+	}
+	slot_size = (shm_size - lfq_offset -
+	    (long) sizeof(SHMEM_LOCK_FREE_QUEUE)) / nslots;
+	slot_size &= ~63L;
+	if (slot_size <= (long) SHMEM_LOCK_FREE_DATA_OFFSET) {
+	    rcs_print_error
+		("SHMEM: %s is too small for a LOCKFREE queue of %u messages.\n",
+		BufferName, nslots);
+	    status = CMS_INSUFFICIENT_SPACE_ERROR;
+	    return -1;
+	}
+	lfq = (SHMEM_LOCK_FREE_QUEUE *) ((char *) shm->addr + lfq_offset);
+	if (master) {
+	    lfq->magic = 0;
+	    lfq->nslots = nslots;
+	    lfq->slot_size = slot_size;
+	    lfq->head = 0;
+	    lfq->tail = 0;
+	    for (i = 0; i < nslots; i++) {
+		lock_free_slot(lfq, i)->seq = i;
+	    }
+	    /* the ring has to be complete before the magic says it is */
+	    __sync_synchronize();
+	    lfq->magic = SHMEM_LOCK_FREE_MAGIC;
+	}
+	max_message_size = slot_size - SHMEM_LOCK_FREE_DATA_OFFSET;
+	if (guaranteed_message_space > max_message_size) {
+	    guaranteed_message_space = max_message_size;
+	}
+    }
+
     fast_mode = !queuing_enabled && !split_buffer && !neutral &&
 	(mutex_type == NO_SWITCHING_MUTEX);
     handle_to_global_data = dummy_handle = new PHYSMEM_HANDLE;
@@ -468,6 +583,10 @@ CMS_STATUS SHMEM::main_access(void *_local)
 	return (status = CMS_NO_BLOCKING_SEM_ERROR);
     }
 
+    if (NULL != lfq) {
+	return lock_free_access(_local);
+    }
+
     mao.read_only = ((internal_access_type == CMS_CHECK_IF_READ_ACCESS) ||
 	(internal_access_type == CMS_PEEK_ACCESS) ||
 	(internal_access_type == CMS_READ_ACCESS));
@@ -542,9 +661,22 @@ CMS_STATUS SHMEM::main_access(void *_local)
 	disable_diag_store = 1;
     }
 
+    int changes = (internal_access_type == CMS_WRITE_ACCESS ||
+	internal_access_type == CMS_WRITE_IF_READ_ACCESS ||
+	internal_access_type == CMS_CLEAR_ACCESS);
+    if (changes) {
+	(*seq)++;
+	__sync_synchronize();
+    }
+
     /* Perform access function. */
     internal_access(shm->addr, size, _local);
 
+    if (changes) {
+	__sync_synchronize();
+	(*seq)++;
+    }
+
     disable_diag_store = 0;
 
     if (NULL != bsem &&
@@ -616,3 +748,243 @@ CMS_STATUS SHMEM::main_access(void *_local)
     second_read = 0;
     return (status);
 }
+
+/* Looks at the message where it is in shared memory instead of copying
+   it out, if the message is raw, the buffer does not queue and there is
+   no split or diagnostics area to skip.  Anything else, or a write that
+   is under way, falls back to an ordinary peek. */
+CMS_STATUS SHMEM::peek_in_place()
+{
+    CMS_HEADER *hdr;
+    char *msg;
+
+    in_place_data = NULL;
+    if (NULL == shm || NULL == seq || !read_permission_flag ||
+	queuing_enabled || neutral || split_buffer || enable_diagnostics ||
+	total_subdivisions > 1 ||
+	(min_compatible_version <= 2.58 && min_compatible_version >= 1E-6)) {
+	return peek();
+    }
+
+    in_place_seq = *seq;
+    __sync_synchronize();
+    if (in_place_seq & 1) {
+	return peek();
+    }
+    hdr = (CMS_HEADER *) ((char *) shm->addr + skip_area);
+    msg = (char *) (hdr + 1);
+    header = *hdr;
+    if (header.in_buffer_size > max_message_size ||
+	((unsigned long) msg) % sizeof(double) != 0) {
+	return peek();
+    }
+    __sync_synchronize();
+    if (*seq != in_place_seq) {
+	return peek();
+    }
+
+    in_place_prev_id = in_buffer_id;
+    status = CMS_STATUS_NOT_SET;
+    check_id(header.write_id);
+    in_place_data = msg;
+    return (status);
+}
+
+/* Checks that no writer got in since peek_in_place().  If one did, the
+   message is forgotten, so the next read or peek copies it again. */
+int SHMEM::in_place_valid()
+{
+    if (NULL == in_place_data) {
+	return 1;
+    }
+    __sync_synchronize();
+    if (*seq == in_place_seq) {
+	return 1;
+    }
+    in_buffer_id = in_place_prev_id;
+    in_place_data = NULL;
+    return 0;
+}
+
+/* Sleeps on the blocking semaphore, which every write to the buffer
+   flushes.  The flush leaves the semaphore given when nobody is waiting,
+   so a write since the last wait makes the next one return at once. */
+CMS_STATUS SHMEM::wait_for_write(double _timeout)
+{
+    if (NULL == bsem) {
+	return (status = CMS_NO_BLOCKING_SEM_ERROR);
+    }
+    bsem->timeout = _timeout;
+    if (bsem->wait() == -1) {
+	if (errno == EAGAIN || errno == EINTR) {
+	    return (status = CMS_TIMED_OUT);
+	}
+	rcs_print_error("CMS: Blocking semaphore error.\n");
+	return (status = CMS_MISC_ERROR);
+    }
+    return (status = CMS_READ_OK);
+}
+
+/* Does what main_access() does for a LOCKFREE buffer, see
+   SHMEM_LOCK_FREE_QUEUE above. */
+CMS_STATUS SHMEM::lock_free_access(void *_local)
+{
+    SHMEM_LOCK_FREE_SLOT *slot;
+    unsigned int pos, head, tail;
+    int diff;
+
+    if (lfq->magic != SHMEM_LOCK_FREE_MAGIC) {
+	return (status = CMS_NO_MASTER_ERROR);
+    }
+
+    switch (internal_access_type) {
+    case CMS_WRITE_IF_READ_ACCESS:
+	if (lfq->head != lfq->tail) {
+	    return (status = CMS_WRITE_WAS_BLOCKED);
+	}
+	/* fall through */
+    case CMS_WRITE_ACCESS:
+	if (!write_permission_flag) {
+	    rcs_print_error("CMS: %s was not configured to write to %s\n",
+		ProcessName, BufferName);
+	    return (status = CMS_PERMISSIONS_ERROR);
+	}
+	if (header.in_buffer_size > max_message_size) {
+	    rcs_print_error
+		("CMS:(%s) Message size of %ld exceeds maximum of %ld\n",
+		BufferName, header.in_buffer_size, max_message_size);
+	    return (status = CMS_INSUFFICIENT_SPACE_ERROR);
+	}
+	pos = lfq->head;
+	for (;;) {
+	    slot = lock_free_slot(lfq, pos);
+	    diff = (int) (slot->seq - pos);
+	    if (diff == 0) {
+		if (__sync_bool_compare_and_swap(&lfq->head, pos, pos + 1)) {
+		    break;
+		}
+	    } else if (diff < 0) {
+		if (cms_print_queue_free_space || cms_print_queue_full_messages) {
+		    rcs_print_error("CMS: %s message queue is full.\n",
+			BufferName);
+		}
+		return (status = CMS_QUEUE_FULL);
+	    }
+	    pos = lfq->head;
+	}
+	slot->header.was_read = 0;
+	slot->header.write_id = pos + 1;
+	slot->header.in_buffer_size = header.in_buffer_size;
+	memcpy((char *) slot + SHMEM_LOCK_FREE_DATA_OFFSET, _local,
+	    header.in_buffer_size);
+	__sync_synchronize();
+	slot->seq = pos + 1;
+	header.write_id = pos + 1;
+	if (NULL != bsem) {
+	    bsem->flush();
+	}
+	return (status = CMS_WRITE_OK);
+
+    case CMS_READ_ACCESS:
+    case CMS_PEEK_ACCESS:
+	if (!read_permission_flag) {
+	    rcs_print_error("CMS: %s was not configured to read %s\n",
+		ProcessName, BufferName);
+	    return (status = CMS_PERMISSIONS_ERROR);
+	}
+	for (;;) {
+	    pos = lfq->tail;
+	    slot = lock_free_slot(lfq, pos);
+	    diff = (int) (slot->seq - (pos + 1));
+	    if (diff < 0) {
+		if (internal_access_type != CMS_READ_ACCESS || NULL == bsem
+		    || !not_zero(blocking_timeout)) {
+		    return (status = CMS_READ_OLD);
+		}
+		bsem->timeout = blocking_timeout;
+		switch (bsem->wait()) {
+		case -2:
+		    return (status = CMS_TIMED_OUT);
+		case -1:
+		    rcs_print_error("CMS: Blocking semaphore error.\n");
+		    return (status = CMS_MISC_ERROR);
+		default:
+		    continue;
+		}
+	    }
+	    if (diff > 0) {
+		continue;
+	    }
+	    if (internal_access_type == CMS_READ_ACCESS) {
+		if (!__sync_bool_compare_and_swap(&lfq->tail, pos, pos + 1)) {
+		    continue;
+		}
+	    } else {
+		__sync_synchronize();
+	    }
+	    header = slot->header;
+	    if (header.in_buffer_size <= max_message_size) {
+		memcpy(subdiv_data, (char *) slot + SHMEM_LOCK_FREE_DATA_OFFSET,
+		    header.in_buffer_size);
+	    }
+	    __sync_synchronize();
+	    if (internal_access_type == CMS_READ_ACCESS) {
+		/* the slot is ours until this hands it back to the writers */
+		slot->seq = pos + lfq->nslots;
+		header.was_read = 1;
+		break;
+	    }
+	    /* a peek copied the message while it stayed where it was */
+	    if (slot->seq == pos + 1 && lfq->tail == pos) {
+		break;
+	    }
+	}
+	if (header.in_buffer_size > max_message_size) {
+	    rcs_print_error
+		("CMS:(%s) Message size of %ld exceeds maximum of %ld\n",
+		BufferName, header.in_buffer_size, max_message_size);
+	    return (status = CMS_INTERNAL_ACCESS_ERROR);
+	}
+	check_id(header.write_id);
+	return (status);
+
+    case CMS_CHECK_IF_READ_ACCESS:
+    case CMS_GET_QUEUE_LENGTH_ACCESS:
+    case CMS_GET_SPACE_AVAILABLE_ACCESS:
+	tail = lfq->tail;
+	__sync_synchronize();
+	head = lfq->head;
+	queuing_header.queue_length = head - tail;
+	if (queuing_header.queue_length > (long) lfq->nslots) {
+	    queuing_header.queue_length = lfq->nslots;
+	}
+	header.was_read = (queuing_header.queue_length == 0);
+	free_space = (lfq->nslots - queuing_header.queue_length) *
+	    max_message_size;
+	return (status);
+
+    case CMS_GET_MSG_COUNT_ACCESS:
+	header.write_id = lfq->head;
+	return (status);
+
+    case CMS_CLEAR_ACCESS:
+	/* take everything that is in the queue, like a reader would */
+	for (;;) {
+	    pos = lfq->tail;
+	    slot = lock_free_slot(lfq, pos);
+	    diff = (int) (slot->seq - (pos + 1));
+	    if (diff < 0) {
+		break;
+	    }
+	    if (diff == 0
+		&& __sync_bool_compare_and_swap(&lfq->tail, pos, pos + 1)) {
+		slot->seq = pos + lfq->nslots;
+	    }
+	}
+	in_buffer_id = 0;
+	return (status = CMS_CLEAR_OK);
+
+    default:
+	return (status = CMS_INTERNAL_ACCESS_ERROR);
+    }
+}
@@ -42,8 +42,12 @@ class SHMEM:public CMS {
     virtual ~ SHMEM();
 
     CMS_STATUS main_access(void *_local);
+    CMS_STATUS peek_in_place();
+    CMS_STATUS wait_for_write(double _timeout);
+    int in_place_valid();
 
   private:
+    CMS_STATUS lock_free_access(void *_local);
 
     /* data buffer stuff */
     int fast_mode;
@@ -78,6 +82,14 @@ class SHMEM:public CMS {
     RCS_SEMAPHORE *bsem;	// blocking semaphore
     int autokey_table_size;
 
+    volatile unsigned int *seq;	/* odd while a writer changes the buffer */
+    unsigned int in_place_seq;	/* *seq when the message was peeked in place */
+    CMSID in_place_prev_id;	/* in_buffer_id before that */
+
+    int lock_free;		/* queue without taking the mutex */
+    int lock_free_slots;	/* number of messages the queue holds */
+    struct SHMEM_LOCK_FREE_QUEUE *lfq;
+
 };
 
 #endif /* !SHMEM_HH */
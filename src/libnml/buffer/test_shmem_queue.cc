@@ -0,0 +1,158 @@
+/* Times a queued SHMEM buffer with several writer processes and one
+   reader, once with the mutex and once LOCKFREE, and prints messages
+   per second for both.  A message that is lost, duplicated or out of
+   order for its writer is reported as ****fail****.
+
+   usage: test_shmem_queue [writers [messages-per-writer]] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "cms.hh"
+#include "shmem.hh"
+#include "timer.hh"
+
+#define MAX_WRITERS 64
+
+struct TEST_MSG {
+    long type;			/* laid out like an NMLmsg */
+    long size;
+    int writer;
+    int n;
+    double payload[4];
+};
+
+static const char *procline(char *buf, const char *ops, int master,
+    int cnum)
+{
+    sprintf(buf, "P p%d q LOCAL localhost %s 0 10.0 %d %d", cnum, ops,
+	master, cnum);
+    return buf;
+}
+
+static void writer(const char *bufline, int w, int count)
+{
+    char pl[128];
+    SHMEM *cms = new SHMEM(bufline, procline(pl, "W", 0, w + 1), 0, -1);
+    TEST_MSG msg;
+    int n;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.type = 1;
+    msg.size = sizeof(msg);
+    msg.writer = w;
+    for (n = 0; n < count; n++) {
+	msg.n = n;
+	for (;;) {
+	    cms->header.in_buffer_size = sizeof(msg);
+	    if (cms->write(&msg) != CMS_QUEUE_FULL) {
+		break;
+	    }
+	    /* let the reader make room */
+	    sched_yield();
+	}
+	if (cms->status < 0) {
+	    printf("writer %d: status %d\n", w, cms->status);
+	    break;
+	}
+    }
+    delete cms;
+}
+
+static int run(const char *name, const char *bufline, int writers,
+    int count)
+{
+    char pl[128];
+    SHMEM *cms = new SHMEM(bufline, procline(pl, "R", 1, 0), 0, 1);
+    int next[MAX_WRITERS];
+    int w, got = 0, bad = 0, done = 0, status;
+    double t0, t;
+
+    if (cms->status < 0) {
+	printf("%-10s could not open the buffer (%d)\n", name, cms->status);
+	delete cms;
+	return 1;
+    }
+    memset(next, 0, sizeof(next));
+    fflush(stdout);
+    t0 = etime();
+    for (w = 0; w < writers; w++) {
+	if (fork() == 0) {
+	    writer(bufline, w, count);
+	    fflush(stdout);
+	    _exit(0);
+	}
+    }
+    while (got < writers * count) {
+	switch (cms->read()) {
+	case CMS_READ_OK:
+	    break;
+	case CMS_READ_OLD:
+	    /* stop if the writers all exited and left nothing behind */
+	    if (done == writers) {
+		break;
+	    }
+	    while (done < writers && waitpid(-1, &status, WNOHANG) > 0) {
+		done++;
+	    }
+	    sched_yield();
+	    continue;
+	default:
+	    printf("%-10s read status %d\n", name, cms->status);
+	    bad++;
+	    break;
+	}
+	if (cms->status != CMS_READ_OK) {
+	    break;
+	}
+	TEST_MSG *msg = (TEST_MSG *) cms->subdiv_data;
+	if (msg->writer < 0 || msg->writer >= writers
+	    || msg->n != next[msg->writer]) {
+	    bad++;
+	} else {
+	    next[msg->writer]++;
+	}
+	got++;
+    }
+    t = etime() - t0;
+    for (w = done; w < writers; w++) {
+	wait(&status);
+    }
+    bad += writers * count - got;
+    if (cms->get_queue_length() != 0) {
+	bad++;
+    }
+    printf("%-10s %d writers %10.0f messages/s", name, writers, got / t);
+    if (bad) {
+	printf(" ****fail**** (%d messages wrong)", bad);
+    }
+    printf("\n");
+    delete cms;
+    return bad != 0;
+}
+
+int main(int argc, char **argv)
+{
+    int writers = argc > 1 ? atoi(argv[1]) : 4;
+    int count = argc > 2 ? atoi(argv[2]) : 100000;
+    int fail = 0;
+
+    /* a full queue is what this is about */
+    cms_print_queue_full_messages = 0;
+
+    if (writers < 1 || writers > MAX_WRITERS || count < 1) {
+	fprintf(stderr, "usage: %s [writers [messages-per-writer]]\n",
+	    argv[0]);
+	return 2;
+    }
+    fail += run("mutex",
+	"B q SHMEM localhost 8192 0 0 1 80 7341 queue", writers, count);
+    fail += run("lockfree",
+	"B q SHMEM localhost 8192 0 0 1 80 7342 queue LOCKFREE SLOTS=32",
+	writers, count);
+    return fail ? 1 : 0;
+}
@@ -617,6 +617,7 @@ void CMS::open(void)
     /* free successfully allocated memory. */
     data = NULL;
     subdiv_data = NULL;
+    in_place_data = NULL;
     encoded_data = NULL;
     encoded_header = NULL;
     encoded_queuing_header = NULL;
@@ -994,6 +995,7 @@ int CMS::get_space_available()
 
 CMS_STATUS CMS::read()
 {
+    in_place_data = NULL;
     internal_access_type = CMS_READ_ACCESS;
     status = CMS_STATUS_NOT_SET;
     blocking_timeout = 0;
@@ -1003,6 +1005,7 @@ CMS_STATUS CMS::read()
 
 CMS_STATUS CMS::blocking_read(double _blocking_timeout)
 {
+    in_place_data = NULL;
     status = CMS_STATUS_NOT_SET;
     internal_access_type = CMS_READ_ACCESS;
     blocking_timeout = _blocking_timeout;
@@ -1010,6 +1013,12 @@ CMS_STATUS CMS::blocking_read(double _blocking_timeout)
     return (status);
 }
 
+/* Only buffers with a blocking semaphore can be waited on. */
+CMS_STATUS CMS::wait_for_write(double _timeout)
+{
+    return (status = CMS_NO_BLOCKING_SEM_ERROR);
+}
+
 void CMS::disconnect()
 {
 }
@@ -1020,6 +1029,7 @@ void CMS::reconnect()
 
 CMS_STATUS CMS::peek()
 {
+    in_place_data = NULL;
     internal_access_type = CMS_PEEK_ACCESS;
     status = CMS_STATUS_NOT_SET;
     blocking_timeout = 0;
@@ -1027,6 +1037,18 @@ CMS_STATUS CMS::peek()
     return (status);
 }
 
+/* Buffers that can not be read in place just copy the message. */
+CMS_STATUS CMS::peek_in_place()
+{
+    return peek();
+}
+
+/* A copied message stays valid until the next read. */
+int CMS::in_place_valid()
+{
+    return 1;
+}
+
 CMS_STATUS CMS::write(void *user_data)
 {
     internal_access_type = CMS_WRITE_ACCESS;
@@ -193,6 +193,13 @@ class CMS {
 							   wait for new data. 
 							 */
     virtual CMS_STATUS peek();	/* Read without setting flag. */
+    virtual CMS_STATUS wait_for_write(double _timeout);	/* Sleep until the
+							   buffer is written
+							   to. */
+    virtual CMS_STATUS peek_in_place();	/* Peek, without copying if the
+					   buffer allows it. */
+    virtual int in_place_valid();	/* Was the message peeked in place
+					   left alone while it was used? */
     virtual CMS_STATUS write(void *user_data);	/* Write to buffer. */
     virtual CMS_STATUS write_if_read(void *user_data);	/* Write to buffer. */
     virtual int login(const char *name, const char *passwd);
@@ -349,6 +356,7 @@ class CMS {
     void set_encoded_data(void *, long _encoded_data_size);
     void *data;			/* pointer to local copy of data (raw) */
     void *subdiv_data;		/* pointer to current subdiv; */
+    void *in_place_data;	/* message peeked in place, or NULL */
 
     /* Intersting Info Saved from the Configuration File. */
     char BufferName[CMS_CONFIG_LINELEN];
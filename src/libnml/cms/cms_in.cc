@@ -1465,8 +1465,10 @@ CMS_STATUS CMS::queue_write_raw(void *user_data)
 	    queuing_header.queue_length, queuing_header.write_id);
     }
 
-    /* Check to see if there is enough free space. */
-    if (free_space < ((long) (header.in_buffer_size + sizeof(CMS_HEADER)))) {
+    /* Check to see if there is enough free space.  A message that filled
+       it exactly would leave tail == head, which the next writer takes
+       for the start of free space, so it has to be left some room. */
+    if (free_space <= ((long) (header.in_buffer_size + sizeof(CMS_HEADER)))) {
 	if (cms_print_queue_free_space || cms_print_queue_full_messages) {
 	    rcs_print_error("CMS: %s message queue is full.\n", BufferName);
 	    rcs_print_error
@@ -1676,7 +1678,7 @@ CMS_STATUS CMS::queue_write_encoded()
     }
 
     /* Check to see if there is enough free space. */
-    if (free_space < header.in_buffer_size + encoded_header_size) {
+    if (free_space <= header.in_buffer_size + encoded_header_size) {
 	if (cms_print_queue_free_space || cms_print_queue_full_messages) {
 	    rcs_print_error("CMS: %s message queue is full.\n", BufferName);
 	    rcs_print_error
@@ -1894,8 +1896,9 @@ CMS_STATUS CMS::queue_write_if_read_raw(void *user_data)
 	    queuing_header.queue_length, queuing_header.write_id);
     }
 
-    /* Check to see if there is enough free space. */
-    if (free_space < ((long) (header.in_buffer_size + sizeof(CMS_HEADER)))) {
+    /* Check to see if there is enough free space, leaving some as
+       queue_write_raw() does. */
+    if (free_space <= ((long) (header.in_buffer_size + sizeof(CMS_HEADER)))) {
 	if (cms_print_queue_free_space || cms_print_queue_full_messages) {
 	    rcs_print_error("CMS: %s message queue is full.\n", BufferName);
 	    rcs_print_error
@@ -2113,7 +2116,7 @@ CMS_STATUS CMS::queue_write_if_read_encoded()
     }
 
     /* Check to see if there is enough free space. */
-    if (free_space < header.in_buffer_size + encoded_header_size) {
+    if (free_space <= header.in_buffer_size + encoded_header_size) {
 	if (cms_print_queue_free_space || cms_print_queue_full_messages) {
 	    rcs_print_error("CMS: %s message queue is full.\n", BufferName);
 	    rcs_print_error
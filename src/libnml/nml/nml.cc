@@ -803,6 +803,8 @@ NMLmsg *NML::get_address()
 	}
 	error_type = NML_INVALID_CONFIGURATION;
 	return ((NMLmsg *) NULL);
+    } else if (NULL != cms->in_place_data) {
+	return ((NMLmsg *) cms->in_place_data);
     } else {
 	return ((NMLmsg *) cms->subdiv_data);
     }
@@ -1383,6 +1385,117 @@ NMLTYPE NML::peek()
 
 }
 
+/***********************************************************
+* NML Member Function: peek_in_place()
+* Purpose: Same as peek(), except that for a local SHMEM buffer
+* holding raw messages, get_address() points at the message in
+* shared memory instead of at a copy of it.
+* Returns:
+*  0 The read was successful but the data was not updated since the last read.
+*  -1 The buffer could not be read.
+*  o.w. The type of the new NMLmsg is returned.
+* Notes:
+*  1. The writer does not wait for readers, so the message can change
+* while it is being used.  Call in_place_valid() when done with it.
+* If that returns 0, throw away whatever was taken from the message
+* and call peek() to get a copy.
+*  2. All other buffers are copied as by peek(), and in_place_valid()
+* returns 1 for them.
+***********************************************************/
+NMLTYPE NML::peek_in_place()
+{
+    error_type = NML_NO_ERROR;
+    if (NULL == cms) {
+	if (error_type != NML_INVALID_CONFIGURATION) {
+	    error_type = NML_INVALID_CONFIGURATION;
+	    rcs_print_error("NML::peek_in_place: CMS not configured.\n");
+	}
+	return (-1);
+    }
+
+    if (cms->is_phantom) {
+	return peek();
+    }
+    if (!cms->force_raw) {
+	cms->set_mode(CMS_READ);
+    }
+
+    cms->peek_in_place();
+    if (!cms->force_raw && NULL == cms->in_place_data) {
+	if (cms->status == CMS_READ_OK) {
+	    if (-1 == format_output()) {
+		error_type = NML_FORMAT_ERROR;
+		return (-1);
+	    }
+	}
+    }
+
+    switch (cms->status) {
+    case CMS_READ_OLD:
+	return (0);
+    case CMS_READ_OK:
+	if (get_address()->type <= 0 && !cms->isserver) {
+	    rcs_print_error
+		("NML: New data recieved but type of %d is invalid.\n",
+		(int) get_address()->type);
+	    return -1;
+	}
+	return (get_address()->type);
+
+    default:
+	set_error();
+	return -1;
+    }
+}
+
+/***********************************************************
+* NML Member Function: in_place_valid()
+* Purpose: Tells whether the message found by peek_in_place() was
+* left alone by the writer until now.
+* Returns:
+*  1 Everything taken from the message since peek_in_place() is good.
+*  0 The message was overwritten; the next read or peek copies it.
+***********************************************************/
+int NML::in_place_valid()
+{
+    if (NULL == cms) {
+	return (0);
+    }
+    return (cms->in_place_valid());
+}
+
+/***********************************************************
+* NML Member Function: wait_for_write()
+* Purpose: Sleeps until a message is written to the buffer or the
+* timeout passes, without reading it.
+* Returns:
+*  1 A message may have been written.
+*  0 The timeout passed.
+*  -1 The buffer has no blocking semaphore (bsem= in the buffer line),
+*     or waiting on it failed.
+* Notes:
+*  1. A write since the last wait is not missed, but a wait may return
+* 1 once without a new message, so check the buffer before acting.
+***********************************************************/
+int NML::wait_for_write(double timeout)
+{
+    if (NULL == cms) {
+	error_type = NML_INVALID_CONFIGURATION;
+	return (-1);
+    }
+    error_type = NML_NO_ERROR;
+    switch (cms->wait_for_write(timeout)) {
+    case CMS_READ_OK:
+	return (1);
+    case CMS_TIMED_OUT:
+	error_type = NML_TIMED_OUT;
+	return (0);
+    default:
+	error_type = NML_INTERNAL_CMS_ERROR;
+	return (-1);
+    }
+}
+
 /***********************************************************
 * NML Member Function: format_output()
 * Purpose: Formats the data read from a CMS buffer as required
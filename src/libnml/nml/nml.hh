@@ -97,6 +97,12 @@ class NML:public virtual CMS_USER {
     NMLTYPE peek();		/* Read buffer without changing was_read */
     NMLTYPE read(void *, long);
     NMLTYPE peek(void *, long);
+    NMLTYPE peek_in_place();	/* Peek, leaving the message where it is
+				   if the buffer allows it. */
+    int in_place_valid();	/* Was that message left alone while it
+				   was used? */
+    int wait_for_write(double timeout);	/* Sleep until the buffer is
+					   written to. */
     int write(NMLmsg & nml_msg);	/* Write a message. (Use reference) */
     int write(NMLmsg * nml_msg);	/* Write a message. (Use pointer) */
     int write_if_read(NMLmsg & nml_msg);	/* Write only if buffer
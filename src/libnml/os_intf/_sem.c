@@ -64,8 +64,12 @@ union semun {
    since rcs_sem_close frees the storage allocated for the rcs_sem_t */
 int rcs_sem_destroy(rcs_sem_t * sem)
 {
-    /* remove OS semaphore */
+    /* remove OS semaphore; buffers that share a blocking semaphore
+       each remove it, and all but the first find it gone */
     if (semctl(*sem, 0, IPC_RMID, 0) == -1) {
+	if (errno == EINVAL || errno == EIDRM) {
+	    return 0;
+	}
 	rcs_print_error("semctl(%d,0,%d) failed: (errno = %d) %s\n",
 	    *sem, IPC_RMID, errno, strerror(errno));
 	return -1;
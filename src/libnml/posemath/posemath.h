@@ -644,6 +644,21 @@ extern "C" {
 
     } PmCircle;
 
+/* Structure-of-arrays buffers for the batch functions.  Point i is
+   (x[i], y[i], z[i]); pose i has translation tran[i] and rotation
+   (s[i], x[i], y[i], z[i]). */
+
+    typedef struct {
+	double *x, *y, *z;
+
+    } PmCartesianArray;
+
+    typedef struct {
+	PmCartesianArray tran;
+	double *s, *x, *y, *z;
+
+    } PmPoseArray;
+
 /*
    shorthand types for normal use-- don't define PM_LOOSE_NAMESPACE if these
    names are used by other headers you need to include and you don't want
@@ -917,6 +932,32 @@ extern "C" {
 	PmCartesian center, PmCartesian normal, int turn);
     extern int pmCirclePoint(PmCircle * circle, double angle, PmPose * point);
 
+/* batch functions
+
+   These apply one transform to n points or poses at a time and give the
+   same results as calling the scalar function on each of them.  The
+   arguments are checked once per call instead of once per point.  An
+   output array may be the same as an input array, but must not
+   otherwise overlap it.  They are only built into the user space
+   library. */
+
+    extern int pmCartArrayCartAdd(PmCartesianArray v1, PmCartesian v2,
+	PmCartesianArray vout, int n);
+    extern int pmCartArrayCartSub(PmCartesianArray v1, PmCartesian v2,
+	PmCartesianArray vout, int n);
+    extern int pmCartArrayScalMult(PmCartesianArray v1, double d,
+	PmCartesianArray vout, int n);
+    extern int pmMatCartArrayMult(PmRotationMatrix m, PmCartesianArray v,
+	PmCartesianArray vout, int n);
+    extern int pmQuatCartArrayMult(PmQuaternion q1, PmCartesianArray v2,
+	PmCartesianArray vout, int n);
+    extern int pmPoseCartArrayMult(PmPose p1, PmCartesianArray v2,
+	PmCartesianArray vout, int n);
+    extern int pmHomCartArrayMult(PmHomogeneous h1, PmCartesianArray v2,
+	PmCartesianArray vout, int n);
+    extern int pmPosePoseArrayMult(PmPose p1, PmPoseArray p2,
+	PmPoseArray pout, int n);
+
 /* slicky macros for item-by-item copying between C and C++ structs */
 
 #define toCart(src,dst) {(dst)->x = (src).x; (dst)->y = (src).y; (dst)->z = (src).z;}
@@ -0,0 +1,170 @@
+/* Checks the posemath batch functions against the scalar ones and
+   times both.  Any difference is reported as ****fail****. */
+#include "posemath.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#define N (4096)
+#define REPEAT (500)
+
+static double unow(void)
+{
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec * 1e-6;
+}
+
+static double rnd(void)
+{
+    return 200.0 * rand() / RAND_MAX - 100.0;
+}
+
+static PmCartesian pts[N], out[N];
+static PmPose poses[N], pout[N];
+static double ax[N], ay[N], az[N], bx[N], by[N], bz[N];
+static double as[N], aqx[N], aqy[N], aqz[N];
+static double bs[N], bqx[N], bqy[N], bqz[N];
+
+static PmCartesianArray a = { ax, ay, az };
+static PmCartesianArray b = { bx, by, bz };
+static PmPoseArray pa = { { ax, ay, az }, as, aqx, aqy, aqz };
+static PmPoseArray pb = { { bx, by, bz }, bs, bqx, bqy, bqz };
+
+static int fail;
+
+static void compare_cart(const char *name, double scalar, double batch)
+{
+    int i, bad = 0;
+
+    for (i = 0; i < N; i++) {
+	if (out[i].x != bx[i] || out[i].y != by[i] || out[i].z != bz[i])
+	    bad++;
+    }
+    printf("%-20s", name);
+    if (scalar > 0.0)
+	printf(" scalar %6.2fns/pt batch %6.2fns/pt",
+	    scalar * 1e9 / N / REPEAT, batch * 1e9 / N / REPEAT);
+    if (bad) {
+	fail++;
+	printf(" ****fail**** (%d points differ)", bad);
+    }
+    printf("\n");
+}
+
+static void compare_pose(const char *name, double scalar, double batch)
+{
+    int i, bad = 0;
+
+    for (i = 0; i < N; i++) {
+	if (pout[i].tran.x != bx[i] || pout[i].tran.y != by[i]
+	    || pout[i].tran.z != bz[i] || pout[i].rot.s != bs[i]
+	    || pout[i].rot.x != bqx[i] || pout[i].rot.y != bqy[i]
+	    || pout[i].rot.z != bqz[i])
+	    bad++;
+    }
+    printf("%-20s scalar %6.2fns/pt batch %6.2fns/pt", name,
+	scalar * 1e9 / N / REPEAT, batch * 1e9 / N / REPEAT);
+    if (bad) {
+	fail++;
+	printf(" ****fail**** (%d poses differ)", bad);
+    }
+    printf("\n");
+}
+
+#define TIME(t, body) do { \
+	int r; double t0 = unow(); \
+	for (r = 0; r < REPEAT; r++) { body; } \
+	t = unow() - t0; \
+    } while (0)
+
+int main(void)
+{
+    PmCartesian v;
+    PmRotationVector rv;
+    PmPose pose;
+    PmHomogeneous hom;
+    double scalar, batch;
+    int i;
+
+    srand(1);
+    for (i = 0; i < N; i++) {
+	pts[i].x = ax[i] = rnd();
+	pts[i].y = ay[i] = rnd();
+	pts[i].z = az[i] = rnd();
+	v.x = rnd();
+	v.y = rnd();
+	v.z = rnd();
+	pmCartUnit(v, &v);
+	rv.s = rnd() * PM_PI / 100.0;
+	rv.x = v.x;
+	rv.y = v.y;
+	rv.z = v.z;
+	poses[i].tran = pts[i];
+	pmRotQuatConvert(rv, &poses[i].rot);
+	as[i] = poses[i].rot.s;
+	aqx[i] = poses[i].rot.x;
+	aqy[i] = poses[i].rot.y;
+	aqz[i] = poses[i].rot.z;
+    }
+
+    v.x = 1.5;
+    v.y = -2.25;
+    v.z = 3.125;
+    pose.tran = v;
+    rv.s = 0.7;
+    rv.x = 0.0;
+    rv.y = 0.6;
+    rv.z = 0.8;
+    pmRotQuatConvert(rv, &pose.rot);
+    pmPoseHomConvert(pose, &hom);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmCartCartAdd(pts[i], v, &out[i]));
+    TIME(batch, pmCartArrayCartAdd(a, v, b, N));
+    compare_cart("pmCartCartAdd", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmCartCartSub(pts[i], v, &out[i]));
+    TIME(batch, pmCartArrayCartSub(a, v, b, N));
+    compare_cart("pmCartCartSub", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmCartScalMult(pts[i], 0.3, &out[i]));
+    TIME(batch, pmCartArrayScalMult(a, 0.3, b, N));
+    compare_cart("pmCartScalMult", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmMatCartMult(hom.rot, pts[i], &out[i]));
+    TIME(batch, pmMatCartArrayMult(hom.rot, a, b, N));
+    compare_cart("pmMatCartMult", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmQuatCartMult(pose.rot, pts[i], &out[i]));
+    TIME(batch, pmQuatCartArrayMult(pose.rot, a, b, N));
+    compare_cart("pmQuatCartMult", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmPoseCartMult(pose, pts[i], &out[i]));
+    TIME(batch, pmPoseCartArrayMult(pose, a, b, N));
+    compare_cart("pmPoseCartMult", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) {
+	pmMatCartMult(hom.rot, pts[i], &out[i]);
+	pmCartCartAdd(hom.tran, out[i], &out[i]);
+    });
+    TIME(batch, pmHomCartArrayMult(hom, a, b, N));
+    compare_cart("pmHomCartMult", scalar, batch);
+
+    TIME(scalar, for (i = 0; i < N; i++) pmPosePoseMult(pose, poses[i], &pout[i]));
+    TIME(batch, pmPosePoseArrayMult(pose, pa, pb, N));
+    compare_pose("pmPosePoseMult", scalar, batch);
+
+    /* in place */
+    for (i = 0; i < N; i++) {
+	pmPoseCartMult(pose, pts[i], &out[i]);
+	bx[i] = ax[i];
+	by[i] = ay[i];
+	bz[i] = az[i];
+    }
+    pmPoseCartArrayMult(pose, b, b, N);
+    compare_cart("in place", 0.0, 0.0);
+
+    return fail ? 1 : 0;
+}
@@ -0,0 +1,2 @@
+#!/bin/sh
+test_canon_queue 20000
@@ -0,0 +1,2 @@
+#!/bin/sh
+halrun -b -f batch.hal
@@ -0,0 +1,62 @@
+#!/bin/sh
+realtime start
+python <<EOF
+import hal
+import array
+h = hal.component("x")
+try:
+    h.newpin("s", hal.HAL_S32, hal.HAL_OUT)
+    h.newpin("u", hal.HAL_U32, hal.HAL_OUT)
+    h.newpin("f", hal.HAL_FLOAT, hal.HAL_OUT)
+    h.newpin("b", hal.HAL_BIT, hal.HAL_OUT)
+    h.newparam("param", hal.HAL_FLOAT, hal.HAL_RW)
+    h.ready()
+
+    g = h.getgroup(["s", "u", "f", "b", "param"])
+    print "names", len(g), g.get_names()
+    print "get", g.get()
+    print "changed", g.changed()
+    print "changed", g.changed()
+    h["f"] = 2.5
+    h["s"] = -3
+    print "changed", g.changed()
+
+    g.set([1, 2, 3.5, True, -1.25])
+    print "set", g.get(), h["s"], h["param"]
+    print "changed", g.changed()
+
+    a = array.array('d', [0] * len(g))
+    g.read_into(a)
+    print "read_into", list(a)
+    g.write_from(array.array('d', [-7, 4294967295, 1e10, 0, 0.5]))
+    print "write_from", g.get()
+
+    try:
+        g.write_from(array.array('d', [0, -1, 0, 0, 0]))
+        print "write_from", "-1", "ok"
+    except OverflowError:
+        print "write_from", "-1", "fail"
+    try:
+        g.set([1, 2])
+        print "set", "short", "ok"
+    except ValueError:
+        print "set", "short", "fail"
+    try:
+        g.read_into(array.array('d', [0]))
+        print "read_into", "short", "ok"
+    except ValueError:
+        print "read_into", "short", "fail"
+    try:
+        h.getgroup(["s", "not-found"])
+        print "getgroup", "not-found", "ok"
+    except AttributeError:
+        print "getgroup", "not-found", "fail"
+    del g
+except:
+    import traceback
+    print "Exception:", traceback.format_exc()
+    raise
+finally:
+    h.exit()
+EOF
+realtime stop
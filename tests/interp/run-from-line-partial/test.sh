@@ -0,0 +1,3 @@
+#!/bin/bash
+rs274 -i test.ini -r 10 -R 9 -g test.ngc | awk '{$1=""; print}'
+exit ${PIPESTATUS[0]}
@@ -0,0 +1,2 @@
+#!/bin/sh
+test_posemath_batch
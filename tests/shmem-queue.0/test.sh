@@ -0,0 +1,2 @@
+#!/bin/sh
+test_shmem_queue 4 2000
@@ -0,0 +1,2 @@
+#!/bin/sh
+test_tool_store